@@ -34,6 +34,7 @@
 #include <ctkCmdLineModuleConcurrentHelpers.h>
 #include <ctkCmdLineModuleDescription.h>
 #include <ctkCmdLineModuleFrontendFactoryQtGui.h>
+#include <ctkCmdLineModuleFrontendQtGui.h>
 #include <ctkCmdLineModuleFrontendFactoryQtWebKit.h>
 #include <ctkCmdLineModuleBackendLocalProcess.h>
 #include <ctkCmdLineModuleBackendFunctionPointer.h>
@@ -107,6 +108,9 @@ ctkCLModuleExplorerMainWindow::ctkCLModuleExplorerMainWindow(QWidget *parent) :
   // If a module is registered via the ModuleManager, add it to the tree
   connect(&moduleManager, SIGNAL(moduleRegistered(ctkCmdLineModuleReference)), ui->modulesTreeWidget, SLOT(addModuleItem(ctkCmdLineModuleReference)));
   connect(&moduleManager, SIGNAL(moduleUnregistered(ctkCmdLineModuleReference)), ui->modulesTreeWidget, SLOT(removeModuleItem(ctkCmdLineModuleReference)));
+  // Generate the Qt GUI of the registered modules in the background
+  connect(&moduleManager, &ctkCmdLineModuleManager::moduleRegistered,
+          [](const ctkCmdLineModuleReference& moduleRef) { ctkCmdLineModuleFrontendQtGui::prepareGui(moduleRef); });
   // React to specific frontend creations
   connect(ui->modulesTreeWidget, SIGNAL(moduleFrontendCreated(ctkCmdLineModuleFrontend*)), tabList.data(), SLOT(addTab(ctkCmdLineModuleFrontend*)));
   // React to tab-changes
@@ -207,7 +207,7 @@ QByteArray ctkCmdLineModuleBackendLocalProcess::rawXmlDescription(const QUrl &lo
 //----------------------------------------------------------------------------
 ctkCmdLineModuleFuture ctkCmdLineModuleBackendLocalProcess::run(ctkCmdLineModuleFrontend* frontend)
 {
-  QStringList args = d->commandLineArguments(frontend->values(), frontend->moduleReference().description());
+  QStringList args = this->commandLineArguments(frontend->values(), frontend->moduleReference().description());
 
   // Instances of ctkCmdLineModuleProcessTask are auto-deleted by the
   // thread pool.
@@ -216,6 +216,13 @@ ctkCmdLineModuleFuture ctkCmdLineModuleBackendLocalProcess::run(ctkCmdLineModule
   return moduleProcess->start();
 }
 
+//----------------------------------------------------------------------------
+QStringList ctkCmdLineModuleBackendLocalProcess::commandLineArguments(const QHash<QString,QVariant>& values,
+                                                                      const ctkCmdLineModuleDescription& description) const
+{
+  return d->commandLineArguments(values, description);
+}
+
 //----------------------------------------------------------------------------
 void ctkCmdLineModuleBackendLocalProcess::setTimeOutForXMLRetrieval(int timeOut)
 {
@@ -26,8 +26,12 @@
 
 #include "ctkCommandLineModulesBackendLocalProcessExport.h"
 
+#include <QHash>
 #include <QScopedPointer>
+#include <QStringList>
+#include <QVariant>
 
+class ctkCmdLineModuleDescription;
 struct ctkCmdLineModuleBackendLocalProcessPrivate;
 
 /**
@@ -102,6 +106,17 @@ public:
    */
   virtual int timeOutForXMLRetrieval() const;
 
+protected:
+
+  /**
+   * @brief Build the command line arguments of a module.
+   * @param values The parameter values, as returned by ctkCmdLineModuleFrontend::values().
+   * @param description The description of the module.
+   * @return The arguments to pass to the module executable.
+   */
+  QStringList commandLineArguments(const QHash<QString,QVariant>& values,
+                                   const ctkCmdLineModuleDescription& description) const;
+
 private:
 
   QScopedPointer<ctkCmdLineModuleBackendLocalProcessPrivate> d;
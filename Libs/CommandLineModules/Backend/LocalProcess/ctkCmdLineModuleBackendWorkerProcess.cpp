@@ -0,0 +1,277 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleBackendWorkerProcess.h"
+
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleFrontend.h"
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleParameter.h"
+#include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleRunException.h"
+#include "ctkCmdLineModuleWorkerPool_p.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSet>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QUrl>
+
+//----------------------------------------------------------------------------
+struct ctkCmdLineModuleBackendWorkerProcessPrivate
+{
+  mutable QMutex Mutex;
+  QSet<QString> WorkerLocations;
+  QString SharedMemoryPath;
+
+  QThread Thread;
+  ctkCmdLineModuleWorkerPool* Pool;
+
+  ctkCmdLineModuleBackendWorkerProcessPrivate()
+    : Pool(new ctkCmdLineModuleWorkerPool)
+  {
+#ifdef Q_OS_LINUX
+    QFileInfo shm("/dev/shm");
+    if (shm.isDir() && shm.isWritable())
+    {
+      this->SharedMemoryPath = shm.absoluteFilePath();
+    }
+#endif
+    if (this->SharedMemoryPath.isEmpty())
+    {
+      this->SharedMemoryPath = QDir::tempPath();
+    }
+
+    // The worker processes live in the thread of the pool, which is deleted
+    // with them once the thread finished.
+    this->Thread.setObjectName("ctkCmdLineModuleWorkerPool");
+    this->Pool->moveToThread(&this->Thread);
+    QObject::connect(&this->Thread, SIGNAL(finished()), this->Pool, SLOT(deleteLater()));
+    this->Thread.start();
+  }
+
+  ~ctkCmdLineModuleBackendWorkerProcessPrivate()
+  {
+    this->Thread.quit();
+    this->Thread.wait();
+  }
+
+  static bool isFileParameter(const ctkCmdLineModuleParameter& parameter)
+  {
+    static QSet<QString> fileTags = QSet<QString>() << "image" << "file" << "geometry"
+                                                    << "table" << "transform" << "pointfile";
+    return fileTags.contains(parameter.tag());
+  }
+
+  QString createSharedFile(const ctkCmdLineModuleParameter& parameter, const QByteArray& data) const
+  {
+    QString extension;
+    if (!parameter.fileExtensions().isEmpty())
+    {
+      extension = parameter.fileExtensions().front().trimmed();
+      if (!extension.isEmpty() && !extension.startsWith('.'))
+      {
+        extension.prepend('.');
+      }
+    }
+
+    QMutexLocker lock(&this->Mutex);
+    QTemporaryFile file(QDir(this->SharedMemoryPath).filePath("ctkCmdLineModule-XXXXXX" + extension));
+    lock.unlock();
+
+    // The file is removed by the invocation, once the module finished
+    file.setAutoRemove(false);
+    if (!file.open())
+    {
+      return QString();
+    }
+    if (!data.isEmpty() && file.write(data) != data.size())
+    {
+      file.remove();
+      return QString();
+    }
+    file.close();
+    return file.fileName();
+  }
+};
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleBackendWorkerProcess::ctkCmdLineModuleBackendWorkerProcess()
+  : d(new ctkCmdLineModuleBackendWorkerProcessPrivate)
+{
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleBackendWorkerProcess::~ctkCmdLineModuleBackendWorkerProcess()
+{
+}
+
+//----------------------------------------------------------------------------
+QString ctkCmdLineModuleBackendWorkerProcess::name() const
+{
+  return "Worker Process";
+}
+
+//----------------------------------------------------------------------------
+QString ctkCmdLineModuleBackendWorkerProcess::description() const
+{
+  return "Runs an executable command line module using reusable local processes.";
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBackendWorkerProcess::run(ctkCmdLineModuleFrontend* frontend)
+{
+  QString location = frontend->location().toLocalFile();
+  QHash<QString,QVariant> values = frontend->values();
+
+  QStringList inputFiles;
+  QHash<QString,QString> outputFiles;
+  foreach(const ctkCmdLineModuleParameter& parameter, frontend->parameters())
+  {
+    if (!d->isFileParameter(parameter))
+    {
+      continue;
+    }
+    QVariant data = frontend->value(parameter.name(), ctkCmdLineModuleFrontend::UserRole);
+    if (data.type() != QVariant::ByteArray)
+    {
+      continue;
+    }
+
+    bool output = parameter.channel().compare("output", Qt::CaseInsensitive) == 0;
+    QString filePath = d->createSharedFile(parameter, output ? QByteArray() : data.toByteArray());
+    if (filePath.isEmpty())
+    {
+      foreach(const QString& file, inputFiles + outputFiles.values())
+      {
+        QFile::remove(file);
+      }
+      throw ctkCmdLineModuleRunException(frontend->location(), 0,
+                                         QString("Could not write the value of parameter \"%1\" to %2")
+                                         .arg(parameter.name()).arg(this->sharedMemoryPath()));
+    }
+
+    values[parameter.name()] = filePath;
+    if (output)
+    {
+      outputFiles.insert(parameter.name(), filePath);
+    }
+    else
+    {
+      inputFiles << filePath;
+    }
+  }
+
+  ctkCmdLineModuleWorkerInvocationPointer invocation(new ctkCmdLineModuleWorkerInvocation(
+      location, this->commandLineArguments(values, frontend->moduleReference().description()),
+      this->isWorkerEnabled(frontend->location())));
+  invocation->InputFiles = inputFiles;
+  invocation->OutputFiles = outputFiles;
+
+  invocation->FutureInterface.setCanCancel(true);
+#ifdef Q_OS_UNIX
+  invocation->FutureInterface.setCanPause(true);
+#endif
+  invocation->FutureInterface.reportStarted();
+  ctkCmdLineModuleFuture future = invocation->FutureInterface.future();
+
+  d->Pool->enqueue(invocation);
+  return future;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBackendWorkerProcess::setWorkerEnabled(const QUrl& location, bool enabled)
+{
+  QMutexLocker lock(&d->Mutex);
+  if (enabled)
+  {
+    d->WorkerLocations.insert(location.toLocalFile());
+  }
+  else
+  {
+    d->WorkerLocations.remove(location.toLocalFile());
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleBackendWorkerProcess::isWorkerEnabled(const QUrl& location) const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->WorkerLocations.contains(location.toLocalFile());
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBackendWorkerProcess::setMaximumIdleWorkers(int count)
+{
+  d->Pool->setMaximumIdleWorkers(count);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBackendWorkerProcess::maximumIdleWorkers() const
+{
+  return d->Pool->maximumIdleWorkers();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBackendWorkerProcess::setWorkerIdleTimeout(int msecs)
+{
+  d->Pool->setIdleTimeout(msecs);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBackendWorkerProcess::workerIdleTimeout() const
+{
+  return d->Pool->idleTimeout();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBackendWorkerProcess::setWorkerStartTimeout(int msecs)
+{
+  d->Pool->setStartTimeout(msecs);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBackendWorkerProcess::workerStartTimeout() const
+{
+  return d->Pool->startTimeout();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBackendWorkerProcess::idleWorkerCount(const QUrl& location) const
+{
+  return d->Pool->idleWorkerCount(location.toLocalFile());
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBackendWorkerProcess::setSharedMemoryPath(const QString& path)
+{
+  QMutexLocker lock(&d->Mutex);
+  d->SharedMemoryPath = path;
+}
+
+//----------------------------------------------------------------------------
+QString ctkCmdLineModuleBackendWorkerProcess::sharedMemoryPath() const
+{
+  QMutexLocker lock(&d->Mutex);
+  return d->SharedMemoryPath;
+}
@@ -0,0 +1,155 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULEBACKENDWORKERPROCESS_H
+#define CTKCMDLINEMODULEBACKENDWORKERPROCESS_H
+
+#include "ctkCmdLineModuleBackendLocalProcess.h"
+
+#include <QScopedPointer>
+
+struct ctkCmdLineModuleBackendWorkerProcessPrivate;
+
+/**
+ * @ingroup CommandLineModulesBackendLocalProcess_API
+ *
+ * @brief A local process back-end which keeps module processes alive and
+ * exchanges in-memory data through shared memory files.
+ *
+ * This back-end handles the "file" URL scheme like ctkCmdLineModuleBackendLocalProcess
+ * and adds two features for modules which are run many times in a row:
+ *
+ * - <b>Worker processes</b>: for the modules enabled with setWorkerEnabled(), the
+ *   executable is started once with the \c &ndash;&ndash;worker argument and kept
+ *   alive between runs. A worker writes <tt>\<worker-ready/\></tt> on its standard
+ *   output once started, then reads one invocation per line of its standard input,
+ *   as a JSON array of command line arguments. For each invocation, it writes the
+ *   usual progress XML output followed by <tt>\<worker-done exit-code="N"/\></tt>.
+ *   A worker exits when its standard input is closed. Modules which do not
+ *   answer within workerStartTimeout() are run in a new process for each
+ *   invocation, like with ctkCmdLineModuleBackendLocalProcess.
+ * - <b>In-memory values</b>: for file-like parameters (image, file, geometry, ...),
+ *   a QByteArray returned by ctkCmdLineModuleFrontend::value() for the
+ *   ctkCmdLineModuleFrontend::UserRole role is written to a file in
+ *   sharedMemoryPath() whose path is passed to the module. On Linux, this defaults
+ *   to \c /dev/shm such that the data never hits the disk. For output parameters,
+ *   the content of the file is reported as a ctkCmdLineModuleResult holding a
+ *   QByteArray once the module finished. The files are removed after each run.
+ *
+ * Invocations are dispatched from a dedicated thread, so run() never blocks.
+ */
+class CTK_CMDLINEMODULEBACKENDLP_EXPORT ctkCmdLineModuleBackendWorkerProcess : public ctkCmdLineModuleBackendLocalProcess
+{
+
+public:
+
+  ctkCmdLineModuleBackendWorkerProcess();
+
+  /**
+   * @brief Stops all the worker processes and cancels the pending runs.
+   */
+  ~ctkCmdLineModuleBackendWorkerProcess();
+
+  virtual QString name() const;
+  virtual QString description() const;
+
+  /**
+   * @brief Run a front-end for this module, in a worker process if enabled.
+   * @param frontend The front-end to run.
+   * @return A future object for communicating with the running process.
+   * @throws ctkCmdLineModuleRunException if an in-memory value could not be
+   *         written to sharedMemoryPath().
+   */
+  virtual ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend* frontend);
+
+  /**
+   * @brief Enable or disable the worker mode of a module.
+   * @param location The location URL of the module.
+   * @param enabled \c true if the module supports the worker protocol.
+   *
+   * By default, a module is run in a new process for each invocation.
+   */
+  void setWorkerEnabled(const QUrl& location, bool enabled = true);
+
+  /**
+   * @brief Check if the worker mode of a module is enabled.
+   * @param location The location URL of the module.
+   */
+  bool isWorkerEnabled(const QUrl& location) const;
+
+  /**
+   * @brief Set the maximum number of idle workers kept alive per module.
+   * @param count The maximum number of idle workers, 1 by default.
+   */
+  void setMaximumIdleWorkers(int count);
+
+  /**
+   * @brief Get the maximum number of idle workers kept alive per module.
+   */
+  int maximumIdleWorkers() const;
+
+  /**
+   * @brief Set how long an idle worker is kept alive.
+   * @param msecs The timeout in milliseconds, 60000 by default.
+   */
+  void setWorkerIdleTimeout(int msecs);
+
+  /**
+   * @brief Get how long an idle worker is kept alive, in milliseconds.
+   */
+  int workerIdleTimeout() const;
+
+  /**
+   * @brief Set how long to wait for a worker to be ready.
+   * @param msecs The timeout in milliseconds, 5000 by default.
+   */
+  void setWorkerStartTimeout(int msecs);
+
+  /**
+   * @brief Get how long to wait for a worker to be ready, in milliseconds.
+   */
+  int workerStartTimeout() const;
+
+  /**
+   * @brief Get the number of idle workers of a module.
+   * @param location The location URL of the module.
+   */
+  int idleWorkerCount(const QUrl& location) const;
+
+  /**
+   * @brief Set the directory of the files holding in-memory values.
+   * @param path The directory path.
+   */
+  void setSharedMemoryPath(const QString& path);
+
+  /**
+   * @brief Get the directory of the files holding in-memory values.
+   * @return \c /dev/shm if it is a writable directory, QDir::tempPath() otherwise.
+   */
+  QString sharedMemoryPath() const;
+
+private:
+
+  QScopedPointer<ctkCmdLineModuleBackendWorkerProcessPrivate> d;
+
+};
+
+#endif // CTKCMDLINEMODULEBACKENDWORKERPROCESS_H
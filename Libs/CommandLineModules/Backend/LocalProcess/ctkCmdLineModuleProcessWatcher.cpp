@@ -35,6 +35,21 @@ ctkCmdLineModuleProcessWatcher::ctkCmdLineModuleProcessWatcher(QProcess& process
                                                                ctkCmdLineModuleFutureInterface &futureInterface)
   : process(process), location(location), futureInterface(futureInterface), processXmlWatcher(&process),
     processPaused(false), progressValue(0)
+{
+  this->init();
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleProcessWatcher::ctkCmdLineModuleProcessWatcher(QProcess& process, QIODevice* output, const QString& location,
+                                                               ctkCmdLineModuleFutureInterface &futureInterface)
+  : process(process), location(location), futureInterface(futureInterface), processXmlWatcher(output),
+    processPaused(false), progressValue(0)
+{
+  this->init();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleProcessWatcher::init()
 {
   // The reported float value in the range [0.0,1.0] for the progress is scaled to [0,1000].
   // Value 1001 is reserved for the last "filter-end" output, which is reported as a progress event.
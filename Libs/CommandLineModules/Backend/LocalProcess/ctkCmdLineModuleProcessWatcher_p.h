@@ -31,6 +31,7 @@
 
 class ctkCmdLineModuleResult;
 
+class QIODevice;
 class QProcess;
 
 /**
@@ -47,6 +48,14 @@ public:
   ctkCmdLineModuleProcessWatcher(QProcess& process, const QString& location,
                                  ctkCmdLineModuleFutureInterface& futureInterface);
 
+  /**
+   * Watches the module output written to \a output instead of the standard
+   * output of \a process, which is still paused, resumed and killed on request.
+   * This is used for processes running several modules one after the other.
+   */
+  ctkCmdLineModuleProcessWatcher(QProcess& process, QIODevice* output, const QString& location,
+                                 ctkCmdLineModuleFutureInterface& futureInterface);
+
 protected Q_SLOTS:
 
   void filterStarted(const QString& name, const QString& comment);
@@ -65,6 +74,8 @@ protected Q_SLOTS:
 
 private:
 
+  void init();
+
   int updateProgress(float progress);
   int incrementProgress();
 
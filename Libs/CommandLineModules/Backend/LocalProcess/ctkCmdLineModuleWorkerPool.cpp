@@ -0,0 +1,637 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleWorkerPool_p.h"
+
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleProcessWatcher_p.h"
+#include "ctkCmdLineModuleRunException.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QUrl>
+#include <QXmlStreamReader>
+
+namespace {
+
+// Written by a persistent worker once it is ready to read invocations
+const QByteArray WORKER_READY = "<worker-ready/>";
+// Written by a persistent worker at the end of each invocation, with an
+// "exit-code" attribute
+const QByteArray WORKER_DONE = "<worker-done";
+
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleWorkerInvocation::ctkCmdLineModuleWorkerInvocation(const QString& location,
+                                                                   const QStringList& args, bool useWorker)
+  : Location(location)
+  , Args(args)
+  , UseWorker(useWorker)
+{
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerInvocation::finish(int exitCode, const QString& errorString)
+{
+  if (exitCode != 0 || !errorString.isEmpty())
+  {
+    this->FutureInterface.reportException(ctkCmdLineModuleRunException(QUrl::fromLocalFile(this->Location), exitCode, errorString));
+  }
+  else
+  {
+    QHashIterator<QString, QString> iter(this->OutputFiles);
+    while (iter.hasNext())
+    {
+      iter.next();
+      QFile file(iter.value());
+      if (file.open(QIODevice::ReadOnly))
+      {
+        this->FutureInterface.reportResult(ctkCmdLineModuleResult(iter.key(), file.readAll()));
+      }
+    }
+  }
+  this->removeFiles();
+
+  if (this->FutureInterface.progressValue() == 1001)
+  {
+    // We got a "filter-end" progress report, potentially with a comment,
+    // so don't overwrite the comment in the progress text.
+    this->FutureInterface.setProgressValue(1002);
+  }
+  else
+  {
+    this->FutureInterface.setProgressValueAndText(1002,
+      QCoreApplication::translate("ctkCmdLineModuleWorkerInvocation", "Finished."));
+  }
+  this->FutureInterface.reportFinished();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerInvocation::cancel()
+{
+  this->FutureInterface.reportCanceled();
+  this->removeFiles();
+  this->FutureInterface.reportFinished();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerInvocation::removeFiles()
+{
+  foreach(const QString& file, this->InputFiles)
+  {
+    QFile::remove(file);
+  }
+  foreach(const QString& file, this->OutputFiles)
+  {
+    QFile::remove(file);
+  }
+  this->InputFiles.clear();
+  this->OutputFiles.clear();
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleWorker::ctkCmdLineModuleWorker(const QString& location, bool persistent, QObject* parent)
+  : QObject(parent)
+  , Location(location)
+  , Persistent(persistent)
+  , CurrentState(Starting)
+  , ExitCode(0)
+{
+  this->Process.setReadChannel(QProcess::StandardOutput);
+  if (persistent)
+  {
+    // Otherwise the process watcher reads the process output directly
+    connect(&this->Process, SIGNAL(readyReadStandardOutput()), SLOT(readStandardOutput()));
+    connect(&this->Process, SIGNAL(readyReadStandardError()), SLOT(readStandardError()));
+  }
+  connect(&this->Process, SIGNAL(finished(int)), SLOT(processFinished()));
+  connect(&this->Process, SIGNAL(error(QProcess::ProcessError)), SLOT(processFinished()));
+
+  this->StartTimer.setSingleShot(true);
+  connect(&this->StartTimer, SIGNAL(timeout()), SLOT(startTimedOut()));
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleWorker::~ctkCmdLineModuleWorker()
+{
+  this->Process.disconnect(this);
+  this->InvocationWatcher.reset();
+  if (this->Invocation)
+  {
+    this->Invocation->cancel();
+  }
+  if (this->PendingInvocation)
+  {
+    this->PendingInvocation->cancel();
+  }
+  if (this->Process.state() != QProcess::NotRunning)
+  {
+    if (this->CurrentState == Idle)
+    {
+      // A persistent worker exits at the end of its standard input
+      this->Process.closeWriteChannel();
+      if (this->Process.waitForFinished(500))
+      {
+        return;
+      }
+    }
+    this->Process.kill();
+    this->Process.waitForFinished();
+  }
+}
+
+//----------------------------------------------------------------------------
+QString ctkCmdLineModuleWorker::location() const
+{
+  return this->Location;
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleWorker::isPersistent() const
+{
+  return this->Persistent;
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleWorker::isIdle() const
+{
+  return this->CurrentState == Idle && !this->PendingInvocation;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::start(const QStringList& args, int startTimeout)
+{
+  this->CurrentState = Starting;
+  this->Process.start(this->Location, args, QIODevice::ReadWrite | QIODevice::Text);
+  this->StartTimer.start(startTimeout);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::run(const ctkCmdLineModuleWorkerInvocationPointer& invocation)
+{
+  if (!this->Persistent)
+  {
+    this->Invocation = invocation;
+    this->CurrentState = Busy;
+    this->InvocationWatcher.reset(new ctkCmdLineModuleProcessWatcher(
+                                    this->Process, this->Location, invocation->FutureInterface));
+    this->Process.start(this->Location, invocation->Args, QIODevice::ReadOnly | QIODevice::Text);
+    return;
+  }
+
+  if (this->CurrentState == Starting)
+  {
+    this->PendingInvocation = invocation;
+    return;
+  }
+  Q_ASSERT(this->CurrentState == Idle);
+  this->Invocation = invocation;
+  this->startInvocation();
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleWorkerInvocationPointer ctkCmdLineModuleWorker::takePendingInvocation()
+{
+  ctkCmdLineModuleWorkerInvocationPointer invocation = this->PendingInvocation;
+  this->PendingInvocation.clear();
+  return invocation;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::startInvocation()
+{
+  this->CurrentState = Busy;
+  this->ExitCode = 0;
+  this->ErrorString.clear();
+
+  this->InvocationOutput.reset(new QBuffer);
+  this->InvocationOutput->open(QIODevice::ReadWrite);
+  this->InvocationWatcher.reset(new ctkCmdLineModuleProcessWatcher(
+                                  this->Process, this->InvocationOutput.data(),
+                                  this->Location, this->Invocation->FutureInterface));
+
+  QByteArray request = QJsonDocument(QJsonArray::fromStringList(this->Invocation->Args)).toJson(QJsonDocument::Compact);
+  request.append('\n');
+  this->Process.write(request);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::forwardOutput(const QByteArray& output)
+{
+  if (output.isEmpty() || !this->InvocationOutput)
+  {
+    return;
+  }
+  // The XML progress watcher reads the buffer from its last read position
+  this->InvocationOutput->seek(this->InvocationOutput->size());
+  this->InvocationOutput->write(output);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::readStandardOutput()
+{
+  this->PendingOutput.append(this->Process.readAllStandardOutput());
+
+  if (this->CurrentState == Starting)
+  {
+    int index = this->PendingOutput.indexOf(WORKER_READY);
+    if (index < 0)
+    {
+      return;
+    }
+    this->PendingOutput.remove(0, index + WORKER_READY.size());
+    this->StartTimer.stop();
+    this->CurrentState = Idle;
+    if (this->PendingInvocation)
+    {
+      this->Invocation = this->takePendingInvocation();
+      this->startInvocation();
+    }
+    else
+    {
+      emit ready(this);
+    }
+    return;
+  }
+
+  if (this->CurrentState != Busy)
+  {
+    this->PendingOutput.clear();
+    return;
+  }
+
+  int index = this->PendingOutput.indexOf(WORKER_DONE);
+  if (index < 0)
+  {
+    // Keep what could be the beginning of the end marker
+    int size = this->PendingOutput.size() - (WORKER_DONE.size() - 1);
+    if (size > 0)
+    {
+      this->forwardOutput(this->PendingOutput.left(size));
+      this->PendingOutput.remove(0, size);
+    }
+    return;
+  }
+  this->forwardOutput(this->PendingOutput.left(index));
+  this->PendingOutput.remove(0, index);
+
+  int end = this->PendingOutput.indexOf("/>");
+  if (end < 0)
+  {
+    return;
+  }
+  QXmlStreamReader reader(this->PendingOutput.left(end + 2));
+  reader.readNextStartElement();
+  this->ExitCode = reader.attributes().value("exit-code").toString().toInt();
+  this->PendingOutput.clear();
+
+  // Let the XML progress watcher parse the forwarded output first
+  this->CurrentState = Finishing;
+  QMetaObject::invokeMethod(this, "finishInvocation", Qt::QueuedConnection);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::readStandardError()
+{
+  QByteArray errorData = this->Process.readAllStandardError();
+  if (this->Invocation && !errorData.isEmpty())
+  {
+    this->Invocation->FutureInterface.reportErrorData(errorData);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::processFinished()
+{
+  if (this->CurrentState == Exited ||
+      (this->Process.state() != QProcess::NotRunning && this->Process.error() != QProcess::FailedToStart))
+  {
+    return;
+  }
+  State previousState = this->CurrentState;
+  this->CurrentState = Exited;
+  this->StartTimer.stop();
+
+  switch (previousState)
+  {
+  case Starting:
+    emit startFailed(this);
+    break;
+  case Idle:
+    emit exited(this);
+    break;
+  case Busy:
+    if (this->Persistent)
+    {
+      this->forwardOutput(this->PendingOutput);
+      this->PendingOutput.clear();
+      this->ExitCode = this->Process.exitCode();
+      this->ErrorString = tr("The worker process exited while running the module: %1").arg(this->Process.errorString());
+    }
+    else
+    {
+      this->ExitCode = this->Process.exitCode();
+      if (this->Process.error() != QProcess::UnknownError || this->ExitCode != 0)
+      {
+        this->ErrorString = this->Process.errorString();
+      }
+    }
+    QMetaObject::invokeMethod(this, "finishInvocation", Qt::QueuedConnection);
+    break;
+  case Finishing:
+  case Exited:
+    // The invocation is reported as finished already
+    break;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::startTimedOut()
+{
+  if (this->CurrentState != Starting)
+  {
+    return;
+  }
+  this->CurrentState = Exited;
+  this->Process.kill();
+  emit startFailed(this);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorker::finishInvocation()
+{
+  if (!this->Invocation)
+  {
+    return;
+  }
+  ctkCmdLineModuleWorkerInvocationPointer invocation = this->Invocation;
+  this->Invocation.clear();
+  this->InvocationWatcher.reset();
+  this->InvocationOutput.reset();
+
+  invocation->finish(this->ExitCode, this->ErrorString);
+
+  if (this->CurrentState == Finishing)
+  {
+    this->CurrentState = Idle;
+  }
+  emit invocationFinished(this);
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleWorkerPool::ctkCmdLineModuleWorkerPool()
+  : MaximumIdleWorkers(1)
+  , IdleTimeout(60000)
+  , StartTimeout(5000)
+  , IdleTimer(this)
+{
+  connect(&this->IdleTimer, SIGNAL(timeout()), SLOT(stopIdleWorkers()));
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleWorkerPool::~ctkCmdLineModuleWorkerPool()
+{
+  QList<ctkCmdLineModuleWorkerInvocationPointer> queue;
+  {
+    QMutexLocker lock(&this->Mutex);
+    queue.swap(this->Queue);
+  }
+  foreach(const ctkCmdLineModuleWorkerInvocationPointer& invocation, queue)
+  {
+    invocation->cancel();
+  }
+  // The workers are deleted as children, canceling their invocations
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::enqueue(const ctkCmdLineModuleWorkerInvocationPointer& invocation)
+{
+  {
+    QMutexLocker lock(&this->Mutex);
+    this->Queue.append(invocation);
+  }
+  QMetaObject::invokeMethod(this, "runQueuedInvocations", Qt::QueuedConnection);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::setMaximumIdleWorkers(int count)
+{
+  QMutexLocker lock(&this->Mutex);
+  this->MaximumIdleWorkers = qMax(0, count);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleWorkerPool::maximumIdleWorkers() const
+{
+  QMutexLocker lock(&this->Mutex);
+  return this->MaximumIdleWorkers;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::setIdleTimeout(int msecs)
+{
+  QMutexLocker lock(&this->Mutex);
+  this->IdleTimeout = qMax(0, msecs);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleWorkerPool::idleTimeout() const
+{
+  QMutexLocker lock(&this->Mutex);
+  return this->IdleTimeout;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::setStartTimeout(int msecs)
+{
+  QMutexLocker lock(&this->Mutex);
+  this->StartTimeout = qMax(0, msecs);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleWorkerPool::startTimeout() const
+{
+  QMutexLocker lock(&this->Mutex);
+  return this->StartTimeout;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleWorkerPool::idleWorkerCount(const QString& location) const
+{
+  QMutexLocker lock(&this->Mutex);
+  return this->IdleWorkerCounts.value(location);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::runQueuedInvocations()
+{
+  QList<ctkCmdLineModuleWorkerInvocationPointer> queue;
+  {
+    QMutexLocker lock(&this->Mutex);
+    queue.swap(this->Queue);
+  }
+  foreach(const ctkCmdLineModuleWorkerInvocationPointer& invocation, queue)
+  {
+    this->run(invocation);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::run(const ctkCmdLineModuleWorkerInvocationPointer& invocation)
+{
+  if (invocation->FutureInterface.isCanceled())
+  {
+    invocation->cancel();
+    return;
+  }
+  if (!invocation->UseWorker || this->UnsupportedLocations.contains(invocation->Location))
+  {
+    this->runOnce(invocation);
+    return;
+  }
+
+  QList<ctkCmdLineModuleWorker*> idleWorkers = this->IdleWorkers.value(invocation->Location);
+  if (!idleWorkers.isEmpty())
+  {
+    ctkCmdLineModuleWorker* worker = idleWorkers.last();
+    this->removeIdle(worker);
+    worker->run(invocation);
+    return;
+  }
+
+  ctkCmdLineModuleWorker* worker = new ctkCmdLineModuleWorker(invocation->Location, true, this);
+  connect(worker, SIGNAL(ready(ctkCmdLineModuleWorker*)), SLOT(workerReady(ctkCmdLineModuleWorker*)));
+  connect(worker, SIGNAL(startFailed(ctkCmdLineModuleWorker*)), SLOT(workerStartFailed(ctkCmdLineModuleWorker*)));
+  connect(worker, SIGNAL(invocationFinished(ctkCmdLineModuleWorker*)), SLOT(workerInvocationFinished(ctkCmdLineModuleWorker*)));
+  connect(worker, SIGNAL(exited(ctkCmdLineModuleWorker*)), SLOT(workerExited(ctkCmdLineModuleWorker*)));
+  worker->run(invocation);
+  worker->start(QStringList("--worker"), this->startTimeout());
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::runOnce(const ctkCmdLineModuleWorkerInvocationPointer& invocation)
+{
+  ctkCmdLineModuleWorker* worker = new ctkCmdLineModuleWorker(invocation->Location, false, this);
+  connect(worker, SIGNAL(invocationFinished(ctkCmdLineModuleWorker*)), SLOT(workerInvocationFinished(ctkCmdLineModuleWorker*)));
+  worker->run(invocation);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::workerReady(ctkCmdLineModuleWorker* worker)
+{
+  this->makeIdle(worker);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::workerStartFailed(ctkCmdLineModuleWorker* worker)
+{
+  if (!this->UnsupportedLocations.contains(worker->location()))
+  {
+    qWarning() << "Module" << worker->location() << "does not support the worker protocol."
+               << "It is run in a new process for each invocation.";
+    this->UnsupportedLocations.insert(worker->location());
+  }
+  ctkCmdLineModuleWorkerInvocationPointer invocation = worker->takePendingInvocation();
+  worker->deleteLater();
+  if (invocation)
+  {
+    this->run(invocation);
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::workerInvocationFinished(ctkCmdLineModuleWorker* worker)
+{
+  if (worker->isPersistent() && worker->isIdle())
+  {
+    this->makeIdle(worker);
+  }
+  else
+  {
+    worker->deleteLater();
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::workerExited(ctkCmdLineModuleWorker* worker)
+{
+  this->removeIdle(worker);
+  worker->deleteLater();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::makeIdle(ctkCmdLineModuleWorker* worker)
+{
+  QList<ctkCmdLineModuleWorker*>& idleWorkers = this->IdleWorkers[worker->location()];
+  int idleTimeout = this->idleTimeout();
+  if (idleWorkers.size() >= this->maximumIdleWorkers() || idleTimeout == 0)
+  {
+    worker->deleteLater();
+    return;
+  }
+  idleWorkers.append(worker);
+  this->IdleSince.insert(worker, QDateTime::currentMSecsSinceEpoch());
+  {
+    QMutexLocker lock(&this->Mutex);
+    this->IdleWorkerCounts[worker->location()] = idleWorkers.size();
+  }
+  if (!this->IdleTimer.isActive())
+  {
+    this->IdleTimer.start(qBound(10, idleTimeout / 2, 1000));
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::removeIdle(ctkCmdLineModuleWorker* worker)
+{
+  if (!this->IdleSince.remove(worker))
+  {
+    return;
+  }
+  QList<ctkCmdLineModuleWorker*>& idleWorkers = this->IdleWorkers[worker->location()];
+  idleWorkers.removeOne(worker);
+  QMutexLocker lock(&this->Mutex);
+  this->IdleWorkerCounts[worker->location()] = idleWorkers.size();
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerPool::stopIdleWorkers()
+{
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  int idleTimeout = this->idleTimeout();
+  foreach(ctkCmdLineModuleWorker* worker, this->IdleSince.keys())
+  {
+    if (now - this->IdleSince.value(worker) >= idleTimeout)
+    {
+      this->removeIdle(worker);
+      worker->deleteLater();
+    }
+  }
+  if (this->IdleSince.isEmpty())
+  {
+    this->IdleTimer.stop();
+  }
+}
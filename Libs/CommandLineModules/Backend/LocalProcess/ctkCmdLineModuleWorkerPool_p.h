@@ -0,0 +1,215 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULEWORKERPOOL_P_H
+#define CTKCMDLINEMODULEWORKERPOOL_P_H
+
+#include "ctkCmdLineModuleFutureInterface.h"
+
+#include <QBuffer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTimer>
+
+class ctkCmdLineModuleProcessWatcher;
+
+/**
+ * \class ctkCmdLineModuleWorkerInvocation
+ * \brief One run of a module by ctkCmdLineModuleBackendWorkerProcess.
+ * \ingroup CommandLineModulesBackendLocalProcess_API
+ */
+struct ctkCmdLineModuleWorkerInvocation
+{
+  ctkCmdLineModuleWorkerInvocation(const QString& location, const QStringList& args, bool useWorker);
+
+  /** Report the end of the run, reading the in-memory outputs and removing the shared files. */
+  void finish(int exitCode, const QString& errorString);
+
+  /** Report the cancellation of the run, removing the shared files. */
+  void cancel();
+
+  const QString Location;
+  const QStringList Args;
+  const bool UseWorker;
+
+  ctkCmdLineModuleFutureInterface FutureInterface;
+
+  // Files holding the in-memory input values
+  QStringList InputFiles;
+  // Parameter name to file receiving an in-memory output value
+  QHash<QString, QString> OutputFiles;
+
+private:
+
+  void removeFiles();
+};
+
+typedef QSharedPointer<ctkCmdLineModuleWorkerInvocation> ctkCmdLineModuleWorkerInvocationPointer;
+
+/**
+ * \class ctkCmdLineModuleWorker
+ * \brief A module process running one invocation at a time.
+ * \ingroup CommandLineModulesBackendLocalProcess_API
+ *
+ * A persistent worker is started with the \c --worker argument and runs the
+ * invocations sent on its standard input, see ctkCmdLineModuleBackendWorkerProcess.
+ * Otherwise, the process runs a single invocation given on its command line.
+ */
+class ctkCmdLineModuleWorker : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkCmdLineModuleWorker(const QString& location, bool persistent, QObject* parent = 0);
+  ~ctkCmdLineModuleWorker();
+
+  QString location() const;
+  bool isPersistent() const;
+
+  /** A persistent worker is idle when started and not running an invocation. */
+  bool isIdle() const;
+
+  /** Start the process. A persistent worker emits ready() or startFailed() once started. */
+  void start(const QStringList& args, int startTimeout);
+
+  /** Run an invocation. A persistent worker which is not ready yet runs it once ready. */
+  void run(const ctkCmdLineModuleWorkerInvocationPointer& invocation);
+
+  /** The invocation given to run() which was not started, if any */
+  ctkCmdLineModuleWorkerInvocationPointer takePendingInvocation();
+
+Q_SIGNALS:
+
+  void ready(ctkCmdLineModuleWorker* worker);
+  void startFailed(ctkCmdLineModuleWorker* worker);
+
+  /** Emitted once an invocation finished. The worker can be reused if it is idle. */
+  void invocationFinished(ctkCmdLineModuleWorker* worker);
+
+  /** Emitted when the process of an idle persistent worker exited. */
+  void exited(ctkCmdLineModuleWorker* worker);
+
+private Q_SLOTS:
+
+  void readStandardOutput();
+  void readStandardError();
+  void processFinished();
+  void startTimedOut();
+  void finishInvocation();
+
+private:
+
+  void startInvocation();
+  void forwardOutput(const QByteArray& output);
+
+  enum State
+  {
+    Starting,
+    Idle,
+    Busy,
+    Finishing,
+    Exited
+  };
+
+  const QString Location;
+  const bool Persistent;
+  State CurrentState;
+  QProcess Process;
+  QTimer StartTimer;
+
+  // Standard output not forwarded to the current invocation yet
+  QByteArray PendingOutput;
+  int ExitCode;
+  QString ErrorString;
+
+  ctkCmdLineModuleWorkerInvocationPointer PendingInvocation;
+  ctkCmdLineModuleWorkerInvocationPointer Invocation;
+  QScopedPointer<QBuffer> InvocationOutput;
+  QScopedPointer<ctkCmdLineModuleProcessWatcher> InvocationWatcher;
+};
+
+/**
+ * \class ctkCmdLineModuleWorkerPool
+ * \brief Dispatches invocations to the workers, in a dedicated thread.
+ * \ingroup CommandLineModulesBackendLocalProcess_API
+ */
+class ctkCmdLineModuleWorkerPool : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  ctkCmdLineModuleWorkerPool();
+  ~ctkCmdLineModuleWorkerPool();
+
+  /** Thread-safe: queue an invocation to run in the thread of the pool. */
+  void enqueue(const ctkCmdLineModuleWorkerInvocationPointer& invocation);
+
+  /** Thread-safe settings */
+  void setMaximumIdleWorkers(int count);
+  int maximumIdleWorkers() const;
+  void setIdleTimeout(int msecs);
+  int idleTimeout() const;
+  void setStartTimeout(int msecs);
+  int startTimeout() const;
+
+  /** Thread-safe: number of idle persistent workers for a module. */
+  int idleWorkerCount(const QString& location) const;
+
+private Q_SLOTS:
+
+  void runQueuedInvocations();
+  void workerReady(ctkCmdLineModuleWorker* worker);
+  void workerStartFailed(ctkCmdLineModuleWorker* worker);
+  void workerInvocationFinished(ctkCmdLineModuleWorker* worker);
+  void workerExited(ctkCmdLineModuleWorker* worker);
+  void stopIdleWorkers();
+
+private:
+
+  void run(const ctkCmdLineModuleWorkerInvocationPointer& invocation);
+  void runOnce(const ctkCmdLineModuleWorkerInvocationPointer& invocation);
+  void makeIdle(ctkCmdLineModuleWorker* worker);
+  void removeIdle(ctkCmdLineModuleWorker* worker);
+
+  mutable QMutex Mutex;
+  QList<ctkCmdLineModuleWorkerInvocationPointer> Queue;
+  int MaximumIdleWorkers;
+  int IdleTimeout;
+  int StartTimeout;
+  QHash<QString, int> IdleWorkerCounts;
+
+  // Accessed from the thread of the pool only
+  QSet<QString> UnsupportedLocations;
+  QHash<QString, QList<ctkCmdLineModuleWorker*> > IdleWorkers;
+  QHash<ctkCmdLineModuleWorker*, qint64> IdleSince;
+  QTimer IdleTimer;
+};
+
+#endif // CTKCMDLINEMODULEWORKERPOOL_P_H
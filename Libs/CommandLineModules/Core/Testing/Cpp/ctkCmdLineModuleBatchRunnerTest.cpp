@@ -0,0 +1,426 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleBackend.h"
+#include "ctkCmdLineModuleBatchRunner.h"
+#include "ctkCmdLineModuleFrontend.h"
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleManager.h"
+#include "ctkCmdLineModuleRunException.h"
+#include "ctkException.h"
+
+#include "ctkTest.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QRunnable>
+#include <QSignalSpy>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+class BatchBackendMockUp;
+
+//-----------------------------------------------------------------------------
+// Task doubling the "param" parameter value, reporting progress on the way
+class BatchTaskMockUp : public ctkCmdLineModuleFutureInterface, public QRunnable
+{
+public:
+
+  BatchTaskMockUp(BatchBackendMockUp* backend, int param)
+    : m_Backend(backend)
+    , m_Param(param)
+  {
+    this->setCanCancel(true);
+  }
+
+  ctkCmdLineModuleFuture start()
+  {
+    this->setRunnable(this);
+    this->reportStarted();
+    ctkCmdLineModuleFuture future = this->future();
+    QThreadPool::globalInstance()->start(this);
+    return future;
+  }
+
+  virtual void run();
+
+private:
+
+  BatchBackendMockUp* m_Backend;
+  int m_Param;
+};
+
+//-----------------------------------------------------------------------------
+class BatchBackendMockUp : public ctkCmdLineModuleBackend
+{
+
+public:
+
+  BatchBackendMockUp(const QByteArray& xml)
+    : m_Xml(xml)
+    , m_RunDuration(50)
+  {}
+
+  // Number of times running the module with this parameter value fails
+  void setFailureCount(int param, int count)
+  {
+    QMutexLocker lock(&m_Mutex);
+    m_FailureCounts[param] = count;
+  }
+
+  void setRunDuration(int msecs)
+  {
+    m_RunDuration = msecs;
+  }
+
+  int runDuration() const
+  {
+    return m_RunDuration;
+  }
+
+  bool fail(int param)
+  {
+    QMutexLocker lock(&m_Mutex);
+    QHash<int,int>::Iterator iter = m_FailureCounts.find(param);
+    if (iter == m_FailureCounts.end() || iter.value() == 0)
+    {
+      return false;
+    }
+    if (iter.value() > 0)
+    {
+      --iter.value();
+    }
+    return true;
+  }
+
+  void enter()
+  {
+    int count = m_ConcurrentRunCount.fetchAndAddOrdered(1) + 1;
+    int maximumCount = m_MaximumConcurrentRunCount.loadAcquire();
+    while (count > maximumCount &&
+           !m_MaximumConcurrentRunCount.testAndSetOrdered(maximumCount, count))
+    {
+      maximumCount = m_MaximumConcurrentRunCount.loadAcquire();
+    }
+  }
+
+  void leave()
+  {
+    m_ConcurrentRunCount.fetchAndAddOrdered(-1);
+  }
+
+  int maximumConcurrentRunCount() const
+  {
+    return m_MaximumConcurrentRunCount.loadAcquire();
+  }
+
+  virtual QString name() const { return "BatchMockup"; }
+  virtual QString description() const { return "Batch Test Mock-up"; }
+  virtual QList<QString> schemes() const { return QList<QString>() << "test"; }
+  virtual qint64 timeStamp(const QUrl& /*location*/) const { return 0; }
+  virtual QByteArray rawXmlDescription(const QUrl& /*location*/, int /*timeout*/) { return m_Xml; }
+
+protected:
+
+  virtual ctkCmdLineModuleFuture run(ctkCmdLineModuleFrontend* frontend)
+  {
+    BatchTaskMockUp* task = new BatchTaskMockUp(this, frontend->value("param").toInt());
+    return task->start();
+  }
+
+private:
+
+  QByteArray m_Xml;
+  int m_RunDuration;
+  QMutex m_Mutex;
+  QHash<int,int> m_FailureCounts;
+  QAtomicInt m_ConcurrentRunCount;
+  QAtomicInt m_MaximumConcurrentRunCount;
+};
+
+//-----------------------------------------------------------------------------
+void BatchTaskMockUp::run()
+{
+  m_Backend->enter();
+  this->setProgressRange(0, 100);
+  for (int step = 1; step <= 5 && !this->isCanceled(); ++step)
+  {
+    QThread::msleep(m_Backend->runDuration() / 5);
+    this->setProgressValue(step * 20);
+  }
+  m_Backend->leave();
+
+  if (!this->isCanceled())
+  {
+    if (m_Backend->fail(m_Param))
+    {
+      this->reportException(ctkCmdLineModuleRunException(QUrl("test://module"), 1, "Mock-up failure"));
+    }
+    else
+    {
+      this->reportResult(ctkCmdLineModuleResult("output", m_Param * 2));
+    }
+  }
+  this->reportFinished();
+}
+
+//-----------------------------------------------------------------------------
+QList<QHash<QString, QVariant> > parameterTable(const QList<int>& params)
+{
+  QList<QHash<QString, QVariant> > table;
+  foreach(int param, params)
+  {
+    QHash<QString, QVariant> row;
+    row["param"] = param;
+    table << row;
+  }
+  return table;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+class ctkCmdLineModuleBatchRunnerTester : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+
+  void initTestCase();
+  void init();
+  void cleanup();
+
+  void testDefaults();
+  void testRun();
+  void testRetry();
+  void testCancel();
+
+private:
+
+  QByteArray Xml;
+  QScopedPointer<BatchBackendMockUp> Backend;
+  QScopedPointer<ctkCmdLineModuleManager> Manager;
+  ctkCmdLineModuleReference ModuleRef;
+};
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunnerTester::initTestCase()
+{
+  Xml = "<executable>\n"
+        "  <title>My Filter</title>\n"
+        "  <description>Awesome filter</description>\n"
+        "  <parameters>\n"
+        "    <label>bla</label>\n"
+        "    <description>bla</description>\n"
+        "    <integer>\n"
+        "      <name>param</name>\n"
+        "      <flag>i</flag>\n"
+        "      <description>bla</description>\n"
+        "      <label>bla</label>\n"
+        "      <default>0</default>\n"
+        "    </integer>\n"
+        "    <integer>\n"
+        "      <name>output</name>\n"
+        "      <channel>output</channel>\n"
+        "      <description>bla</description>\n"
+        "      <label>bla</label>\n"
+        "    </integer>\n"
+        "  </parameters>\n"
+        "</executable>\n";
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunnerTester::init()
+{
+  Backend.reset(new BatchBackendMockUp(Xml));
+  Manager.reset(new ctkCmdLineModuleManager(ctkCmdLineModuleManager::SKIP_VALIDATION));
+  Manager->registerBackend(Backend.data());
+  ModuleRef = Manager->registerModule(QUrl("test://module"));
+  QVERIFY(ModuleRef);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunnerTester::cleanup()
+{
+  QThreadPool::globalInstance()->waitForDone();
+  ModuleRef = ctkCmdLineModuleReference();
+  Manager.reset();
+  Backend.reset();
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunnerTester::testDefaults()
+{
+  ctkCmdLineModuleBatchRunner runner(Manager.data());
+  QCOMPARE(runner.maximumConcurrentRuns(), QThread::idealThreadCount());
+  QCOMPARE(runner.maximumRetries(), 0);
+  QCOMPARE(runner.isRunning(), false);
+  QCOMPARE(runner.itemCount(), 0);
+
+  runner.setMaximumConcurrentRuns(0);
+  QCOMPARE(runner.maximumConcurrentRuns(), 1);
+  runner.setMaximumRetries(-1);
+  QCOMPARE(runner.maximumRetries(), 0);
+
+  // An empty batch finishes right away
+  ctkCmdLineModuleFuture future = runner.run(ModuleRef, QList<QHash<QString, QVariant> >());
+  QVERIFY(future.isFinished());
+  QCOMPARE(runner.isRunning(), false);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunnerTester::testRun()
+{
+  const int itemCount = 20;
+  QList<int> params;
+  int expectedSum = 0;
+  for (int i = 0; i < itemCount; ++i)
+  {
+    params << i;
+    expectedSum += 2 * i;
+  }
+
+  ctkCmdLineModuleBatchRunner runner(Manager.data());
+  runner.setMaximumConcurrentRuns(2);
+  QSignalSpy itemStartedSpy(&runner, SIGNAL(itemStarted(int)));
+  QSignalSpy itemFinishedSpy(&runner, SIGNAL(itemFinished(int)));
+  QSignalSpy finishedSpy(&runner, SIGNAL(finished()));
+
+  ctkCmdLineModuleFuture future = runner.run(ModuleRef, parameterTable(params));
+  QVERIFY(runner.isRunning());
+  QCOMPARE(runner.itemCount(), itemCount);
+  QCOMPARE(future.progressMaximum(), 1000 * itemCount);
+  QCOMPARE(runner.itemStatus(0), ctkCmdLineModuleBatchRunner::Running);
+  QCOMPARE(runner.itemStatus(itemCount - 1), ctkCmdLineModuleBatchRunner::Pending);
+
+  try
+  {
+    runner.run(ModuleRef, parameterTable(params));
+    QFAIL("ctkIllegalStateException expected");
+  }
+  catch (const ctkIllegalStateException&)
+  {}
+
+  QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 30000);
+  QVERIFY(!future.isCanceled());
+  QCOMPARE(runner.isRunning(), false);
+  QCOMPARE(runner.doneItemCount(), itemCount);
+  QCOMPARE(future.progressValue(), 1000 * itemCount);
+  QCOMPARE(itemStartedSpy.count(), itemCount);
+  QCOMPARE(itemFinishedSpy.count(), itemCount);
+  QCOMPARE(finishedSpy.count(), 1);
+  QVERIFY(Backend->maximumConcurrentRunCount() <= 2);
+
+  // One result per item, reported in the batch future
+  QList<ctkCmdLineModuleResult> results = future.results();
+  QCOMPARE(results.size(), itemCount);
+  int sum = 0;
+  foreach(const ctkCmdLineModuleResult& result, results)
+  {
+    QCOMPARE(result.parameter(), QString("output"));
+    sum += result.value().toInt();
+  }
+  QCOMPARE(sum, expectedSum);
+
+  for (int i = 0; i < itemCount; ++i)
+  {
+    QCOMPARE(runner.itemStatus(i), ctkCmdLineModuleBatchRunner::Finished);
+    QCOMPARE(runner.itemRunCount(i), 1);
+    QCOMPARE(runner.itemFuture(i).resultAt(0).value().toInt(), 2 * i);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunnerTester::testRetry()
+{
+  Backend->setFailureCount(1, -1);
+  Backend->setFailureCount(2, 1);
+
+  ctkCmdLineModuleBatchRunner runner(Manager.data());
+  runner.setMaximumConcurrentRuns(1);
+  runner.setMaximumRetries(2);
+
+  ctkCmdLineModuleFuture future = runner.run(ModuleRef, parameterTable(QList<int>() << 1 << 2 << 3));
+  QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 30000);
+  QVERIFY(!future.isCanceled());
+
+  // Always failing: run once, then retried twice
+  QCOMPARE(runner.itemStatus(0), ctkCmdLineModuleBatchRunner::Failed);
+  QCOMPARE(runner.itemRunCount(0), 3);
+  QVERIFY(runner.itemErrorString(0).contains("Mock-up failure"));
+
+  // Failing once
+  QCOMPARE(runner.itemStatus(1), ctkCmdLineModuleBatchRunner::Finished);
+  QCOMPARE(runner.itemRunCount(1), 2);
+  QVERIFY(runner.itemErrorString(1).isEmpty());
+
+  QCOMPARE(runner.itemStatus(2), ctkCmdLineModuleBatchRunner::Finished);
+  QCOMPARE(runner.itemRunCount(2), 1);
+
+  QCOMPARE(future.results().size(), 2);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunnerTester::testCancel()
+{
+  Backend->setRunDuration(500);
+
+  ctkCmdLineModuleBatchRunner runner(Manager.data());
+  runner.setMaximumConcurrentRuns(1);
+  QSignalSpy finishedSpy(&runner, SIGNAL(finished()));
+
+  ctkCmdLineModuleFuture future = runner.run(ModuleRef, parameterTable(QList<int>() << 1 << 2 << 3 << 4));
+  QCOMPARE(runner.itemStatus(0), ctkCmdLineModuleBatchRunner::Running);
+
+  // Canceling a pending item
+  runner.cancelItem(3);
+  QCOMPARE(runner.itemStatus(3), ctkCmdLineModuleBatchRunner::Canceled);
+  QCOMPARE(runner.doneItemCount(), 1);
+  QVERIFY(runner.retryItem(3));
+  QCOMPARE(runner.itemStatus(3), ctkCmdLineModuleBatchRunner::Pending);
+  QCOMPARE(runner.doneItemCount(), 0);
+  QVERIFY(!runner.retryItem(3));
+
+  // Canceling a running item starts the next one
+  runner.cancelItem(0);
+  QTRY_COMPARE(runner.itemStatus(0), ctkCmdLineModuleBatchRunner::Canceled);
+  QCOMPARE(runner.itemStatus(1), ctkCmdLineModuleBatchRunner::Running);
+
+  // Canceling the batch
+  future.cancel();
+  QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 30000);
+  QVERIFY(future.isCanceled());
+  QCOMPARE(finishedSpy.count(), 1);
+  QCOMPARE(runner.isRunning(), false);
+  for (int i = 0; i < runner.itemCount(); ++i)
+  {
+    QCOMPARE(runner.itemStatus(i), ctkCmdLineModuleBatchRunner::Canceled);
+  }
+  QCOMPARE(runner.itemRunCount(2), 0);
+  QVERIFY(!runner.retryItem(0));
+}
+
+// ----------------------------------------------------------------------------
+CTK_TEST_MAIN(ctkCmdLineModuleBatchRunnerTest)
+#include "moc_ctkCmdLineModuleBatchRunnerTest.cpp"
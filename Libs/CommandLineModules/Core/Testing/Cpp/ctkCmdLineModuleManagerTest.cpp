@@ -22,6 +22,8 @@
 
 #include "ctkCmdLineModuleManager.h"
 #include "ctkCmdLineModuleBackend.h"
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleParameter.h"
 #include "ctkException.h"
 #include "ctkCmdLineModuleFuture.h"
 #include "ctkCmdLineModuleReferenceResult.h"
@@ -35,6 +37,10 @@
 #include <QBuffer>
 #include <QDataStream>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
 
 #if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
 extern int qHash(const QUrl& url);
@@ -47,8 +53,13 @@ class BackendMockUp : public ctkCmdLineModuleBackend
 
 public:
 
+  BackendMockUp()
+    : m_RetrievalDuration(0)
+  {}
+
   void addModule(const QUrl& location, const QByteArray& xml, int msDelay = 0)
   {
+    QMutexLocker lock(&this->m_Mutex);
     this->m_UrlToXmlRetrievalCount[location] = 0;
     this->m_UrlToXml[location] = xml;
     this->m_UrlToXmlOutputDelay[location] = msDelay;
@@ -66,10 +77,22 @@ public:
 
   int xmlRetrievalCount(const QUrl& location) const
   {
+    QMutexLocker lock(&this->m_Mutex);
     QHash<QUrl,int>::ConstIterator iter = this->m_UrlToXmlRetrievalCount.find(location);
     return iter == this->m_UrlToXmlRetrievalCount.end() ? 0 : iter.value();
   }
 
+  // Time spent by each XML retrieval, as running a module would
+  void setRetrievalDuration(int msecs)
+  {
+    this->m_RetrievalDuration = msecs;
+  }
+
+  int maximumConcurrentRetrievalCount() const
+  {
+    return this->m_MaximumConcurrentRetrievalCount.loadAcquire();
+  }
+
   virtual QString name() const { return "Mockup"; }
   virtual QString description() const { return "Test Mock-up"; }
   virtual QList<QString> schemes() const { return QList<QString>() << "test"; }
@@ -82,12 +105,32 @@ public:
 
   virtual QByteArray rawXmlDescription(const QUrl& location, int timeout)
   {
-    ++m_UrlToXmlRetrievalCount[location];
-    if (timeout < m_UrlToXmlOutputDelay[location])
+    int outputDelay = 0;
+    QByteArray xml;
+    {
+      // modules may be registered concurrently
+      QMutexLocker lock(&this->m_Mutex);
+      ++m_UrlToXmlRetrievalCount[location];
+      outputDelay = m_UrlToXmlOutputDelay.value(location);
+      xml = m_UrlToXml.value(location);
+    }
+    if (timeout < outputDelay)
     {
       throw ctkCmdLineModuleTimeoutException(location, "Timeout in BackendMockUp occurred");
     }
-    return m_UrlToXml[location];
+    if (m_RetrievalDuration > 0)
+    {
+      int count = m_ConcurrentRetrievalCount.fetchAndAddOrdered(1) + 1;
+      int maximumCount = m_MaximumConcurrentRetrievalCount.loadAcquire();
+      while (count > maximumCount &&
+             !m_MaximumConcurrentRetrievalCount.testAndSetOrdered(maximumCount, count))
+      {
+        maximumCount = m_MaximumConcurrentRetrievalCount.loadAcquire();
+      }
+      QThread::msleep(m_RetrievalDuration);
+      m_ConcurrentRetrievalCount.fetchAndAddOrdered(-1);
+    }
+    return xml;
   }
 
 protected:
@@ -99,10 +142,14 @@ protected:
 
 private:
 
+  mutable QMutex m_Mutex;
   QHash<QUrl, qint64> m_UrlToTimestamp;
   QHash<QUrl, int> m_UrlToXmlRetrievalCount;
   QHash<QUrl, int> m_UrlToXmlOutputDelay;
   QHash<QUrl, QByteArray> m_UrlToXml;
+  int m_RetrievalDuration;
+  QAtomicInt m_ConcurrentRetrievalCount;
+  QAtomicInt m_MaximumConcurrentRetrievalCount;
 };
 
 }
@@ -122,6 +169,8 @@ private Q_SLOTS:
   void testSkipValidation();
   void testTimeoutHandling();
   void testCaching();
+  void testDescriptionCaching();
+  void testAsyncRegistration();
 
 private:
 
@@ -396,6 +445,108 @@ void ctkCmdLineModuleManagerTester::testCaching()
   }
 }
 
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleManagerTester::testDescriptionCaching()
+{
+  QUrl location("test://validXml");
+
+  {
+    BackendMockUp backend;
+    backend.addModule(location, validXml);
+    backend.setTimestamp(location, 1);
+
+    ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+    manager.registerBackend(&backend);
+    QVERIFY(manager.registerModule(location));
+    QCOMPARE(backend.xmlRetrievalCount(location), 1);
+
+    // The index is written without waiting for the manager destruction
+    QVERIFY(QFile::exists(cachePath + "/ctkCmdLineModuleCache.index"));
+  }
+
+  // A single index file holds the cache
+  QCOMPARE(QDir(cachePath).entryList(QDir::Files), QStringList() << "ctkCmdLineModuleCache.index");
+
+  {
+    BackendMockUp backend;
+    backend.addModule(location, validXml);
+    backend.setTimestamp(location, 1);
+
+    ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+    manager.registerBackend(&backend);
+    ctkCmdLineModuleReference moduleRef = manager.registerModule(location);
+    QVERIFY(moduleRef);
+    QCOMPARE(backend.xmlRetrievalCount(location), 0);
+
+    // The description comes from the cache
+    ctkCmdLineModuleDescription description = moduleRef.description();
+    QCOMPARE(description.title(), QString("My Filter"));
+    QCOMPARE(description.description(), QString("Awesome filter"));
+    QCOMPARE(description.parameterGroups().size(), 1);
+    QVERIFY(description.hasParameter("param"));
+    QCOMPARE(description.parameter("param").flag(), QString("i"));
+    QCOMPARE(description.parameter("param").tag(), QString("integer"));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleManagerTester::testAsyncRegistration()
+{
+  const int moduleCount = 32;
+  const int maximumConcurrentRegistrations = 4;
+
+  BackendMockUp backend;
+  backend.setRetrievalDuration(20);
+  QList<QUrl> locations;
+  for (int i = 0; i < moduleCount; ++i)
+  {
+    QUrl location(QString("test://validXml%1").arg(i));
+    backend.addModule(location, validXml);
+    backend.setTimestamp(location, 1);
+    locations << location;
+  }
+  backend.addModule(QUrl("test://invalidXml"), invalidXml);
+  locations << QUrl("test://invalidXml");
+
+  ctkCmdLineModuleManager manager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+  manager.registerBackend(&backend);
+  manager.setMaximumConcurrentRegistrations(maximumConcurrentRegistrations);
+  QCOMPARE(manager.maximumConcurrentRegistrations(), maximumConcurrentRegistrations);
+
+  QList<QFuture<ctkCmdLineModuleReferenceResult> > futures = manager.registerModulesAsync(locations);
+  QCOMPARE(futures.size(), moduleCount + 1);
+  for (int i = 0; i < moduleCount; ++i)
+  {
+    ctkCmdLineModuleReferenceResult result = futures[i].result();
+    QCOMPARE(result.m_Url, locations[i]);
+    QVERIFY(result.m_Reference);
+    QVERIFY(result.m_RuntimeError.isEmpty());
+  }
+  // Errors are reported in the result instead of being thrown
+  ctkCmdLineModuleReferenceResult invalidResult = futures.last().result();
+  QVERIFY(!invalidResult.m_Reference);
+  QVERIFY(!invalidResult.m_RuntimeError.isEmpty());
+
+  QCOMPARE(manager.moduleReferences().size(), moduleCount);
+  QVERIFY(backend.maximumConcurrentRetrievalCount() <= maximumConcurrentRegistrations);
+
+  // The index is written once the batch finished, a new manager sharing the
+  // cache directory does not retrieve the XML descriptions again
+  {
+    BackendMockUp warmBackend;
+    warmBackend.addModule(locations.first(), validXml);
+    warmBackend.setTimestamp(locations.first(), 1);
+    ctkCmdLineModuleManager warmManager(ctkCmdLineModuleManager::STRICT_VALIDATION, cachePath);
+    warmManager.registerBackend(&warmBackend);
+    QVERIFY(warmManager.registerModule(locations.first()));
+    QCOMPARE(warmBackend.xmlRetrievalCount(locations.first()), 0);
+  }
+
+  // Registered modules are returned right away
+  QVERIFY(manager.registerModuleAsync(locations.first()).result().m_Reference);
+  QCOMPARE(backend.xmlRetrievalCount(locations.first()), 1);
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkCmdLineModuleManagerTest)
 #include "moc_ctkCmdLineModuleManagerTest.cpp"
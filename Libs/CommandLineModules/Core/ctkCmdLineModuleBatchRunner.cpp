@@ -0,0 +1,537 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "ctkCmdLineModuleBatchRunner.h"
+
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleFrontend.h"
+#include "ctkCmdLineModuleFuture.h"
+#include "ctkCmdLineModuleFutureWatcher.h"
+#include "ctkCmdLineModuleManager.h"
+#include "ctkCmdLineModuleParameter.h"
+#include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleRunException.h"
+
+#include <ctkException.h>
+
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+
+namespace {
+
+//----------------------------------------------------------------------------
+// Front-end without GUI holding the parameter values of one invocation
+class ctkCmdLineModuleBatchFrontend : public ctkCmdLineModuleFrontend
+{
+public:
+
+  ctkCmdLineModuleBatchFrontend(const ctkCmdLineModuleReference& moduleRef,
+                                const QHash<QString, QVariant>& values)
+    : ctkCmdLineModuleFrontend(moduleRef)
+    , Values(values)
+  {}
+
+  virtual QObject* guiHandle() const
+  {
+    return 0;
+  }
+
+  virtual QVariant value(const QString& parameter, int role = LocalResourceRole) const
+  {
+    Q_UNUSED(role)
+    QHash<QString, QVariant>::ConstIterator iter = this->Values.find(parameter);
+    if (iter != this->Values.end())
+    {
+      return iter.value();
+    }
+    return this->moduleReference().description().parameter(parameter).defaultValue();
+  }
+
+  virtual void setValue(const QString& parameter, const QVariant& value, int role = DisplayRole)
+  {
+    Q_UNUSED(role)
+    this->Values[parameter] = value;
+  }
+
+private:
+
+  QHash<QString, QVariant> Values;
+};
+
+}
+
+//----------------------------------------------------------------------------
+struct ctkCmdLineModuleBatchRunnerPrivate
+{
+  struct Item
+  {
+    Item()
+      : Status(ctkCmdLineModuleBatchRunner::Pending)
+      , RunCount(0)
+      , FailureCount(0)
+      , Progress(0)
+      , CancelRequested(false)
+      , Frontend(0)
+      , Watcher(0)
+    {}
+
+    QHash<QString, QVariant> Values;
+    ctkCmdLineModuleBatchRunner::ItemStatus Status;
+    QString ErrorString;
+    int RunCount;
+    // Failures since the invocation was last queued by the user
+    int FailureCount;
+    // Progress of the invocation in [0, 1000]
+    int Progress;
+    bool CancelRequested;
+    ctkCmdLineModuleFuture Future;
+    ctkCmdLineModuleFrontend* Frontend;
+    ctkCmdLineModuleFutureWatcher* Watcher;
+  };
+
+  ctkCmdLineModuleBatchRunnerPrivate(ctkCmdLineModuleBatchRunner* q, ctkCmdLineModuleManager* manager)
+    : q(q)
+    , Manager(manager)
+    , MaximumConcurrentRuns(qMax(1, QThread::idealThreadCount()))
+    , MaximumRetries(0)
+    , RunningCount(0)
+    , DoneCount(0)
+    , TotalProgress(0)
+    , BatchRunning(false)
+    , BatchCanceled(false)
+  {
+  }
+
+  bool isValidIndex(int index) const
+  {
+    return index >= 0 && index < this->Items.size();
+  }
+
+  void scheduleNext()
+  {
+    while (this->BatchRunning && !this->BatchCanceled && !this->Pending.isEmpty() &&
+           this->RunningCount < this->MaximumConcurrentRuns && !this->FutureInterface.isPaused())
+    {
+      this->startItem(this->Pending.dequeue());
+    }
+    this->checkFinished();
+  }
+
+  void startItem(int index)
+  {
+    Item& item = this->Items[index];
+    ++item.RunCount;
+    item.Status = ctkCmdLineModuleBatchRunner::Running;
+    item.ErrorString.clear();
+    this->setItemProgress(index, 0);
+
+    ctkCmdLineModuleBatchFrontend* frontend = new ctkCmdLineModuleBatchFrontend(this->ModuleReference, item.Values);
+    try
+    {
+      item.Future = this->Manager->run(frontend);
+    }
+    catch (const ctkException& e)
+    {
+      delete frontend;
+      emit q->itemStarted(index);
+      this->itemFailed(index, e.message());
+      return;
+    }
+
+    ++this->RunningCount;
+    item.Frontend = frontend;
+    item.Watcher = new ctkCmdLineModuleFutureWatcher;
+    this->WatcherToIndex.insert(item.Watcher, index);
+    QObject::connect(item.Watcher, SIGNAL(finished()), q, SLOT(_q_itemFinished()));
+    QObject::connect(item.Watcher, SIGNAL(progressValueChanged(int)), q, SLOT(_q_itemProgressValueChanged(int)));
+    item.Watcher->setFuture(item.Future);
+    emit q->itemStarted(index);
+  }
+
+  void itemFailed(int index, const QString& errorString)
+  {
+    Item& item = this->Items[index];
+    ++item.FailureCount;
+    if (!this->BatchCanceled && item.FailureCount <= this->MaximumRetries)
+    {
+      item.Status = ctkCmdLineModuleBatchRunner::Pending;
+      this->Pending.enqueue(index);
+      return;
+    }
+    item.Status = ctkCmdLineModuleBatchRunner::Failed;
+    item.ErrorString = errorString;
+    this->itemDone(index);
+  }
+
+  void itemDone(int index)
+  {
+    ++this->DoneCount;
+    this->setItemProgress(index, 1000);
+    emit q->itemFinished(index);
+  }
+
+  void setItemProgress(int index, int progress)
+  {
+    Item& item = this->Items[index];
+    this->TotalProgress += progress - item.Progress;
+    item.Progress = progress;
+    this->FutureInterface.setProgressValueAndText(this->TotalProgress,
+      ctkCmdLineModuleBatchRunner::tr("%1 of %2 done").arg(this->DoneCount).arg(this->Items.size()));
+  }
+
+  void checkFinished()
+  {
+    if (!this->BatchRunning || this->DoneCount < this->Items.size())
+    {
+      return;
+    }
+    this->BatchRunning = false;
+    this->FutureInterface.reportFinished();
+    emit q->finished();
+  }
+
+  void cancelAll()
+  {
+    if (!this->BatchRunning || this->BatchCanceled)
+    {
+      return;
+    }
+    this->BatchCanceled = true;
+    for (int index = 0; index < this->Items.size(); ++index)
+    {
+      Item& item = this->Items[index];
+      if (item.Status == ctkCmdLineModuleBatchRunner::Running)
+      {
+        item.CancelRequested = true;
+        item.Future.cancel();
+      }
+    }
+    while (!this->Pending.isEmpty())
+    {
+      int index = this->Pending.dequeue();
+      this->Items[index].Status = ctkCmdLineModuleBatchRunner::Canceled;
+      this->itemDone(index);
+    }
+    this->checkFinished();
+  }
+
+  void _q_itemFinished()
+  {
+    QObject* watcher = q->sender();
+    if (!this->WatcherToIndex.contains(watcher))
+    {
+      return;
+    }
+    int index = this->WatcherToIndex.take(watcher);
+    --this->RunningCount;
+
+    Item& item = this->Items[index];
+    item.Watcher->deleteLater();
+    item.Watcher = 0;
+    item.Frontend->deleteLater();
+    item.Frontend = 0;
+
+    if (item.CancelRequested)
+    {
+      item.Status = ctkCmdLineModuleBatchRunner::Canceled;
+      this->itemDone(index);
+    }
+    else if (item.Future.isCanceled())
+    {
+      // The back-end reports errors as exceptions, which also cancel the future
+      QString errorString = ctkCmdLineModuleBatchRunner::tr("The module was canceled.");
+      try
+      {
+        item.Future.waitForFinished();
+      }
+      catch (const ctkCmdLineModuleRunException& e)
+      {
+        errorString = ctkCmdLineModuleBatchRunner::tr("%1 (error code %2)").arg(e.errorString()).arg(e.errorCode());
+      }
+      catch (const ctkException& e)
+      {
+        errorString = e.message();
+      }
+      catch (...)
+      {
+        errorString = ctkCmdLineModuleBatchRunner::tr("Unknown error.");
+      }
+      this->itemFailed(index, errorString);
+    }
+    else
+    {
+      item.Status = ctkCmdLineModuleBatchRunner::Finished;
+      QList<ctkCmdLineModuleResult> results = item.Future.results();
+      if (!results.isEmpty())
+      {
+        this->FutureInterface.reportResults(results.toVector());
+      }
+      this->itemDone(index);
+    }
+    this->scheduleNext();
+  }
+
+  void _q_itemProgressValueChanged(int progressValue)
+  {
+    ctkCmdLineModuleFutureWatcher* watcher = static_cast<ctkCmdLineModuleFutureWatcher*>(q->sender());
+    QHash<QObject*, int>::ConstIterator iter = this->WatcherToIndex.find(watcher);
+    if (iter == this->WatcherToIndex.end())
+    {
+      return;
+    }
+    int range = watcher->progressMaximum() - watcher->progressMinimum();
+    if (range <= 0)
+    {
+      return;
+    }
+    qint64 progress = qint64(progressValue - watcher->progressMinimum()) * 1000 / range;
+    this->setItemProgress(iter.value(), qBound(0, static_cast<int>(progress), 999));
+  }
+
+  void _q_batchCanceled()
+  {
+    this->cancelAll();
+  }
+
+  void _q_batchResumed()
+  {
+    this->scheduleNext();
+  }
+
+  ctkCmdLineModuleBatchRunner* q;
+  ctkCmdLineModuleManager* Manager;
+
+  int MaximumConcurrentRuns;
+  int MaximumRetries;
+
+  ctkCmdLineModuleReference ModuleReference;
+  QVector<Item> Items;
+  QQueue<int> Pending;
+  QHash<QObject*, int> WatcherToIndex;
+  int RunningCount;
+  int DoneCount;
+  int TotalProgress;
+  bool BatchRunning;
+  bool BatchCanceled;
+
+  ctkCmdLineModuleFutureInterface FutureInterface;
+  // Watches the batch future for cancel and resume requests
+  ctkCmdLineModuleFutureWatcher FutureWatcher;
+};
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleBatchRunner::ctkCmdLineModuleBatchRunner(ctkCmdLineModuleManager* manager, QObject* parent)
+  : QObject(parent)
+  , d(new ctkCmdLineModuleBatchRunnerPrivate(this, manager))
+{
+  connect(&d->FutureWatcher, SIGNAL(canceled()), SLOT(_q_batchCanceled()));
+  connect(&d->FutureWatcher, SIGNAL(resumed()), SLOT(_q_batchResumed()));
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleBatchRunner::~ctkCmdLineModuleBatchRunner()
+{
+  this->cancel();
+  if (d->BatchRunning)
+  {
+    // The canceled invocations are not waited for
+    d->BatchRunning = false;
+    d->FutureInterface.reportFinished();
+  }
+  qDeleteAll(d->WatcherToIndex.keys());
+  d->WatcherToIndex.clear();
+  foreach(const ctkCmdLineModuleBatchRunnerPrivate::Item& item, d->Items)
+  {
+    delete item.Frontend;
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunner::setMaximumConcurrentRuns(int count)
+{
+  d->MaximumConcurrentRuns = qMax(1, count);
+  d->scheduleNext();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBatchRunner::maximumConcurrentRuns() const
+{
+  return d->MaximumConcurrentRuns;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunner::setMaximumRetries(int count)
+{
+  d->MaximumRetries = qMax(0, count);
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBatchRunner::maximumRetries() const
+{
+  return d->MaximumRetries;
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBatchRunner::run(const ctkCmdLineModuleReference& moduleRef,
+                                                       const QList<QHash<QString, QVariant> >& parameterTable)
+{
+  if (d->BatchRunning)
+  {
+    throw ctkIllegalStateException("A batch is already running");
+  }
+
+  d->ModuleReference = moduleRef;
+  d->Items.clear();
+  d->Items.resize(parameterTable.size());
+  d->Pending.clear();
+  for (int index = 0; index < parameterTable.size(); ++index)
+  {
+    d->Items[index].Values = parameterTable[index];
+    d->Pending.enqueue(index);
+  }
+  d->RunningCount = 0;
+  d->DoneCount = 0;
+  d->TotalProgress = 0;
+  d->BatchCanceled = false;
+  d->BatchRunning = true;
+
+  d->FutureInterface = ctkCmdLineModuleFutureInterface();
+  d->FutureInterface.setCanCancel(true);
+  d->FutureInterface.setCanPause(true);
+  d->FutureInterface.reportStarted();
+  d->FutureInterface.setProgressRange(0, 1000 * parameterTable.size());
+  ctkCmdLineModuleFuture future = d->FutureInterface.future();
+  d->FutureWatcher.setFuture(future);
+
+  d->scheduleNext();
+  return future;
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBatchRunner::future() const
+{
+  return d->FutureInterface.future();
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleBatchRunner::isRunning() const
+{
+  return d->BatchRunning;
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBatchRunner::itemCount() const
+{
+  return d->Items.size();
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleBatchRunner::ItemStatus ctkCmdLineModuleBatchRunner::itemStatus(int index) const
+{
+  if (!d->isValidIndex(index))
+  {
+    throw ctkInvalidArgumentException(QString("Invalid batch item index: %1").arg(index));
+  }
+  return d->Items[index].Status;
+}
+
+//----------------------------------------------------------------------------
+QString ctkCmdLineModuleBatchRunner::itemErrorString(int index) const
+{
+  return d->isValidIndex(index) ? d->Items[index].ErrorString : QString();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBatchRunner::itemRunCount(int index) const
+{
+  return d->isValidIndex(index) ? d->Items[index].RunCount : 0;
+}
+
+//----------------------------------------------------------------------------
+ctkCmdLineModuleFuture ctkCmdLineModuleBatchRunner::itemFuture(int index) const
+{
+  return d->isValidIndex(index) ? d->Items[index].Future : ctkCmdLineModuleFuture();
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleBatchRunner::doneItemCount() const
+{
+  return d->DoneCount;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunner::cancelItem(int index)
+{
+  if (!d->BatchRunning || !d->isValidIndex(index))
+  {
+    return;
+  }
+  ctkCmdLineModuleBatchRunnerPrivate::Item& item = d->Items[index];
+  if (item.Status == Pending)
+  {
+    d->Pending.removeOne(index);
+    item.Status = Canceled;
+    d->itemDone(index);
+    d->checkFinished();
+  }
+  else if (item.Status == Running)
+  {
+    item.CancelRequested = true;
+    item.Future.cancel();
+  }
+}
+
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleBatchRunner::retryItem(int index)
+{
+  if (!d->BatchRunning || d->BatchCanceled || !d->isValidIndex(index))
+  {
+    return false;
+  }
+  ctkCmdLineModuleBatchRunnerPrivate::Item& item = d->Items[index];
+  if (item.Status != Failed && item.Status != Canceled)
+  {
+    return false;
+  }
+  --d->DoneCount;
+  item.Status = Pending;
+  item.CancelRequested = false;
+  item.FailureCount = 0;
+  item.ErrorString.clear();
+  d->setItemProgress(index, 0);
+  d->Pending.enqueue(index);
+  d->scheduleNext();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleBatchRunner::cancel()
+{
+  if (!d->BatchRunning)
+  {
+    return;
+  }
+  d->FutureInterface.cancel();
+  d->cancelAll();
+}
+
+#include "moc_ctkCmdLineModuleBatchRunner.cpp"
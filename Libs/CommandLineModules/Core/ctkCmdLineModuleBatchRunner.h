@@ -0,0 +1,251 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CTKCMDLINEMODULEBATCHRUNNER_H
+#define CTKCMDLINEMODULEBATCHRUNNER_H
+
+#include "ctkCommandLineModulesCoreExport.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QScopedPointer>
+#include <QString>
+#include <QVariant>
+
+class ctkCmdLineModuleFuture;
+class ctkCmdLineModuleManager;
+class ctkCmdLineModuleReference;
+struct ctkCmdLineModuleBatchRunnerPrivate;
+
+/**
+ * @ingroup CommandLineModulesCore_API
+ *
+ * @brief Runs a module once for each row of a parameter table.
+ *
+ * Each row of the table holds the parameter values of one invocation of the
+ * module, parameters missing from a row keep their default value. The
+ * invocations are run by the back-end registered in the module manager, at
+ * most maximumConcurrentRuns() of them at the same time.
+ *
+ * The ctkCmdLineModuleFuture returned by run() represents the whole batch:
+ * - its progress is the sum of the progress of all the invocations,
+ *   each invocation counting for 1000 in the range [0, 1000 * itemCount()].
+ * - the results of an invocation are reported as soon as it finishes
+ *   successfully. Use the itemFinished() signal or itemFuture() to know which
+ *   invocation reported which results.
+ * - canceling it cancels all the running and pending invocations.
+ * - pausing it stops starting new invocations.
+ *
+ * A failed invocation is started again up to maximumRetries() times, and can
+ * be started again with retryItem() while the batch is running. Failed
+ * invocations do not make the batch fail, use itemStatus() and
+ * itemErrorString() to check their outcome.
+ *
+ * The invocations are scheduled from the event loop of the thread of the
+ * batch runner: do not block this thread waiting for the batch future.
+ *
+ * \code
+ * ctkCmdLineModuleBatchRunner runner(&manager);
+ * QList<QHash<QString, QVariant> > table;
+ * foreach(const QString& file, inputFiles)
+ * {
+ *   QHash<QString, QVariant> row;
+ *   row["inputImage"] = file;
+ *   table << row;
+ * }
+ * ctkCmdLineModuleFutureWatcher watcher;
+ * watcher.setFuture(runner.run(moduleRef, table));
+ * \endcode
+ */
+class CTK_CMDLINEMODULECORE_EXPORT ctkCmdLineModuleBatchRunner : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  enum ItemStatus {
+    /** The invocation is waiting for a free slot */
+    Pending,
+    /** The module is running */
+    Running,
+    /** The module finished successfully */
+    Finished,
+    /** The module failed and was not retried */
+    Failed,
+    /** The invocation was canceled */
+    Canceled
+  };
+
+  ctkCmdLineModuleBatchRunner(ctkCmdLineModuleManager* manager, QObject* parent = 0);
+
+  /**
+   * @brief Cancels the running batch, if any.
+   */
+  ~ctkCmdLineModuleBatchRunner();
+
+  /**
+   * @brief Set the maximum number of invocations running at the same time.
+   *
+   * The default is QThread::idealThreadCount(). Changing it while a batch
+   * runs only affects the invocations started afterwards.
+   *
+   * @param count The maximum number of concurrent invocations.
+   */
+  void setMaximumConcurrentRuns(int count);
+
+  /**
+   * @brief Get the maximum number of invocations running at the same time.
+   * @return The maximum number of concurrent invocations.
+   */
+  int maximumConcurrentRuns() const;
+
+  /**
+   * @brief Set how many times a failed invocation is started again.
+   *
+   * The default is 0, failed invocations are not retried.
+   *
+   * @param count The maximum number of retries per invocation.
+   */
+  void setMaximumRetries(int count);
+
+  /**
+   * @brief Get how many times a failed invocation is started again.
+   * @return The maximum number of retries per invocation.
+   */
+  int maximumRetries() const;
+
+  /**
+   * @brief Start running a module once for each row of a parameter table.
+   * @param moduleRef The module to run.
+   * @param parameterTable The parameter values of each invocation.
+   * @return A future representing the whole batch.
+   * @throws ctkIllegalStateException if a batch is already running.
+   */
+  ctkCmdLineModuleFuture run(const ctkCmdLineModuleReference& moduleRef,
+                             const QList<QHash<QString, QVariant> >& parameterTable);
+
+  /**
+   * @brief Get the future of the last batch started with run().
+   */
+  ctkCmdLineModuleFuture future() const;
+
+  /**
+   * @brief Check if a batch is running.
+   */
+  bool isRunning() const;
+
+  /**
+   * @brief Get the number of invocations of the last batch.
+   */
+  int itemCount() const;
+
+  /**
+   * @brief Get the status of an invocation.
+   * @param index The row of the invocation in the parameter table.
+   * @throws ctkInvalidArgumentException if \c index is out of range.
+   */
+  ItemStatus itemStatus(int index) const;
+
+  /**
+   * @brief Get the reason of the failure of an invocation.
+   * @param index The row of the invocation in the parameter table.
+   * @return The error string, or an empty string if the invocation did not fail.
+   */
+  QString itemErrorString(int index) const;
+
+  /**
+   * @brief Get the number of times an invocation was started.
+   * @param index The row of the invocation in the parameter table.
+   */
+  int itemRunCount(int index) const;
+
+  /**
+   * @brief Get the future of the last run of an invocation.
+   * @param index The row of the invocation in the parameter table.
+   * @return The future, or an invalid future if the invocation never started.
+   */
+  ctkCmdLineModuleFuture itemFuture(int index) const;
+
+  /**
+   * @brief Get the number of invocations which are finished, failed or canceled.
+   */
+  int doneItemCount() const;
+
+public Q_SLOTS:
+
+  /**
+   * @brief Cancel an invocation.
+   * @param index The row of the invocation in the parameter table.
+   *
+   * A pending invocation is not started, a running one is canceled. This
+   * does nothing if the invocation is already done.
+   */
+  void cancelItem(int index);
+
+  /**
+   * @brief Start a failed or canceled invocation again.
+   * @param index The row of the invocation in the parameter table.
+   * @return \c true if the invocation was queued, \c false if the batch
+   *         is not running or the invocation is not failed or canceled.
+   */
+  bool retryItem(int index);
+
+  /**
+   * @brief Cancel the running batch.
+   */
+  void cancel();
+
+Q_SIGNALS:
+
+  /**
+   * @brief This signal is emitted when an invocation is started.
+   * @param index The row of the invocation in the parameter table.
+   */
+  void itemStarted(int index);
+
+  /**
+   * @brief This signal is emitted when an invocation is done, whatever its
+   *        status. It is not emitted for failures which are retried.
+   * @param index The row of the invocation in the parameter table.
+   */
+  void itemFinished(int index);
+
+  /**
+   * @brief This signal is emitted when all the invocations of the batch are done.
+   */
+  void finished();
+
+private:
+
+  friend struct ctkCmdLineModuleBatchRunnerPrivate;
+
+  Q_PRIVATE_SLOT(d, void _q_itemFinished())
+  Q_PRIVATE_SLOT(d, void _q_itemProgressValueChanged(int))
+  Q_PRIVATE_SLOT(d, void _q_batchCanceled())
+  Q_PRIVATE_SLOT(d, void _q_batchResumed())
+
+  QScopedPointer<ctkCmdLineModuleBatchRunnerPrivate> d;
+
+  Q_DISABLE_COPY(ctkCmdLineModuleBatchRunner)
+};
+
+#endif // CTKCMDLINEMODULEBATCHRUNNER_H
@@ -21,10 +21,21 @@
 
 #include "ctkCmdLineModuleCache_p.h"
 
+#include "ctkCmdLineModuleDescription.h"
+#include "ctkCmdLineModuleDescription_p.h"
+#include "ctkCmdLineModuleParameter.h"
+#include "ctkCmdLineModuleParameter_p.h"
+#include "ctkCmdLineModuleParameterGroup.h"
+#include "ctkCmdLineModuleParameterGroup_p.h"
+
 #include <QUrl>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QDirIterator>
-#include <QTextStream>
+#include <QSaveFile>
 #include <QMutex>
 #include <QHash>
 
@@ -36,17 +47,95 @@ CTK_CMDLINEMODULECORE_EXPORT int qHash(const QUrl& url)
 }
 #endif
 
+namespace {
+
+const quint32 IndexFileMagic = 0x434d4c43; // "CMLC"
+const quint32 IndexFileVersion = 2;
+
+}
+
 struct ctkCmdLineModuleCachePrivate
 {
+  struct Entry
+  {
+    Entry() : TimeStamp(-1), XmlValidated(false), XmlValid(false) {}
+
+    qint64 TimeStamp;
+    QByteArray XmlDescription;
+    bool XmlValidated;
+    bool XmlValid;
+    QString XmlValidationErrorString;
+    QByteArray Description;
+    // Data derived from the XML description, e.g. by front-ends
+    QHash<QString, QByteArray> Data;
+  };
+
+  ctkCmdLineModuleCachePrivate()
+    : Dirty(false)
+  {}
+
   QString CacheDir;
 
-  QHash<QUrl, qint64> LocationToTimeStamp;
-  QHash<QUrl, QByteArray> LocationToXmlDescription;
+  QHash<QUrl, Entry> LocationToEntry;
+  bool Dirty;
 
   QMutex Mutex;
 
-  void LoadTimeStamps()
+  QString indexFileName() const
+  {
+    return this->CacheDir + "/ctkCmdLineModuleCache.index";
+  }
+
+  void LoadIndex()
+  {
+    QFile indexFile(this->indexFileName());
+    if (!indexFile.exists())
+    {
+      this->ImportTimeStampFiles();
+      return;
+    }
+    if (!indexFile.open(QIODevice::ReadOnly))
+    {
+      return;
+    }
+
+    QDataStream stream(&indexFile);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != IndexFileMagic || version != IndexFileVersion)
+    {
+      // An index from another version is rewritten from scratch
+      this->Dirty = true;
+      return;
+    }
+    quint32 count = 0;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+      QUrl location;
+      Entry entry;
+      stream >> location >> entry.TimeStamp >> entry.XmlDescription
+             >> entry.XmlValidated >> entry.XmlValid >> entry.XmlValidationErrorString
+             >> entry.Description >> entry.Data;
+      if (stream.status() == QDataStream::Ok && !location.isEmpty())
+      {
+        this->LocationToEntry[location] = entry;
+      }
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+      qWarning() << "Command line module cache index" << indexFile.fileName() << "is corrupted.";
+      this->LocationToEntry.clear();
+      this->Dirty = true;
+    }
+  }
+
+  void ImportTimeStampFiles()
   {
+    // Cache directories written by previous versions contain one .timestamp
+    // and one .xml file per module
     QDirIterator dirIter(this->CacheDir, QStringList() << "*.timestamp", QDir::Files | QDir::Readable);
     while(dirIter.hasNext())
     {
@@ -54,23 +143,142 @@ struct ctkCmdLineModuleCachePrivate
       timestampFile.open(QIODevice::ReadOnly);
       QUrl url = QUrl(timestampFile.readLine().trimmed().data());
       QByteArray timestamp = timestampFile.readLine();
+      timestampFile.close();
       bool ok = false;
       qint64 ts = timestamp.toLongLong(&ok);
       if (ok && !url.isEmpty())
       {
-        this->LocationToTimeStamp[url] = ts;
+        Entry entry;
+        entry.TimeStamp = ts;
+        QFile xmlFile(QFileInfo(timestampFile).absolutePath() + "/" + QFileInfo(timestampFile).completeBaseName() + ".xml");
+        if (xmlFile.exists() && xmlFile.open(QIODevice::ReadOnly))
+        {
+          entry.XmlDescription = xmlFile.readAll();
+          xmlFile.close();
+        }
+        xmlFile.remove();
+        this->LocationToEntry[url] = entry;
       }
+      timestampFile.remove();
+      this->Dirty = true;
     }
   }
 
-  QString timeStampFileName(const QUrl& moduleLocation) const
+  void SaveIndex()
   {
-    return this->CacheDir + "/" + QString::number(qHash(moduleLocation)) + ".timestamp";
+    if (!this->Dirty)
+    {
+      return;
+    }
+    QSaveFile indexFile(this->indexFileName());
+    if (!indexFile.open(QIODevice::WriteOnly))
+    {
+      qWarning() << "Command line module cache index" << indexFile.fileName() << "could not be written.";
+      return;
+    }
+
+    QDataStream stream(&indexFile);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << IndexFileMagic << IndexFileVersion << quint32(this->LocationToEntry.size());
+    QHash<QUrl, Entry>::ConstIterator iter = this->LocationToEntry.constBegin();
+    for (; iter != this->LocationToEntry.constEnd(); ++iter)
+    {
+      const Entry& entry = iter.value();
+      stream << iter.key() << entry.TimeStamp << entry.XmlDescription
+             << entry.XmlValidated << entry.XmlValid << entry.XmlValidationErrorString
+             << entry.Description << entry.Data;
+    }
+    if (stream.status() != QDataStream::Ok || !indexFile.commit())
+    {
+      qWarning() << "Command line module cache index" << indexFile.fileName() << "could not be written.";
+      return;
+    }
+    this->Dirty = false;
   }
 
-  QString xmlFileName(const QUrl& moduleLocation) const
+  // The logo is not part of the XML description, hence not stored
+  static QByteArray WriteDescription(const ctkCmdLineModuleDescription& description)
   {
-    return this->CacheDir + "/" + QString::number(qHash(moduleLocation)) + ".xml";
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    const ctkCmdLineModuleDescriptionPrivate* d = description.d.constData();
+    stream << d->Title << d->Category << d->Description << d->Version
+           << d->DocumentationURL << d->License << d->Acknowledgements
+           << d->Contributor << d->Type << d->Target << d->Location
+           << d->AlternativeType << d->AlternativeTarget << d->AlternativeLocation;
+    stream << quint32(d->ParameterGroups.size());
+    foreach(const ctkCmdLineModuleParameterGroup& group, d->ParameterGroups)
+    {
+      const ctkCmdLineModuleParameterGroupPrivate* gd = group.d.constData();
+      stream << gd->Label << gd->Description << gd->Advanced;
+      stream << quint32(gd->Parameters.size());
+      foreach(const ctkCmdLineModuleParameter& parameter, gd->Parameters)
+      {
+        const ctkCmdLineModuleParameterPrivate* pd = parameter.d.constData();
+        stream << pd->Tag << pd->Name << pd->Description << pd->Label << pd->Type
+               << pd->Hidden << pd->Default << pd->Flag << pd->LongFlag
+               << pd->Constraints << pd->Minimum << pd->Maximum << pd->Step
+               << pd->Channel << pd->Index << pd->Multiple
+               << pd->FileExtensionsAsString << pd->FileExtensions
+               << pd->CoordinateSystem << pd->Elements
+               << pd->FlagAliasesAsString << pd->DeprecatedFlagAliasesAsString
+               << pd->LongFlagAliasesAsString << pd->DeprecatedLongFlagAliasesAsString
+               << pd->FlagAliases << pd->DeprecatedFlagAliases
+               << pd->LongFlagAliases << pd->DeprecatedLongFlagAliases;
+      }
+    }
+    return data;
+  }
+
+  static ctkCmdLineModuleDescription ReadDescription(const QByteArray& data)
+  {
+    ctkCmdLineModuleDescription description;
+    if (data.isEmpty())
+    {
+      return description;
+    }
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_0);
+    ctkCmdLineModuleDescriptionPrivate* d = description.d.data();
+    stream >> d->Title >> d->Category >> d->Description >> d->Version
+           >> d->DocumentationURL >> d->License >> d->Acknowledgements
+           >> d->Contributor >> d->Type >> d->Target >> d->Location
+           >> d->AlternativeType >> d->AlternativeTarget >> d->AlternativeLocation;
+    quint32 groupCount = 0;
+    stream >> groupCount;
+    for (quint32 i = 0; i < groupCount && stream.status() == QDataStream::Ok; ++i)
+    {
+      ctkCmdLineModuleParameterGroup group;
+      ctkCmdLineModuleParameterGroupPrivate* gd = group.d.data();
+      stream >> gd->Label >> gd->Description >> gd->Advanced;
+      quint32 parameterCount = 0;
+      stream >> parameterCount;
+      for (quint32 j = 0; j < parameterCount && stream.status() == QDataStream::Ok; ++j)
+      {
+        ctkCmdLineModuleParameter parameter;
+        ctkCmdLineModuleParameterPrivate* pd = parameter.d.data();
+        stream >> pd->Tag >> pd->Name >> pd->Description >> pd->Label >> pd->Type
+               >> pd->Hidden >> pd->Default >> pd->Flag >> pd->LongFlag
+               >> pd->Constraints >> pd->Minimum >> pd->Maximum >> pd->Step
+               >> pd->Channel >> pd->Index >> pd->Multiple
+               >> pd->FileExtensionsAsString >> pd->FileExtensions
+               >> pd->CoordinateSystem >> pd->Elements
+               >> pd->FlagAliasesAsString >> pd->DeprecatedFlagAliasesAsString
+               >> pd->LongFlagAliasesAsString >> pd->DeprecatedLongFlagAliasesAsString
+               >> pd->FlagAliases >> pd->DeprecatedFlagAliases
+               >> pd->LongFlagAliases >> pd->DeprecatedLongFlagAliases;
+        gd->Parameters.push_back(parameter);
+      }
+      d->ParameterGroups.push_back(group);
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+      // Parsed again from the XML description
+      return ctkCmdLineModuleDescription();
+    }
+    return description;
   }
 };
 
@@ -78,11 +286,12 @@ ctkCmdLineModuleCache::ctkCmdLineModuleCache(const QString& cacheDir)
   : d(new ctkCmdLineModuleCachePrivate)
 {
   d->CacheDir = cacheDir;
-  d->LoadTimeStamps();
+  d->LoadIndex();
 }
 
 ctkCmdLineModuleCache::~ctkCmdLineModuleCache()
 {
+  this->save();
 }
 
 QString ctkCmdLineModuleCache::cacheDir() const
@@ -94,98 +303,135 @@ QString ctkCmdLineModuleCache::cacheDir() const
 QByteArray ctkCmdLineModuleCache::rawXmlDescription(const QUrl& moduleLocation) const
 {
   QMutexLocker lock(&d->Mutex);
-
-  if (d->LocationToXmlDescription.contains(moduleLocation))
-  {
-    return d->LocationToXmlDescription[moduleLocation];
-  }
-  // lazily load the XML description from the file system
-  QByteArray xml;
-  QString a = moduleLocation.toString();
-  QString fn = d->xmlFileName(moduleLocation);
-  QFile xmlFile(d->xmlFileName(moduleLocation));
-  if (xmlFile.exists() && xmlFile.open(QIODevice::ReadOnly))
-  {
-    xml = xmlFile.readAll();
-    xmlFile.close();
-  }
-  d->LocationToXmlDescription[moduleLocation] = xml;
-  return xml;
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::ConstIterator iter =
+      d->LocationToEntry.find(moduleLocation);
+  return iter == d->LocationToEntry.end() ? QByteArray() : iter.value().XmlDescription;
 }
 
 qint64 ctkCmdLineModuleCache::timeStamp(const QUrl& moduleLocation) const
 {
   QMutexLocker lock(&d->Mutex);
-  if (d->LocationToTimeStamp.contains(moduleLocation))
-  {
-    return d->LocationToTimeStamp[moduleLocation];
-  }
-  return -1;
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::ConstIterator iter =
+      d->LocationToEntry.find(moduleLocation);
+  return iter == d->LocationToEntry.end() ? -1 : iter.value().TimeStamp;
 }
 
 void ctkCmdLineModuleCache::cacheXmlDescription(const QUrl& moduleLocation, qint64 timestamp, const QByteArray& xmlDescription)
 {
-  QFile timestampFile(d->timeStampFileName(moduleLocation));
-  QFile xmlFile(d->xmlFileName(moduleLocation));
-  timestampFile.remove();
-  timestampFile.open(QIODevice::WriteOnly);
+  ctkCmdLineModuleCachePrivate::Entry entry;
+  entry.TimeStamp = timestamp;
+  entry.XmlDescription = xmlDescription;
 
-  QByteArray ba;
-  QTextStream str(&ba);
-  str << moduleLocation.toString() << '\n' << timestamp;
-  str.flush();
-  if (timestampFile.write(ba) == -1)
+  QMutexLocker lock(&d->Mutex);
+  d->LocationToEntry[moduleLocation] = entry;
+  d->Dirty = true;
+}
+
+bool ctkCmdLineModuleCache::xmlValidation(const QUrl& moduleLocation, bool* valid, QString* errorString) const
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::ConstIterator iter =
+      d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || !iter.value().XmlValidated)
+  {
+    return false;
+  }
+  *valid = iter.value().XmlValid;
+  *errorString = iter.value().XmlValidationErrorString;
+  return true;
+}
+
+void ctkCmdLineModuleCache::cacheXmlValidation(const QUrl& moduleLocation, bool valid, const QString& errorString)
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::Iterator iter =
+      d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end())
   {
-    timestampFile.close();
-    timestampFile.remove();
     return;
   }
-  timestampFile.close();
+  iter.value().XmlValidated = true;
+  iter.value().XmlValid = valid;
+  iter.value().XmlValidationErrorString = errorString;
+  d->Dirty = true;
+}
 
-  xmlFile.remove();
-  if (!xmlDescription.isEmpty())
+ctkCmdLineModuleDescription ctkCmdLineModuleCache::description(const QUrl& moduleLocation) const
+{
+  QByteArray data;
   {
-    xmlFile.open(QIODevice::WriteOnly);
-    if (xmlFile.write(xmlDescription) == -1)
+    QMutexLocker lock(&d->Mutex);
+    QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::ConstIterator iter =
+        d->LocationToEntry.find(moduleLocation);
+    if (iter != d->LocationToEntry.end())
     {
-      timestampFile.remove();
-      xmlFile.close();
-      xmlFile.remove();
-      return;
+      data = iter.value().Description;
     }
   }
+  return ctkCmdLineModuleCachePrivate::ReadDescription(data);
+}
 
+void ctkCmdLineModuleCache::cacheDescription(const QUrl& moduleLocation, const ctkCmdLineModuleDescription& description)
+{
+  QByteArray data = ctkCmdLineModuleCachePrivate::WriteDescription(description);
+
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::Iterator iter =
+      d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end())
   {
-    QMutexLocker lock(&d->Mutex);
-    d->LocationToXmlDescription[moduleLocation] = xmlDescription;
-    d->LocationToTimeStamp[moduleLocation] = timestamp;
+    return;
   }
+  iter.value().Description = data;
+  d->Dirty = true;
 }
 
-void ctkCmdLineModuleCache::removeCacheEntry(const QUrl& moduleLocation)
+QByteArray ctkCmdLineModuleCache::data(const QUrl& moduleLocation, const QByteArray& xmlDescription,
+                                       const QString& key) const
 {
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::ConstIterator iter =
+      d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || iter.value().XmlDescription != xmlDescription)
   {
-    QMutexLocker lock(&d->Mutex);
-    d->LocationToTimeStamp.remove(moduleLocation);
-    d->LocationToXmlDescription.remove(moduleLocation);
+    return QByteArray();
   }
+  return iter.value().Data.value(key);
+}
 
-  QFile timestampFile(d->timeStampFileName(moduleLocation));
-  if (timestampFile.exists())
+void ctkCmdLineModuleCache::cacheData(const QUrl& moduleLocation, const QByteArray& xmlDescription,
+                                      const QString& key, const QByteArray& data)
+{
+  QMutexLocker lock(&d->Mutex);
+  QHash<QUrl, ctkCmdLineModuleCachePrivate::Entry>::Iterator iter =
+      d->LocationToEntry.find(moduleLocation);
+  if (iter == d->LocationToEntry.end() || iter.value().XmlDescription != xmlDescription)
   {
-    timestampFile.remove();
+    return;
   }
-  QFile xmlFile(d->xmlFileName(moduleLocation));
-  if (xmlFile.exists())
+  iter.value().Data[key] = data;
+  d->Dirty = true;
+}
+
+void ctkCmdLineModuleCache::removeCacheEntry(const QUrl& moduleLocation)
+{
+  QMutexLocker lock(&d->Mutex);
+  if (d->LocationToEntry.remove(moduleLocation))
   {
-    xmlFile.remove();
+    d->Dirty = true;
   }
 }
 
 void ctkCmdLineModuleCache::clearCache()
 {
-  foreach(const QUrl &url, d->LocationToXmlDescription.keys())
-  {
-    removeCacheEntry(url);
-  }
+  QMutexLocker lock(&d->Mutex);
+  d->LocationToEntry.clear();
+  d->Dirty = false;
+  QFile::remove(d->indexFileName());
+}
+
+void ctkCmdLineModuleCache::save()
+{
+  QMutexLocker lock(&d->Mutex);
+  d->SaveIndex();
 }
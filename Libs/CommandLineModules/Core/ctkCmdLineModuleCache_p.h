@@ -23,9 +23,12 @@
 #define CTKCMDLINEMODULECACHE_H
 
 #include <QScopedPointer>
+#include <QString>
 
 struct ctkCmdLineModuleCachePrivate;
 
+class ctkCmdLineModuleDescription;
+
 class QUrl;
 
 /**
@@ -33,9 +36,18 @@ class QUrl;
  * \brief Private non-exported class to contain a cache of
  * XML descriptions and time-stamps.
  *
- * The intention is that this Cache is an in-memory representation
- * of a file-system directory containing XML files and a corresponding
- * timestamp. Hence these should always be in synch.
+ * The cache is an in-memory representation of a single index file
+ * in the cache directory. Next to the XML description and time-stamp of
+ * each module, the index stores the XML validation result, the parsed
+ * ctkCmdLineModuleDescription and data derived from the XML description
+ * by front-ends, so that a warm start neither runs the module nor parses
+ * its XML description.
+ *
+ * The index file is read once on construction and written back by save()
+ * and on destruction if the cache changed. ctkCmdLineModuleManager saves it
+ * once a batch of registrations finished, ctkCmdLineModuleFrontend after
+ * caching data. Cache directories using the
+ * previous one .timestamp and .xml file per module layout are imported.
  *
  * \ingroup CommandLineModulesCore_API
  */
@@ -78,6 +90,57 @@ public:
    */
   void cacheXmlDescription(const QUrl& moduleLocation, qint64 timestamp, const QByteArray& xmlDescription);
 
+  /**
+   * @brief Returns the cached validation result of a module XML description.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @param valid set to the validation result
+   * @param errorString set to the validation error, if any
+   * @return false if the cached XML description was not validated yet
+   */
+  bool xmlValidation(const QUrl& moduleLocation, bool* valid, QString* errorString) const;
+
+  /**
+   * @brief Adds the validation result of the cached XML description of a module.
+   *
+   * This does nothing if the module is not cached.
+   */
+  void cacheXmlValidation(const QUrl& moduleLocation, bool valid, const QString& errorString);
+
+  /**
+   * @brief Returns the cached parsed description of a module.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @return the description, with a null title if none is cached
+   */
+  ctkCmdLineModuleDescription description(const QUrl& moduleLocation) const;
+
+  /**
+   * @brief Adds the parsed description of the cached XML description of a module.
+   *
+   * This does nothing if the module is not cached.
+   */
+  void cacheDescription(const QUrl& moduleLocation, const ctkCmdLineModuleDescription& description);
+
+  /**
+   * @brief Returns data derived from the XML description of a module.
+   * @param moduleLocation QUrl representing the location,
+   * for example a file path for a local process.
+   * @param xmlDescription the XML description the data was derived from
+   * @param key the key of the data
+   * @return the data, or an empty QByteArray if none is cached for this XML description
+   */
+  QByteArray data(const QUrl& moduleLocation, const QByteArray& xmlDescription, const QString& key) const;
+
+  /**
+   * @brief Adds data derived from the XML description of a module.
+   *
+   * The data is dropped when the XML description of the module changes.
+   * This does nothing if \a xmlDescription is not the cached XML description.
+   */
+  void cacheData(const QUrl& moduleLocation, const QByteArray& xmlDescription,
+                 const QString& key, const QByteArray& data);
+
   /**
    * @brief Removes an entry from the cache.
    * @param moduleLocation QUrl representing the location,
@@ -90,6 +153,12 @@ public:
    */
   void clearCache();
 
+  /**
+   * @brief Writes the index file if the cache changed since it was read
+   * or last written.
+   */
+  void save();
+
 private:
 
   QScopedPointer<ctkCmdLineModuleCachePrivate> d;
@@ -32,6 +32,7 @@
 #include <QFileInfo>
 #include <QUrl>
 #include <QDebug>
+#include <QFuture>
 #include <QtConcurrentMap>
 
 #include <iostream>
@@ -415,8 +416,25 @@ void ctkCmdLineModuleDirectoryWatcherPrivate::updateModules(const QString &direc
 //-----------------------------------------------------------------------------
 QList<ctkCmdLineModuleReferenceResult> ctkCmdLineModuleDirectoryWatcherPrivate::loadModules(const QStringList& executables)
 {
-  QList<ctkCmdLineModuleReferenceResult> refResults = QtConcurrent::blockingMapped(executables,
-                                                                                   ctkCmdLineModuleConcurrentRegister(this->ModuleManager, this->Debug));
+  // The manager bounds the number of modules run at the same time
+  QList<QUrl> locations;
+  foreach(const QString& executable, executables)
+  {
+    locations << QUrl::fromLocalFile(executable);
+  }
+  QList<QFuture<ctkCmdLineModuleReferenceResult> > futures =
+      this->ModuleManager->registerModulesAsync(locations);
+
+  QList<ctkCmdLineModuleReferenceResult> refResults;
+  foreach(QFuture<ctkCmdLineModuleReferenceResult> future, futures)
+  {
+    ctkCmdLineModuleReferenceResult refResult = future.result();
+    if (this->Debug && !refResult.m_RuntimeError.isEmpty())
+    {
+      qDebug() << refResult.m_RuntimeError;
+    }
+    refResults << refResult;
+  }
 
   for (int i = 0; i < executables.size(); ++i)
   {
@@ -21,10 +21,12 @@
 
 #include "ctkCmdLineModuleFrontend.h"
 
+#include "ctkCmdLineModuleCache_p.h"
 #include "ctkCmdLineModuleDescription.h"
 #include "ctkCmdLineModuleParameter.h"
 #include "ctkCmdLineModuleParameterGroup.h"
 #include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleReference_p.h"
 #include "ctkCmdLineModuleFuture.h"
 #include "ctkException.h"
 
@@ -112,6 +114,25 @@ QUrl ctkCmdLineModuleFrontend::location() const
   return d->ModuleReference.location();
 }
 
+//----------------------------------------------------------------------------
+QByteArray ctkCmdLineModuleFrontend::cachedData(const QString& key) const
+{
+  QSharedPointer<ctkCmdLineModuleCache> cache = d->ModuleReference.d->Cache.toStrongRef();
+  if (!cache) return QByteArray();
+  return cache->data(d->ModuleReference.location(), d->ModuleReference.rawXmlDescription(), key);
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleFrontend::setCachedData(const QString& key, const QByteArray& data) const
+{
+  QSharedPointer<ctkCmdLineModuleCache> cache = d->ModuleReference.d->Cache.toStrongRef();
+  if (!cache) return;
+  cache->cacheData(d->ModuleReference.location(), d->ModuleReference.rawXmlDescription(), key, data);
+  // Written now, the data is available to the next start even if the
+  // application does not exit normally
+  cache->save();
+}
+
 //----------------------------------------------------------------------------
 ctkCmdLineModuleFuture ctkCmdLineModuleFrontend::future() const
 {
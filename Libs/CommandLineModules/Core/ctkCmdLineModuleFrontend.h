@@ -238,6 +238,29 @@ protected:
    */
   ctkCmdLineModuleFrontend(const ctkCmdLineModuleReference& moduleRef);
 
+  /**
+   * @brief Get data derived from the XML description of the module.
+   * @param key The key used with setCachedData().
+   * @return The cached data or an empty QByteArray if there is none.
+   *
+   * Sub-classes can use this method to avoid deriving expensive data from
+   * the XML description each time a front-end is created.
+   *
+   * @see setCachedData()
+   */
+  QByteArray cachedData(const QString& key) const;
+
+  /**
+   * @brief Cache data derived from the XML description of the module.
+   * @param key The key identifying the data.
+   * @param data The data.
+   *
+   * The data is stored with the XML description in the cache of the module
+   * manager which registered the module, and dropped when the XML description
+   * changes. This does nothing if the module manager has no cache directory.
+   */
+  void setCachedData(const QString& key, const QByteArray& data) const;
+
 private Q_SLOTS:
 
   /**
@@ -25,6 +25,7 @@
 #include "ctkCmdLineModuleFrontend.h"
 #include "ctkCmdLineModuleTimeoutException.h"
 #include "ctkCmdLineModuleCache_p.h"
+#include "ctkCmdLineModuleConcurrentHelpers.h"
 #include "ctkCmdLineModuleFuture.h"
 #include "ctkCmdLineModuleXmlValidator.h"
 #include "ctkCmdLineModuleReference.h"
@@ -42,9 +43,14 @@
 #include <QUrl>
 #include <QHash>
 #include <QList>
+#include <QAtomicInt>
 #include <QMutex>
+#include <QSharedPointer>
 #include <QDebug>
 #include <QFuture>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 
 #include <algorithm>
 
@@ -87,24 +93,84 @@ struct ctkCmdLineModuleManagerPrivate
     }
   }
 
+  // Writes the cache index once no registration is pending anymore, so
+  // that a batch of registrations writes it only once
+  void registrationStarted()
+  {
+    this->PendingRegistrationCount.ref();
+  }
+
+  void registrationFinished()
+  {
+    if (!this->PendingRegistrationCount.deref() && this->ModuleCache)
+    {
+      this->ModuleCache->save();
+    }
+  }
+
   QMutex Mutex;
   QHash<QString, ctkCmdLineModuleBackend*> SchemeToBackend;
   QHash<QUrl, ctkCmdLineModuleReference> LocationToRef;
-  QScopedPointer<ctkCmdLineModuleCache> ModuleCache;
+  // Shared with the module references, see ctkCmdLineModuleFrontend::cachedData()
+  QSharedPointer<ctkCmdLineModuleCache> ModuleCache;
   int XmlTimeOut;
 
+  // Runs the asynchronous registrations
+  QThreadPool RegistrationPool;
+  QAtomicInt PendingRegistrationCount;
+
   ctkCmdLineModuleManager::ValidationMode ValidationMode;
 };
 
+//----------------------------------------------------------------------------
+struct ctkCmdLineModulePendingRegistration
+{
+  ctkCmdLineModulePendingRegistration(ctkCmdLineModuleManagerPrivate* d)
+    : d(d)
+  {
+    d->registrationStarted();
+  }
+
+  ~ctkCmdLineModulePendingRegistration()
+  {
+    d->registrationFinished();
+  }
+
+  ctkCmdLineModuleManagerPrivate* d;
+};
+
+//----------------------------------------------------------------------------
+// Registration run by the registration pool, pending from the time it is queued
+struct ctkCmdLineModuleAsyncRegister
+{
+  typedef ctkCmdLineModuleReferenceResult result_type;
+
+  ctkCmdLineModuleAsyncRegister(ctkCmdLineModuleManager* manager, ctkCmdLineModuleManagerPrivate* d)
+    : Manager(manager), d(d)
+  {}
+
+  ctkCmdLineModuleReferenceResult operator()(const QUrl& location)
+  {
+    ctkCmdLineModuleReferenceResult result = ctkCmdLineModuleConcurrentRegister(this->Manager)(location);
+    d->registrationFinished();
+    return result;
+  }
+
+  ctkCmdLineModuleManager* Manager;
+  ctkCmdLineModuleManagerPrivate* d;
+};
+
 //----------------------------------------------------------------------------
 ctkCmdLineModuleManager::ctkCmdLineModuleManager(ValidationMode validationMode, const QString& cacheDir)
   : d(new ctkCmdLineModuleManagerPrivate(validationMode, cacheDir))
 {
+  d->RegistrationPool.setMaxThreadCount(QThread::idealThreadCount());
 }
 
 //----------------------------------------------------------------------------
 ctkCmdLineModuleManager::~ctkCmdLineModuleManager()
 {
+  d->RegistrationPool.waitForDone();
 }
 
 //----------------------------------------------------------------------------
@@ -133,6 +199,18 @@ int ctkCmdLineModuleManager::timeOutForXMLRetrieval() const
   return d->XmlTimeOut;
 }
 
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleManager::setMaximumConcurrentRegistrations(int count)
+{
+  d->RegistrationPool.setMaxThreadCount(qMax(1, count));
+}
+
+//----------------------------------------------------------------------------
+int ctkCmdLineModuleManager::maximumConcurrentRegistrations() const
+{
+  return d->RegistrationPool.maxThreadCount();
+}
+
 //----------------------------------------------------------------------------
 void ctkCmdLineModuleManager::registerBackend(ctkCmdLineModuleBackend *backend)
 {
@@ -183,6 +261,7 @@ QList<ctkCmdLineModuleBackend*> ctkCmdLineModuleManager::backends() const
 ctkCmdLineModuleReference
 ctkCmdLineModuleManager::registerModule(const QUrl &location)
 {
+  ctkCmdLineModulePendingRegistration pendingRegistration(d.data());
   QByteArray xml;
   ctkCmdLineModuleBackend* backend = NULL;
   {
@@ -271,38 +350,48 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
   ref.d->Location = location;
   ref.d->RawXmlDescription = xml;
   ref.d->Backend = backend;
+  ref.d->Cache = d->ModuleCache;
 
   if (d->ValidationMode != SKIP_VALIDATION)
   {
-    // validate the outputted xml description
-    QBuffer input(&xml);
-    input.open(QIODevice::ReadOnly);
-
-    ctkCmdLineModuleXmlValidator validator(&input);
-    if (!validator.validateInput())
+    bool valid = true;
+    QString validationErrorString;
+    if (!fromCache || !d->ModuleCache->xmlValidation(location, &valid, &validationErrorString))
     {
+      // validate the outputted xml description
+      QBuffer input(&xml);
+      input.open(QIODevice::ReadOnly);
+
+      ctkCmdLineModuleXmlValidator validator(&input);
+      valid = validator.validateInput();
+      validationErrorString = valid ? QString() : validator.errorString();
+
       if (d->ModuleCache)
       {
-        // validation failed, cache the description anyway
-        d->ModuleCache->cacheXmlDescription(location, newTimeStamp, xml);
+        if (!valid)
+        {
+          // validation failed, cache the description anyway
+          d->ModuleCache->cacheXmlDescription(location, newTimeStamp, xml);
+        }
+        else if (newTimeStamp > 0 && !fromCache)
+        {
+          // successfully validated the xml, cache it
+          d->ModuleCache->cacheXmlDescription(location, newTimeStamp, xml);
+        }
+        d->ModuleCache->cacheXmlValidation(location, valid, validationErrorString);
       }
+    }
 
+    if (!valid)
+    {
       if (d->ValidationMode == STRICT_VALIDATION)
       {
         throw ctkInvalidArgumentException(QString("Validating module at %1 failed: %2")
-                                          .arg(location.toString()).arg(validator.errorString()));
+                                          .arg(location.toString()).arg(validationErrorString));
       }
       else
       {
-        ref.d->XmlValidationErrorString = validator.errorString();
-      }
-    }
-    else
-    {
-      if (d->ModuleCache && newTimeStamp > 0 && !fromCache)
-      {
-        // successfully validated the xml, cache it
-        d->ModuleCache->cacheXmlDescription(location, newTimeStamp, xml);
+        ref.d->XmlValidationErrorString = validationErrorString;
       }
     }
   }
@@ -315,6 +404,21 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
     }
   }
 
+  if (d->ModuleCache)
+  {
+    // Use the cached description or cache the parsed one, so that the
+    // XML description is not parsed again on the next start
+    ctkCmdLineModuleDescription description = d->ModuleCache->description(location);
+    if (fromCache && !description.title().isNull())
+    {
+      ref.d->setDescription(description);
+    }
+    else if (ref.d->parseDescription())
+    {
+      d->ModuleCache->cacheDescription(location, ref.d->description());
+    }
+  }
+
   {
     QMutexLocker lock(&d->Mutex);
     // Check that we don't have a race condition
@@ -330,6 +434,26 @@ ctkCmdLineModuleManager::registerModule(const QUrl &location)
   return ref;
 }
 
+//----------------------------------------------------------------------------
+QFuture<ctkCmdLineModuleReferenceResult>
+ctkCmdLineModuleManager::registerModuleAsync(const QUrl& location)
+{
+  d->registrationStarted();
+  return QtConcurrent::run(&d->RegistrationPool, ctkCmdLineModuleAsyncRegister(this, d.data()), location);
+}
+
+//----------------------------------------------------------------------------
+QList<QFuture<ctkCmdLineModuleReferenceResult> >
+ctkCmdLineModuleManager::registerModulesAsync(const QList<QUrl>& locations)
+{
+  QList<QFuture<ctkCmdLineModuleReferenceResult> > futures;
+  foreach(const QUrl& location, locations)
+  {
+    futures.push_back(this->registerModuleAsync(location));
+  }
+  return futures;
+}
+
 //----------------------------------------------------------------------------
 void ctkCmdLineModuleManager::unregisterModule(const ctkCmdLineModuleReference& ref)
 {
@@ -354,7 +478,10 @@ void ctkCmdLineModuleManager::unregisterModule(const ctkCmdLineModuleReference&
 //----------------------------------------------------------------------------
 void ctkCmdLineModuleManager::clearCache()
 {
-  d->ModuleCache->clearCache();
+  if (d->ModuleCache)
+  {
+    d->ModuleCache->clearCache();
+  }
 }
 
 
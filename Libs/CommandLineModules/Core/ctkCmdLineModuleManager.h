@@ -24,11 +24,13 @@
 
 #include <ctkCommandLineModulesCoreExport.h>
 
+#include <QFuture>
 #include <QObject>
 #include <QScopedPointer>
 #include <QString>
 #include <QStringList>
 #include "ctkCmdLineModuleReference.h"
+#include "ctkCmdLineModuleReferenceResult.h"
 
 struct ctkCmdLineModuleBackend;
 struct ctkCmdLineModuleFrontendFactory;
@@ -127,6 +129,23 @@ public:
    */
   int timeOutForXMLRetrieval() const;
 
+  /**
+   * @brief Set the maximum number of modules registered at the same time by
+   *        registerModuleAsync() and registerModulesAsync().
+   *
+   * This bounds the number of modules run at the same time to retrieve their
+   * XML description. The default is QThread::idealThreadCount().
+   *
+   * @param count The maximum number of concurrent registrations.
+   */
+  void setMaximumConcurrentRegistrations(int count);
+
+  /**
+   * @brief Get the maximum number of modules registered at the same time.
+   * @return The maximum number of concurrent registrations.
+   */
+  int maximumConcurrentRegistrations() const;
+
   /**
    * @brief Registers a new back-end.
    * @param backend The new back-end.
@@ -160,6 +179,26 @@ public:
    */
   ctkCmdLineModuleReference registerModule(const QUrl& location);
 
+  /**
+   * @brief Registers a module in a background thread.
+   * @param location The URL for the new module.
+   * @return A future providing the registration result. Errors for which
+   *         registerModule() throws an exception are reported in
+   *         ctkCmdLineModuleReferenceResult::m_RuntimeError.
+   *
+   * @see setMaximumConcurrentRegistrations()
+   */
+  QFuture<ctkCmdLineModuleReferenceResult> registerModuleAsync(const QUrl& location);
+
+  /**
+   * @brief Registers modules in background threads.
+   * @param locations The URLs for the new modules.
+   * @return One future per location, in the same order.
+   *
+   * @see registerModuleAsync()
+   */
+  QList<QFuture<ctkCmdLineModuleReferenceResult> > registerModulesAsync(const QList<QUrl>& locations);
+
   /**
    * @brief Unregister a previously registered module.
    * @param moduleRef The reference for the module to unregister.
@@ -170,7 +209,7 @@ public:
   void unregisterModule(const ctkCmdLineModuleReference& moduleRef);
 
   /**
-   * @brief Clears the XML/timestamp cache.
+   * @brief Clears the XML/timestamp/description cache.
    */
   void clearCache();
 
@@ -67,6 +67,22 @@ ctkCmdLineModuleDescription ctkCmdLineModuleReferencePrivate::description() cons
   return Description;
 }
 
+//----------------------------------------------------------------------------
+bool ctkCmdLineModuleReferencePrivate::parseDescription() const
+{
+  if (!XmlException)
+  {
+    this->description();
+  }
+  return XmlException == NULL;
+}
+
+//----------------------------------------------------------------------------
+void ctkCmdLineModuleReferencePrivate::setDescription(const ctkCmdLineModuleDescription& description)
+{
+  Description = description;
+}
+
 //----------------------------------------------------------------------------
 ctkCmdLineModuleReference::ctkCmdLineModuleReference()
   : d(new ctkCmdLineModuleReferencePrivate())
@@ -94,6 +94,7 @@ public:
 private:
 
   friend class ctkCmdLineModuleManager;
+  friend class ctkCmdLineModuleFrontend;
   friend CTK_CMDLINEMODULECORE_EXPORT uint qHash(const ctkCmdLineModuleReference&);
 
   QSharedDataPointer<ctkCmdLineModuleReferencePrivate> d;
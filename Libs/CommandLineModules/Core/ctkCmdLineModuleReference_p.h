@@ -26,8 +26,10 @@
 
 #include <QSharedData>
 #include <QUrl>
+#include <QWeakPointer>
 
 struct ctkCmdLineModuleBackend;
+class ctkCmdLineModuleCache;
 class ctkCmdLineModuleXmlException;
 
 struct ctkCmdLineModuleReferencePrivate : public QSharedData
@@ -37,10 +39,22 @@ struct ctkCmdLineModuleReferencePrivate : public QSharedData
 
   ctkCmdLineModuleDescription description() const;
 
+  /**
+   * @brief Parses the XML description now instead of on first access.
+   * @return false if the XML description could not be parsed.
+   */
+  bool parseDescription() const;
+
+  /**
+   * @brief Sets an already parsed description, e.g. from the module cache.
+   */
+  void setDescription(const ctkCmdLineModuleDescription& description);
+
   ctkCmdLineModuleBackend* Backend;
   QUrl Location;
   QByteArray RawXmlDescription;
   QString XmlValidationErrorString;
+  QWeakPointer<ctkCmdLineModuleCache> Cache;
 
 private:
 
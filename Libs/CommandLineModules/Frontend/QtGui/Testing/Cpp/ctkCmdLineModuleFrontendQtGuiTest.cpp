@@ -22,6 +22,7 @@
 // Qt includes
 #include <QSpinBox>
 #include <QComboBox>
+#include <QTemporaryDir>
 #include <QVariant>
 
 #if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
@@ -38,6 +39,9 @@ Q_DECLARE_METATYPE(QVariant)
 
 #include "ctkTest.h"
 
+// STD includes
+#include <typeinfo>
+
 #if (QT_VERSION < QT_VERSION_CHECK(4,7,0))
 extern int qHash(const QUrl& url);
 #endif
@@ -75,6 +79,37 @@ private:
   QHash<QUrl, QByteArray> UrlToXml;
 };
 
+// Counts the XSL transformations run by the front-end
+class FrontendQtGuiMockUp : public ctkCmdLineModuleFrontendQtGui
+{
+
+public:
+
+  FrontendQtGuiMockUp(const ctkCmdLineModuleReference& moduleRef)
+    : ctkCmdLineModuleFrontendQtGui(moduleRef)
+    , TransformCount(0)
+  {}
+
+  virtual ctkCmdLineModuleXslTransform* xslTransform() const
+  {
+    ++this->TransformCount;
+    return ctkCmdLineModuleFrontendQtGui::xslTransform();
+  }
+
+  // Share the forms prepared for ctkCmdLineModuleFrontendQtGui
+  virtual QString guiCacheKey() const
+  {
+    return QString(typeid(ctkCmdLineModuleFrontendQtGui).name());
+  }
+
+  QByteArray preparedForm() const
+  {
+    return this->cachedData(this->guiCacheKey());
+  }
+
+  mutable int TransformCount;
+};
+
 }
 
 // ----------------------------------------------------------------------------
@@ -84,8 +119,9 @@ class ctkCmdLineModuleFrontendQtGuiTester: public QObject
 
 private:
 
+  QTemporaryDir CacheDir;
   QScopedPointer<ctkCmdLineModuleBackend> Backend;
-  ctkCmdLineModuleManager Manager;
+  QScopedPointer<ctkCmdLineModuleManager> Manager;
 
   ctkCmdLineModuleReference ModuleRef;
 
@@ -105,6 +141,9 @@ private Q_SLOTS:
   void testValueSetterAndGetter();
   void testValueSetterAndGetter_data();
 
+  void testPrepareGui();
+  void testGuiPool();
+
 };
 
 // ----------------------------------------------------------------------------
@@ -123,11 +162,18 @@ void ctkCmdLineModuleFrontendQtGuiTester::initTestCase()
   QFile xmlFile(":/ctkCmdLineModuleFrontendQtGuiTestModule1.xml");
   QVERIFY(xmlFile.open(QIODevice::ReadOnly));
 
-  backend->addModule(QUrl("test://module1"), xmlFile.readAll());
+  QByteArray xml = xmlFile.readAll();
+  backend->addModule(QUrl("test://module1"), xml);
+  // Only used by testPrepareGui(), so that its GUI is not generated yet
+  backend->addModule(QUrl("test://module2"), xml);
 
-  this->Manager.registerBackend(backend);
+  // The generated forms are stored in the module cache
+  QVERIFY(this->CacheDir.isValid());
+  this->Manager.reset(new ctkCmdLineModuleManager(
+                        ctkCmdLineModuleManager::STRICT_VALIDATION, this->CacheDir.path()));
+  this->Manager->registerBackend(backend);
 
-  this->ModuleRef = this->Manager.registerModule(QUrl("test://module1"));
+  this->ModuleRef = this->Manager->registerModule(QUrl("test://module1"));
   QVERIFY(this->ModuleRef);
 }
 
@@ -238,6 +284,63 @@ void ctkCmdLineModuleFrontendQtGuiTester::testValueSetterAndGetter_data()
 }
 
 
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleFrontendQtGuiTester::testPrepareGui()
+{
+  ctkCmdLineModuleReference moduleRef = this->Manager->registerModule(QUrl("test://module2"));
+  QVERIFY(moduleRef);
+  QVERIFY(FrontendQtGuiMockUp(moduleRef).preparedForm().isEmpty());
+
+  ctkCmdLineModuleFrontendQtGui::prepareGui(moduleRef).waitForFinished();
+
+  // The form is stored in the module cache
+  QScopedPointer<FrontendQtGuiMockUp> frontend(new FrontendQtGuiMockUp(moduleRef));
+  QVERIFY(!frontend->preparedForm().isEmpty());
+
+  // and the front-end creates its GUI without transforming the XML description
+  QScopedPointer<QObject> gui(frontend->guiHandle());
+  QVERIFY(gui);
+  QCOMPARE(frontend->TransformCount, 0);
+  QCOMPARE(frontend->value("intParam"), QVariant(1));
+
+  // as does the next one
+  QScopedPointer<FrontendQtGuiMockUp> frontend2(new FrontendQtGuiMockUp(moduleRef));
+  QScopedPointer<QObject> gui2(frontend2->guiHandle());
+  QVERIFY(gui2);
+  QCOMPARE(frontend2->TransformCount, 0);
+}
+
+// ----------------------------------------------------------------------------
+void ctkCmdLineModuleFrontendQtGuiTester::testGuiPool()
+{
+  QCOMPARE(ctkCmdLineModuleFrontendQtGui::guiPoolSize(), 0);
+  ctkCmdLineModuleFrontendQtGui::setGuiPoolSize(1);
+
+  QScopedPointer<ctkCmdLineModuleFrontend> frontend(new ctkCmdLineModuleFrontendQtGui(this->ModuleRef));
+  QObject* gui = frontend->guiHandle();
+  QVERIFY(gui);
+  frontend->setValue("intParam", 2);
+  frontend.reset();
+
+  // The GUI is reused with its initial values
+  frontend.reset(new ctkCmdLineModuleFrontendQtGui(this->ModuleRef));
+  QCOMPARE(frontend->guiHandle(), gui);
+  QCOMPARE(frontend->value("intParam"), QVariant(1));
+
+  // GUIs owned by the application are not reused
+  QWidget parentWidget;
+  qobject_cast<QWidget*>(gui)->setParent(&parentWidget);
+  frontend.reset();
+  frontend.reset(new ctkCmdLineModuleFrontendQtGui(this->ModuleRef));
+  QVERIFY(frontend->guiHandle() != gui);
+  frontend.reset();
+
+  // Disabling the pool deletes the unused GUIs
+  QCOMPARE(ctkCmdLineModuleFrontendQtGui::guiPoolSize(), 1);
+  ctkCmdLineModuleFrontendQtGui::setGuiPoolSize(0);
+  QCOMPARE(ctkCmdLineModuleFrontendQtGui::guiPoolSize(), 0);
+}
+
 // ----------------------------------------------------------------------------
 CTK_TEST_MAIN(ctkCmdLineModuleFrontendQtGuiTest)
 #include "moc_ctkCmdLineModuleFrontendQtGuiTest.cpp"
@@ -28,24 +28,110 @@
 
 #include <QBuffer>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QPointer>
 #include <QUiLoader>
+#include <QUrl>
 #include <QWidget>
 #include <QVariant>
 #include <QCoreApplication>
+#include <QtConcurrentRun>
 
 #include <QDebug>
 
+#include <typeinfo>
+
+namespace {
+
+typedef QList<QPair<QString, QVariant> > ParameterValues;
+
+//-----------------------------------------------------------------------------
+// Generated .ui forms and unused GUIs, shared by all front-ends
+struct ctkCmdLineModuleQtGuiCache
+{
+  struct PooledGui
+  {
+    QPointer<QWidget> Widget;
+    ParameterValues InitialValues;
+  };
+
+  ctkCmdLineModuleQtGuiCache()
+    : GuiPoolSize(0)
+    , CleanupRegistered(false)
+  {}
+
+  QMutex Mutex;
+  QHash<QString, QByteArray> UiForms;
+  QHash<QString, QList<PooledGui> > Guis;
+  int GuiPoolSize;
+  bool CleanupRegistered;
+};
+
+Q_GLOBAL_STATIC(ctkCmdLineModuleQtGuiCache, guiCache)
+
+//-----------------------------------------------------------------------------
+void clearGuiPool()
+{
+  QHash<QString, QList<ctkCmdLineModuleQtGuiCache::PooledGui> > guis;
+  {
+    QMutexLocker lock(&guiCache()->Mutex);
+    guis.swap(guiCache()->Guis);
+  }
+  foreach(const QList<ctkCmdLineModuleQtGuiCache::PooledGui>& pooledGuis, guis)
+  {
+    foreach(const ctkCmdLineModuleQtGuiCache::PooledGui& pooledGui, pooledGuis)
+    {
+      delete pooledGui.Widget.data();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+ParameterValues parameterValues(QWidget* widget)
+{
+  ParameterValues values;
+  ctkCmdLineModuleObjectTreeWalker walker(widget);
+  while(walker.readNextParameter())
+  {
+    values.push_back(qMakePair(walker.name(), walker.value()));
+  }
+  return values;
+}
+
+//-----------------------------------------------------------------------------
+void setParameterValues(QWidget* widget, const ParameterValues& values)
+{
+  int index = 0;
+  ctkCmdLineModuleObjectTreeWalker walker(widget);
+  while(walker.readNextParameter() && index < values.size())
+  {
+    if (walker.value() != values[index].second)
+    {
+      walker.setValue(values[index].second);
+    }
+    ++index;
+  }
+}
+
+}
+
 //-----------------------------------------------------------------------------
 struct ctkCmdLineModuleFrontendQtGuiPrivate
 {
   ctkCmdLineModuleFrontendQtGuiPrivate()
-    : Widget(NULL)
   {}
 
   mutable QScopedPointer<QUiLoader> Loader;
   mutable QScopedPointer<QIODevice> xslFile;
   mutable QScopedPointer<ctkCmdLineModuleXslTransform> Transform;
-  mutable QWidget* Widget;
+  mutable QPointer<QWidget> Widget;
+
+  // Key of the .ui form and of the pooled GUIs of this front-end
+  mutable QString GuiKey;
+  // Values of the parameters when the GUI was created, restored when reused
+  mutable ParameterValues InitialValues;
 
   // Cache the list of parameter names
   mutable QList<QString> ParameterNames;
@@ -62,6 +148,140 @@ ctkCmdLineModuleFrontendQtGui::ctkCmdLineModuleFrontendQtGui(const ctkCmdLineMod
 //-----------------------------------------------------------------------------
 ctkCmdLineModuleFrontendQtGui::~ctkCmdLineModuleFrontendQtGui()
 {
+  // A GUI which was not re-parented by the application can be reused
+  if (d->Widget && d->Widget->parent() == NULL && !d->GuiKey.isEmpty())
+  {
+    QMutexLocker lock(&guiCache()->Mutex);
+    QList<ctkCmdLineModuleQtGuiCache::PooledGui>& pooledGuis = guiCache()->Guis[d->GuiKey];
+    if (pooledGuis.size() < guiCache()->GuiPoolSize)
+    {
+      if (!guiCache()->CleanupRegistered)
+      {
+        qAddPostRoutine(clearGuiPool);
+        guiCache()->CleanupRegistered = true;
+      }
+      // Shown again like a new GUI when added to a layout
+      d->Widget->hide();
+      d->Widget->setAttribute(Qt::WA_WState_ExplicitShowHide, false);
+      ctkCmdLineModuleQtGuiCache::PooledGui pooledGui;
+      pooledGui.Widget = d->Widget;
+      pooledGui.InitialValues = d->InitialValues;
+      pooledGuis.push_back(pooledGui);
+      d->Widget = NULL;
+    }
+  }
+}
+
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleFrontendQtGui::setGuiPoolSize(int size)
+{
+  {
+    QMutexLocker lock(&guiCache()->Mutex);
+    guiCache()->GuiPoolSize = qMax(0, size);
+    if (guiCache()->GuiPoolSize > 0)
+    {
+      return;
+    }
+  }
+  clearGuiPool();
+}
+
+
+//-----------------------------------------------------------------------------
+int ctkCmdLineModuleFrontendQtGui::guiPoolSize()
+{
+  QMutexLocker lock(&guiCache()->Mutex);
+  return guiCache()->GuiPoolSize;
+}
+
+
+//-----------------------------------------------------------------------------
+QFuture<void> ctkCmdLineModuleFrontendQtGui::prepareGui(const ctkCmdLineModuleReference& moduleRef)
+{
+  return QtConcurrent::run(&ctkCmdLineModuleFrontendQtGui::prepareGuiForm, moduleRef);
+}
+
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleFrontendQtGui::prepareGuiForm(const ctkCmdLineModuleReference& moduleRef)
+{
+  ctkCmdLineModuleFrontendQtGui frontend(moduleRef);
+  frontend.uiForm();
+}
+
+
+//-----------------------------------------------------------------------------
+QString ctkCmdLineModuleFrontendQtGui::guiCacheKey() const
+{
+  return QString(typeid(*this).name());
+}
+
+
+//-----------------------------------------------------------------------------
+QString ctkCmdLineModuleFrontendQtGui::guiKey() const
+{
+  QString cacheKey = this->guiCacheKey();
+  if (cacheKey.isEmpty())
+  {
+    return QString();
+  }
+  // The location alone does not identify the XML description of the module
+  return cacheKey + '|' + this->location().toString() + '|'
+      + QString::number(qHash(this->moduleReference().rawXmlDescription()));
+}
+
+
+//-----------------------------------------------------------------------------
+QByteArray ctkCmdLineModuleFrontendQtGui::uiForm() const
+{
+  QString guiKey = this->guiKey();
+  QString cacheKey = this->guiCacheKey();
+  QByteArray form;
+  if (!guiKey.isEmpty())
+  {
+    {
+      QMutexLocker lock(&guiCache()->Mutex);
+      form = guiCache()->UiForms.value(guiKey);
+    }
+    if (!form.isEmpty())
+    {
+      return form;
+    }
+    form = this->cachedData(cacheKey);
+    if (!form.isEmpty())
+    {
+      QMutexLocker lock(&guiCache()->Mutex);
+      guiCache()->UiForms.insert(guiKey, form);
+      return form;
+    }
+  }
+
+  QBuffer input;
+  input.setData(moduleReference().rawXmlDescription());
+
+  QBuffer uiForm(&form);
+  uiForm.open(QIODevice::ReadWrite);
+
+  ctkCmdLineModuleXslTransform* xslTransform = this->xslTransform();
+  xslTransform->setInput(&input);
+  xslTransform->setOutput(&uiForm);
+
+  if (!xslTransform->transform())
+  {
+    // maybe throw an exception
+    qCritical() << xslTransform->errorString();
+    return QByteArray();
+  }
+  uiForm.close();
+
+  if (!guiKey.isEmpty())
+  {
+    this->setCachedData(cacheKey, form);
+    QMutexLocker lock(&guiCache()->Mutex);
+    guiCache()->UiForms.insert(guiKey, form);
+  }
+  return form;
 }
 
 
@@ -127,22 +347,38 @@ QObject* ctkCmdLineModuleFrontendQtGui::guiHandle() const
 {
   if (d->Widget) return d->Widget;
 
-  QBuffer input;
-  input.setData(moduleReference().rawXmlDescription());
-
-  QBuffer uiForm;
-  uiForm.open(QIODevice::ReadWrite);
-
-  ctkCmdLineModuleXslTransform* xslTransform = this->xslTransform();
-  xslTransform->setInput(&input);
-  xslTransform->setOutput(&uiForm);
+  d->GuiKey = this->guiKey();
+  if (!d->GuiKey.isEmpty())
+  {
+    // Reuse a GUI of a destroyed front-end of the same module
+    ctkCmdLineModuleQtGuiCache::PooledGui pooledGui;
+    {
+      QMutexLocker lock(&guiCache()->Mutex);
+      QHash<QString, QList<ctkCmdLineModuleQtGuiCache::PooledGui> >::Iterator iter =
+          guiCache()->Guis.find(d->GuiKey);
+      while (iter != guiCache()->Guis.end() && !iter.value().isEmpty() && !pooledGui.Widget)
+      {
+        pooledGui = iter.value().takeLast();
+      }
+    }
+    if (pooledGui.Widget)
+    {
+      d->Widget = pooledGui.Widget;
+      d->InitialValues = pooledGui.InitialValues;
+      setParameterValues(d->Widget, d->InitialValues);
+      this->setParameterContainerEnabled(true);
+      d->Widget->setEnabled(true);
+      return d->Widget;
+    }
+  }
 
-  if (!xslTransform->transform())
+  QByteArray form = this->uiForm();
+  if (form.isEmpty())
   {
-    // maybe throw an exception
-    qCritical() << xslTransform->errorString();
     return 0;
   }
+  QBuffer uiForm(&form);
+  uiForm.open(QIODevice::ReadOnly);
 
   QUiLoader* uiLoader = this->uiLoader();
 #ifdef CMAKE_INTDIR
@@ -153,6 +389,10 @@ QObject* ctkCmdLineModuleFrontendQtGui::guiHandle() const
   }
 #endif
   d->Widget = uiLoader->load(&uiForm);
+  if (d->Widget && !d->GuiKey.isEmpty())
+  {
+    d->InitialValues = parameterValues(d->Widget);
+  }
   return d->Widget;
 }
 
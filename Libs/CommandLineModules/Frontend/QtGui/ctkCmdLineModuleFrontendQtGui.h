@@ -26,6 +26,8 @@
 
 #include "ctkCommandLineModulesFrontendQtGuiExport.h"
 
+#include <QFuture>
+
 class ctkCmdLineModuleReference;
 class ctkCmdLineModuleXslTransform;
 
@@ -119,6 +121,11 @@ struct ctkCmdLineModuleFrontendQtGuiPrivate;
  * <tr><td>image (output channel)</td><td>imageOutputSetProperty</td><td>filters</td><td>imageOutputSetProperty</td><td>ctkPathLineEdit::Files|ctkPathLineEdit::Writable</td></tr>
  * </table>
  * \endhtmlonly
+ *
+ * The .ui form generated for a module is cached in memory and, if the module manager has a
+ * cache directory, in the module cache. Use prepareGui() to generate it in a background
+ * thread after the module is registered. GUIs of destroyed front-ends can also be reused
+ * by the next front-end of the same module, see setGuiPoolSize().
  */
 class CTK_CMDLINEMODULEQTGUI_EXPORT ctkCmdLineModuleFrontendQtGui : public ctkCmdLineModuleFrontend
 {
@@ -177,6 +184,32 @@ public:
    */
   virtual void setParameterContainerEnabled(const bool& enabled);
 
+  /**
+   * @brief Set the maximum number of unused GUIs kept for each module.
+   * @param size The maximum number of GUIs kept per module.
+   *
+   * When a front-end is destroyed while its GUI has no parent, the GUI is kept and
+   * given to the next front-end created for the same module, with the parameter values
+   * it had when created. The default is 0, which disables the reuse of GUIs.
+   */
+  static void setGuiPoolSize(int size);
+
+  /**
+   * @brief Get the maximum number of unused GUIs kept for each module.
+   * @return The maximum number of GUIs kept per module.
+   */
+  static int guiPoolSize();
+
+  /**
+   * @brief Generate and cache the .ui form of a module in a background thread.
+   * @param moduleRef The module reference.
+   * @return A future finished when the .ui form is cached.
+   *
+   * This uses the default XSL transformation of this class, so that the first
+   * ctkCmdLineModuleFrontendQtGui created for the module only needs to load the form.
+   */
+  static QFuture<void> prepareGui(const ctkCmdLineModuleReference& moduleRef);
+
 protected:
 
   /**
@@ -227,8 +260,23 @@ protected:
    */
   void setCustomValue(const QString& parameter, const QVariant& value, const QString& propertyName = QString()) ;
 
+  /**
+   * @brief Get the key identifying the customization of the generated GUI.
+   * @return The key, or an empty string to disable caching and reuse of the GUI.
+   *
+   * The generated .ui form and the unused GUIs of a module are shared by all the front-ends
+   * returning the same key. The default implementation returns a key specific to the
+   * class of this front-end. Sub-classes customizing uiLoader() or xslTransform() differently
+   * for each instance must return different keys.
+   */
+  virtual QString guiCacheKey() const;
+
 private:
 
+  QString guiKey() const;
+  QByteArray uiForm() const;
+  static void prepareGuiForm(const ctkCmdLineModuleReference& moduleRef);
+
   QScopedPointer<ctkCmdLineModuleFrontendQtGuiPrivate> d;
 
 };
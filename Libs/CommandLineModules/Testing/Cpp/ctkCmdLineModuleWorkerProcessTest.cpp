@@ -0,0 +1,236 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include <ctkCmdLineModuleManager.h>
+#include <ctkCmdLineModuleFrontendFactory.h>
+#include <ctkCmdLineModuleFrontend.h>
+#include <ctkCmdLineModuleReference.h>
+#include <ctkCmdLineModuleDescription.h>
+#include <ctkCmdLineModuleParameter.h>
+#include <ctkCmdLineModuleResult.h>
+#include <ctkCmdLineModuleRunException.h>
+#include <ctkCmdLineModuleFuture.h>
+
+#include "ctkCmdLineModuleBackendWorkerProcess.h"
+
+#include "ctkTest.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QVariant>
+
+
+//-----------------------------------------------------------------------------
+class ctkCmdLineModuleFrontendMockupFactory : public ctkCmdLineModuleFrontendFactory
+{
+public:
+
+  virtual ctkCmdLineModuleFrontend* create(const ctkCmdLineModuleReference& moduleRef)
+  {
+    struct ModuleFrontendMockup : public ctkCmdLineModuleFrontend
+    {
+      ModuleFrontendMockup(const ctkCmdLineModuleReference& moduleRef)
+        : ctkCmdLineModuleFrontend(moduleRef) {}
+
+      virtual QObject* guiHandle() const { return NULL; }
+
+      virtual QVariant value(const QString& parameter, int role) const
+      {
+        if (role == UserRole)
+          return userValues[parameter];
+        QVariant value = currentValues[parameter];
+        if (!value.isValid())
+          return this->moduleReference().description().parameter(parameter).defaultValue();
+        return value;
+      }
+
+      virtual void setValue(const QString& parameter, const QVariant& value, int role = DisplayRole)
+      {
+        if (role == UserRole)
+          userValues[parameter] = value;
+        else
+          currentValues[parameter] = value;
+      }
+
+    private:
+
+      QHash<QString, QVariant> currentValues;
+      QHash<QString, QVariant> userValues;
+    };
+
+    return new ModuleFrontendMockup(moduleRef);
+  }
+
+  virtual QString name() const { return "Mock-up"; }
+  virtual QString description() const { return "A mock-up factory for testing."; }
+};
+
+//-----------------------------------------------------------------------------
+class ctkCmdLineModuleWorkerProcessTester : public QObject
+{
+  Q_OBJECT
+
+private Q_SLOTS:
+
+  void initTestCase();
+
+  void init();
+  void cleanup();
+
+  void testWorkerReuse();
+  void testInMemoryData_data();
+  void testInMemoryData();
+
+private:
+
+  QStringList startedWorkers() const;
+
+  ctkCmdLineModuleFrontendMockupFactory factory;
+  ctkCmdLineModuleBackendWorkerProcess backend;
+
+  ctkCmdLineModuleManager manager;
+
+  QTemporaryDir sharedDir;
+  QTemporaryDir workerLogDir;
+  QUrl moduleUrl;
+  ctkCmdLineModuleReference moduleRef;
+  ctkCmdLineModuleFrontend* frontend;
+};
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerProcessTester::initTestCase()
+{
+  QVERIFY(sharedDir.isValid());
+  QVERIFY(workerLogDir.isValid());
+  // Each worker process started by the TestBed appends its process id to this file
+  qputenv("CTK_CMDLINEMODULE_TESTBED_WORKER_LOG", QFile::encodeName(workerLogDir.filePath("workers.log")));
+  backend.setSharedMemoryPath(sharedDir.path());
+  manager.registerBackend(&backend);
+
+  moduleUrl = QUrl::fromLocalFile(QCoreApplication::applicationDirPath() + "/ctkCmdLineModuleTestBed");
+  moduleRef = manager.registerModule(moduleUrl);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerProcessTester::init()
+{
+  frontend = factory.create(moduleRef);
+  frontend->setValue("runtimeVar", 0);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerProcessTester::cleanup()
+{
+  delete frontend;
+  backend.setWorkerEnabled(moduleUrl, false);
+}
+
+//-----------------------------------------------------------------------------
+QStringList ctkCmdLineModuleWorkerProcessTester::startedWorkers() const
+{
+  QFile workerLog(workerLogDir.filePath("workers.log"));
+  if (!workerLog.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    return QStringList();
+  }
+  return QString::fromLatin1(workerLog.readAll()).split('\n', QString::SkipEmptyParts);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerProcessTester::testWorkerReuse()
+{
+  QFile::remove(workerLogDir.filePath("workers.log"));
+  backend.setWorkerEnabled(moduleUrl);
+  QCOMPARE(backend.idleWorkerCount(moduleUrl), 0);
+
+  QList<ctkCmdLineModuleResult> expectedResults;
+  expectedResults << ctkCmdLineModuleResult("imageOutput", "/tmp/out.nrrd");
+  expectedResults << ctkCmdLineModuleResult("exitStatusOutput", "Normal exit");
+
+  for (int i = 0; i < 2; ++i)
+  {
+    ctkCmdLineModuleFuture future = manager.run(frontend);
+    future.waitForFinished();
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(future.progressValue(), 1002);
+    QCOMPARE(future.results(), expectedResults);
+
+    // the worker is kept alive for the next run
+    QTRY_COMPARE(backend.idleWorkerCount(moduleUrl), 1);
+  }
+  // both runs used the same process
+  QCOMPARE(startedWorkers().size(), 1);
+
+  // a failing run reports its exit code, without stopping the worker
+  frontend->setValue("exitCodeVar", 24);
+  ctkCmdLineModuleFuture future = manager.run(frontend);
+  try
+  {
+    future.waitForFinished();
+    QFAIL("Exception expected");
+  }
+  catch (const ctkCmdLineModuleRunException& e)
+  {
+    QCOMPARE(e.errorCode(), 24);
+  }
+  QTRY_COMPARE(backend.idleWorkerCount(moduleUrl), 1);
+  QCOMPARE(startedWorkers().size(), 1);
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerProcessTester::testInMemoryData_data()
+{
+  QTest::addColumn<bool>("worker");
+  QTest::newRow("one process per run") << false;
+  QTest::newRow("worker process") << true;
+}
+
+//-----------------------------------------------------------------------------
+void ctkCmdLineModuleWorkerProcessTester::testInMemoryData()
+{
+  QFETCH(bool, worker);
+  backend.setWorkerEnabled(moduleUrl, worker);
+
+  frontend->setValue("imageInput", QByteArray("pixels"), ctkCmdLineModuleFrontend::UserRole);
+  frontend->setValue("imageOutput", QByteArray(), ctkCmdLineModuleFrontend::UserRole);
+
+  ctkCmdLineModuleFuture future = manager.run(frontend);
+  future.waitForFinished();
+
+  QByteArray imageOutput;
+  foreach(const ctkCmdLineModuleResult& result, future.results())
+  {
+    if (result.parameter() == "imageOutput" && result.value().type() == QVariant::ByteArray)
+    {
+      imageOutput = result.value().toByteArray();
+    }
+  }
+  QCOMPARE(imageOutput, QByteArray("pixels"));
+
+  // the shared files are removed once the module finished
+  QCOMPARE(QDir(sharedDir.path()).entryList(QDir::Files), QStringList());
+}
+
+// ----------------------------------------------------------------------------
+CTK_TEST_MAIN(ctkCmdLineModuleWorkerProcessTest)
+#include "moc_ctkCmdLineModuleWorkerProcessTest.cpp"
@@ -26,6 +26,8 @@
 #include <QTextStream>
 #include <QFile>
 #include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
 #include <QElapsedTimer>
 #else
@@ -52,13 +54,8 @@ void sleep_ms(int ms)
 #endif
 }
 
-int main(int argc, char* argv[])
+int runModule(const QStringList& arguments)
 {
-  QCoreApplication app(argc, argv);
-  // This is used by QSettings
-  QCoreApplication::setOrganizationName("CommonTK");
-  QCoreApplication::setApplicationName("CmdLineModuleTestBed");
-
   ctkCommandLineParser parser;
   // Use Unix-style argument names
   parser.setArgumentPrefix("--", "-");
@@ -72,13 +69,15 @@ int main(int argc, char* argv[])
   parser.addArgument("exitCrash", "", QVariant::Bool, "Force crash", false);
   parser.addArgument("exitTime", "", QVariant::Int, "Exit time", 0);
   parser.addArgument("errorText", "", QVariant::String, "Error text printed at the end");
+  parser.addArgument("imageInput", "", QVariant::String, "Input image copied to the output image");
+  parser.addArgument("worker", "", QVariant::Bool, "Run the invocations read from the standard input, one JSON array of arguments per line");
 
   QTextStream out(stdout, QIODevice::WriteOnly | QIODevice::Text);
   QTextStream err(stderr, QIODevice::WriteOnly | QIODevice::Text);
 
   // Parse the command line arguments
   bool ok = false;
-  QHash<QString, QVariant> parsedArgs = parser.parseArguments(QCoreApplication::arguments(), &ok);
+  QHash<QString, QVariant> parsedArgs = parser.parseArguments(arguments, &ok);
   if (!ok)
   {
     err << "Error parsing arguments:" << parser.errorString() << ctk::endl;
@@ -121,8 +120,22 @@ int main(int argc, char* argv[])
   bool exitCrash = parsedArgs["exitCrash"].toBool();
   QString errorText = parsedArgs["errorText"].toString();
 
+  QString imageInput = parsedArgs["imageInput"].toString();
+
   QString imageOutput = parser.unparsedArguments().at(0);
 
+  if (!imageInput.isEmpty())
+  {
+    QFile inputFile(imageInput);
+    QFile outputFile(imageOutput);
+    if (!inputFile.open(QIODevice::ReadOnly) || !outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      err << "Error copying " << imageInput << " to " << imageOutput << ctk::endl;
+      return EXIT_FAILURE;
+    }
+    outputFile.write(inputFile.readAll());
+  }
+
   err << "A superficial error message." << ctk::endl;
 
   // sleep 500ms to give the "errorReady" signal a chance
@@ -220,3 +233,51 @@ int main(int argc, char* argv[])
 
   return exitCode;
 }
+
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  // This is used by QSettings
+  QCoreApplication::setOrganizationName("CommonTK");
+  QCoreApplication::setApplicationName("CmdLineModuleTestBed");
+
+  if (!QCoreApplication::arguments().contains("--worker"))
+  {
+    return runModule(QCoreApplication::arguments());
+  }
+
+  // Worker mode, see ctkCmdLineModuleBackendWorkerProcess
+
+  // Record the process id, so that tests can count the started workers
+  QString workerLogPath = QString::fromLocal8Bit(qgetenv("CTK_CMDLINEMODULE_TESTBED_WORKER_LOG"));
+  if (!workerLogPath.isEmpty())
+  {
+    QFile workerLog(workerLogPath);
+    if (workerLog.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+    {
+      workerLog.write(QByteArray::number(QCoreApplication::applicationPid()) + "\n");
+    }
+  }
+
+  QTextStream in(stdin, QIODevice::ReadOnly | QIODevice::Text);
+  QTextStream out(stdout, QIODevice::WriteOnly | QIODevice::Text);
+  out << "<worker-ready/>" << ctk::endl;
+
+  QString line = in.readLine();
+  while (!line.isNull())
+  {
+    if (!line.trimmed().isEmpty())
+    {
+      QStringList arguments(QCoreApplication::arguments().front());
+      foreach(const QJsonValue& argument, QJsonDocument::fromJson(line.toUtf8()).array())
+      {
+        arguments << argument.toString();
+      }
+      int exitCode = runModule(arguments);
+      out << "<worker-done exit-code=\"" << exitCode << "\"/>" << ctk::endl;
+    }
+    line = in.readLine();
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,8 +1,56 @@
+// Qt includes
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
 
 // CTK includes
 #include "ctkFileLogger.h"
 #include "ctkTest.h"
 
+namespace
+{
+
+// ----------------------------------------------------------------------------
+QStringList readLines(const QString& filePath)
+{
+  QFile file(filePath);
+  if (!file.open(QFile::ReadOnly | QFile::Text))
+    {
+    return QStringList();
+    }
+  QStringList lines;
+  QTextStream stream(&file);
+  while (!stream.atEnd())
+    {
+    lines << stream.readLine();
+    }
+  return lines;
+}
+
+// ----------------------------------------------------------------------------
+class ctkFileLoggerTestThread : public QThread
+{
+public:
+  ctkFileLoggerTestThread(ctkFileLogger& logger, int numberOfMessages)
+    : Logger(logger), NumberOfMessages(numberOfMessages) {}
+protected:
+  virtual void run()
+  {
+    for (int i = 0; i < this->NumberOfMessages; ++i)
+      {
+      this->Logger.logMessage(
+        QString("[DEBUG][Qt] thread %1 message %2").arg(quintptr(this)).arg(i));
+      }
+  }
+  ctkFileLogger& Logger;
+  int NumberOfMessages;
+};
+
+}
+
 // ----------------------------------------------------------------------------
 class ctkFileLoggerTester: public QObject
 {
@@ -10,12 +58,182 @@ class ctkFileLoggerTester: public QObject
 private slots:
   void initTestCase();
 
+  void testDefaults();
+  void testSynchronous();
+  void testAsynchronous();
+  void testFlushInterval();
+  void testDroppedMessages();
+  void testRotation();
+
+  void testLogMessageFromThreads_data();
+  void testLogMessageFromThreads();
+
+private:
+  QScopedPointer<QTemporaryDir> TemporaryDir;
 };
 
 // ----------------------------------------------------------------------------
 void ctkFileLoggerTester::initTestCase()
 {
+  this->TemporaryDir.reset(new QTemporaryDir);
+  QVERIFY(this->TemporaryDir->isValid());
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testDefaults()
+{
+  ctkFileLogger logger;
+  QCOMPARE(logger.enabled(), true);
+  QCOMPARE(logger.numberOfFilesToKeep(), 10);
+  QCOMPARE(logger.maximumFileSize(), qint64(0));
+  QCOMPARE(logger.asynchronous(), false);
+  QCOMPARE(logger.flushInterval(), 1000);
+  QCOMPARE(logger.bufferSize(), 10000);
+  QCOMPARE(logger.numberOfDroppedMessages(), 0);
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testSynchronous()
+{
+  QString filePath = this->TemporaryDir->filePath("synchronous.log");
+  ctkFileLogger logger;
+  logger.setFilePath(filePath);
+  logger.logMessage("first");
+  logger.logMessage("second");
+  QCOMPARE(readLines(filePath), QStringList() << "first" << "second");
+
+  logger.setEnabled(false);
+  logger.logMessage("third");
+  QCOMPARE(readLines(filePath).count(), 2);
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testAsynchronous()
+{
+  QString filePath = this->TemporaryDir->filePath("asynchronous.log");
+  ctkFileLogger logger;
+  logger.setFilePath(filePath);
+  logger.setFlushInterval(60000);
+  logger.setAsynchronous(true);
+  QCOMPARE(logger.asynchronous(), true);
+
+  logger.logMessage("first");
+  logger.logMessage("second");
+  logger.flush();
+  QCOMPARE(readLines(filePath), QStringList() << "first" << "second");
+
+  // Switching back to synchronous mode writes the pending messages
+  logger.logMessage("third");
+  logger.setAsynchronous(false);
+  QCOMPARE(readLines(filePath), QStringList() << "first" << "second" << "third");
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testFlushInterval()
+{
+  QString filePath = this->TemporaryDir->filePath("interval.log");
+  ctkFileLogger logger;
+  logger.setFilePath(filePath);
+  logger.setFlushInterval(10);
+  logger.setAsynchronous(true);
+  logger.logMessage("first");
+  QTRY_COMPARE(readLines(filePath), QStringList() << "first");
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testDroppedMessages()
+{
+  QString filePath = this->TemporaryDir->filePath("dropped.log");
+  ctkFileLogger logger;
+  logger.setFilePath(filePath);
+  logger.setFlushInterval(60000);
+  logger.setBufferSize(3);
+  logger.setAsynchronous(true);
+  for (int i = 0; i < 5; ++i)
+    {
+    logger.logMessage(QString::number(i));
+    }
+  QCOMPARE(logger.numberOfDroppedMessages(), 2);
+  logger.flush();
+  QCOMPARE(readLines(filePath), QStringList() << "0" << "1" << "2");
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testRotation()
+{
+  QString filePath = this->TemporaryDir->filePath("rotation.log");
+  ctkFileLogger logger;
+  logger.setFilePath(filePath);
+  logger.setMaximumFileSize(10);
+  logger.setNumberOfFilesToKeep(3);
+  for (int i = 0; i < 5; ++i)
+    {
+    logger.logMessage(QString("message %1").arg(i));
+    }
+  // Each message fills a file, only the last 3 files are kept
+  QCOMPARE(QFile::exists(filePath), false);
+  QCOMPARE(readLines(filePath + ".1"), QStringList() << "message 4");
+  QCOMPARE(readLines(filePath + ".2"), QStringList() << "message 3");
+  QCOMPARE(QFile::exists(filePath + ".3"), false);
+
+  logger.setAsynchronous(true);
+  logger.logMessage("message 5");
+  logger.flush();
+  QCOMPARE(readLines(filePath + ".1"), QStringList() << "message 5");
+  QCOMPARE(readLines(filePath + ".2"), QStringList() << "message 4");
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testLogMessageFromThreads_data()
+{
+  QTest::addColumn<bool>("asynchronous");
+  QTest::newRow("synchronous") << false;
+  QTest::newRow("asynchronous") << true;
+}
+
+// ----------------------------------------------------------------------------
+void ctkFileLoggerTester::testLogMessageFromThreads()
+{
+  QFETCH(bool, asynchronous);
+
+  const int numberOfThreads = 8;
+  const int numberOfMessagesPerThread = 5000;
+
+  QString filePath = this->TemporaryDir->filePath(
+    QString("threads-%1.log").arg(asynchronous ? "async" : "sync"));
+  ctkFileLogger logger;
+  logger.setFilePath(filePath);
+  logger.setBufferSize(numberOfThreads * numberOfMessagesPerThread);
+  logger.setAsynchronous(asynchronous);
+
+  QList<QThread*> threads;
+  for (int i = 0; i < numberOfThreads; ++i)
+    {
+    threads << new ctkFileLoggerTestThread(logger, numberOfMessagesPerThread);
+    }
+  QElapsedTimer timer;
+  timer.start();
+  foreach(QThread* thread, threads)
+    {
+    thread->start();
+    }
+  foreach(QThread* thread, threads)
+    {
+    thread->wait();
+    }
+  qint64 logTime = timer.elapsed();
+  logger.flush();
+  qint64 writeTime = timer.elapsed();
+  qDeleteAll(threads);
+
+  const int numberOfMessages = numberOfThreads * numberOfMessagesPerThread;
+  QCOMPARE(logger.numberOfDroppedMessages(), 0);
+  QCOMPARE(readLines(filePath).count(), numberOfMessages);
 
+  qDebug() << QTest::currentDataTag() << ":" << numberOfThreads << "threads logged"
+           << numberOfMessages << "messages in" << logTime << "ms,"
+           << numberOfMessages * 1000.0 / qMax(qint64(1), logTime) << "messages/s,"
+           << "written after" << writeTime << "ms";
 }
 
 // ----------------------------------------------------------------------------
@@ -29,6 +29,7 @@
 #include <QPointer>
 #include <QStringList>
 #include <QThread>
+#include <QTimer>
 
 // CTK includes
 #include "ctkErrorLogContext.h"
@@ -52,7 +53,33 @@ public:
 
   void init(QAbstractItemModel* itemModel);
 
-  void setMessageHandlerConnection(ctkErrorLogAbstractMessageHandler * msgHandler, bool asynchronous);
+  /// Connect the message handler and entryPosted() to addEntry(), or to
+  /// the entry queue if EntryBatchInterval is set.
+  void setMessageHandlerConnection(ctkErrorLogAbstractMessageHandler * msgHandler);
+  void setEntryPostedConnection();
+  void updateEntryConnections();
+
+  struct Entry
+  {
+    QDateTime DateTime;
+    QString ThreadId;
+    ctkErrorLogLevel::LogLevel LogLevel;
+    QString Origin;
+    ctkErrorLogContext Context;
+    QString Text;
+  };
+
+  void addEntries(const QList<Entry>& entries);
+
+  /// Return true if \a entry can be grouped with the model entry \a columns
+  bool canGroupEntry(const QStringList& columns, const Entry& entry)const;
+  QStringList lastModelEntry()const;
+  void groupWithLastModelEntry(const QString& text);
+
+  void _q_queueEntry(const QDateTime& currentDateTime, const QString& threadId,
+                     ctkErrorLogLevel::LogLevel logLevel, const QString& origin,
+                     const ctkErrorLogContext& context, const QString& text);
+  void _q_addQueuedEntries();
 
   QAbstractItemModel* ItemModel;
 
@@ -71,8 +98,15 @@ public:
 
   ctkFileLogger FileLogger;
   QString FileLoggingPattern;
+
+  int EntryBatchInterval;
+  QMutex QueuedEntriesMutex;
+  QList<Entry> QueuedEntries;
+  QTimer QueuedEntriesTimer;
 };
 
+#include "moc_ctkErrorLogAbstractModel.cpp"
+
 // --------------------------------------------------------------------------
 // ctkErrorLogAbstractModelPrivate methods
 
@@ -84,6 +118,7 @@ ctkErrorLogAbstractModelPrivate::ctkErrorLogAbstractModelPrivate(ctkErrorLogAbst
   this->LogEntryGrouping = false;
   this->AsynchronousLogging = true;
   this->AddingEntry = false;
+  this->EntryBatchInterval = 0;
   this->FileLogger.setEnabled(false);
   this->FileLoggingPattern = "[%{level}][%{origin}] %{timestamp} [%{category}] (%{file}:%{line}) - %{msg}";
 }
@@ -115,24 +150,233 @@ void ctkErrorLogAbstractModelPrivate::init(QAbstractItemModel* itemModel)
 
   this->ItemModel = itemModel;
 
-  QObject::connect(q,
-    SIGNAL(entryPosted(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
-    q, SLOT(addEntry(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
-    this->AsynchronousLogging ? Qt::QueuedConnection : Qt::BlockingQueuedConnection);
+  this->QueuedEntriesTimer.setSingleShot(true);
+  QObject::connect(&this->QueuedEntriesTimer, SIGNAL(timeout()),
+                   q, SLOT(_q_addQueuedEntries()));
+
+  this->setEntryPostedConnection();
 }
 
 // --------------------------------------------------------------------------
 void ctkErrorLogAbstractModelPrivate::setMessageHandlerConnection(
-    ctkErrorLogAbstractMessageHandler * msgHandler, bool asynchronous)
+    ctkErrorLogAbstractMessageHandler * msgHandler)
 {
   Q_Q(ctkErrorLogAbstractModel);
 
   msgHandler->disconnect();
 
+  if (this->EntryBatchInterval > 0)
+    {
+    // Queued from the thread of the message
+    QObject::connect(msgHandler,
+          SIGNAL(messageHandled(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
+          q, SLOT(_q_queueEntry(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
+          Qt::DirectConnection);
+    return;
+    }
+
   QObject::connect(msgHandler,
         SIGNAL(messageHandled(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
         q, SLOT(addEntry(QDateTime,QString,ctkErrorLogLevel::LogLevel,QString,ctkErrorLogContext,QString)),
-        asynchronous ? Qt::QueuedConnection : Qt::BlockingQueuedConnection);
+        this->AsynchronousLogging ? Qt::QueuedConnection : Qt::BlockingQueuedConnection);
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractModelPrivate::setEntryPostedConnection()
+{
+  Q_Q(ctkErrorLogAbstractModel);
+
+  QObject::disconnect(q,
+    SIGNAL(entryPosted(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
+    q, 0);
+
+  if (this->EntryBatchInterval > 0)
+    {
+    QObject::connect(q,
+      SIGNAL(entryPosted(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
+      q, SLOT(_q_queueEntry(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
+      Qt::DirectConnection);
+    return;
+    }
+
+  QObject::connect(q,
+    SIGNAL(entryPosted(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
+    q, SLOT(addEntry(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
+    this->AsynchronousLogging ? Qt::QueuedConnection : Qt::BlockingQueuedConnection);
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractModelPrivate::updateEntryConnections()
+{
+  foreach(ctkErrorLogAbstractMessageHandler* msgHandler, this->RegisteredHandlers.values())
+    {
+    this->setMessageHandlerConnection(msgHandler);
+    }
+  this->setEntryPostedConnection();
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractModelPrivate::addEntries(const QList<Entry>& entries)
+{
+  Q_Q(ctkErrorLogAbstractModel);
+
+  if (this->AddingEntry)
+    {
+    return;
+    }
+
+  this->AddingEntry = true;
+
+  QString timeFormat("dd.MM.yyyy hh:mm:ss");
+
+  // Entries not added to the model yet, added at once
+  QList<QStringList> newModelEntries;
+  foreach(const Entry& entry, entries)
+    {
+    if (this->LogEntryGrouping)
+      {
+      if (!newModelEntries.isEmpty() && this->canGroupEntry(newModelEntries.last(), entry))
+        {
+        q->addModelEntries(newModelEntries);
+        newModelEntries.clear();
+        }
+      if (newModelEntries.isEmpty() && this->canGroupEntry(this->lastModelEntry(), entry))
+        {
+        this->groupWithLastModelEntry(entry.Text);
+        continue;
+        }
+      }
+    newModelEntries << (QStringList()
+                        << entry.DateTime.toString(timeFormat) << entry.ThreadId
+                        << this->ErrorLogLevel(entry.LogLevel) << entry.Origin << entry.Text);
+    }
+  if (!newModelEntries.isEmpty())
+    {
+    q->addModelEntries(newModelEntries);
+    }
+
+  this->AddingEntry = false;
+
+  foreach(const Entry& entry, entries)
+    {
+    QString fileLogText = this->FileLoggingPattern;
+    fileLogText.replace("%{level}", this->ErrorLogLevel(entry.LogLevel).toUpper());
+    fileLogText.replace("%{timestamp}", entry.DateTime.toString(timeFormat));
+    fileLogText.replace("%{origin}", entry.Origin);
+    fileLogText.replace("%{pid}", QString("%1").arg(QCoreApplication::applicationPid()));
+    fileLogText.replace("%{threadid}", entry.ThreadId);
+    fileLogText.replace("%{function}", entry.Context.Function);
+    fileLogText.replace("%{line}", QString("%1").arg(entry.Context.Line));
+    fileLogText.replace("%{file}", entry.Context.File);
+    fileLogText.replace("%{category}", entry.Context.Category);
+    fileLogText.replace("%{msg}", entry.Context.Message);
+    this->FileLogger.logMessage(fileLogText.trimmed());
+    if (entry.LogLevel >= ctkErrorLogLevel::Error && entry.LogLevel <= ctkErrorLogLevel::Fatal)
+      {
+      this->FileLogger.flush();
+      }
+
+    emit q->entryAdded(entry.DateTime, entry.ThreadId, entry.LogLevel, entry.Origin, entry.Context, entry.Text);
+    emit q->entryAdded(entry.LogLevel);
+    }
+}
+
+// --------------------------------------------------------------------------
+bool ctkErrorLogAbstractModelPrivate::canGroupEntry(const QStringList& columns, const Entry& entry)const
+{
+  if (columns.count() <= ctkErrorLogAbstractModel::OriginColumn)
+    {
+    return false;
+    }
+  bool threadIdMatched = entry.ThreadId == columns[ctkErrorLogAbstractModel::ThreadIdColumn];
+  bool logLevelMatched =
+      ctkErrorLogLevel::logLevelAsString(entry.LogLevel) == columns[ctkErrorLogAbstractModel::LogLevelColumn];
+  bool originMatched = entry.Origin == columns[ctkErrorLogAbstractModel::OriginColumn];
+
+  QDateTime lastRowDateTime =
+      QDateTime::fromString(columns[ctkErrorLogAbstractModel::TimeColumn], "dd.MM.yyyy hh:mm:ss");
+  int groupingIntervalInMsecs = 1000;
+  bool withinGroupingInterval = lastRowDateTime.time().msecsTo(entry.DateTime.time()) <= groupingIntervalInMsecs;
+
+  return threadIdMatched && logLevelMatched && originMatched && withinGroupingInterval;
+}
+
+// --------------------------------------------------------------------------
+QStringList ctkErrorLogAbstractModelPrivate::lastModelEntry()const
+{
+  Q_Q(const ctkErrorLogAbstractModel);
+  QStringList columns;
+  int lastRowIndex = this->ItemModel->rowCount() - 1;
+  if (lastRowIndex < 0)
+    {
+    return columns;
+    }
+  for (int column = 0; column <= ctkErrorLogAbstractModel::OriginColumn; ++column)
+    {
+    columns << q->logEntryData(lastRowIndex, column).toString();
+    }
+  return columns;
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractModelPrivate::groupWithLastModelEntry(const QString& text)
+{
+  // Retrieve description associated with last row
+  QModelIndex lastRowDescriptionIndex =
+      this->ItemModel->index(this->ItemModel->rowCount() - 1, ctkErrorLogAbstractModel::DescriptionColumn);
+
+  QStringList updatedDescription;
+  updatedDescription << lastRowDescriptionIndex.data(ctkErrorLogAbstractModel::DescriptionTextRole).toString();
+  updatedDescription << text;
+
+  this->ItemModel->setData(lastRowDescriptionIndex, updatedDescription.join("\n"),
+                           ctkErrorLogAbstractModel::DescriptionTextRole);
+
+  // Append '...' to displayText if needed
+  QString displayText = lastRowDescriptionIndex.data().toString();
+  if (!displayText.endsWith("..."))
+    {
+    this->ItemModel->setData(lastRowDescriptionIndex, displayText.append("..."), Qt::DisplayRole);
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractModelPrivate::_q_queueEntry(
+  const QDateTime& currentDateTime, const QString& threadId,
+  ctkErrorLogLevel::LogLevel logLevel, const QString& origin,
+  const ctkErrorLogContext& context, const QString& text)
+{
+  Entry entry;
+  entry.DateTime = currentDateTime;
+  entry.ThreadId = threadId;
+  entry.LogLevel = logLevel;
+  entry.Origin = origin;
+  entry.Context = context;
+  entry.Text = text;
+
+  bool wasEmpty = false;
+  {
+  QMutexLocker locker(&this->QueuedEntriesMutex);
+  wasEmpty = this->QueuedEntries.isEmpty();
+  this->QueuedEntries.append(entry);
+  }
+  // The first queued entry starts the timer, the next ones are added
+  // with it, at most once per interval. This may run in any thread.
+  if (wasEmpty)
+    {
+    QMetaObject::invokeMethod(&this->QueuedEntriesTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractModelPrivate::_q_addQueuedEntries()
+{
+  QList<Entry> entries;
+  {
+  QMutexLocker locker(&this->QueuedEntriesMutex);
+  entries.swap(this->QueuedEntries);
+  }
+  this->addEntries(entries);
 }
 
 // --------------------------------------------------------------------------
@@ -166,7 +410,7 @@ bool ctkErrorLogAbstractModel::registerMsgHandler(ctkErrorLogAbstractMessageHand
     return false;
     }
 
-  d->setMessageHandlerConnection(msgHandler, d->AsynchronousLogging);
+  d->setMessageHandlerConnection(msgHandler);
 
   msgHandler->setTerminalOutput(ctkErrorLogTerminalOutput::StandardError, &d->StdErrTerminalOutput);
   msgHandler->setTerminalOutput(ctkErrorLogTerminalOutput::StandardOutput, &d->StdOutTerminalOutput);
@@ -285,81 +529,24 @@ void ctkErrorLogAbstractModel::addEntry(const QDateTime& currentDateTime, const
                                 const QString& origin, const ctkErrorLogContext &context, const QString &text)
 {
   Q_D(ctkErrorLogAbstractModel);
+  ctkErrorLogAbstractModelPrivate::Entry entry;
+  entry.DateTime = currentDateTime;
+  entry.ThreadId = threadId;
+  entry.LogLevel = logLevel;
+  entry.Origin = origin;
+  entry.Context = context;
+  entry.Text = text;
+  d->addEntries(QList<ctkErrorLogAbstractModelPrivate::Entry>() << entry);
+}
 
-  if (d->AddingEntry)
-    {
-    return;
-    }
-
-  d->AddingEntry = true;
-
-  QString timeFormat("dd.MM.yyyy hh:mm:ss");
-
-  bool groupEntry = false;
-  if (d->LogEntryGrouping)
-    {
-    int lastRowIndex = d->ItemModel->rowCount() - 1;
-
-    QString lastRowThreadId = this->logEntryData(lastRowIndex, Self::ThreadIdColumn).toString();
-    bool threadIdMatched = threadId == lastRowThreadId;
-
-    QString lastRowLogLevel = this->logEntryData(lastRowIndex, Self::LogLevelColumn).toString();
-    bool logLevelMatched = d->ErrorLogLevel(logLevel) == lastRowLogLevel;
-
-    QString lastRowOrigin = this->logEntryData(lastRowIndex, Self::OriginColumn).toString();
-    bool originMatched = origin == lastRowOrigin;
-
-    QDateTime lastRowDateTime =
-        QDateTime::fromString(this->logEntryData(lastRowIndex, Self::TimeColumn).toString(), timeFormat);
-    int groupingIntervalInMsecs = 1000;
-    bool withinGroupingInterval = lastRowDateTime.time().msecsTo(currentDateTime.time()) <= groupingIntervalInMsecs;
-
-    groupEntry = threadIdMatched && logLevelMatched && originMatched && withinGroupingInterval;
-    }
-
-  if (!groupEntry)
-    {
-    this->addModelEntry(
-      currentDateTime.toString(timeFormat), threadId, d->ErrorLogLevel(logLevel), origin, text);
-    }
-  else
+//------------------------------------------------------------------------------
+void ctkErrorLogAbstractModel::addModelEntries(const QList<QStringList>& entries)
+{
+  foreach(const QStringList& entry, entries)
     {
-    // Retrieve description associated with last row
-    QModelIndex lastRowDescriptionIndex =
-        d->ItemModel->index(d->ItemModel->rowCount() - 1, ctkErrorLogAbstractModel::DescriptionColumn);
-
-    QStringList updatedDescription;
-    updatedDescription << lastRowDescriptionIndex.data(ctkErrorLogAbstractModel::DescriptionTextRole).toString();
-    updatedDescription << text;
-
-    d->ItemModel->setData(lastRowDescriptionIndex, updatedDescription.join("\n"),
-                                 ctkErrorLogAbstractModel::DescriptionTextRole);
-
-    // Append '...' to displayText if needed
-    QString displayText = lastRowDescriptionIndex.data().toString();
-    if (!displayText.endsWith("..."))
-      {
-      d->ItemModel->setData(lastRowDescriptionIndex, displayText.append("..."), Qt::DisplayRole);
-      }
+    this->addModelEntry(entry[TimeColumn], entry[ThreadIdColumn], entry[LogLevelColumn],
+                        entry[OriginColumn], entry[DescriptionColumn]);
     }
-
-  d->AddingEntry = false;
-
-  QString fileLogText = d->FileLoggingPattern;
-  fileLogText.replace("%{level}", d->ErrorLogLevel(logLevel).toUpper());
-  fileLogText.replace("%{timestamp}", currentDateTime.toString(timeFormat));
-  fileLogText.replace("%{origin}", origin);
-  fileLogText.replace("%{pid}", QString("%1").arg(QCoreApplication::applicationPid()));
-  fileLogText.replace("%{threadid}", threadId);
-  fileLogText.replace("%{function}", context.Function);
-  fileLogText.replace("%{line}", QString("%1").arg(context.Line));
-  fileLogText.replace("%{file}", context.File);
-  fileLogText.replace("%{category}", context.Category);
-  fileLogText.replace("%{msg}", context.Message);
-  d->FileLogger.logMessage(fileLogText.trimmed());
-
-  emit this->entryAdded(currentDateTime, threadId, logLevel, origin, context, text);
-  emit this->entryAdded(logLevel);
 }
 
 //------------------------------------------------------------------------------
@@ -481,23 +668,34 @@ void ctkErrorLogAbstractModel::setAsynchronousLogging(bool value)
     {
     return;
     }
+  d->AsynchronousLogging = value;
+  d->updateEntryConnections();
+}
 
-  foreach(const QString& handlerName, d->RegisteredHandlers.keys())
+//------------------------------------------------------------------------------
+int ctkErrorLogAbstractModel::entryBatchInterval()const
+{
+  Q_D(const ctkErrorLogAbstractModel);
+  return d->EntryBatchInterval;
+}
+
+//------------------------------------------------------------------------------
+void ctkErrorLogAbstractModel::setEntryBatchInterval(int msecs)
+{
+  Q_D(ctkErrorLogAbstractModel);
+  msecs = qMax(0, msecs);
+  if (d->EntryBatchInterval == msecs)
     {
-    d->setMessageHandlerConnection(
-          d->RegisteredHandlers.value(handlerName), value);
+    return;
+    }
+  d->EntryBatchInterval = msecs;
+  d->QueuedEntriesTimer.setInterval(msecs);
+  d->updateEntryConnections();
+  if (msecs == 0)
+    {
+    // Add the entries queued so far
+    d->_q_addQueuedEntries();
     }
-
-  QObject::disconnect(this,
-    SIGNAL(entryPosted(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
-    this, SLOT(addEntry(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)));
-
-  QObject::connect(this,
-    SIGNAL(entryPosted(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
-    this, SLOT(addEntry(QDateTime, QString, ctkErrorLogLevel::LogLevel, QString, ctkErrorLogContext, QString)),
-    value ? Qt::QueuedConnection : Qt::BlockingQueuedConnection);
-
-  d->AsynchronousLogging = value;
 }
 
 // --------------------------------------------------------------------------
@@ -542,6 +740,20 @@ void ctkErrorLogAbstractModel::setFileLoggingEnabled(bool value)
   d->FileLogger.setEnabled(value);
 }
 
+// --------------------------------------------------------------------------
+bool ctkErrorLogAbstractModel::asynchronousFileLogging()const
+{
+  Q_D(const ctkErrorLogAbstractModel);
+  return d->FileLogger.asynchronous();
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogAbstractModel::setAsynchronousFileLogging(bool value)
+{
+  Q_D(ctkErrorLogAbstractModel);
+  d->FileLogger.setAsynchronous(value);
+}
+
 // --------------------------------------------------------------------------
 QString ctkErrorLogAbstractModel::fileLoggingPattern()const
 {
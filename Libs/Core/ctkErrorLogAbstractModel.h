@@ -43,9 +43,11 @@ class CTK_CORE_EXPORT ctkErrorLogAbstractModel : public QSortFilterProxyModel
   Q_PROPERTY(bool logEntryGrouping READ logEntryGrouping WRITE setLogEntryGrouping)
   Q_PROPERTY(ctkErrorLogTerminalOutput::TerminalOutputs terminalOutputs READ terminalOutputs WRITE setTerminalOutputs)
   Q_PROPERTY(bool asynchronousLogging READ asynchronousLogging WRITE  setAsynchronousLogging)
+  Q_PROPERTY(int entryBatchInterval READ entryBatchInterval WRITE  setEntryBatchInterval)
   Q_PROPERTY(QString filePath READ filePath WRITE  setFilePath)
   Q_PROPERTY(int numberOfFilesToKeep READ numberOfFilesToKeep WRITE  setNumberOfFilesToKeep)
   Q_PROPERTY(bool fileLoggingEnabled READ fileLoggingEnabled WRITE  setFileLoggingEnabled)
+  Q_PROPERTY(bool asynchronousFileLogging READ asynchronousFileLogging WRITE  setAsynchronousFileLogging)
   Q_PROPERTY(QString fileLoggingPattern READ fileLoggingPattern WRITE setFileLoggingPattern)
   Q_PROPERTY(QStringList msgHandlerNames READ msgHandlerNames)
 
@@ -111,6 +113,15 @@ public:
   bool asynchronousLogging()const;
   void setAsynchronousLogging(bool value);
 
+  /// Time in milliseconds during which the entries posted by message handlers
+  /// or postEntry() are queued before being added to the model at once.
+  /// The producers then never wait for the thread of the model, whatever
+  /// asynchronousLogging is, and the model is updated at most once per interval.
+  /// 0 (default) adds each entry through its own (blocking) queued connection.
+  /// \sa asynchronousLogging()
+  int entryBatchInterval()const;
+  void setEntryBatchInterval(int msecs);
+
   QString filePath()const;
   void setFilePath(const QString& filePath);
 
@@ -120,6 +131,12 @@ public:
   bool fileLoggingEnabled()const;
   void setFileLoggingEnabled(bool value);
 
+  /// Write the log file from a background thread. Entries of level
+  /// Error and above are written before addEntry() returns.
+  /// \sa ctkFileLogger::asynchronous
+  bool asynchronousFileLogging()const;
+  void setAsynchronousFileLogging(bool value);
+
   QString fileLoggingPattern()const;
   void setFileLoggingPattern(const QString& value);
 
@@ -183,9 +200,17 @@ protected:
   virtual void addModelEntry(const QString& currentDateTime, const QString& threadId,
                              const QString& logLevel, const QString& origin, const QString& descriptionText) = 0;
 
+  /// Add several entries at once, each given as one string per column (see ColumnsIds).
+  /// The default implementation calls addModelEntry() for each entry.
+  virtual void addModelEntries(const QList<QStringList>& entries);
+
 private:
   Q_DECLARE_PRIVATE(ctkErrorLogAbstractModel)
   Q_DISABLE_COPY(ctkErrorLogAbstractModel)
+
+  Q_PRIVATE_SLOT(d_func(), void _q_queueEntry(const QDateTime&, const QString&, ctkErrorLogLevel::LogLevel,
+                                              const QString&, const ctkErrorLogContext&, const QString&))
+  Q_PRIVATE_SLOT(d_func(), void _q_addQueuedEntries())
 };
 
 #endif
@@ -20,12 +20,33 @@
 
 // Qt includes
 #include <QFile>
+#include <QMutex>
+#include <QStringList>
 #include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
 
 // CTK includes
 #include "ctkFileLogger.h"
 #include "ctkUtils.h"
 
+class ctkFileLoggerPrivate;
+
+// --------------------------------------------------------------------------
+// ctkFileLoggerWriter
+
+// --------------------------------------------------------------------------
+/// \internal
+/// Thread writing the queued messages of a ctkFileLogger in asynchronous mode.
+class ctkFileLoggerWriter : public QThread
+{
+public:
+  ctkFileLoggerWriter(ctkFileLoggerPrivate* d) : d(d) {}
+protected:
+  virtual void run();
+  ctkFileLoggerPrivate* d;
+};
+
 // --------------------------------------------------------------------------
 // ctkFileLoggerPrivate
 
@@ -41,9 +62,36 @@ public:
 
   void init();
 
+  void startWriter();
+  void stopWriter();
+
+  /// Rename the log files if \a file is larger than \a maximumFileSize.
+  /// Return true if \a file was closed by the rotation.
+  static bool rotateIfNeeded(QFile& file, qint64 maximumFileSize, int numberOfFilesToKeep);
+
   bool Enabled;
   QString FilePath;
   int NumberOfFilesToKeep;
+  qint64 MaximumFileSize;
+  bool Asynchronous;
+  int FlushInterval;
+  int BufferSize;
+
+  /// Protects the properties above and the queue below
+  mutable QMutex Mutex;
+  QWaitCondition WakeWriter;
+  QWaitCondition MessagesWritten;
+  /// Serializes the appends to the log file and its rotation
+  QMutex FileMutex;
+
+  QStringList Buffer;
+  qint64 NumberOfQueuedMessages;
+  qint64 NumberOfWrittenMessages;
+  int NumberOfDroppedMessages;
+  bool FlushRequested;
+  bool StopRequested;
+
+  QScopedPointer<ctkFileLoggerWriter> Writer;
 };
 
 // --------------------------------------------------------------------------
@@ -52,11 +100,21 @@ ctkFileLoggerPrivate::ctkFileLoggerPrivate(ctkFileLogger& object)
 {
   this->Enabled = true;
   this->NumberOfFilesToKeep = 10;
+  this->MaximumFileSize = 0;
+  this->Asynchronous = false;
+  this->FlushInterval = 1000;
+  this->BufferSize = 10000;
+  this->NumberOfQueuedMessages = 0;
+  this->NumberOfWrittenMessages = 0;
+  this->NumberOfDroppedMessages = 0;
+  this->FlushRequested = false;
+  this->StopRequested = false;
 }
 
 // --------------------------------------------------------------------------
 ctkFileLoggerPrivate::~ctkFileLoggerPrivate()
 {
+  this->stopWriter();
 }
 
 // --------------------------------------------------------------------------
@@ -64,6 +122,111 @@ void ctkFileLoggerPrivate::init()
 {
 }
 
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::startWriter()
+{
+  if (this->Writer)
+    {
+    return;
+    }
+  this->StopRequested = false;
+  this->Writer.reset(new ctkFileLoggerWriter(this));
+  this->Writer->start();
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerPrivate::stopWriter()
+{
+  if (!this->Writer)
+    {
+    return;
+    }
+  {
+  QMutexLocker locker(&this->Mutex);
+  this->StopRequested = true;
+  this->WakeWriter.wakeOne();
+  }
+  // the writer writes the pending messages before returning
+  this->Writer->wait();
+  this->Writer.reset();
+}
+
+// --------------------------------------------------------------------------
+bool ctkFileLoggerPrivate::rotateIfNeeded(QFile& file, qint64 maximumFileSize, int numberOfFilesToKeep)
+{
+  if (maximumFileSize <= 0 || file.size() < maximumFileSize)
+    {
+    return false;
+    }
+  file.close();
+  QString filePath = file.fileName();
+  if (numberOfFilesToKeep <= 1)
+    {
+    QFile::remove(filePath);
+    return true;
+    }
+  QFile::remove(QString("%1.%2").arg(filePath).arg(numberOfFilesToKeep - 1));
+  for (int index = numberOfFilesToKeep - 2; index >= 1; --index)
+    {
+    QFile::rename(QString("%1.%2").arg(filePath).arg(index),
+                  QString("%1.%2").arg(filePath).arg(index + 1));
+    }
+  QFile::rename(filePath, filePath + ".1");
+  return true;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLoggerWriter::run()
+{
+  QFile file;
+  QMutexLocker locker(&d->Mutex);
+  forever
+    {
+    if (!d->StopRequested && !d->FlushRequested)
+      {
+      d->WakeWriter.wait(&d->Mutex, d->FlushInterval);
+      }
+    QStringList messages;
+    messages.swap(d->Buffer);
+    QString filePath = d->FilePath;
+    qint64 maximumFileSize = d->MaximumFileSize;
+    int numberOfFilesToKeep = d->NumberOfFilesToKeep;
+    qint64 numberOfQueuedMessages = d->NumberOfQueuedMessages;
+    bool stop = d->StopRequested;
+    d->FlushRequested = false;
+    locker.unlock();
+
+    if (!messages.isEmpty())
+      {
+      if (file.fileName() != filePath)
+        {
+        file.close();
+        file.setFileName(filePath);
+        }
+      QMutexLocker fileLocker(&d->FileMutex);
+      if (file.isOpen() || file.open(QFile::Append))
+        {
+        QTextStream stream(&file);
+        foreach(const QString& msg, messages)
+          {
+          stream << msg << '\n';
+          }
+        stream.flush();
+        file.flush();
+        ctkFileLoggerPrivate::rotateIfNeeded(file, maximumFileSize, numberOfFilesToKeep);
+        }
+      }
+
+    locker.relock();
+    d->NumberOfWrittenMessages = numberOfQueuedMessages;
+    d->MessagesWritten.wakeAll();
+    if (stop)
+      {
+      break;
+      }
+    }
+}
+
 // --------------------------------------------------------------------------
 // ctkFileLogger
 
@@ -85,6 +248,7 @@ ctkFileLogger::~ctkFileLogger()
 bool ctkFileLogger::enabled()const
 {
   Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
   return d->Enabled;
 }
 
@@ -92,6 +256,7 @@ bool ctkFileLogger::enabled()const
 void ctkFileLogger::setEnabled(bool value)
 {
   Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
   d->Enabled = value;
 }
 
@@ -99,6 +264,7 @@ void ctkFileLogger::setEnabled(bool value)
 QString ctkFileLogger::filePath()const
 {
   Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
   return d->FilePath;
 }
 
@@ -106,6 +272,7 @@ QString ctkFileLogger::filePath()const
 void ctkFileLogger::setFilePath(const QString& filePath)
 {
   Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
   d->FilePath = filePath;
 }
 
@@ -113,6 +280,7 @@ void ctkFileLogger::setFilePath(const QString& filePath)
 int ctkFileLogger::numberOfFilesToKeep()const
 {
   Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
   return d->NumberOfFilesToKeep;
 }
 
@@ -120,24 +288,149 @@ int ctkFileLogger::numberOfFilesToKeep()const
 void ctkFileLogger::setNumberOfFilesToKeep(int value)
 {
   Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
   d->NumberOfFilesToKeep = value;
 }
 
+// --------------------------------------------------------------------------
+qint64 ctkFileLogger::maximumFileSize()const
+{
+  Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  return d->MaximumFileSize;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setMaximumFileSize(qint64 value)
+{
+  Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  d->MaximumFileSize = value;
+}
+
+// --------------------------------------------------------------------------
+bool ctkFileLogger::asynchronous()const
+{
+  Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  return d->Asynchronous;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setAsynchronous(bool value)
+{
+  Q_D(ctkFileLogger);
+  {
+  QMutexLocker locker(&d->Mutex);
+  if (d->Asynchronous == value)
+    {
+    return;
+    }
+  d->Asynchronous = value;
+  }
+  if (value)
+    {
+    d->startWriter();
+    }
+  else
+    {
+    d->stopWriter();
+    }
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLogger::flushInterval()const
+{
+  Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  return d->FlushInterval;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setFlushInterval(int msecs)
+{
+  Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  d->FlushInterval = qMax(1, msecs);
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLogger::bufferSize()const
+{
+  Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  return d->BufferSize;
+}
+
+// --------------------------------------------------------------------------
+void ctkFileLogger::setBufferSize(int value)
+{
+  Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  d->BufferSize = qMax(1, value);
+}
+
+// --------------------------------------------------------------------------
+int ctkFileLogger::numberOfDroppedMessages()const
+{
+  Q_D(const ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  return d->NumberOfDroppedMessages;
+}
+
 // --------------------------------------------------------------------------
 void ctkFileLogger::logMessage(const QString& msg)
 {
   Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
   if (!d->Enabled)
     {
     return;
     }
-  QFile f(d->FilePath);
+  if (d->Asynchronous)
+    {
+    if (d->Buffer.size() >= d->BufferSize)
+      {
+      ++d->NumberOfDroppedMessages;
+      return;
+      }
+    d->Buffer.append(msg);
+    ++d->NumberOfQueuedMessages;
+    return;
+    }
+  QString filePath = d->FilePath;
+  qint64 maximumFileSize = d->MaximumFileSize;
+  int numberOfFilesToKeep = d->NumberOfFilesToKeep;
+  locker.unlock();
+
+  // Without the lock, two threads could both see the file over the limit
+  // and rotate it twice.
+  QMutexLocker fileLocker(&d->FileMutex);
+  QFile f(filePath);
   if (!f.open(QFile::Append))
     {
     return;
     }
   QTextStream s(&f);
   s << msg << ctk::endl;
+  ctkFileLoggerPrivate::rotateIfNeeded(f, maximumFileSize, numberOfFilesToKeep);
   f.close();
 }
 
+// --------------------------------------------------------------------------
+void ctkFileLogger::flush()
+{
+  Q_D(ctkFileLogger);
+  QMutexLocker locker(&d->Mutex);
+  if (!d->Asynchronous)
+    {
+    return;
+    }
+  qint64 numberOfQueuedMessages = d->NumberOfQueuedMessages;
+  d->FlushRequested = true;
+  d->WakeWriter.wakeOne();
+  while (d->NumberOfWrittenMessages < numberOfQueuedMessages)
+    {
+    d->MessagesWritten.wait(&d->Mutex);
+    }
+}
@@ -32,11 +32,29 @@ class ctkFileLoggerPrivate;
 
 //------------------------------------------------------------------------------
 /// \ingroup Core
+/// Append log messages to a file.
+///
+/// By default each message is written synchronously: the file is opened,
+/// the message appended and the file closed again. When \a asynchronous is
+/// enabled, messages are instead queued in memory and written by a background
+/// thread every \a flushInterval milliseconds, keeping the file open. At most
+/// \a bufferSize messages are queued; messages logged while the buffer is full
+/// are dropped and counted in numberOfDroppedMessages().
+///
+/// When \a maximumFileSize is set, the file is rotated once it exceeds that
+/// size: \a filePath is renamed to "filePath.1", "filePath.1" to "filePath.2"
+/// and so on, keeping at most \a numberOfFilesToKeep files including the
+/// current one.
 class CTK_CORE_EXPORT ctkFileLogger : public QObject
 {
   Q_OBJECT
   Q_PROPERTY(bool enabled READ enabled WRITE setEnabled)
   Q_PROPERTY(QString filePath READ filePath WRITE setFilePath)
+  Q_PROPERTY(int numberOfFilesToKeep READ numberOfFilesToKeep WRITE setNumberOfFilesToKeep)
+  Q_PROPERTY(qint64 maximumFileSize READ maximumFileSize WRITE setMaximumFileSize)
+  Q_PROPERTY(bool asynchronous READ asynchronous WRITE setAsynchronous)
+  Q_PROPERTY(int flushInterval READ flushInterval WRITE setFlushInterval)
+  Q_PROPERTY(int bufferSize READ bufferSize WRITE setBufferSize)
 
 public:
   typedef QObject Superclass;
@@ -53,9 +71,36 @@ public:
   int numberOfFilesToKeep()const;
   void setNumberOfFilesToKeep(int value);
 
+  /// Size in bytes above which the file is rotated.
+  /// 0 (default) disables the rotation.
+  qint64 maximumFileSize()const;
+  void setMaximumFileSize(qint64 value);
+
+  /// Write the messages from a background thread. Disabling it writes
+  /// the pending messages first. Default is false.
+  bool asynchronous()const;
+  void setAsynchronous(bool value);
+
+  /// Time in milliseconds between two writes of the queued messages
+  /// in asynchronous mode. Default is 1000.
+  int flushInterval()const;
+  void setFlushInterval(int msecs);
+
+  /// Maximum number of queued messages in asynchronous mode.
+  /// Default is 10000.
+  int bufferSize()const;
+  void setBufferSize(int value);
+
+  /// Number of messages dropped because the buffer was full.
+  int numberOfDroppedMessages()const;
+
 public Q_SLOTS:
   void logMessage(const QString& msg);
 
+  /// Write the queued messages and wait until they are written.
+  /// Does nothing in synchronous mode.
+  void flush();
+
 protected:
   QScopedPointer<ctkFileLoggerPrivate> d_ptr;
 
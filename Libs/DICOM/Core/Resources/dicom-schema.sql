@@ -21,9 +21,10 @@ DROP INDEX IF EXISTS 'ImagesFilenameIndex' ;
 DROP INDEX IF EXISTS 'ImagesSeriesIndex' ;
 DROP INDEX IF EXISTS 'SeriesStudyIndex' ;
 DROP INDEX IF EXISTS 'StudiesPatientIndex' ;
+DROP INDEX IF EXISTS 'ImagesDisplayedFieldsPendingIndex' ;
 
 CREATE TABLE 'SchemaInfo' ( 'Version' VARCHAR(1024) NOT NULL );
-INSERT INTO 'SchemaInfo' VALUES('0.8.0');
+INSERT INTO 'SchemaInfo' VALUES('0.8.1');
 
 CREATE TABLE 'Images' (
   'SOPInstanceUID' VARCHAR(64) NOT NULL,
@@ -91,6 +92,7 @@ CREATE INDEX IF NOT EXISTS 'ImagesFilenameIndex' ON 'Images' ('URL');
 CREATE INDEX IF NOT EXISTS 'ImagesSeriesIndex' ON 'Images' ('SeriesInstanceUID');
 CREATE INDEX IF NOT EXISTS 'SeriesStudyIndex' ON 'Series' ('StudyInstanceUID');
 CREATE INDEX IF NOT EXISTS 'StudiesPatientIndex' ON 'Studies' ('PatientsUID');
+CREATE INDEX IF NOT EXISTS 'ImagesDisplayedFieldsPendingIndex' ON 'Images' ('SeriesInstanceUID') WHERE DisplayedFieldsUpdatedTimestamp IS NULL;
 
 CREATE TABLE 'Directories' (
   'Dirname' VARCHAR(1024) ,
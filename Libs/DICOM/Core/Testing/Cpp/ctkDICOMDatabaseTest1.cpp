@@ -21,6 +21,7 @@
 // Qt includes
 #include <QCoreApplication>
 #include <QDir>
+#include <QSqlQuery>
 #include <QTimer>
 
 // ctkDICOMCore includes
@@ -75,6 +76,39 @@ int ctkDICOMDatabaseTest1( int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // default tuning profile allows reading while importing
+  QSqlQuery journalModeQuery(database.database());
+  if (!journalModeQuery.exec("PRAGMA journal_mode") || !journalModeQuery.next()
+    || journalModeQuery.value(0).toString().toLower() != "wal")
+    {
+    std::cerr << "ctkDICOMDatabase::openDatabase() failed: "
+              << "journal mode of the default tuning profile is not applied" << std::endl;
+    return EXIT_FAILURE;
+    }
+  journalModeQuery.finish();
+
+  QVariantMap tuningProfile = ctkDICOMDatabase::defaultTuningProfile();
+  tuningProfile["cache_size"] = -1024;
+  int tuningProfileChangedCount = 0;
+  QObject::connect(&database, &ctkDICOMDatabase::tuningProfileChanged,
+                   [&tuningProfileChangedCount]() { ++tuningProfileChangedCount; });
+  database.setTuningProfile(tuningProfile);
+  if (tuningProfileChangedCount != 1)
+    {
+    std::cerr << "ctkDICOMDatabase::setTuningProfile() failed: "
+              << "tuningProfileChanged() is not emitted" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QSqlQuery cacheSizeQuery(database.database());
+  if (!cacheSizeQuery.exec("PRAGMA cache_size") || !cacheSizeQuery.next()
+    || cacheSizeQuery.value(0).toInt() != -1024)
+    {
+    std::cerr << "ctkDICOMDatabase::setTuningProfile() failed: "
+              << "cache size is not applied to the open database" << std::endl;
+    return EXIT_FAILURE;
+    }
+  cacheSizeQuery.finish();
+
   bool res = database.initializeDatabase();
   
   if (!res)
@@ -116,8 +116,17 @@ int ctkDICOMDatabaseTest4( int argc, char * argv [] )
   // check for series description in tag cache
   QString knownSeriesDescription("3D Cor T1 FAST IR-prepped GRE");
 
+  database.resetTagValueCacheStatistics();
+
   QString cachedTag = database.cachedTag(instanceUID, tag);
 
+  // precached tags are written through to the in-memory cache
+  if (database.tagValueCacheHitCount() != 1 || database.tagValueCacheMissCount() != 0)
+    {
+    std::cerr << "ctkDICOMDatabase: precached tag should be found in the in-memory cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   if (cachedTag != knownSeriesDescription)
     {
     std::cerr << "ctkDICOMDatabase: tag cache should return known value for instance" << std::endl;
@@ -142,6 +151,46 @@ int ctkDICOMDatabaseTest4( int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // bulk access: precached tag comes from the cache, other tag is read from the file
+  QString instanceNumberTag("0020,0013");
+  QMap<QString, QStringList> tagValues =
+    database.filesTagValues(QStringList() << filePath, QStringList() << tag << instanceNumberTag);
+  if (tagValues["0008,0018"] != QStringList(instanceUID)
+    || tagValues["0008,103E"] != QStringList(knownSeriesDescription)
+    || tagValues[instanceNumberTag] != QStringList(database.instanceValue(instanceUID, instanceNumberTag))
+    || tagValues[instanceNumberTag][0].isEmpty())
+    {
+    std::cerr << "ctkDICOMDatabase: filesTagValues returned unexpected values" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // removing the cached tags invalidates the in-memory cache
+  database.removeCachedTags(instanceUID);
+  if (database.cachedTag(instanceUID, tag) != QString(""))
+    {
+    std::cerr << "ctkDICOMDatabase: removed tag should not be returned from the cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the in-memory cache only follows the writes made through the same object,
+  // writes made through another connection are seen after clearing it
+  database.cacheTag(instanceUID, tag, knownSeriesDescription);
+  ctkDICOMDatabase otherConnection;
+  otherConnection.openDatabase(databaseFile.absoluteFilePath(), "otherConnection");
+  otherConnection.cacheTag(instanceUID, tag, "Modified description");
+  otherConnection.closeDatabase();
+  if (database.cachedTag(instanceUID, tag) != knownSeriesDescription)
+    {
+    std::cerr << "ctkDICOMDatabase: tag written through this object should be returned from the in-memory cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+  database.clearTagValueCache();
+  if (database.cachedTag(instanceUID, tag) != QString("Modified description"))
+    {
+    std::cerr << "ctkDICOMDatabase: tag written through another connection should be returned after clearing the cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   database.closeDatabase();
 
   std::cerr << "Database is in " << databaseDirectory.path().toStdString() << std::endl;
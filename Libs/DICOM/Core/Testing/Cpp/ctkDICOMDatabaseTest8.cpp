@@ -0,0 +1,103 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMItem.h"
+#include "ctkDICOMSyntheticDataTestHelper.h"
+
+// DCMTK includes
+#include <dcmtk/dcmdata/dcdeftag.h>
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+// Measure the per-instance cost of inserting a large batch of synthetic
+// indexing results into the database.
+int ctkDICOMDatabaseTest8( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  int numberOfInstances = 100000;
+  if (argc > 1)
+  {
+    numberOfInstances = QString(argv[1]).toInt();
+  }
+  if (numberOfInstances <= 0)
+  {
+    std::cerr << "Invalid number of instances: " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  QList<ctkDICOMDatabase::IndexingResult> indexingResults =
+    ctkDICOMCreateSyntheticIndexingResults(0, numberOfInstances);
+  QSet<QString> patientIDs;
+  QSet<QString> studyUIDs;
+  QSet<QString> seriesUIDs;
+  foreach(const ctkDICOMDatabase::IndexingResult& indexingResult, indexingResults)
+  {
+    patientIDs.insert(indexingResult.dataset->GetElementAsString(DCM_PatientID));
+    studyUIDs.insert(indexingResult.dataset->GetElementAsString(DCM_StudyInstanceUID));
+    seriesUIDs.insert(indexingResult.dataset->GetElementAsString(DCM_SeriesInstanceUID));
+  }
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+
+  QElapsedTimer timer;
+  timer.start();
+  database.insert(indexingResults);
+  qint64 elapsedTimeInMsec = timer.elapsed();
+
+  std::cout << "Inserted " << numberOfInstances << " instances in " << elapsedTimeInMsec << "ms ("
+            << 1000.0 * elapsedTimeInMsec / numberOfInstances << "us per instance)" << std::endl;
+
+  if (database.imagesCount() != numberOfInstances
+    || database.seriesCount() != seriesUIDs.size()
+    || database.studiesCount() != studyUIDs.size()
+    || database.patientsCount() != patientIDs.size())
+  {
+    std::cerr << "ctkDICOMDatabase::insert() failed: unexpected number of items in the database:"
+              << " patients=" << database.patientsCount() << " (expected " << patientIDs.size() << ")"
+              << " studies=" << database.studiesCount() << " (expected " << studyUIDs.size() << ")"
+              << " series=" << database.seriesCount() << " (expected " << seriesUIDs.size() << ")"
+              << " images=" << database.imagesCount() << " (expected " << numberOfInstances << ")"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Inserting the same batch again must not add any item
+  database.insert(indexingResults);
+  if (database.imagesCount() != numberOfInstances
+    || database.seriesCount() != seriesUIDs.size())
+  {
+    std::cerr << "ctkDICOMDatabase::insert() failed: repeated insert modified the database" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QStringList>
+#include <QTemporaryDir>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMSyntheticDataTestHelper.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+int numberOfImagesPendingDisplayedFieldsUpdate(ctkDICOMDatabase& database)
+{
+  QSqlQuery query(database.database());
+  query.exec("SELECT COUNT(*) FROM Images WHERE DisplayedFieldsUpdatedTimestamp IS NULL");
+  return query.next() ? query.value(0).toInt() : -1;
+}
+
+//------------------------------------------------------------------------------
+bool hasPendingDisplayedFieldsIndex(ctkDICOMDatabase& database)
+{
+  QSqlQuery query(database.database());
+  query.exec("SELECT name FROM sqlite_master WHERE type='index' AND name='ImagesDisplayedFieldsPendingIndex'");
+  return query.next();
+}
+
+//------------------------------------------------------------------------------
+QString pendingImagesQueryPlan(ctkDICOMDatabase& database)
+{
+  QSqlQuery query(database.database());
+  query.exec("EXPLAIN QUERY PLAN SELECT SOPInstanceUID, SeriesInstanceUID FROM Images WHERE DisplayedFieldsUpdatedTimestamp IS NULL");
+  QStringList plan;
+  while (query.next())
+  {
+    plan << query.value(query.record().count() - 1).toString();
+  }
+  return plan.join("; ");
+}
+
+} // end of anonymous namespace
+
+// Compare the time of updating the displayed fields of a few instances inserted into
+// a large database (incremental update) with the time of updating all of them (full update).
+// The new instances are inserted and updated through a new database object, as the
+// indexer and inserter workers do, the other instances must be left pending.
+int ctkDICOMDatabaseTest9( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  int numberOfInstances = 200000;
+  if (argc > 1)
+  {
+    numberOfInstances = QString(argv[1]).toInt();
+  }
+  if (numberOfInstances <= 0)
+  {
+    std::cerr << "Invalid number of instances: " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  const int numberOfNewInstances = 50;
+
+  QTemporaryDir databaseDirectory;
+  QString databaseFile = databaseDirectory.path() + "/ctkDICOM.sql";
+
+  ctkDICOMDatabase database;
+  database.openDatabase(databaseFile);
+  if (!hasPendingDisplayedFieldsIndex(database))
+  {
+    std::cerr << "ctkDICOMDatabase::openDatabase() failed: pending displayed fields index is not in the schema" << std::endl;
+    return EXIT_FAILURE;
+  }
+  database.insert(ctkDICOMCreateSyntheticIndexingResults(0, numberOfInstances));
+  database.closeDatabase();
+
+  // Only the instances inserted through the worker database object are updated
+  ctkDICOMDatabase workerDatabase;
+  workerDatabase.openDatabase(databaseFile);
+  workerDatabase.insert(ctkDICOMCreateSyntheticIndexingResults(numberOfInstances, numberOfNewInstances));
+  QElapsedTimer timer;
+  timer.start();
+  workerDatabase.updateDisplayedFields();
+  qint64 incrementalUpdateTimeInMsec = timer.elapsed();
+  int pendingCount = numberOfImagesPendingDisplayedFieldsUpdate(workerDatabase);
+  workerDatabase.closeDatabase();
+  if (pendingCount != numberOfInstances)
+  {
+    std::cerr << "ctkDICOMDatabase::updateDisplayedFields() failed: incremental update left " << pendingCount
+              << " pending instances instead of " << numberOfInstances << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A database object that inserted nothing finds the pending instances without scanning the Images table
+  database.openDatabase(databaseFile);
+  QString queryPlan = pendingImagesQueryPlan(database);
+  if (!queryPlan.contains("ImagesDisplayedFieldsPendingIndex"))
+  {
+    std::cerr << "ctkDICOMDatabase: pending images are not looked up with the partial index: "
+              << qPrintable(queryPlan) << std::endl;
+    return EXIT_FAILURE;
+  }
+  timer.start();
+  database.updateDisplayedFields();
+  qint64 fullUpdateTimeInMsec = timer.elapsed();
+  if (numberOfImagesPendingDisplayedFieldsUpdate(database) != 0)
+  {
+    std::cerr << "ctkDICOMDatabase::updateDisplayedFields() failed: full update is incomplete" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Updated displayed fields in a database of " << numberOfInstances << " instances:" << std::endl
+            << "  full update: " << fullUpdateTimeInMsec << "ms" << std::endl
+            << "  incremental update of " << numberOfNewInstances << " new instances: "
+            << incrementalUpdateTimeInMsec << "ms" << std::endl;
+  if (incrementalUpdateTimeInMsec >= fullUpdateTimeInMsec)
+  {
+    std::cerr << "ctkDICOMDatabase::updateDisplayedFields() failed: incremental update is not faster than full update" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMIndexer.h"
+
+// STD includes
+#include <iostream>
+
+// Measure indexing throughput (files/s) as a function of the number of parser threads.
+int ctkDICOMIndexerTest2( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2)
+    {
+    std::cerr << "Usage: ctkDICOMIndexerTest2 <dicom directory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QString dicomDir = QString::fromLocal8Bit(argv[1]);
+  if (!QDir(dicomDir).exists())
+    {
+    std::cerr << "Directory does not exist: " << qPrintable(dicomDir) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QList<int> threadCounts;
+  threadCounts << 1 << 2 << 4;
+  if (!threadCounts.contains(QThread::idealThreadCount()))
+    {
+    threadCounts << QThread::idealThreadCount();
+    }
+
+  // Index with reading entire files first, then with header-only parsing
+  // for each thread count. The same number of images must be found each time.
+  QList<bool> headerOnlyParsingModes;
+  headerOnlyParsingModes << false;
+  QList<int> runThreadCounts;
+  runThreadCounts << 1;
+  foreach(int threadCount, threadCounts)
+    {
+    headerOnlyParsingModes << true;
+    runThreadCounts << threadCount;
+    }
+
+  int expectedImagesCount = -1;
+  for (int run = 0; run < runThreadCounts.size(); ++run)
+    {
+    int threadCount = runThreadCounts[run];
+    bool headerOnlyParsing = headerOnlyParsingModes[run];
+    ctkDICOMDatabase database;
+    database.openDatabase(":memory:");
+    ctkDICOMIndexer indexer;
+    indexer.setHeaderOnlyParsing(headerOnlyParsing);
+    indexer.setNumberOfParserThreads(threadCount);
+    if (indexer.numberOfParserThreads() != threadCount)
+      {
+      std::cerr << "ctkDICOMIndexer::setNumberOfParserThreads() failed" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    QElapsedTimer timer;
+    timer.start();
+    indexer.addDirectory(&database, dicomDir, false);
+    indexer.waitForImportFinished();
+    double elapsedTimeInSeconds = timer.elapsed() / 1000.0;
+
+    int imagesCount = database.imagesCount();
+    std::cout << "Parser threads: " << threadCount
+              << ", header-only: " << (headerOnlyParsing ? "yes" : "no")
+              << ", files: " << imagesCount
+              << ", time: " << elapsedTimeInSeconds << "s"
+              << ", throughput: " << (elapsedTimeInSeconds > 0 ? imagesCount / elapsedTimeInSeconds : 0.0) << " files/s"
+              << std::endl;
+
+    if (expectedImagesCount < 0)
+      {
+      expectedImagesCount = imagesCount;
+      }
+    else if (imagesCount != expectedImagesCount)
+      {
+      std::cerr << "Indexing with " << threadCount << " parser threads found " << imagesCount
+                << " images instead of " << expectedImagesCount << std::endl;
+      return EXIT_FAILURE;
+      }
+    database.closeDatabase();
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+// Qt includes
+#include <QCoreApplication>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMIndexer.h"
+#include "ctkDICOMSyntheticDataTestHelper.h"
+
+// STD includes
+#include <iostream>
+#include <cstdlib>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+QString seriesInstanceUID(int seriesIndex)
+{
+  return QString("1.2.826.0.1.3680043.2.1125.1.0.0.%1").arg(seriesIndex);
+}
+
+//------------------------------------------------------------------------------
+QVariant queryValue(ctkDICOMDatabase& database, const QString& queryString)
+{
+  QSqlQuery query(database.database());
+  query.exec(queryString);
+  return query.next() ? query.value(0) : QVariant();
+}
+
+//------------------------------------------------------------------------------
+bool saveSeries(const QString& directory, int seriesIndex, int firstInstance, int numberOfInstances)
+{
+  for (int instance = firstInstance; instance < firstInstance + numberOfInstances; ++instance)
+  {
+    QString fileName = QString("%1/%2_%3.dcm").arg(directory).arg(seriesIndex).arg(instance);
+    if (!ctkDICOMSaveSyntheticFile(fileName, 0, 0, seriesIndex, instance))
+    {
+      std::cerr << "Failed to write " << qPrintable(fileName) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool checkDisplayedFields(ctkDICOMDatabase& database, int expectedSeriesCounts[], int numberOfSeries)
+{
+  int pendingCount = queryValue(database,
+    "SELECT COUNT(*) FROM Images WHERE DisplayedFieldsUpdatedTimestamp IS NULL").toInt();
+  if (pendingCount != 0)
+  {
+    std::cerr << pendingCount << " images are pending a displayed fields update after indexing" << std::endl;
+    return false;
+  }
+  for (int seriesIndex = 0; seriesIndex < numberOfSeries; ++seriesIndex)
+  {
+    int displayedCount = queryValue(database, QString(
+      "SELECT DisplayedCount FROM Series WHERE SeriesInstanceUID = '%1'").arg(seriesInstanceUID(seriesIndex))).toInt();
+    if (displayedCount != expectedSeriesCounts[seriesIndex])
+    {
+      std::cerr << "Series " << seriesIndex << " displayed count is " << displayedCount
+                << " instead of " << expectedSeriesCounts[seriesIndex] << std::endl;
+      return false;
+    }
+  }
+  int displayedNumberOfSeries = queryValue(database,
+    "SELECT DisplayedNumberOfSeries FROM Studies WHERE StudyInstanceUID = '1.2.826.0.1.3680043.2.1125.1.0.0'").toInt();
+  if (displayedNumberOfSeries != numberOfSeries)
+  {
+    std::cerr << "Study displayed number of series is " << displayedNumberOfSeries
+              << " instead of " << numberOfSeries << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // end of anonymous namespace
+
+// Check that the displayed fields of the instances added by successive indexing runs are
+// updated, while the indexer worker inserts them through its own database connection.
+int ctkDICOMIndexerTest3( int argc, char * argv [] )
+{
+  QCoreApplication app(argc, argv);
+
+  QTemporaryDir databaseDirectory;
+  QTemporaryDir firstDirectory;
+  QTemporaryDir secondDirectory;
+
+  ctkDICOMDatabase database;
+  database.openDatabase(databaseDirectory.path() + "/ctkDICOM.sql");
+  ctkDICOMIndexer indexer;
+
+  // First run: one series
+  if (!saveSeries(firstDirectory.path(), 0, 0, 10))
+  {
+    return EXIT_FAILURE;
+  }
+  indexer.addDirectory(&database, firstDirectory.path(), false);
+  indexer.waitForImportFinished();
+  int firstSeriesCounts[] = { 10 };
+  if (!checkDisplayedFields(database, firstSeriesCounts, 1))
+  {
+    std::cerr << "ctkDICOMIndexer failed to update the displayed fields of the first run" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The tag values kept in memory by the database object are dropped when the worker completes
+  QString firstInstanceUID = seriesInstanceUID(0) + ".0";
+  QString seriesInstanceUIDTag("0020,000E");
+  database.cachedTag(firstInstanceUID, seriesInstanceUIDTag);
+  database.resetTagValueCacheStatistics();
+  database.cachedTag(firstInstanceUID, seriesInstanceUIDTag);
+  if (database.tagValueCacheHitCount() != 1)
+  {
+    std::cerr << "ctkDICOMDatabase failed to keep the tag value in memory" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Second run: more instances of the same series and a new series of the same study
+  if (!saveSeries(secondDirectory.path(), 0, 10, 5) ||
+      !saveSeries(secondDirectory.path(), 1, 0, 3))
+  {
+    return EXIT_FAILURE;
+  }
+  indexer.addDirectory(&database, secondDirectory.path(), false);
+  indexer.waitForImportFinished();
+  int secondSeriesCounts[] = { 15, 3 };
+  if (!checkDisplayedFields(database, secondSeriesCounts, 2))
+  {
+    std::cerr << "ctkDICOMIndexer failed to update the displayed fields of the second run" << std::endl;
+    return EXIT_FAILURE;
+  }
+  database.resetTagValueCacheStatistics();
+  database.cachedTag(firstInstanceUID, seriesInstanceUIDTag);
+  if (database.tagValueCacheMissCount() != 1)
+  {
+    std::cerr << "ctkDICOMIndexer failed to clear the in-memory tag values of the database after indexing" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  database.closeDatabase();
+
+  return EXIT_SUCCESS;
+}
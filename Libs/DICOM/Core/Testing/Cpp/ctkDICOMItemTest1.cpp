@@ -31,6 +31,7 @@ int ctkDICOMItemTest1( int argc, char * argv [] )
   ctkDICOMItem dataset;
   dataset.InitializeFromItem(0);
   dataset.InitializeFromFile(QString());
+  dataset.InitializeFromFileUntilTag(QString());
   try
     {
     dataset.Serialize();
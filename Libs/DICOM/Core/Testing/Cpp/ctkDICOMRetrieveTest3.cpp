@@ -0,0 +1,238 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+
+// ctk includes
+#include "ctkCoreTestingMacros.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMJobResponseSet.h"
+#include "ctkDICOMQuery.h"
+#include "ctkDICOMRetrieve.h"
+#include "ctkDICOMSyntheticDataTestHelper.h"
+#include "ctkDICOMTester.h"
+
+// DCMTK includes
+#include <dcmtk/dcmdata/dcdeftag.h>
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Return the peak resident set size of the process in kB, or -1 if unknown.
+qint64 peakResidentSetSize()
+{
+  QFile status("/proc/self/status");
+  if (!status.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+    return -1;
+    }
+  foreach (const QByteArray& line, status.readAll().split('\n'))
+    {
+    if (line.startsWith("VmHWM:"))
+      {
+      return line.mid(6).trimmed().split(' ').first().toLongLong();
+      }
+    }
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+// Reset the peak resident set size to the current resident set size
+// (Linux 4.0 and later). Return false if it is not supported.
+bool resetPeakResidentSetSize()
+{
+  QFile clearRefs("/proc/self/clear_refs");
+  if (!clearRefs.open(QIODevice::WriteOnly))
+    {
+    return false;
+    }
+  return clearRefs.write("5") == 1;
+}
+
+//----------------------------------------------------------------------------
+// Retrieve the given studies and return the growth of the peak resident
+// set size in kB, or -1 if it can't be measured.
+qint64 retrieveStudies(ctkDICOMRetrieve& retrieve, const QSet<QString>& studyInstanceUIDs, bool& success)
+{
+  bool measured = resetPeakResidentSetSize();
+  qint64 peakBefore = peakResidentSetSize();
+  success = true;
+  foreach (const QString& studyInstanceUID, studyInstanceUIDs)
+    {
+    success = retrieve.getStudy(studyInstanceUID) && success;
+    }
+  qint64 peakAfter = peakResidentSetSize();
+  if (!measured || peakBefore < 0 || peakAfter < 0)
+    {
+    return -1;
+    }
+  return peakAfter - peakBefore;
+}
+
+}
+
+//----------------------------------------------------------------------------
+// Test the streaming of the C-GET responses to disk: the retrieved objects
+// must not be kept in memory, only their header travels in the job response sets.
+// The same studies, including a large synthetic multiframe object, are retrieved
+// with and without streaming to compare the memory high-water marks.
+int ctkDICOMRetrieveTest3(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+  QStringList arguments = app.arguments();
+  arguments.pop_front(); // remove test name
+  if (!arguments.count())
+    {
+    std::cout << " ctkDICOMRetrieveTest3 images" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // 96 frames of 512x512 16 bits pixels: 48 MB of pixel data
+  QTemporaryDir syntheticDirectory;
+  CHECK_BOOL(syntheticDirectory.isValid(), true);
+  QString largeFile = syntheticDirectory.filePath("large.dcm");
+  CHECK_BOOL(ctkDICOMSaveSyntheticFile(largeFile, 0, 0, 0, 0, 512, 512, 96), true);
+  qint64 largeFileSize = QFileInfo(largeFile).size();
+  QStringList storedFiles = arguments;
+  storedFiles << largeFile;
+
+  ctkDICOMTester tester;
+  tester.startDCMQRSCP();
+  CHECK_BOOL(tester.storeData(storedFiles), true);
+
+  QTemporaryDir temporaryDirectory;
+  CHECK_BOOL(temporaryDirectory.isValid(), true);
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+
+  ctkDICOMQuery query;
+  query.setCallingAETitle("CTK_AE");
+  query.setCalledAETitle("CTK_AE");
+  query.setHost("localhost");
+  query.setPort(tester.dcmqrscpPort());
+  CHECK_BOOL(query.query(database), true);
+  QSet<QString> studyInstanceUIDs;
+  typedef QPair<QString,QString> StudyAndSeriesInstanceUIDPair;
+  foreach (const StudyAndSeriesInstanceUIDPair& studyAndSeriesInstanceUID, query.studyAndSeriesInstanceUIDQueried())
+    {
+    studyInstanceUIDs.insert(studyAndSeriesInstanceUID.first);
+    }
+  CHECK_BOOL(studyInstanceUIDs.count() > 1, true);
+
+  ctkDICOMRetrieve retrieve;
+  retrieve.setCallingAETitle("CTK_AE");
+  retrieve.setCalledAETitle("CTK_AE");
+  retrieve.setPort(tester.dcmqrscpPort());
+  retrieve.setHost("localhost");
+  retrieve.setJobUID("ctkDICOMRetrieveTest3");
+
+  // Test the default values
+  CHECK_BOOL(retrieve.streamToDisk(), false);
+
+  retrieve.setStreamToDisk(true);
+  retrieve.setStorageDirectory(temporaryDirectory.path());
+  CHECK_BOOL(retrieve.streamToDisk(), true);
+  CHECK_QSTRING(retrieve.storageDirectory(), temporaryDirectory.path());
+
+  bool success = false;
+  qint64 streamingPeakGrowth = retrieveStudies(retrieve, studyInstanceUIDs, success);
+  CHECK_BOOL(success, true);
+
+  qint64 bytesReceived = 0;
+  QList<QSharedPointer<ctkDICOMJobResponseSet>> jobResponseSets = retrieve.jobResponseSetsShared();
+  CHECK_INT(jobResponseSets.count(), storedFiles.count());
+  foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, jobResponseSets)
+    {
+    // the object is on disk, only its header is in memory
+    CHECK_BOOL(jobResponseSet->temporaryFile(), true);
+    CHECK_BOOL(QFileInfo(jobResponseSet->filePath()).absolutePath() ==
+               QFileInfo(temporaryDirectory.path()).absoluteFilePath(), true);
+    CHECK_BOOL(QFile::exists(jobResponseSet->filePath()), true);
+    CHECK_BOOL(jobResponseSet->dataset() != nullptr, true);
+    CHECK_BOOL(jobResponseSet->dataset()->GetDcmItem().tagExists(DCM_PixelData), false);
+    CHECK_BOOL(jobResponseSet->sopInstanceUID().isEmpty(), false);
+    bytesReceived += QFileInfo(jobResponseSet->filePath()).size();
+    }
+  CHECK_BOOL(bytesReceived >= largeFileSize, true);
+
+  // The temporary files are moved into the database
+  QTemporaryDir databaseDirectory;
+  ctkDICOMDatabase fileDatabase;
+  fileDatabase.openDatabase(databaseDirectory.filePath("ctkDICOM.sql"));
+  fileDatabase.insert(jobResponseSets);
+  foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, jobResponseSets)
+    {
+    CHECK_BOOL(QFile::exists(jobResponseSet->filePath()), false);
+    CHECK_BOOL(QFile::exists(fileDatabase.fileForInstance(jobResponseSet->sopInstanceUID())), true);
+    }
+  jobResponseSets.clear();
+
+  // Same retrieve, the objects are received in memory
+  ctkDICOMRetrieve inMemoryRetrieve;
+  inMemoryRetrieve.setCallingAETitle("CTK_AE");
+  inMemoryRetrieve.setCalledAETitle("CTK_AE");
+  inMemoryRetrieve.setPort(tester.dcmqrscpPort());
+  inMemoryRetrieve.setHost("localhost");
+  inMemoryRetrieve.setJobUID("ctkDICOMRetrieveTest3InMemory");
+  qint64 inMemoryPeakGrowth = retrieveStudies(inMemoryRetrieve, studyInstanceUIDs, success);
+  CHECK_BOOL(success, true);
+
+  QList<QSharedPointer<ctkDICOMJobResponseSet>> inMemoryJobResponseSets = inMemoryRetrieve.jobResponseSetsShared();
+  CHECK_INT(inMemoryJobResponseSets.count(), storedFiles.count());
+  foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, inMemoryJobResponseSets)
+    {
+    CHECK_BOOL(jobResponseSet->temporaryFile(), false);
+    CHECK_BOOL(jobResponseSet->dataset() != nullptr, true);
+    CHECK_BOOL(jobResponseSet->dataset()->GetDcmItem().tagExists(DCM_PixelData), true);
+    }
+
+  std::cout << "ctkDICOMRetrieveTest3: received " << bytesReceived << " bytes" << std::endl;
+  if (streamingPeakGrowth < 0 || inMemoryPeakGrowth < 0)
+    {
+    std::cout << "ctkDICOMRetrieveTest3: memory high-water mark not available on this platform" << std::endl;
+    return EXIT_SUCCESS;
+    }
+  std::cout << "ctkDICOMRetrieveTest3: memory high-water mark growth "
+            << streamingPeakGrowth << " kB when streaming to disk, "
+            << inMemoryPeakGrowth << " kB when receiving in memory" << std::endl;
+
+  // Received in memory, the large object alone grows the high-water mark by
+  // about its size. Streamed to disk, only the association buffers are needed.
+  CHECK_BOOL(inMemoryPeakGrowth >= largeFileSize / 1024 / 2, true);
+  CHECK_BOOL(streamingPeakGrowth < inMemoryPeakGrowth / 4, true);
+
+  return EXIT_SUCCESS;
+}
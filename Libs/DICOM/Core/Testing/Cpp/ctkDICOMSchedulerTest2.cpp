@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+
+// ctk includes
+#include "ctkCoreTestingMacros.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMJob.h"
+#include "ctkDICOMScheduler.h"
+#include "ctkDICOMWorker.h"
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+
+QMutex ExecutedSeriesMutex;
+QStringList ExecutedSeries;
+
+//----------------------------------------------------------------------------
+// Worker doing nothing but reporting the series of its job
+class ctkDICOMSchedulerTest2Worker : public ctkDICOMWorker
+{
+public:
+  void run() override
+  {
+    QSharedPointer<ctkDICOMJob> job =
+      qobject_cast<QSharedPointer<ctkDICOMJob>>(this->Job);
+    if (!job)
+      {
+      return;
+      }
+
+    job->setStatus(ctkAbstractJob::JobStatus::Running);
+    {
+    QMutexLocker locker(&ExecutedSeriesMutex);
+    ExecutedSeries.append(job->seriesInstanceUID());
+    }
+    job->setStatus(ctkAbstractJob::JobStatus::Finished);
+    emit job->finished();
+  }
+
+  void cancel() override
+  {
+  }
+};
+
+//----------------------------------------------------------------------------
+class ctkDICOMSchedulerTest2Job : public ctkDICOMJob
+{
+public:
+  QString loggerReport(const QString& status) const override
+  {
+    return QString("ctkDICOMSchedulerTest2Job: job %1 %2").arg(this->jobUID()).arg(status);
+  }
+
+  ctkDICOMJob* generateCopy() const override
+  {
+    ctkDICOMSchedulerTest2Job* newJob = new ctkDICOMSchedulerTest2Job;
+    newJob->setPatientID(this->patientID());
+    newJob->setStudyInstanceUID(this->studyInstanceUID());
+    newJob->setSeriesInstanceUID(this->seriesInstanceUID());
+    newJob->setPriority(this->priority());
+    return newJob;
+  }
+
+  ctkDICOMWorker* createWorker() override
+  {
+    ctkDICOMSchedulerTest2Worker* worker = new ctkDICOMSchedulerTest2Worker;
+    worker->setJob(*this);
+    return worker;
+  }
+};
+
+}
+
+//----------------------------------------------------------------------------
+// Stress test of the job dispatch of ctkDICOMScheduler: the cost of adding,
+// re-prioritizing, stopping and dispatching jobs must not depend on the
+// total number of jobs in the scheduler.
+int ctkDICOMSchedulerTest2(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+  int numberOfJobs = 50000;
+  if (argc > 1)
+    {
+    numberOfJobs = QString(argv[1]).toInt();
+    }
+  const int numberOfSeries = 1000;
+  const int numberOfJobsPerSeries = qMax(1, numberOfJobs / numberOfSeries);
+
+  ctkDICOMScheduler scheduler;
+  scheduler.setMaximumThreadCount(1);
+
+  QElapsedTimer timer;
+  timer.start();
+  for (int jobIndex = 0; jobIndex < numberOfJobs; ++jobIndex)
+    {
+    int seriesIndex = jobIndex / numberOfJobsPerSeries;
+    // the scheduler takes ownership of the job
+    ctkDICOMSchedulerTest2Job* job = new ctkDICOMSchedulerTest2Job;
+    job->setPatientID(QString("Patient%1").arg(seriesIndex / 100));
+    job->setStudyInstanceUID(QString("1.2.3.%1").arg(seriesIndex / 10));
+    job->setSeriesInstanceUID(QString("1.2.3.4.%1").arg(seriesIndex));
+    job->setPriority(jobIndex % 2 ? QThread::NormalPriority : QThread::LowPriority);
+    scheduler.addJob(job);
+    }
+  qint64 addTime = timer.restart();
+  CHECK_INT(scheduler.numberOfJobs(), numberOfJobs);
+
+  // The jobs of the last series added are dispatched first
+  QString selectedSeries = QString("1.2.3.4.%1").arg((numberOfJobs - 1) / numberOfJobsPerSeries);
+  scheduler.raiseJobsPriorityForSeries(QStringList() << selectedSeries, QThread::HighestPriority);
+  qint64 raiseTime = timer.restart();
+
+  // Stop the jobs of the first series
+  scheduler.stopJobsByUIDs(QStringList(), QStringList(), QStringList() << "1.2.3.4.0");
+  qint64 stopTime = timer.restart();
+  CHECK_INT(scheduler.numberOfJobs(), numberOfJobs - numberOfJobsPerSeries);
+
+  scheduler.waitForFinish();
+  qint64 runTime = timer.elapsed();
+  CHECK_INT(scheduler.numberOfJobs(), 0);
+
+  {
+  QMutexLocker locker(&ExecutedSeriesMutex);
+  CHECK_INT(ExecutedSeries.count(), numberOfJobs - numberOfJobsPerSeries);
+  CHECK_QSTRING(ExecutedSeries.first(), selectedSeries);
+  CHECK_BOOL(ExecutedSeries.contains("1.2.3.4.0"), false);
+  }
+
+  std::cout << "ctkDICOMSchedulerTest2: " << numberOfJobs << " jobs" << std::endl
+            << "  add:   " << addTime << " ms" << std::endl
+            << "  raise: " << raiseTime << " ms" << std::endl
+            << "  stop:  " << stopTime << " ms" << std::endl
+            << "  run:   " << runTime << " ms" << std::endl;
+
+  return EXIT_SUCCESS;
+}
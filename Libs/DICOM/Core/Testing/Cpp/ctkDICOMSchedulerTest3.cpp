@@ -0,0 +1,117 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+
+// ctk includes
+#include "ctkCoreTestingMacros.h"
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+#include "ctkDICOMJobResponseSet.h"
+#include "ctkDICOMScheduler.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+QList<QSharedPointer<ctkDICOMJobResponseSet>> createJobResponseSets(int count)
+{
+  QList<QSharedPointer<ctkDICOMJobResponseSet>> jobResponseSets;
+  for (int index = 0; index < count; ++index)
+    {
+    QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet =
+      QSharedPointer<ctkDICOMJobResponseSet>(new ctkDICOMJobResponseSet);
+    jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::RetrieveSeries);
+    jobResponseSet->setJobUID("ctkDICOMSchedulerTest3");
+    jobResponseSet->setStudyInstanceUID("1.2.3");
+    jobResponseSet->setSeriesInstanceUID("1.2.3.4");
+    jobResponseSet->setSOPInstanceUID(QString("1.2.3.4.%1").arg(index));
+    jobResponseSets.append(jobResponseSet);
+    }
+  return jobResponseSets;
+}
+
+}
+
+//----------------------------------------------------------------------------
+// Test the coalescing of the insertion of job response sets in ctkDICOMScheduler
+int ctkDICOMSchedulerTest3(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+  ctkDICOMDatabase database;
+  database.openDatabase(":memory:");
+
+  ctkDICOMScheduler scheduler;
+  scheduler.setDicomDatabase(database);
+
+  // Test the default values
+  CHECK_INT(scheduler.insertBatchSize(), 100);
+  CHECK_BOOL(scheduler.insertBatchBytes() == 64 * 1024 * 1024, true);
+  CHECK_INT(scheduler.insertBatchInterval(), 250);
+  CHECK_INT(scheduler.numberOfPendingJobResponseSets(), 0);
+
+  int numberOfJobDetails = 0;
+  QObject::connect(&scheduler, &ctkDICOMScheduler::progressJobDetail,
+                   [&numberOfJobDetails](QVariant) { ++numberOfJobDetails; });
+
+  // Only the time window can trigger the insertion
+  scheduler.setInsertBatchSize(5);
+  scheduler.setInsertBatchInterval(60000);
+
+  // Buffered until the batch size is reached
+  scheduler.insertJobResponseSets(createJobResponseSets(2));
+  scheduler.insertJobResponseSets(createJobResponseSets(2));
+  CHECK_INT(scheduler.numberOfPendingJobResponseSets(), 4);
+  CHECK_INT(scheduler.numberOfJobs(), 0);
+
+  // One inserter job for all the buffered sets
+  scheduler.insertJobResponseSet(createJobResponseSets(1).first());
+  CHECK_INT(scheduler.numberOfPendingJobResponseSets(), 0);
+  CHECK_INT(scheduler.numberOfJobs(), 1);
+
+  // waitForFinish inserts the remaining sets
+  scheduler.insertJobResponseSets(createJobResponseSets(3));
+  CHECK_INT(scheduler.numberOfPendingJobResponseSets(), 3);
+  scheduler.waitForFinish();
+  CHECK_INT(scheduler.numberOfPendingJobResponseSets(), 0);
+  CHECK_INT(scheduler.numberOfJobs(), 0);
+
+  // Progress is reported once per inserter job for the series
+  CHECK_INT(numberOfJobDetails, 2);
+
+  // Without time window, the sets are inserted right away
+  scheduler.setInsertBatchInterval(0);
+  scheduler.insertJobResponseSets(createJobResponseSets(1));
+  CHECK_INT(scheduler.numberOfPendingJobResponseSets(), 0);
+  scheduler.waitForFinish();
+  CHECK_INT(scheduler.numberOfJobs(), 0);
+
+  // Stopping the jobs drops the buffered sets
+  scheduler.setInsertBatchInterval(60000);
+  scheduler.insertJobResponseSets(createJobResponseSets(2));
+  scheduler.stopAllJobs();
+  CHECK_INT(scheduler.numberOfPendingJobResponseSets(), 0);
+  CHECK_INT(scheduler.numberOfJobs(), 0);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// ctkDICOMCore includes
+#include "ctkDICOMItem.h"
+#include "ctkDICOMSyntheticDataTestHelper.h"
+
+// DCMTK includes
+#include <dcmtk/dcmdata/dcdatset.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmdata/dcuid.h>
+#include <dcmtk/dcmdata/dcvrpobw.h>
+
+//------------------------------------------------------------------------------
+QSharedPointer<ctkDICOMItem> ctkDICOMCreateSyntheticDataset(int patientIndex, int studyIndex,
+                                                           int seriesIndex, int instanceIndex)
+{
+  QString studyInstanceUID = QString("1.2.826.0.1.3680043.2.1125.1.%1.%2").arg(patientIndex).arg(studyIndex);
+  QString seriesInstanceUID = QString("%1.%2").arg(studyInstanceUID).arg(seriesIndex);
+  QString sopInstanceUID = QString("%1.%2").arg(seriesInstanceUID).arg(instanceIndex);
+
+  DcmDataset* dataset = new DcmDataset();
+  dataset->putAndInsertString(DCM_PatientName, QString("Synthetic^Patient%1").arg(patientIndex).toLatin1().constData());
+  dataset->putAndInsertString(DCM_PatientID, QString("SYN%1").arg(patientIndex).toLatin1().constData());
+  dataset->putAndInsertString(DCM_StudyInstanceUID, studyInstanceUID.toLatin1().constData());
+  dataset->putAndInsertString(DCM_SeriesInstanceUID, seriesInstanceUID.toLatin1().constData());
+  dataset->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID.toLatin1().constData());
+  dataset->putAndInsertString(DCM_Modality, "CT");
+  dataset->putAndInsertString(DCM_SeriesNumber, QString::number(seriesIndex).toLatin1().constData());
+  dataset->putAndInsertString(DCM_InstanceNumber, QString::number(instanceIndex).toLatin1().constData());
+
+  QSharedPointer<ctkDICOMItem> item(new ctkDICOMItem);
+  item->InitializeFromItem(dataset, true);
+  return item;
+}
+
+//------------------------------------------------------------------------------
+QList<ctkDICOMDatabase::IndexingResult> ctkDICOMCreateSyntheticIndexingResults(int firstInstance,
+                                                                              int numberOfInstances)
+{
+  QList<ctkDICOMDatabase::IndexingResult> indexingResults;
+  for (int instance = firstInstance; instance < firstInstance + numberOfInstances; ++instance)
+  {
+    int seriesCount = instance / ctkDICOMSyntheticInstancesPerSeries;
+    int studyCount = seriesCount / ctkDICOMSyntheticSeriesPerStudy;
+    int patientIndex = studyCount / ctkDICOMSyntheticStudiesPerPatient;
+    ctkDICOMDatabase::IndexingResult indexingResult;
+    indexingResult.dataset = ctkDICOMCreateSyntheticDataset(patientIndex,
+      studyCount % ctkDICOMSyntheticStudiesPerPatient,
+      seriesCount % ctkDICOMSyntheticSeriesPerStudy,
+      instance % ctkDICOMSyntheticInstancesPerSeries);
+    indexingResult.filePath = QString("/synthetic/%1.dcm").arg(instance);
+    indexingResult.copyFile = false;
+    indexingResult.overwriteExistingDataset = false;
+    indexingResults << indexingResult;
+  }
+  return indexingResults;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMSaveSyntheticFile(const QString& fileName,
+                               int patientIndex, int studyIndex, int seriesIndex, int instanceIndex,
+                               int rows, int columns, int numberOfFrames)
+{
+  QSharedPointer<ctkDICOMItem> item =
+    ctkDICOMCreateSyntheticDataset(patientIndex, studyIndex, seriesIndex, instanceIndex);
+  DcmItem& dataset = item->GetDcmItem();
+  dataset.putAndInsertString(DCM_SOPClassUID, UID_CTImageStorage);
+
+  if (rows > 0 && columns > 0 && numberOfFrames > 0)
+  {
+    dataset.putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset.putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset.putAndInsertUint16(DCM_Rows, static_cast<Uint16>(rows));
+    dataset.putAndInsertUint16(DCM_Columns, static_cast<Uint16>(columns));
+    dataset.putAndInsertString(DCM_NumberOfFrames, QString::number(numberOfFrames).toLatin1().constData());
+    dataset.putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset.putAndInsertUint16(DCM_BitsStored, 12);
+    dataset.putAndInsertUint16(DCM_HighBit, 11);
+    dataset.putAndInsertUint16(DCM_PixelRepresentation, 0);
+
+    // Gradient, so that the pixel data is not a constant
+    const unsigned long numberOfPixels =
+      static_cast<unsigned long>(rows) * columns * numberOfFrames;
+    DcmPolymorphOBOW* pixelData = new DcmPolymorphOBOW(DcmTag(DCM_PixelData, EVR_OW));
+    Uint16* pixels = nullptr;
+    if (pixelData->createUint16Array(numberOfPixels, pixels).bad())
+    {
+      delete pixelData;
+      return false;
+    }
+    for (unsigned long pixel = 0; pixel < numberOfPixels; ++pixel)
+    {
+      pixels[pixel] = static_cast<Uint16>(pixel % 4096);
+    }
+    dataset.insert(pixelData, true);
+  }
+
+  return item->SaveToFile(fileName);
+}
@@ -0,0 +1,55 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMSyntheticDataTestHelper_h
+#define __ctkDICOMSyntheticDataTestHelper_h
+
+// Qt includes
+#include <QList>
+#include <QSharedPointer>
+
+// ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
+class ctkDICOMItem;
+
+/// Layout of the synthetic datasets: consecutive instances are grouped into
+/// series, series into studies and studies into patients.
+const int ctkDICOMSyntheticInstancesPerSeries = 200;
+const int ctkDICOMSyntheticSeriesPerStudy = 5;
+const int ctkDICOMSyntheticStudiesPerPatient = 2;
+
+/// Create an in-memory dataset with the patient, study, series and instance
+/// identifiers needed to insert it into a database, no pixel data.
+QSharedPointer<ctkDICOMItem> ctkDICOMCreateSyntheticDataset(int patientIndex, int studyIndex,
+                                                           int seriesIndex, int instanceIndex);
+
+/// Create the indexing results of numberOfInstances synthetic instances, starting
+/// at instance number firstInstance. The files (/synthetic/<instance>.dcm) don't exist.
+QList<ctkDICOMDatabase::IndexingResult> ctkDICOMCreateSyntheticIndexingResults(int firstInstance,
+                                                                              int numberOfInstances);
+
+/// Write the synthetic dataset of an instance (CT image storage) to fileName,
+/// with uncompressed 16 bits pixel data of numberOfFrames frames of
+/// rows x columns pixels. The pixel data is omitted if a dimension is 0.
+bool ctkDICOMSaveSyntheticFile(const QString& fileName,
+                               int patientIndex, int studyIndex, int seriesIndex, int instanceIndex,
+                               int rows = 0, int columns = 0, int numberOfFrames = 1);
+
+#endif
@@ -142,6 +142,11 @@ public slots:
     ts->setCopyFile(copyFile);
     }
 
+  void setTemporaryFile(ctkDICOMJobResponseSet* ts, const bool& temporaryFile)
+    {
+    ts->setTemporaryFile(temporaryFile);
+    }
+
   void setOverwriteExistingDataset(ctkDICOMJobResponseSet* ts, const bool& overwriteExistingDataset)
     {
     ts->setOverwriteExistingDataset(overwriteExistingDataset);
@@ -24,11 +24,14 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QRegExp>
+#include <QRunnable>
 #include <QSet>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QStringList>
+#include <QThreadPool>
 #include <QUuid>
 #include <QVariant>
 
@@ -70,6 +73,87 @@ static QString ValueIsNotStored("__VALUE_IS_NOT_STORED__");
 /// Separator character for table and field names to be used in display rules manager
 static QString TableFieldSeparator(":");
 
+/// Statements used for inserting each instance, kept prepared (see ctkDICOMDatabasePrivate::preparedQuery)
+static QString InsertImageStatement("INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'URL', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ?, ? )");
+/// Linked files may be already in the database, in this case the existing record is kept
+static QString InsertOrIgnoreImageStatement("INSERT OR IGNORE INTO Images ( 'SOPInstanceUID', 'Filename', 'URL', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ?, ? )");
+static QString InsertTagStatement("INSERT OR REPLACE INTO TagCache VALUES(?,?,?)");
+
+/// Number of values bound in one "IN (...)" clause of bulk queries
+/// (keeps the number of bound values below the SQLite limit)
+static const int QueryChunkSize = 500;
+
+//------------------------------------------------------------------------------
+static QString sqlPlaceholders(int count)
+{
+  QStringList placeholders;
+  for (int i = 0; i < count; ++i)
+  {
+    placeholders << "?";
+  }
+  return placeholders.join(",");
+}
+
+//------------------------------------------------------------------------------
+/// Read values of tags from a file header. Used for reading files in parallel
+/// in ctkDICOMDatabasePrivate::tagValues.
+class ctkDICOMDatabaseTagReader : public QRunnable
+{
+public:
+  ctkDICOMDatabaseTagReader(int row, const QString& filePath, const QStringList& tags, const QList<DcmTagKey>& tagKeys,
+    const QStringList& tagsToExcludeFromStorage, const DcmTagKey& stopParsingAtElement)
+    : Row(row)
+    , FilePath(filePath)
+    , Tags(tags)
+    , TagKeys(tagKeys)
+    , TagsToExcludeFromStorage(tagsToExcludeFromStorage)
+    , StopParsingAtElement(stopParsingAtElement)
+  {
+    this->setAutoDelete(false);
+  }
+
+  void run() override
+  {
+    ctkDICOMItem dataset;
+    if (this->StopParsingAtElement == DCM_UndefinedTagKey)
+    {
+      dataset.InitializeFromFile(this->FilePath);
+    }
+    else
+    {
+      dataset.InitializeFromFileUntilTag(this->FilePath, this->StopParsingAtElement);
+    }
+    if (!dataset.IsInitialized())
+    {
+      logger.error("File " + this->FilePath + " could not be initialized.");
+      return;
+    }
+    for (int i = 0; i < this->Tags.size(); ++i)
+    {
+      const DcmTagKey& tagKey = this->TagKeys[i];
+      QString value;
+      if (this->TagsToExcludeFromStorage.contains(this->Tags[i]))
+      {
+        value = dataset.TagExists(tagKey) ? ValueIsNotStored : TagNotInInstance;
+      }
+      else
+      {
+        value = dataset.GetAllElementValuesAsString(tagKey);
+      }
+      this->Values << value;
+    }
+  }
+
+  int Row;
+  QString FilePath;
+  QStringList Tags;
+  QList<DcmTagKey> TagKeys;
+  QStringList TagsToExcludeFromStorage;
+  DcmTagKey StopParsingAtElement;
+  /// Values read from the file, empty if the file could not be read
+  QStringList Values;
+};
+
 //------------------------------------------------------------------------------
 // ctkDICOMDatabasePrivate methods
 
@@ -80,7 +164,11 @@ ctkDICOMDatabasePrivate::ctkDICOMDatabasePrivate(ctkDICOMDatabase& o)
   , UseShortStoragePath(true)
   , ThumbnailGenerator(nullptr)
   , TagCacheVerified(false)
-  , SchemaVersion("0.8.0")
+  , TagValueCache(100000)
+  , TagValueCacheHitCount(0)
+  , TagValueCacheMissCount(0)
+  , TuningProfile(ctkDICOMDatabase::defaultTuningProfile())
+  , SchemaVersion("0.8.1")
 {
   this->resetLastInsertedValues();
   this->DisplayedFieldGenerator = new ctkDICOMDisplayedFieldGenerator(q_ptr);
@@ -190,6 +278,30 @@ bool ctkDICOMDatabasePrivate::loggedExecBatch(QSqlQuery& query)
   return (success);
 }
 
+//------------------------------------------------------------------------------
+QSqlQuery& ctkDICOMDatabasePrivate::preparedQuery(const QSqlDatabase& database, const QString& queryString)
+{
+  QString key = database.connectionName() + "\n" + queryString;
+  QHash<QString, QSharedPointer<QSqlQuery> >::iterator it = this->PreparedQueries.find(key);
+  if (it == this->PreparedQueries.end())
+  {
+    QSharedPointer<QSqlQuery> query(new QSqlQuery(database));
+    if (!query->prepare(queryString))
+    {
+      logger.error("SQLITE ERROR preparing statement: " + queryString + " Error: " + query->lastError().text());
+    }
+    it = this->PreparedQueries.insert(key, query);
+  }
+  return *it.value();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::clearPreparedQueries()
+{
+  // Statements must be released before their connection is closed or removed
+  this->PreparedQueries.clear();
+}
+
 //------------------------------------------------------------------------------
 QStringList ctkDICOMDatabasePrivate::allFilesInDatabase()
 {
@@ -205,6 +317,93 @@ QStringList ctkDICOMDatabasePrivate::allFilesInDatabase()
   return allFileNames;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::markDisplayedFieldsDirty(const QString& sopInstanceUID, const QString& seriesInstanceUID,
+  const QString& studyInstanceUID, const QString& patientID)
+{
+  this->DisplayedFieldsDirtyInstances.insert(sopInstanceUID, seriesInstanceUID);
+  this->DisplayedFieldsDirtySeries.insert(seriesInstanceUID);
+  this->DisplayedFieldsDirtyStudies.insert(studyInstanceUID);
+  this->DisplayedFieldsDirtyPatientIDs.insert(patientID);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::clearDisplayedFieldsDirtyKeys()
+{
+  this->DisplayedFieldsDirtyInstances.clear();
+  this->DisplayedFieldsDirtySeries.clear();
+  this->DisplayedFieldsDirtyStudies.clear();
+  this->DisplayedFieldsDirtyPatientIDs.clear();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::loadDirtyDisplayedFields(QMap<QString, QMap<QString, QString> >& loadedSeries,
+                                                       QMap<QString, QMap<QString, QString> >& loadedStudies,
+                                                       QMap<QString, QMap<QString, QString> >& loadedPatients)
+{
+  // Same records as the ones read by getDisplaySeriesFieldsKey, getDisplayStudyFieldsKey and getDisplayPatientFieldsKey
+  QStringList seriesInstanceUIDs = this->DisplayedFieldsDirtySeries.values();
+  for (int chunkStart = 0; chunkStart < seriesInstanceUIDs.size(); chunkStart += QueryChunkSize)
+  {
+    int chunkSize = qMin(QueryChunkSize, seriesInstanceUIDs.size() - chunkStart);
+    QSqlQuery displaySeriesQuery(this->Database);
+    displaySeriesQuery.prepare("SELECT SeriesInstanceUID FROM Series WHERE SeriesInstanceUID IN (" + sqlPlaceholders(chunkSize) + ");");
+    for (int i = chunkStart; i < chunkStart + chunkSize; ++i)
+    {
+      displaySeriesQuery.addBindValue(seriesInstanceUIDs[i]);
+    }
+    this->loggedExec(displaySeriesQuery);
+    while (displaySeriesQuery.next())
+    {
+      QString seriesInstanceUID = displaySeriesQuery.value(0).toString();
+      loadedSeries[seriesInstanceUID].insert("SeriesInstanceUID", seriesInstanceUID);
+    }
+  }
+
+  QStringList studyInstanceUIDs = this->DisplayedFieldsDirtyStudies.values();
+  for (int chunkStart = 0; chunkStart < studyInstanceUIDs.size(); chunkStart += QueryChunkSize)
+  {
+    int chunkSize = qMin(QueryChunkSize, studyInstanceUIDs.size() - chunkStart);
+    QSqlQuery displayStudiesQuery(this->Database);
+    displayStudiesQuery.prepare("SELECT StudyInstanceUID FROM Studies WHERE StudyInstanceUID IN (" + sqlPlaceholders(chunkSize) + ");");
+    for (int i = chunkStart; i < chunkStart + chunkSize; ++i)
+    {
+      displayStudiesQuery.addBindValue(studyInstanceUIDs[i]);
+    }
+    this->loggedExec(displayStudiesQuery);
+    while (displayStudiesQuery.next())
+    {
+      QString studyInstanceUID = displayStudiesQuery.value(0).toString();
+      loadedStudies[studyInstanceUID].insert("StudyInstanceUID", studyInstanceUID);
+    }
+  }
+
+  QStringList patientIDs = this->DisplayedFieldsDirtyPatientIDs.values();
+  for (int chunkStart = 0; chunkStart < patientIDs.size(); chunkStart += QueryChunkSize)
+  {
+    int chunkSize = qMin(QueryChunkSize, patientIDs.size() - chunkStart);
+    QSqlQuery displayPatientsQuery(this->Database);
+    displayPatientsQuery.prepare("SELECT * FROM Patients WHERE PatientID IN (" + sqlPlaceholders(chunkSize) + ");");
+    for (int i = chunkStart; i < chunkStart + chunkSize; ++i)
+    {
+      displayPatientsQuery.addBindValue(patientIDs[i]);
+    }
+    this->loggedExec(displayPatientsQuery);
+    while (displayPatientsQuery.next())
+    {
+      QSqlRecord patientRecord = displayPatientsQuery.record();
+      QMap<QString, QString> patientFieldsMap;
+      for (int fieldIndex=0; fieldIndex<patientRecord.count(); ++fieldIndex)
+      {
+        patientFieldsMap.insert(patientRecord.fieldName(fieldIndex), patientRecord.value(fieldIndex).toString());
+      }
+      QString compositeID = ctkDICOMDatabase::compositePatientID(
+        patientFieldsMap["PatientID"], patientFieldsMap["PatientsName"], patientFieldsMap["PatientsBirthDate"]);
+      loadedPatients[compositeID] = patientFieldsMap;
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 QString ctkDICOMDatabasePrivate::readValueFromFile(const QString& fileName, const QString& sopInstanceUID, const QString& tag)
 {
@@ -256,6 +455,180 @@ QString ctkDICOMDatabasePrivate::readValueFromFile(const QString& fileName, cons
   return value;
 }
 
+//------------------------------------------------------------------------------
+QMap<QString, QStringList> ctkDICOMDatabasePrivate::tagValues(const QStringList& sopInstanceUIDs,
+  const QStringList& filePaths, const QStringList& tags)
+{
+  Q_Q(ctkDICOMDatabase);
+  const QString sopInstanceUIDTag = q->groupElementToTag(0x0008, 0x0018);
+  int instanceCount = sopInstanceUIDs.size();
+
+  QStringList upperTags;
+  foreach (const QString& tag, tags)
+  {
+    upperTags << tag.toUpper();
+  }
+  upperTags.removeDuplicates();
+  upperTags.removeAll(sopInstanceUIDTag);
+  QSet<QString> requestedTags;
+  foreach (const QString& tag, upperTags)
+  {
+    requestedTags.insert(tag);
+  }
+
+  // Values as stored in the tag cache for each instance
+  QVector<QHash<QString, QString> > storedValues(instanceCount);
+
+  // Get values from the in-memory cache
+  QList<int> rowsToQuery;
+  for (int row = 0; row < instanceCount; ++row)
+  {
+    bool complete = true;
+    foreach (const QString& tag, upperTags)
+    {
+      QString value;
+      if (this->lookupTagValueCache(sopInstanceUIDs[row], tag, value))
+      {
+        storedValues[row][tag] = value;
+      }
+      else
+      {
+        complete = false;
+      }
+    }
+    if (!complete)
+    {
+      rowsToQuery << row;
+    }
+  }
+
+  // Get values from the tag cache table, one query for each chunk of instances
+  if (!rowsToQuery.isEmpty() && q->tagCacheExists())
+  {
+    for (int chunkStart = 0; chunkStart < rowsToQuery.size(); chunkStart += QueryChunkSize)
+    {
+      int chunkSize = qMin(QueryChunkSize, rowsToQuery.size() - chunkStart);
+      QHash<QString, QList<int> > rowsForInstance;
+      QSqlQuery selectValues(this->TagCacheDatabase);
+      selectValues.prepare("SELECT SOPInstanceUID, Tag, Value FROM TagCache WHERE SOPInstanceUID IN ("
+        + sqlPlaceholders(chunkSize) + ")");
+      for (int i = chunkStart; i < chunkStart + chunkSize; ++i)
+      {
+        int row = rowsToQuery[i];
+        rowsForInstance[sopInstanceUIDs[row]] << row;
+        selectValues.addBindValue(sopInstanceUIDs[row]);
+      }
+      if (!this->loggedExec(selectValues))
+      {
+        continue;
+      }
+      while (selectValues.next())
+      {
+        QString tag = selectValues.value(1).toString().toUpper();
+        if (!requestedTags.contains(tag))
+        {
+          continue;
+        }
+        QString sopInstanceUID = selectValues.value(0).toString();
+        QString value = selectValues.value(2).toString();
+        foreach (int row, rowsForInstance.value(sopInstanceUID))
+        {
+          storedValues[row][tag] = value;
+        }
+        this->insertTagValueCache(sopInstanceUID, tag, value);
+      }
+    }
+  }
+
+  // Read the remaining values from the files, one header read per file
+  // Only the header is read if all requested tags are before the pixel data
+  QHash<QString, DcmTagKey> tagKeys;
+  DcmTagKey stopParsingAtElement = DCM_PixelData;
+  foreach (const QString& tag, upperTags)
+  {
+    unsigned short group, element;
+    q->tagToGroupElement(tag, group, element);
+    tagKeys[tag] = DcmTagKey(group, element);
+    if (!(tagKeys[tag] < DCM_PixelData))
+    {
+      stopParsingAtElement = DCM_UndefinedTagKey;
+    }
+  }
+  QList<QSharedPointer<ctkDICOMDatabaseTagReader> > readers;
+  foreach (int row, rowsToQuery)
+  {
+    if (filePaths[row].isEmpty())
+    {
+      continue;
+    }
+    QStringList missingTags;
+    QList<DcmTagKey> missingTagKeys;
+    foreach (const QString& tag, upperTags)
+    {
+      if (!storedValues[row].contains(tag))
+      {
+        missingTags << tag;
+        missingTagKeys << tagKeys[tag];
+      }
+    }
+    if (!missingTags.isEmpty())
+    {
+      readers << QSharedPointer<ctkDICOMDatabaseTagReader>(new ctkDICOMDatabaseTagReader(
+        row, filePaths[row], missingTags, missingTagKeys, this->TagsToExcludeFromStorage, stopParsingAtElement));
+    }
+  }
+  if (readers.size() == 1)
+  {
+    readers[0]->run();
+  }
+  else if (readers.size() > 1)
+  {
+    QThreadPool threadPool;
+    foreach (const QSharedPointer<ctkDICOMDatabaseTagReader>& reader, readers)
+    {
+      threadPool.start(reader.data());
+    }
+    threadPool.waitForDone();
+  }
+
+  // Store values read from files in the tag cache in one batch
+  QStringList cacheSOPInstanceUIDs, cacheTags, cacheValues;
+  foreach (const QSharedPointer<ctkDICOMDatabaseTagReader>& reader, readers)
+  {
+    for (int i = 0; i < reader->Values.size(); ++i)
+    {
+      QString value = reader->Values[i].isEmpty() ? TagNotInInstance : reader->Values[i];
+      storedValues[reader->Row][reader->Tags[i]] = value;
+      cacheSOPInstanceUIDs << sopInstanceUIDs[reader->Row];
+      cacheTags << reader->Tags[i];
+      cacheValues << value;
+    }
+  }
+  if (!cacheSOPInstanceUIDs.isEmpty())
+  {
+    q->cacheTags(cacheSOPInstanceUIDs, cacheTags, cacheValues);
+  }
+
+  // Build the table of values
+  QMap<QString, QStringList> result;
+  result[sopInstanceUIDTag] = sopInstanceUIDs;
+  foreach (const QString& tag, upperTags)
+  {
+    QStringList& values = result[tag];
+    values.reserve(instanceCount);
+    for (int row = 0; row < instanceCount; ++row)
+    {
+      QString value = storedValues[row].value(tag);
+      if (value == TagNotInInstance || value == ValueIsEmptyString || value == ValueIsNotStored)
+      {
+        value = QString();
+      }
+      values << value;
+    }
+  }
+  return result;
+}
+
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabasePrivate::executeScript(const QString script)
 {
@@ -320,17 +693,24 @@ bool ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& dataset, int& db
   patientID = dataset.GetElementAsString(DCM_PatientID);
   patientsBirthDate = dataset.GetElementAsString(DCM_PatientBirthDate);
 
-  QSqlQuery checkPatientExistsQuery(this->Database);
-  checkPatientExistsQuery.prepare("SELECT * FROM Patients WHERE PatientID = ? AND PatientsName = ?");
+  // Patients table has no unique key other than the generated UID,
+  // therefore existence has to be checked before inserting.
+  QSqlQuery& checkPatientExistsQuery = this->preparedQuery(this->Database,
+    "SELECT UID FROM Patients WHERE PatientID = ? AND PatientsName = ?");
   checkPatientExistsQuery.bindValue(0, patientID);
   checkPatientExistsQuery.bindValue(1, patientsName);
   loggedExec(checkPatientExistsQuery);
 
   QString compositeID = ctkDICOMDatabase::compositePatientID(patientID, patientsName, patientsBirthDate);
-  if (checkPatientExistsQuery.next())
+  bool patientFound = checkPatientExistsQuery.next();
+  if (patientFound)
+  {
+    dbPatientID = checkPatientExistsQuery.value(0).toInt();
+  }
+  checkPatientExistsQuery.finish();
+  if (patientFound)
   {
     // we found him
-    dbPatientID = checkPatientExistsQuery.value(checkPatientExistsQuery.record().indexOf("UID")).toInt();
     logger.debug( "Found patient in the database as UId: " + QString::number(dbPatientID));
     foreach(QString key, this->InsertedPatientsCompositeIDCache.keys())
     {
@@ -348,8 +728,7 @@ bool ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& dataset, int& db
     QString patientsAge(dataset.GetElementAsString(DCM_PatientAge));
     QString patientComments(dataset.GetElementAsString(DCM_PatientComments));
 
-    QSqlQuery insertPatientStatement(this->Database);
-    insertPatientStatement.prepare("INSERT INTO Patients "
+    QSqlQuery& insertPatientStatement = this->preparedQuery(this->Database, "INSERT INTO Patients "
       "( 'UID', 'PatientsName', 'PatientID', 'PatientsBirthDate', 'PatientsBirthTime', 'PatientsSex', 'PatientsAge', 'PatientsComments', "
       "'InsertTimestamp', 'DisplayedPatientsName', 'DisplayedNumberOfStudies', 'DisplayedFieldsUpdatedTimestamp' ) "
       "VALUES ( NULL, ?, ?, ?, ?, ?, ?, ?, ?, NULL, NULL, NULL )");
@@ -361,6 +740,7 @@ bool ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& dataset, int& db
     // TODO: shift patient's age to study,
     // since this is not a patient level attribute in images
     // insertPatientStatement.bindValue( 5, patientsAge );
+    insertPatientStatement.bindValue(5, QVariant(QVariant::String));
     insertPatientStatement.bindValue(6, patientComments);
     insertPatientStatement.bindValue(7, QDateTime::currentDateTime());
     loggedExec(insertPatientStatement);
@@ -375,56 +755,50 @@ bool ctkDICOMDatabasePrivate::insertPatient(const ctkDICOMItem& dataset, int& db
 bool ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& dataset, int dbPatientID)
 {
   QString studyInstanceUID(dataset.GetElementAsString(DCM_StudyInstanceUID) );
-  QSqlQuery checkStudyExistsQuery(this->Database);
-  checkStudyExistsQuery.prepare( "SELECT * FROM Studies WHERE StudyInstanceUID = ?" );
-  checkStudyExistsQuery.bindValue( 0, studyInstanceUID );
-  checkStudyExistsQuery.exec();
-  if (!checkStudyExistsQuery.next())
-  {
-    logger.debug("Need to insert new study: " + studyInstanceUID);
-
-    QString studyID(dataset.GetElementAsString(DCM_StudyID) );
-    QString studyDate(dataset.GetElementAsString(DCM_StudyDate) );
-    QString studyTime(dataset.GetElementAsString(DCM_StudyTime) );
-    QString accessionNumber(dataset.GetElementAsString(DCM_AccessionNumber) );
-    QString modalitiesInStudy(dataset.GetElementAsString(DCM_ModalitiesInStudy) );
-    QString institutionName(dataset.GetElementAsString(DCM_InstitutionName) );
-    QString performingPhysiciansName(dataset.GetElementAsString(DCM_PerformingPhysicianName) );
-    QString referringPhysician(dataset.GetElementAsString(DCM_ReferringPhysicianName) );
-    QString studyDescription(dataset.GetElementAsString(DCM_StudyDescription) );
-
-    QSqlQuery insertStudyStatement(this->Database);
-    insertStudyStatement.prepare( "INSERT INTO Studies "
-      "( 'StudyInstanceUID', 'PatientsUID', 'StudyID', 'StudyDate', 'StudyTime', 'AccessionNumber', 'ModalitiesInStudy', 'InstitutionName', 'ReferringPhysician', 'PerformingPhysiciansName', "
-        "'StudyDescription', 'InsertTimestamp', 'DisplayedNumberOfSeries', 'DisplayedFieldsUpdatedTimestamp' ) "
-      "VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, NULL, NULL )" );
-    insertStudyStatement.addBindValue( studyInstanceUID );
-    insertStudyStatement.addBindValue( dbPatientID );
-    insertStudyStatement.addBindValue( studyID );
-    insertStudyStatement.addBindValue( QDate::fromString ( studyDate, "yyyyMMdd" ) );
-    insertStudyStatement.addBindValue( studyTime );
-    insertStudyStatement.addBindValue( accessionNumber );
-    insertStudyStatement.addBindValue( modalitiesInStudy );
-    insertStudyStatement.addBindValue( institutionName );
-    insertStudyStatement.addBindValue( referringPhysician );
-    insertStudyStatement.addBindValue( performingPhysiciansName );
-    insertStudyStatement.addBindValue( studyDescription );
-    insertStudyStatement.addBindValue( QDateTime::currentDateTime() );
-    if (!insertStudyStatement.exec())
-    {
-      logger.error( "Error executing statement: " + insertStudyStatement.lastQuery() + " Error: " + insertStudyStatement.lastError().text() );
-    }
-    else
-    {
-      this->InsertedStudyUIDsCache.insert(studyInstanceUID);
-    }
 
+  QString studyID(dataset.GetElementAsString(DCM_StudyID) );
+  QString studyDate(dataset.GetElementAsString(DCM_StudyDate) );
+  QString studyTime(dataset.GetElementAsString(DCM_StudyTime) );
+  QString accessionNumber(dataset.GetElementAsString(DCM_AccessionNumber) );
+  QString modalitiesInStudy(dataset.GetElementAsString(DCM_ModalitiesInStudy) );
+  QString institutionName(dataset.GetElementAsString(DCM_InstitutionName) );
+  QString performingPhysiciansName(dataset.GetElementAsString(DCM_PerformingPhysicianName) );
+  QString referringPhysician(dataset.GetElementAsString(DCM_ReferringPhysicianName) );
+  QString studyDescription(dataset.GetElementAsString(DCM_StudyDescription) );
+
+  // StudyInstanceUID is the primary key, so an existing study is left unchanged
+  // without having to check its existence first.
+  QSqlQuery& insertStudyStatement = this->preparedQuery(this->Database, "INSERT OR IGNORE INTO Studies "
+    "( 'StudyInstanceUID', 'PatientsUID', 'StudyID', 'StudyDate', 'StudyTime', 'AccessionNumber', 'ModalitiesInStudy', 'InstitutionName', 'ReferringPhysician', 'PerformingPhysiciansName', "
+      "'StudyDescription', 'InsertTimestamp', 'DisplayedNumberOfSeries', 'DisplayedFieldsUpdatedTimestamp' ) "
+    "VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, NULL, NULL )" );
+  insertStudyStatement.bindValue( 0, studyInstanceUID );
+  insertStudyStatement.bindValue( 1, dbPatientID );
+  insertStudyStatement.bindValue( 2, studyID );
+  insertStudyStatement.bindValue( 3, QDate::fromString ( studyDate, "yyyyMMdd" ) );
+  insertStudyStatement.bindValue( 4, studyTime );
+  insertStudyStatement.bindValue( 5, accessionNumber );
+  insertStudyStatement.bindValue( 6, modalitiesInStudy );
+  insertStudyStatement.bindValue( 7, institutionName );
+  insertStudyStatement.bindValue( 8, referringPhysician );
+  insertStudyStatement.bindValue( 9, performingPhysiciansName );
+  insertStudyStatement.bindValue( 10, studyDescription );
+  insertStudyStatement.bindValue( 11, QDateTime::currentDateTime() );
+  if (!insertStudyStatement.exec())
+  {
+    logger.error( "Error executing statement: " + insertStudyStatement.lastQuery() + " Error: " + insertStudyStatement.lastError().text() );
+    return true;
+  }
+
+  this->InsertedStudyUIDsCache.insert(studyInstanceUID);
+  if (insertStudyStatement.numRowsAffected() > 0)
+  {
+    logger.debug("Inserted new study: " + studyInstanceUID);
     return true;
   }
   else
   {
     logger.debug( "Used existing study: " + studyInstanceUID);
-    this->InsertedStudyUIDsCache.insert(studyInstanceUID);
     return false;
   }
 }
@@ -433,65 +807,58 @@ bool ctkDICOMDatabasePrivate::insertStudy(const ctkDICOMItem& dataset, int dbPat
 bool ctkDICOMDatabasePrivate::insertSeries(const ctkDICOMItem& dataset, QString studyInstanceUID)
 {
   QString seriesInstanceUID(dataset.GetElementAsString(DCM_SeriesInstanceUID) );
-  QSqlQuery checkSeriesExistsQuery(this->Database);
-  checkSeriesExistsQuery.prepare( "SELECT * FROM Series WHERE SeriesInstanceUID = ?" );
-  checkSeriesExistsQuery.bindValue( 0, seriesInstanceUID );
-  logger.debug( "Statement: " + checkSeriesExistsQuery.lastQuery() );
-  checkSeriesExistsQuery.exec();
-  if (!checkSeriesExistsQuery.next())
-  {
-    logger.debug( "Need to insert new series: " + seriesInstanceUID);
-
-    QString seriesDate(dataset.GetElementAsString(DCM_SeriesDate) );
-    QString seriesTime(dataset.GetElementAsString(DCM_SeriesTime) );
-    QString seriesDescription(dataset.GetElementAsString(DCM_SeriesDescription) );
-    QString modality(dataset.GetElementAsString(DCM_Modality) );
-    QString bodyPartExamined(dataset.GetElementAsString(DCM_BodyPartExamined) );
-    QString frameOfReferenceUID(dataset.GetElementAsString(DCM_FrameOfReferenceUID) );
-    QString contrastAgent(dataset.GetElementAsString(DCM_ContrastBolusAgent) );
-    QString scanningSequence(dataset.GetElementAsString(DCM_ScanningSequence) );
-    long seriesNumber(dataset.GetElementAsInteger(DCM_SeriesNumber) );
-    long acquisitionNumber(dataset.GetElementAsInteger(DCM_AcquisitionNumber) );
-    long echoNumber(dataset.GetElementAsInteger(DCM_EchoNumbers) );
-    long temporalPosition(dataset.GetElementAsInteger(DCM_TemporalPositionIdentifier) );
-
-    QSqlQuery insertSeriesStatement(this->Database);
-    insertSeriesStatement.prepare( "INSERT INTO Series "
-      "( 'SeriesInstanceUID', 'StudyInstanceUID', 'SeriesNumber', 'SeriesDate', 'SeriesTime', 'SeriesDescription', 'Modality', 'BodyPartExamined', "
-        "'FrameOfReferenceUID', 'AcquisitionNumber', 'ContrastAgent', 'ScanningSequence', 'EchoNumber', 'TemporalPosition', 'InsertTimestamp' ) "
-      "VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
-    insertSeriesStatement.addBindValue( seriesInstanceUID );
-    insertSeriesStatement.addBindValue( studyInstanceUID );
-    insertSeriesStatement.addBindValue( static_cast<int>(seriesNumber) );
-    insertSeriesStatement.addBindValue( QDate::fromString ( seriesDate, "yyyyMMdd" ) );
-    insertSeriesStatement.addBindValue( seriesTime );
-    insertSeriesStatement.addBindValue( seriesDescription );
-    insertSeriesStatement.addBindValue( modality );
-    insertSeriesStatement.addBindValue( bodyPartExamined );
-    insertSeriesStatement.addBindValue( frameOfReferenceUID );
-    insertSeriesStatement.addBindValue( static_cast<int>(acquisitionNumber) );
-    insertSeriesStatement.addBindValue( contrastAgent );
-    insertSeriesStatement.addBindValue( scanningSequence );
-    insertSeriesStatement.addBindValue( static_cast<int>(echoNumber) );
-    insertSeriesStatement.addBindValue( static_cast<int>(temporalPosition) );
-    insertSeriesStatement.addBindValue( QDateTime::currentDateTime() );
-    if ( !insertSeriesStatement.exec() )
-    {
-      logger.error( "Error executing statement: "
-                     + insertSeriesStatement.lastQuery()
-                     + " Error: " + insertSeriesStatement.lastError().text() );
-    }
-    else
-    {
-      this->InsertedSeriesUIDsCache.insert(seriesInstanceUID);
-    }
 
+  QString seriesDate(dataset.GetElementAsString(DCM_SeriesDate) );
+  QString seriesTime(dataset.GetElementAsString(DCM_SeriesTime) );
+  QString seriesDescription(dataset.GetElementAsString(DCM_SeriesDescription) );
+  QString modality(dataset.GetElementAsString(DCM_Modality) );
+  QString bodyPartExamined(dataset.GetElementAsString(DCM_BodyPartExamined) );
+  QString frameOfReferenceUID(dataset.GetElementAsString(DCM_FrameOfReferenceUID) );
+  QString contrastAgent(dataset.GetElementAsString(DCM_ContrastBolusAgent) );
+  QString scanningSequence(dataset.GetElementAsString(DCM_ScanningSequence) );
+  long seriesNumber(dataset.GetElementAsInteger(DCM_SeriesNumber) );
+  long acquisitionNumber(dataset.GetElementAsInteger(DCM_AcquisitionNumber) );
+  long echoNumber(dataset.GetElementAsInteger(DCM_EchoNumbers) );
+  long temporalPosition(dataset.GetElementAsInteger(DCM_TemporalPositionIdentifier) );
+
+  // SeriesInstanceUID is the primary key, so an existing series is left unchanged
+  // without having to check its existence first.
+  QSqlQuery& insertSeriesStatement = this->preparedQuery(this->Database, "INSERT OR IGNORE INTO Series "
+    "( 'SeriesInstanceUID', 'StudyInstanceUID', 'SeriesNumber', 'SeriesDate', 'SeriesTime', 'SeriesDescription', 'Modality', 'BodyPartExamined', "
+      "'FrameOfReferenceUID', 'AcquisitionNumber', 'ContrastAgent', 'ScanningSequence', 'EchoNumber', 'TemporalPosition', 'InsertTimestamp' ) "
+    "VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
+  insertSeriesStatement.bindValue( 0, seriesInstanceUID );
+  insertSeriesStatement.bindValue( 1, studyInstanceUID );
+  insertSeriesStatement.bindValue( 2, static_cast<int>(seriesNumber) );
+  insertSeriesStatement.bindValue( 3, QDate::fromString ( seriesDate, "yyyyMMdd" ) );
+  insertSeriesStatement.bindValue( 4, seriesTime );
+  insertSeriesStatement.bindValue( 5, seriesDescription );
+  insertSeriesStatement.bindValue( 6, modality );
+  insertSeriesStatement.bindValue( 7, bodyPartExamined );
+  insertSeriesStatement.bindValue( 8, frameOfReferenceUID );
+  insertSeriesStatement.bindValue( 9, static_cast<int>(acquisitionNumber) );
+  insertSeriesStatement.bindValue( 10, contrastAgent );
+  insertSeriesStatement.bindValue( 11, scanningSequence );
+  insertSeriesStatement.bindValue( 12, static_cast<int>(echoNumber) );
+  insertSeriesStatement.bindValue( 13, static_cast<int>(temporalPosition) );
+  insertSeriesStatement.bindValue( 14, QDateTime::currentDateTime() );
+  if ( !insertSeriesStatement.exec() )
+  {
+    logger.error( "Error executing statement: "
+                   + insertSeriesStatement.lastQuery()
+                   + " Error: " + insertSeriesStatement.lastError().text() );
+    return true;
+  }
+
+  this->InsertedSeriesUIDsCache.insert(seriesInstanceUID);
+  if (insertSeriesStatement.numRowsAffected() > 0)
+  {
+    logger.debug( "Inserted new series: " + seriesInstanceUID);
     return true;
   }
   else
   {
     logger.debug( "Used existing series: " + seriesInstanceUID);
-    this->InsertedSeriesUIDsCache.insert(seriesInstanceUID);
     return false;
   }
 }
@@ -505,6 +872,8 @@ bool ctkDICOMDatabasePrivate::openTagCacheDatabase()
     return true;
   }
   QString tagCacheConnectionName = this->Database.connectionName() + "TagCache";
+  this->clearPreparedQueries();
+  this->clearTagValueCache();
   if (QSqlDatabase::contains(tagCacheConnectionName))
   {
     QSqlDatabase::removeDatabase(tagCacheConnectionName);
@@ -520,14 +889,121 @@ bool ctkDICOMDatabasePrivate::openTagCacheDatabase()
     return false;
   }
 
-  // Disable synchronous writing to make modifications faster
-  QSqlQuery pragmaSyncQuery(this->TagCacheDatabase);
-  pragmaSyncQuery.exec("PRAGMA synchronous = OFF");
-  pragmaSyncQuery.finish();
+  this->applyTuningProfile(this->TagCacheDatabase);
 
   return true;
 }
 
+//------------------------------------------------------------------------------
+bool ctkDICOMDatabasePrivate::lookupTagValueCache(const QString& sopInstanceUID, const QString& tag, QString& value)
+{
+  QMutexLocker locker(&this->TagValueCacheMutex);
+  // object() also marks the instance as most recently used
+  QHash<QString, QString>* tagValues = this->TagValueCache.object(sopInstanceUID);
+  if (tagValues)
+  {
+    QHash<QString, QString>::const_iterator it = tagValues->constFind(tag);
+    if (it != tagValues->constEnd())
+    {
+      value = it.value();
+      this->TagValueCacheHitCount++;
+      return true;
+    }
+  }
+  this->TagValueCacheMissCount++;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::insertTagValueCache(const QString& sopInstanceUID, const QString& tag, const QString& value)
+{
+  QMutexLocker locker(&this->TagValueCacheMutex);
+  if (this->TagValueCache.maxCost() <= 0)
+  {
+    return;
+  }
+  // Take and re-insert the entry to update its cost
+  QHash<QString, QString>* tagValues = this->TagValueCache.take(sopInstanceUID);
+  if (!tagValues)
+  {
+    tagValues = new QHash<QString, QString>;
+  }
+  tagValues->insert(tag, value);
+  this->TagValueCache.insert(sopInstanceUID, tagValues, tagValues->size());
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::removeFromTagValueCache(const QString& sopInstanceUID)
+{
+  QMutexLocker locker(&this->TagValueCacheMutex);
+  this->TagValueCache.remove(sopInstanceUID);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::clearTagValueCache()
+{
+  QMutexLocker locker(&this->TagValueCacheMutex);
+  this->TagValueCache.clear();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabasePrivate::applyTuningProfile(QSqlDatabase& database)
+{
+  Q_Q(ctkDICOMDatabase);
+  if (!database.isOpen())
+  {
+    return;
+  }
+
+  // page_size must be set before journal_mode (it cannot be changed in WAL mode)
+  // and journal_mode before the other settings.
+  static const QStringList supportedPragmas = QStringList()
+    << "page_size" << "journal_mode" << "synchronous" << "cache_size" << "mmap_size" << "temp_store";
+  foreach (const QString& key, this->TuningProfile.keys())
+  {
+    if (!supportedPragmas.contains(key))
+    {
+      logger.warn(QString("Unsupported pragma in database tuning profile is ignored: %1").arg(key));
+    }
+  }
+
+  // In-memory databases cannot use write-ahead log or memory mapping
+  bool inMemory = q->isInMemory();
+
+  QSqlQuery pragmaQuery(database);
+  foreach (const QString& pragma, supportedPragmas)
+  {
+    if (!this->TuningProfile.contains(pragma))
+    {
+      continue;
+    }
+    if (inMemory && (pragma == "journal_mode" || pragma == "mmap_size"))
+    {
+      continue;
+    }
+    QString value = this->TuningProfile[pragma].toString();
+    // Only accept plain numbers and keywords as value
+    if (!QRegExp("-?[0-9A-Za-z_]+").exactMatch(value))
+    {
+      logger.warn(QString("Invalid value in database tuning profile: %1 = %2").arg(pragma).arg(value));
+      continue;
+    }
+    if (!pragmaQuery.exec(QString("PRAGMA %1 = %2").arg(pragma).arg(value)))
+    {
+      logger.warn(QString("Failed to set database option %1 = %2: %3")
+        .arg(pragma).arg(value).arg(pragmaQuery.lastError().text()));
+    }
+    else if (pragma == "journal_mode" && pragmaQuery.next()
+      && pragmaQuery.value(0).toString().compare(value, Qt::CaseInsensitive) != 0)
+    {
+      // For example, WAL mode is not available on some network file systems
+      logger.warn(QString("Database journal mode is %1 instead of the requested %2 in %3")
+        .arg(pragmaQuery.value(0).toString()).arg(value).arg(database.databaseName()));
+    }
+    pragmaQuery.finish();
+  }
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMDatabasePrivate::precacheTags(const ctkDICOMItem& dataset, const QString sopInstanceUID)
 {
@@ -568,8 +1044,7 @@ void ctkDICOMDatabasePrivate::precacheTags(const ctkDICOMItem& dataset, const QS
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabasePrivate::removeImage(const QString& sopInstanceUID)
 {
-  QSqlQuery deleteFile(Database);
-  deleteFile.prepare("DELETE FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
+  QSqlQuery& deleteFile = this->preparedQuery(this->Database, "DELETE FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
   deleteFile.bindValue(":sopInstanceUID", sopInstanceUID);
   bool success = deleteFile.exec();
   if (!success)
@@ -611,7 +1086,7 @@ QString ctkDICOMDatabasePrivate::internalStoragePath(const QString& studyInstanc
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabasePrivate::storeDatasetFile(const ctkDICOMItem& dataset, const QString& originalFilePath,
   const QString& studyInstanceUID, const QString& seriesInstanceUID, const QString& sopInstanceUID,
-  QString& storedFilePath)
+  QString& storedFilePath, bool moveOriginalFile)
 {
   Q_Q(ctkDICOMDatabase);
 
@@ -639,6 +1114,18 @@ bool ctkDICOMDatabasePrivate::storeDatasetFile(const ctkDICOMItem& dataset, cons
       return false;
     }
   }
+  else if (moveOriginalFile)
+  {
+    // the file is not needed elsewhere, so rename it when it is on the same volume
+    QFile::remove(storedFilePath);
+    if (!QFile::rename(originalFilePath, storedFilePath))
+    {
+      QFile currentFile(originalFilePath);
+      currentFile.copy(storedFilePath);
+      currentFile.remove();
+    }
+    logger.debug("Move file from: " + originalFilePath + " to: " + storedFilePath);
+  }
   else
   {
     // we're inserting an existing file
@@ -658,8 +1145,8 @@ bool ctkDICOMDatabasePrivate::indexingStatusForFile(const QString& filePath, con
   datasetUpToDate = false;
   databaseFilename.clear();
 
-  QSqlQuery fileExistsQuery(Database);
-  fileExistsQuery.prepare("SELECT InsertTimestamp,Filename FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
+  QSqlQuery& fileExistsQuery = this->preparedQuery(this->Database,
+    "SELECT InsertTimestamp,Filename FROM Images WHERE SOPInstanceUID == :sopInstanceUID");
   fileExistsQuery.bindValue(":sopInstanceUID", sopInstanceUID);
   bool success = fileExistsQuery.exec();
   if (!success)
@@ -671,6 +1158,7 @@ bool ctkDICOMDatabasePrivate::indexingStatusForFile(const QString& filePath, con
   if (!foundSOPInstanceUID)
   {
     // this data set is not in the database yet
+    fileExistsQuery.finish();
     return true;
   }
 
@@ -679,13 +1167,15 @@ bool ctkDICOMDatabasePrivate::indexingStatusForFile(const QString& filePath, con
   // The SOP instance UID exists in the database. In theory, new SOP instance UID must be generated if
   // a file is modified, but some software may not respect this, so check if the file was modified.
   databaseFilename = fileExistsQuery.value(1).toString();
+  QString databaseInsertTimestampString = fileExistsQuery.value(0).toString();
+  fileExistsQuery.finish();
   QFileInfo databaseFileInfo(databaseFilename);
   if (!databaseFileInfo.isRelative())
   {
     // database stores a link to an external file, if it is the same filename and the file has not changed
     // since insertion date then it means that the dataset is up-to-date
     QDateTime fileLastModified(databaseFileInfo.lastModified());
-    QDateTime databaseInsertTimestamp(QDateTime::fromString(fileExistsQuery.value(0).toString(), Qt::ISODate));
+    QDateTime databaseInsertTimestamp(QDateTime::fromString(databaseInsertTimestampString, Qt::ISODate));
     // Compare QFileInfo objects instead of path strings to ensure equivalent file names
     // (such as same file name in uppercase/lowercase on Windows) are considered as equal.
     if (databaseFileInfo == QFileInfo(filePath) && fileLastModified < databaseInsertTimestamp)
@@ -885,50 +1375,41 @@ void ctkDICOMDatabasePrivate::insert(const ctkDICOMItem& dataset, QString filePa
   if (!sopInstanceUID.isEmpty() && !seriesInstanceUID.isEmpty() && !storedFilePath.isEmpty())
   {
     logger.debug( "Maybe add Instance" );
-    bool alreadyInserted = false;
-    if (!storeFile)
-    {
-      // file is linked, maybe it is already inserted
-      QSqlQuery checkImageExistsQuery(Database);
-      checkImageExistsQuery.prepare("SELECT * FROM Images WHERE SOPInstanceUID = ?");
-      checkImageExistsQuery.addBindValue(sopInstanceUID);
-      checkImageExistsQuery.exec();
-      alreadyInserted = checkImageExistsQuery.next();
-    }
-    if (!alreadyInserted)
-    {
-      // Get filename that will be stored in the database.
-      // Use relative path if a copy is stored in the database to make the database relocatable.
-      QString storedFilePathInDatabase;
-      if (storeFile)
-      {
-        QDir databaseDirectory(q->databaseDirectory());
-        storedFilePathInDatabase = databaseDirectory.relativeFilePath(storedFilePath);
-      }
-      else
-      {
-        storedFilePathInDatabase = storedFilePath;
-      }
 
-      QSqlQuery insertImageStatement(Database);
-      insertImageStatement.prepare("INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'URL', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ?, ? )");
-      insertImageStatement.addBindValue(sopInstanceUID);
-      insertImageStatement.addBindValue(storedFilePathInDatabase);
-      insertImageStatement.addBindValue(QString(""));
-      insertImageStatement.addBindValue(seriesInstanceUID);
-      insertImageStatement.addBindValue(QDateTime::currentDateTime());
+    // Get filename that will be stored in the database.
+    // Use relative path if a copy is stored in the database to make the database relocatable.
+    QString storedFilePathInDatabase;
+    if (storeFile)
+    {
+      QDir databaseDirectory(q->databaseDirectory());
+      storedFilePathInDatabase = databaseDirectory.relativeFilePath(storedFilePath);
+    }
+    else
+    {
+      storedFilePathInDatabase = storedFilePath;
+    }
+
+    // If the file is linked then it may be already inserted
+    QSqlQuery& insertImageStatement = this->preparedQuery(this->Database,
+      storeFile ? InsertImageStatement : InsertOrIgnoreImageStatement);
+    insertImageStatement.bindValue(0, sopInstanceUID);
+    insertImageStatement.bindValue(1, storedFilePathInDatabase);
+    insertImageStatement.bindValue(2, QString(""));
+    insertImageStatement.bindValue(3, seriesInstanceUID);
+    insertImageStatement.bindValue(4, QDateTime::currentDateTime());
 
-      if ( !insertImageStatement.exec() )
-      {
-        logger.error( "Error executing statement: "
-                       + insertImageStatement.lastQuery()
-                       + " Error: " + insertImageStatement.lastError().text() );
-      }
-      else
-      {
-        // insert was needed, so cache any application-requested tags
-        this->precacheTags(dataset, sopInstanceUID);
-      }
+    if ( !insertImageStatement.exec() )
+    {
+      logger.error( "Error executing statement: "
+                     + insertImageStatement.lastQuery()
+                     + " Error: " + insertImageStatement.lastError().text() );
+    }
+    else if (insertImageStatement.numRowsAffected() > 0)
+    {
+      this->markDisplayedFieldsDirty(sopInstanceUID, seriesInstanceUID, studyInstanceUID, patientID);
+
+      // insert was needed, so cache any application-requested tags
+      this->precacheTags(dataset, sopInstanceUID);
 
       // let users of this class track when things happen
       emit q->instanceAdded(sopInstanceUID);
@@ -994,12 +1475,9 @@ QString ctkDICOMDatabasePrivate::getDisplayPatientFieldsKey(const QString& patie
 QString ctkDICOMDatabasePrivate::getDisplayStudyFieldsKey(QString studyInstanceUID, QMap<QString, QMap<QString, QString> > &displayedFieldsMapStudy)
 {
   // Look for the study in the displayed fields cache first
-  foreach (QString currentStudyInstanceUid, displayedFieldsMapStudy.keys())
+  if (displayedFieldsMapStudy.contains(studyInstanceUID))
   {
-    if ( !displayedFieldsMapStudy[currentStudyInstanceUid]["StudyInstanceUID"].compare(studyInstanceUID) )
-    {
-      return studyInstanceUID;
-    }
+    return studyInstanceUID;
   }
 
   // Look for the study in the display database
@@ -1035,12 +1513,9 @@ QString ctkDICOMDatabasePrivate::getDisplayStudyFieldsKey(QString studyInstanceU
 QString ctkDICOMDatabasePrivate::getDisplaySeriesFieldsKey(QString seriesInstanceUID, QMap<QString, QMap<QString, QString> > &displayedFieldsMapSeries)
 {
   // Look for the series in the displayed fields cache first
-  foreach (QString currentSeriesInstanceUid, displayedFieldsMapSeries.keys())
+  if (displayedFieldsMapSeries.contains(seriesInstanceUID))
   {
-    if ( !displayedFieldsMapSeries[currentSeriesInstanceUid]["SeriesInstanceUID"].compare(seriesInstanceUID) )
-    {
-      return seriesInstanceUID;
-    }
+    return seriesInstanceUID;
   }
 
   // Look for the series in the display database
@@ -1079,61 +1554,58 @@ bool ctkDICOMDatabasePrivate::applyDisplayedFieldsChanges( QMap<QString, QMap<QS
 {
   QMap<QString, int> patientCompositeIdToPatientUidMap;
 
+  // Each record is updated with a single statement that also sets the update timestamp.
+  // Statements are kept prepared, as the set of fields is the same for most records.
+
   // Update patient fields
 
   foreach (QString compositeID, displayedFieldsMapPatient.keys())
   {
     QMap<QString, QString> currentPatient = displayedFieldsMapPatient[compositeID];
-    QSqlQuery displayPatientsQuery(this->Database);
-    displayPatientsQuery.prepare( "SELECT * FROM Patients WHERE PatientID=:patientID AND PatientsName=:patientsName ;" );
-    displayPatientsQuery.bindValue(":patientID", currentPatient["PatientID"]);
-    displayPatientsQuery.bindValue(":patientsName", currentPatient["PatientsName"]);
-    if (!displayPatientsQuery.exec())
+    bool patientUIDValid = false;
+    int patientUID = currentPatient.value("UID").toInt(&patientUIDValid);
+    if (!patientUIDValid)
     {
-      logger.error("SQLITE ERROR: " + displayPatientsQuery.lastError().driverText());
-      return false;
+      QSqlQuery displayPatientsQuery(this->Database);
+      displayPatientsQuery.prepare( "SELECT UID FROM Patients WHERE PatientID=:patientID AND PatientsName=:patientsName ;" );
+      displayPatientsQuery.bindValue(":patientID", currentPatient["PatientID"]);
+      displayPatientsQuery.bindValue(":patientsName", currentPatient["PatientsName"]);
+      if (!displayPatientsQuery.exec())
+      {
+        logger.error("SQLITE ERROR: " + displayPatientsQuery.lastError().driverText());
+        return false;
+      }
+      if (!displayPatientsQuery.next())
+      {
+        logger.error("Failed to find patient with PatientsName=" + currentPatient["PatientsName"] + " and PatientID=" + currentPatient["PatientID"]);
+        return false;
+      }
+      patientUID = displayPatientsQuery.value(0).toInt();
     }
-    if (displayPatientsQuery.next())
+
+    QString displayPatientsFieldUpdateString;
+    QList<QString> boundValues;
+    foreach (QString tagName, currentPatient.keys())
     {
-      QString displayPatientsFieldUpdateString;
-      QList<QString> boundValues;
-      foreach (QString tagName, currentPatient.keys())
+      if (tagName == "PatientCompositeID" || tagName == "UID" || tagName == "DisplayedFieldsUpdatedTimestamp")
       {
-        if (tagName == "PatientCompositeID")
-        {
-          continue; // Do not write patient index that is only used internally and temporarily
-        }
-        displayPatientsFieldUpdateString.append( tagName + " = ? , " );
-        boundValues << currentPatient[tagName];
+        continue; // Do not write patient index that is only used internally and temporarily, and the record key
       }
+      displayPatientsFieldUpdateString.append( tagName + " = ? , " );
+      boundValues << currentPatient[tagName];
+    }
+    displayPatientsFieldUpdateString.append( "DisplayedFieldsUpdatedTimestamp = CURRENT_TIMESTAMP" );
 
-      // Trim the separators from the end
-      displayPatientsFieldUpdateString = displayPatientsFieldUpdateString.left(displayPatientsFieldUpdateString.size() - 3);
-
-      QSqlRecord patientRecord = displayPatientsQuery.record();
-      int patientUID = patientRecord.value("UID").toInt();
-
-      QSqlQuery updateDisplayPatientStatement(this->Database);
-      updateDisplayPatientStatement.prepare( QString("UPDATE Patients SET %1 WHERE UID = ? ;").arg(displayPatientsFieldUpdateString) );
-      foreach (QString boundValue, boundValues)
-        {
-        updateDisplayPatientStatement.addBindValue(boundValue);
-        }
-      updateDisplayPatientStatement.addBindValue(patientUID);
-      this->loggedExec(updateDisplayPatientStatement);
-
-      QSqlQuery updateDisplayedFieldsUpdatedTimestampStatement(this->Database);
-      updateDisplayedFieldsUpdatedTimestampStatement.prepare("UPDATE Patients SET DisplayedFieldsUpdatedTimestamp=CURRENT_TIMESTAMP WHERE UID = ? ;");
-      updateDisplayedFieldsUpdatedTimestampStatement.addBindValue(patientUID);
-      this->loggedExec(updateDisplayedFieldsUpdatedTimestampStatement);
+    QSqlQuery& updateDisplayPatientStatement = this->preparedQuery(this->Database,
+      QString("UPDATE Patients SET %1 WHERE UID = ? ;").arg(displayPatientsFieldUpdateString) );
+    foreach (QString boundValue, boundValues)
+      {
+      updateDisplayPatientStatement.addBindValue(boundValue);
+      }
+    updateDisplayPatientStatement.addBindValue(patientUID);
+    this->loggedExec(updateDisplayPatientStatement);
 
-      patientCompositeIdToPatientUidMap[compositeID] = patientUID;
-    }
-    else
-    {
-      logger.error("Failed to find patient with PatientsName=" + currentPatient["PatientsName"] + " and PatientID=" + currentPatient["PatientID"]);
-      return false;
-    }
+    patientCompositeIdToPatientUidMap[compositeID] = patientUID;
   } // For each patient in displayedFieldsVectorPatient
 
   // Update study fields
@@ -1144,49 +1616,36 @@ bool ctkDICOMDatabasePrivate::applyDisplayedFieldsChanges( QMap<QString, QMap<QS
       continue;
     }
     QMap<QString, QString> currentStudy = displayedFieldsMapStudy[currentStudyInstanceUid];
-    QSqlQuery displayStudiesQuery(this->Database);
-    displayStudiesQuery.prepare("SELECT StudyInstanceUID FROM Studies WHERE StudyInstanceUID = ? ;");
-    displayStudiesQuery.addBindValue(currentStudyInstanceUid);
-    if (!displayStudiesQuery.exec())
-    {
-      logger.error("SQLITE ERROR: " + displayStudiesQuery.lastError().driverText());
-      return false;
-    }
-    if (displayStudiesQuery.next())
+    QString displayStudiesFieldUpdateString;
+    QList<QString> boundValues;
+    foreach (QString tagName, currentStudy.keys())
     {
-      QString displayStudiesFieldUpdateString;
-      QList<QString> boundValues;
-      foreach (QString tagName, currentStudy.keys())
+      if (!tagName.compare("PatientCompositeID"))
       {
-        if (!tagName.compare("PatientCompositeID"))
-        {
-          displayStudiesFieldUpdateString.append( "PatientsUID = ? , " );
-          boundValues << QString::number(patientCompositeIdToPatientUidMap[currentStudy["PatientCompositeID"]]);
-        }
-        else
-        {
-          displayStudiesFieldUpdateString.append( tagName + " = ? , " );
-          boundValues << currentStudy[tagName];
-        }
+        displayStudiesFieldUpdateString.append( "PatientsUID = ? , " );
+        boundValues << QString::number(patientCompositeIdToPatientUidMap[currentStudy["PatientCompositeID"]]);
       }
-      // Trim the separators from the end
-      displayStudiesFieldUpdateString = displayStudiesFieldUpdateString.left(displayStudiesFieldUpdateString.size() - 3);
-
-      QSqlQuery updateDisplayStudyStatement(this->Database);
-      updateDisplayStudyStatement.prepare( QString("UPDATE Studies SET %1 WHERE StudyInstanceUID = ? ;").arg(displayStudiesFieldUpdateString) );
-      foreach (QString boundValue, boundValues)
-        {
-        updateDisplayStudyStatement.addBindValue(boundValue);
-        }
-      updateDisplayStudyStatement.addBindValue(currentStudy["StudyInstanceUID"]);
-      this->loggedExec(updateDisplayStudyStatement);
+      else if (tagName != "DisplayedFieldsUpdatedTimestamp")
+      {
+        displayStudiesFieldUpdateString.append( tagName + " = ? , " );
+        boundValues << currentStudy[tagName];
+      }
+    }
+    displayStudiesFieldUpdateString.append( "DisplayedFieldsUpdatedTimestamp = CURRENT_TIMESTAMP" );
 
-      QSqlQuery updateDisplayedFieldsUpdatedTimestampStatement(this->Database);
-      updateDisplayedFieldsUpdatedTimestampStatement.prepare("UPDATE Studies SET DisplayedFieldsUpdatedTimestamp=CURRENT_TIMESTAMP WHERE StudyInstanceUID = ? ;");
-      updateDisplayedFieldsUpdatedTimestampStatement.addBindValue(currentStudy["StudyInstanceUID"]);
-      this->loggedExec(updateDisplayedFieldsUpdatedTimestampStatement);
+    QSqlQuery& updateDisplayStudyStatement = this->preparedQuery(this->Database,
+      QString("UPDATE Studies SET %1 WHERE StudyInstanceUID = ? ;").arg(displayStudiesFieldUpdateString) );
+    foreach (QString boundValue, boundValues)
+      {
+      updateDisplayStudyStatement.addBindValue(boundValue);
+      }
+    updateDisplayStudyStatement.addBindValue(currentStudyInstanceUid);
+    if (!updateDisplayStudyStatement.exec())
+    {
+      logger.error("SQLITE ERROR: " + updateDisplayStudyStatement.lastError().driverText());
+      return false;
     }
-    else
+    if (updateDisplayStudyStatement.numRowsAffected() < 1)
     {
       logger.error("in applyDisplayedFieldsChanges: Failed to find study with StudyInstanceUID=" + currentStudyInstanceUid);
       continue;
@@ -1200,43 +1659,33 @@ bool ctkDICOMDatabasePrivate::applyDisplayedFieldsChanges( QMap<QString, QMap<QS
     {
       continue;
     }
-    // Insert row into Series if does not exist
     QMap<QString, QString> currentSeries = displayedFieldsMapSeries[currentSeriesInstanceUid];
-    QSqlQuery displaySeriesQuery(this->Database);
-    displaySeriesQuery.prepare("SELECT SeriesInstanceUID FROM Series WHERE SeriesInstanceUID = ? ;");
-    displaySeriesQuery.addBindValue(currentSeriesInstanceUid);
-    if (!displaySeriesQuery.exec())
+    QString displaySeriesFieldUpdateString;
+    QList<QString> boundValues;
+    foreach (QString tagName, currentSeries.keys())
     {
-      logger.error("SQLITE ERROR: " + displaySeriesQuery.lastError().driverText());
-      return false;
-    }
-    if (displaySeriesQuery.next())
-    {
-      QString displaySeriesFieldUpdateString;
-      QList<QString> boundValues;
-      foreach (QString tagName, currentSeries.keys())
+      if (tagName == "DisplayedFieldsUpdatedTimestamp")
       {
-        displaySeriesFieldUpdateString.append( tagName + " = ? , " );
-        boundValues << currentSeries[tagName];
+        continue;
       }
-      // Trim the separators from the end
-      displaySeriesFieldUpdateString = displaySeriesFieldUpdateString.left(displaySeriesFieldUpdateString.size() - 3);
-
-      QSqlQuery updateDisplaySeriesStatement(this->Database);
-      updateDisplaySeriesStatement.prepare( QString("UPDATE Series SET %1 WHERE SeriesInstanceUID = ? ;").arg(displaySeriesFieldUpdateString) );
-      foreach (QString boundValue, boundValues)
-        {
-        updateDisplaySeriesStatement.addBindValue(boundValue);
-        }
-      updateDisplaySeriesStatement.addBindValue(currentSeries["SeriesInstanceUID"]);
-      this->loggedExec(updateDisplaySeriesStatement);
+      displaySeriesFieldUpdateString.append( tagName + " = ? , " );
+      boundValues << currentSeries[tagName];
+    }
+    displaySeriesFieldUpdateString.append( "DisplayedFieldsUpdatedTimestamp = CURRENT_TIMESTAMP" );
 
-      QSqlQuery updateDisplayedFieldsUpdatedTimestampStatement(this->Database);
-      updateDisplayedFieldsUpdatedTimestampStatement.prepare("UPDATE Series SET DisplayedFieldsUpdatedTimestamp=CURRENT_TIMESTAMP WHERE SeriesInstanceUID = ? ;");
-      updateDisplayedFieldsUpdatedTimestampStatement.addBindValue(currentSeries["SeriesInstanceUID"]);
-      this->loggedExec(updateDisplayedFieldsUpdatedTimestampStatement);
+    QSqlQuery& updateDisplaySeriesStatement = this->preparedQuery(this->Database,
+      QString("UPDATE Series SET %1 WHERE SeriesInstanceUID = ? ;").arg(displaySeriesFieldUpdateString) );
+    foreach (QString boundValue, boundValues)
+      {
+      updateDisplaySeriesStatement.addBindValue(boundValue);
+      }
+    updateDisplaySeriesStatement.addBindValue(currentSeriesInstanceUid);
+    if (!updateDisplaySeriesStatement.exec())
+    {
+      logger.error("SQLITE ERROR: " + updateDisplaySeriesStatement.lastError().driverText());
+      return false;
     }
-    else
+    if (updateDisplaySeriesStatement.numRowsAffected() < 1)
     {
       logger.error("in applyDisplayedFieldsChanges: Failed to find series with SeriesInstanceUID=" + currentSeriesInstanceUid);
       continue;
@@ -1324,6 +1773,7 @@ bool ctkDICOMDatabase::openDatabase(const QString databaseFile,
     verifiedConnectionName = QUuid::createUuid().toString();
   }
 
+  d->clearPreparedQueries();
   if (QSqlDatabase::contains(verifiedConnectionName))
   {
     QSqlDatabase::removeDatabase(verifiedConnectionName);
@@ -1341,10 +1791,7 @@ bool ctkDICOMDatabase::openDatabase(const QString databaseFile,
     return false;
   }
 
-  // Disable synchronous writing to make modifications faster
-  QSqlQuery pragmaSyncQuery(d->Database);
-  pragmaSyncQuery.exec("PRAGMA synchronous = OFF");
-  pragmaSyncQuery.finish();
+  d->applyTuningProfile(d->Database);
 
   if ( d->Database.tables().empty() )
   {
@@ -1389,6 +1836,36 @@ bool ctkDICOMDatabase::openDatabase(const QString databaseFile,
   return true;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setTuningProfile(const QVariantMap& profile)
+{
+  Q_D(ctkDICOMDatabase);
+  d->TuningProfile = profile;
+  d->applyTuningProfile(d->Database);
+  d->applyTuningProfile(d->TagCacheDatabase);
+  emit tuningProfileChanged();
+}
+
+//------------------------------------------------------------------------------
+QVariantMap ctkDICOMDatabase::tuningProfile() const
+{
+  Q_D(const ctkDICOMDatabase);
+  return d->TuningProfile;
+}
+
+//------------------------------------------------------------------------------
+QVariantMap ctkDICOMDatabase::defaultTuningProfile()
+{
+  QVariantMap profile;
+  profile["page_size"] = 4096;
+  profile["journal_mode"] = "WAL";
+  profile["synchronous"] = "NORMAL";
+  profile["cache_size"] = -65536; // negative value means size in KiB (64 MiB)
+  profile["mmap_size"] = 268435456; // 256 MiB
+  profile["temp_store"] = "MEMORY";
+  return profile;
+}
+
 //------------------------------------------------------------------------------
 const QString ctkDICOMDatabase::lastError() const {
   Q_D(const ctkDICOMDatabase);
@@ -1573,6 +2050,9 @@ void ctkDICOMDatabase::closeDatabase()
 {
   Q_D(ctkDICOMDatabase);
   bool wasOpen = this->isOpen();
+  d->clearPreparedQueries();
+  d->clearTagValueCache();
+  d->clearDisplayedFieldsDirtyKeys();
   d->Database.close();
   d->TagCacheDatabase.close();
   if (wasOpen)
@@ -2305,6 +2785,96 @@ bool ctkDICOMDatabase::fileValueExists(const QString fileName, const unsigned sh
   return this->fileValueExists(fileName, tag);
 }
 
+//------------------------------------------------------------------------------
+QMap<QString, QStringList> ctkDICOMDatabase::instancesTagValues(const QStringList& sopInstanceUIDs, const QStringList& tags)
+{
+  Q_D(ctkDICOMDatabase);
+  QHash<QString, QString> fileForInstance;
+  for (int chunkStart = 0; chunkStart < sopInstanceUIDs.size(); chunkStart += QueryChunkSize)
+  {
+    int chunkSize = qMin(QueryChunkSize, sopInstanceUIDs.size() - chunkStart);
+    QSqlQuery query(d->Database);
+    query.prepare("SELECT SOPInstanceUID, Filename FROM Images WHERE SOPInstanceUID IN ("
+      + sqlPlaceholders(chunkSize) + ")");
+    for (int i = chunkStart; i < chunkStart + chunkSize; ++i)
+    {
+      query.addBindValue(sopInstanceUIDs[i]);
+    }
+    d->loggedExec(query);
+    while (query.next())
+    {
+      QString fileName = query.value(1).toString();
+      if (!fileName.isEmpty())
+      {
+        fileForInstance[query.value(0).toString()] = d->absolutePathFromInternal(fileName);
+      }
+    }
+  }
+  QStringList filePaths;
+  foreach (const QString& sopInstanceUID, sopInstanceUIDs)
+  {
+    filePaths << fileForInstance.value(sopInstanceUID);
+  }
+  return d->tagValues(sopInstanceUIDs, filePaths, tags);
+}
+
+//------------------------------------------------------------------------------
+QMap<QString, QStringList> ctkDICOMDatabase::seriesTagValues(const QString& seriesInstanceUID, const QStringList& tags)
+{
+  Q_D(ctkDICOMDatabase);
+  QSqlQuery query(d->Database);
+  query.prepare("SELECT SOPInstanceUID, Filename FROM Images WHERE SeriesInstanceUID = ?");
+  query.addBindValue(seriesInstanceUID);
+  d->loggedExec(query);
+  QStringList sopInstanceUIDs;
+  QStringList filePaths;
+  while (query.next())
+  {
+    sopInstanceUIDs << query.value(0).toString();
+    QString fileName = query.value(1).toString();
+    filePaths << (fileName.isEmpty() ? QString() : d->absolutePathFromInternal(fileName));
+  }
+  return d->tagValues(sopInstanceUIDs, filePaths, tags);
+}
+
+//------------------------------------------------------------------------------
+QMap<QString, QStringList> ctkDICOMDatabase::filesTagValues(const QStringList& fileNames, const QStringList& tags)
+{
+  Q_D(ctkDICOMDatabase);
+  QStringList internalFileNames;
+  foreach (const QString& fileName, fileNames)
+  {
+    internalFileNames << d->internalPathFromAbsolute(fileName);
+  }
+  QHash<QString, QString> instanceForFile;
+  for (int chunkStart = 0; chunkStart < internalFileNames.size(); chunkStart += QueryChunkSize)
+  {
+    int chunkSize = qMin(QueryChunkSize, internalFileNames.size() - chunkStart);
+    QSqlQuery query(d->Database);
+    query.prepare("SELECT Filename, SOPInstanceUID FROM Images WHERE Filename IN ("
+      + sqlPlaceholders(chunkSize) + ")");
+    for (int i = chunkStart; i < chunkStart + chunkSize; ++i)
+    {
+      query.addBindValue(internalFileNames[i]);
+    }
+    d->loggedExec(query);
+    while (query.next())
+    {
+      instanceForFile[query.value(0).toString()] = query.value(1).toString();
+    }
+  }
+  QStringList sopInstanceUIDs;
+  QStringList filePaths;
+  for (int i = 0; i < fileNames.size(); ++i)
+  {
+    QString sopInstanceUID = instanceForFile.value(internalFileNames[i]);
+    sopInstanceUIDs << sopInstanceUID;
+    // files that are not in the database are not read
+    filePaths << (sopInstanceUID.isEmpty() ? QString() : fileNames[i]);
+  }
+  return d->tagValues(sopInstanceUIDs, filePaths, tags);
+}
+
 //------------------------------------------------------------------------------
 bool ctkDICOMDatabase::tagToGroupElement(const QString tag, unsigned short& group, unsigned short& element)
 {
@@ -2471,8 +3041,7 @@ void ctkDICOMDatabase::insert(const QList<ctkDICOMDatabase::IndexingResult>& ind
     if (!storedFilePath.isEmpty() && !seriesInstanceUID.isEmpty())
     {
       // Insert all pre-cached fields into tag cache
-      QSqlQuery insertTags(d->TagCacheDatabase);
-      insertTags.prepare("INSERT OR REPLACE INTO TagCache VALUES(?,?,?)");
+      QSqlQuery& insertTags = d->preparedQuery(d->TagCacheDatabase, InsertTagStatement);
       insertTags.bindValue(0, sopInstanceUID);
       foreach(const QString & tag, d->TagsToPrecache)
       {
@@ -2498,24 +3067,26 @@ void ctkDICOMDatabase::insert(const QList<ctkDICOMDatabase::IndexingResult>& ind
         insertTags.bindValue(1, tag);
         if (value.isEmpty())
         {
-          insertTags.bindValue(2, TagNotInInstance);
+          value = TagNotInInstance;
         }
-        else
+        insertTags.bindValue(2, value);
+        if (insertTags.exec())
         {
-          insertTags.bindValue(2, value);
+          d->insertTagValueCache(sopInstanceUID, tag.toUpper(), value);
         }
-        insertTags.exec();
       }
 
       // Insert image files
-      QSqlQuery insertImageStatement(d->Database);
-      insertImageStatement.prepare("INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'URL', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ?, ? )");
-      insertImageStatement.addBindValue(sopInstanceUID);
-      insertImageStatement.addBindValue(d->internalPathFromAbsolute(storedFilePath));
-      insertImageStatement.addBindValue(QString(""));
-      insertImageStatement.addBindValue(seriesInstanceUID);
-      insertImageStatement.addBindValue(QDateTime::currentDateTime());
-      insertImageStatement.exec();
+      QSqlQuery& insertImageStatement = d->preparedQuery(d->Database, InsertImageStatement);
+      insertImageStatement.bindValue(0, sopInstanceUID);
+      insertImageStatement.bindValue(1, d->internalPathFromAbsolute(storedFilePath));
+      insertImageStatement.bindValue(2, QString(""));
+      insertImageStatement.bindValue(3, seriesInstanceUID);
+      insertImageStatement.bindValue(4, QDateTime::currentDateTime());
+      if (insertImageStatement.exec())
+      {
+        d->markDisplayedFieldsDirty(sopInstanceUID, seriesInstanceUID, studyInstanceUID, patientID);
+      }
       emit instanceAdded(sopInstanceUID);
       logger.debug( "Instance Added" );
       databaseWasChanged = true;
@@ -2554,6 +3125,7 @@ void ctkDICOMDatabase::insert(QList<QSharedPointer<ctkDICOMJobResponseSet>> jobR
     QString url;
     bool generateThumbnail = false; // thumbnail will be generated when needed, don't slow down import with that
     bool storeFile = jobResponseSet->copyFile();
+    bool temporaryFileReferenced = false;
 
     QMap<QString, ctkDICOMItem*> datasets = jobResponseSet->datasets();
     for(QString key : datasets.keys())
@@ -2721,7 +3293,8 @@ void ctkDICOMDatabase::insert(QList<QSharedPointer<ctkDICOMJobResponseSet>> jobR
       QString storedFilePath = filePath;
       if (storeFile && !seriesInstanceUID.isEmpty() && !this->isInMemory())
       {
-        if (!d->storeDatasetFile(*dataset, filePath, studyInstanceUID, seriesInstanceUID, sopInstanceUID, storedFilePath))
+        if (!d->storeDatasetFile(*dataset, filePath, studyInstanceUID, seriesInstanceUID, sopInstanceUID, storedFilePath,
+                                 jobResponseSet->temporaryFile()))
         {
           continue;
         }
@@ -2738,62 +3311,64 @@ void ctkDICOMDatabase::insert(QList<QSharedPointer<ctkDICOMJobResponseSet>> jobR
           !url.isEmpty()))
       {
         logger.debug( "Maybe add Instance" );
-        bool alreadyInserted = false;
-        if (!storeFile)
+
+        // Get filename that will be stored in the database.
+        // Use relative path if a copy is stored in the database to make the database relocatable.
+        QString storedFilePathInDatabase;
+        if (storeFile)
         {
-          // file is linked, maybe it is already inserted
-          QSqlQuery checkImageExistsQuery(d->Database);
-          checkImageExistsQuery.prepare("SELECT * FROM Images WHERE SOPInstanceUID = ?");
-          checkImageExistsQuery.addBindValue(sopInstanceUID);
-          checkImageExistsQuery.exec();
-          alreadyInserted = checkImageExistsQuery.next();
+          storedFilePathInDatabase = databaseDirectory.relativeFilePath(storedFilePath);
         }
-        if (!alreadyInserted)
+        else
         {
-          // Get filename that will be stored in the database.
-          // Use relative path if a copy is stored in the database to make the database relocatable.
-          QString storedFilePathInDatabase;
-          if (storeFile)
-          {
-            QDir databaseDirectory(this->databaseDirectory());
-            storedFilePathInDatabase = databaseDirectory.relativeFilePath(storedFilePath);
-          }
-          else
-          {
-            storedFilePathInDatabase = storedFilePath;
-          }
+          storedFilePathInDatabase = storedFilePath;
+        }
 
-          QSqlQuery insertImageStatement(d->Database);
-          insertImageStatement.prepare("INSERT INTO Images ( 'SOPInstanceUID', 'Filename', 'URL', 'SeriesInstanceUID', 'InsertTimestamp' ) VALUES ( ?, ?, ?, ?, ? )");
-          insertImageStatement.addBindValue(sopInstanceUID);
-          insertImageStatement.addBindValue(storedFilePathInDatabase);
-          insertImageStatement.addBindValue(url);
-          insertImageStatement.addBindValue(seriesInstanceUID);
-          insertImageStatement.addBindValue(QDateTime::currentDateTime());
+        // If the file is linked then it may be already inserted
+        QSqlQuery& insertImageStatement = d->preparedQuery(d->Database,
+          storeFile ? InsertImageStatement : InsertOrIgnoreImageStatement);
+        insertImageStatement.bindValue(0, sopInstanceUID);
+        insertImageStatement.bindValue(1, storedFilePathInDatabase);
+        insertImageStatement.bindValue(2, url);
+        insertImageStatement.bindValue(3, seriesInstanceUID);
+        insertImageStatement.bindValue(4, QDateTime::currentDateTime());
 
-          if ( !insertImageStatement.exec() )
-          {
-            logger.error( "Error executing statement: "
-                         + insertImageStatement.lastQuery()
-                         + " Error: " + insertImageStatement.lastError().text() );
-          }
-          else
-          {
-            // insert was needed, so cache any application-requested tags
-            d->precacheTags(*dataset, sopInstanceUID);
-          }
+        if ( !insertImageStatement.exec() )
+        {
+          logger.error( "Error executing statement: "
+                       + insertImageStatement.lastQuery()
+                       + " Error: " + insertImageStatement.lastError().text() );
+        }
+        else if (insertImageStatement.numRowsAffected() > 0)
+        {
+          d->markDisplayedFieldsDirty(sopInstanceUID, seriesInstanceUID, studyInstanceUID, patientID);
+
+          // insert was needed, so cache any application-requested tags
+          d->precacheTags(*dataset, sopInstanceUID);
 
           // let users of this class track when things happen
           emit instanceAdded(sopInstanceUID);
           logger.debug( "Instance Added" );
           databaseWasChanged = true;
         }
+        if (storedFilePath == filePath)
+        {
+          temporaryFileReferenced = true;
+        }
         if (generateThumbnail)
         {
           d->storeThumbnailFile(storedFilePath, studyInstanceUID, seriesInstanceUID, sopInstanceUID);
         }
       }
     }
+
+    // A temporary file that was neither moved into the database folder nor
+    // referenced by the database (e.g. already up to date) is not needed anymore.
+    if (jobResponseSet->temporaryFile() && !temporaryFileReferenced &&
+        !filePath.isEmpty() && QFile::exists(filePath))
+    {
+      QFile::remove(filePath);
+    }
   }
 
   d->Database.commit();
@@ -2931,6 +3506,11 @@ bool ctkDICOMDatabase::removeSeries(const QString& seriesInstanceUID, bool clear
     {
       removeTagCacheSOPInstanceUIDs << sopInstanceUID;
     }
+    else
+    {
+      // Tag cache table is kept but the instance is not accessible via this database anymore
+      d->removeFromTagValueCache(sopInstanceUID);
+    }
   }
 
   QSqlQuery fileRemove(d->Database);
@@ -3151,6 +3731,7 @@ bool ctkDICOMDatabase::initializeTagCache()
     return false;
   }
 
+  d->clearTagValueCache();
   d->TagCacheVerified = true;
   return true;
 }
@@ -3159,6 +3740,13 @@ bool ctkDICOMDatabase::initializeTagCache()
 QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString tag)
 {
   Q_D(ctkDICOMDatabase);
+  QString upperTag = tag.toUpper();
+  QString result;
+  if (d->lookupTagValueCache(sopInstanceUID, upperTag, result))
+  {
+    return result.isEmpty() ? ValueIsEmptyString : result;
+  }
+
   if ( !this->tagCacheExists() )
   {
     if ( !this->initializeTagCache() )
@@ -3169,12 +3757,13 @@ QString ctkDICOMDatabase::cachedTag(const QString sopInstanceUID, const QString
   QSqlQuery selectValue( d->TagCacheDatabase );
   selectValue.prepare( "SELECT Value FROM TagCache WHERE SOPInstanceUID = :sopInstanceUID AND Tag = :tag" );
   selectValue.bindValue(":sopInstanceUID",sopInstanceUID);
-  selectValue.bindValue(":tag",tag.toUpper());
+  selectValue.bindValue(":tag",upperTag);
   d->loggedExec(selectValue);
-  QString result("");
   if (selectValue.next())
   {
     result = selectValue.value(0).toString();
+    // Missing values are not cached in memory, as they may be added by another connection
+    d->insertTagValueCache(sopInstanceUID, upperTag, result);
     if (result == QString(""))
     {
       result = ValueIsEmptyString;
@@ -3245,8 +3834,7 @@ bool ctkDICOMDatabase::cacheTags(const QStringList sopInstanceUIDs, const QStrin
 
   d->TagCacheDatabase.transaction();
 
-  QSqlQuery insertTags(d->TagCacheDatabase);
-  insertTags.prepare( "INSERT OR REPLACE INTO TagCache VALUES(?,?,?)" );
+  QSqlQuery& insertTags = d->preparedQuery(d->TagCacheDatabase, InsertTagStatement);
 
   QStringList::const_iterator sopInstanceUIDsIt = sopInstanceUIDs.begin();
   QStringList::const_iterator tagsIt = tags.begin();
@@ -3254,18 +3842,17 @@ bool ctkDICOMDatabase::cacheTags(const QStringList sopInstanceUIDs, const QStrin
   bool success = true;
   for (int i = 0; i<itemCount; ++i)
   {
+    QString upperTag = (*tagsIt).toUpper();
+    // replace empty strings with special flag string
+    QString value = valuesIt->isEmpty() ? TagNotInInstance : *valuesIt;
     insertTags.bindValue(0, *sopInstanceUIDsIt);
-    insertTags.bindValue(1, (*tagsIt).toUpper());
-    if (valuesIt->isEmpty())
+    insertTags.bindValue(1, upperTag);
+    insertTags.bindValue(2, value);
+    if (insertTags.exec())
     {
-      // replace empty strings with special flag string
-      insertTags.bindValue(2, TagNotInInstance);
+      d->insertTagValueCache(*sopInstanceUIDsIt, upperTag, value);
     }
     else
-    {
-      insertTags.bindValue(2, *valuesIt);
-    }
-    if (!insertTags.exec())
     {
       success = false;
     }
@@ -3283,6 +3870,7 @@ bool ctkDICOMDatabase::cacheTags(const QStringList sopInstanceUIDs, const QStrin
 void ctkDICOMDatabase::removeCachedTags(const QString sopInstanceUID)
 {
   Q_D(ctkDICOMDatabase);
+  d->removeFromTagValueCache(sopInstanceUID);
   if (!this->tagCacheExists())
   {
     return;
@@ -3297,6 +3885,66 @@ void ctkDICOMDatabase::removeCachedTags(const QString sopInstanceUID)
   }
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::setTagValueCacheSize(int size)
+{
+  Q_D(ctkDICOMDatabase);
+  QMutexLocker locker(&d->TagValueCacheMutex);
+  d->TagValueCache.setMaxCost(qMax(size, 0));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMDatabase::tagValueCacheSize() const
+{
+  Q_D(const ctkDICOMDatabase);
+  QMutexLocker locker(&d->TagValueCacheMutex);
+  return d->TagValueCache.maxCost();
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMDatabase::tagValueCacheHitCount() const
+{
+  Q_D(const ctkDICOMDatabase);
+  QMutexLocker locker(&d->TagValueCacheMutex);
+  return d->TagValueCacheHitCount;
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMDatabase::tagValueCacheMissCount() const
+{
+  Q_D(const ctkDICOMDatabase);
+  QMutexLocker locker(&d->TagValueCacheMutex);
+  return d->TagValueCacheMissCount;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::resetTagValueCacheStatistics()
+{
+  Q_D(ctkDICOMDatabase);
+  QMutexLocker locker(&d->TagValueCacheMutex);
+  d->TagValueCacheHitCount = 0;
+  d->TagValueCacheMissCount = 0;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMDatabase::clearTagValueCache()
+{
+  Q_D(ctkDICOMDatabase);
+  d->clearTagValueCache();
+}
+
+//------------------------------------------------------------------------------
+/// Move the record read by loadDirtyDisplayedFields into the displayed fields map, unless the map has it already.
+/// Only the records of the updated instances end up in the map, therefore only those are written back.
+static void moveLoadedDisplayedFields(const QString& key, QMap<QString, QMap<QString, QString> >& loadedFieldsMap,
+  QMap<QString, QMap<QString, QString> >& displayedFieldsMap)
+{
+  if (!displayedFieldsMap.contains(key) && loadedFieldsMap.contains(key))
+  {
+    displayedFieldsMap.insert(key, loadedFieldsMap.take(key));
+  }
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMDatabase::updateDisplayedFields()
 {
@@ -3305,8 +3953,33 @@ void ctkDICOMDatabase::updateDisplayedFields()
   // Get the files for which the displayed fields have not been created yet (DisplayedFieldsUpdatedTimestamp is NULL)
   // Note: The per-instance update only covers insertion and schema update. If fields on the series/study/patient level need to be
   // updated on the insertion of a new instance, then it can be handled using the startUpdate/endUpdate functions of the rules.
-  QSqlQuery newFilesQuery(d->Database);
-  d->loggedExec(newFilesQuery,QString("SELECT SOPInstanceUID, SeriesInstanceUID FROM Images WHERE DisplayedFieldsUpdatedTimestamp IS NULL;"));
+  // If instances were inserted through this object then only those, and the series, studies and patients they
+  // touched, are recomputed (the indexer and inserter workers insert and update through the same object).
+  // Otherwise the instances inserted through other connections or by a schema update are found with the
+  // ImagesDisplayedFieldsPendingIndex partial index.
+  QList<QPair<QString /*SOPInstanceUID*/, QString /*SeriesInstanceUID*/> > newFiles;
+  QMap<QString, QMap<QString, QString> > loadedSeries;
+  QMap<QString, QMap<QString, QString> > loadedStudies;
+  QMap<QString, QMap<QString, QString> > loadedPatients;
+  if (!d->DisplayedFieldsDirtyInstances.isEmpty())
+  {
+    QMap<QString, QString>::const_iterator dirtyInstanceIt;
+    for (dirtyInstanceIt = d->DisplayedFieldsDirtyInstances.constBegin();
+         dirtyInstanceIt != d->DisplayedFieldsDirtyInstances.constEnd(); ++dirtyInstanceIt)
+    {
+      newFiles << qMakePair(dirtyInstanceIt.key(), dirtyInstanceIt.value());
+    }
+    d->loadDirtyDisplayedFields(loadedSeries, loadedStudies, loadedPatients);
+  }
+  else
+  {
+    QSqlQuery newFilesQuery(d->Database);
+    d->loggedExec(newFilesQuery,QString("SELECT SOPInstanceUID, SeriesInstanceUID FROM Images WHERE DisplayedFieldsUpdatedTimestamp IS NULL;"));
+    while (newFilesQuery.next())
+    {
+      newFiles << qMakePair(newFilesQuery.value(0).toString(), newFilesQuery.value(1).toString());
+    }
+  }
 
   // Populate displayed fields maps from the current display tables
   QMap<QString /*SeriesInstanceUID*/, QMap<QString /*DisplayField*/, QString /*Value*/> > displayedFieldsMapSeries;
@@ -3320,10 +3993,12 @@ void ctkDICOMDatabase::updateDisplayedFields()
   d->DisplayedFieldGenerator->startUpdate();
 
   // Get display names for newly added files and add them into the display tables
-  while (newFilesQuery.next())
+  QStringList updatedInstances;
+  for (int newFileIndex = 0; newFileIndex < newFiles.size(); ++newFileIndex)
   {
-    QString sopInstanceUID = newFilesQuery.value(0).toString();
-    QString seriesInstanceUID = newFilesQuery.value(1).toString();
+    QString sopInstanceUID = newFiles[newFileIndex].first;
+    QString seriesInstanceUID = newFiles[newFileIndex].second;
+    updatedInstances << sopInstanceUID;
     QMap<QString, QString> cachedTags;
     this->getCachedTags(sopInstanceUID, cachedTags);
 
@@ -3338,6 +4013,8 @@ void ctkDICOMDatabase::updateDisplayedFields()
     }
     QString patientsBirthDate = cachedTags[ctkDICOMItem::TagKeyStripped(DCM_PatientBirthDate)];
 
+    moveLoadedDisplayedFields(ctkDICOMDatabase::compositePatientID(patientID, patientsName, patientsBirthDate),
+      loadedPatients, displayedFieldsMapPatient);
     QString compositeId = d->getDisplayPatientFieldsKey(patientID, patientsName, patientsBirthDate, displayedFieldsMapPatient);
     if (compositeId.isEmpty())
     {
@@ -3347,6 +4024,7 @@ void ctkDICOMDatabase::updateDisplayedFields()
     QMap<QString, QString> displayedFieldsForCurrentPatient = displayedFieldsMapPatient[compositeId];
 
     // Study
+    moveLoadedDisplayedFields(studyInstanceUID, loadedStudies, displayedFieldsMapStudy);
     QString displayedFieldsKeyForCurrentStudy = d->getDisplayStudyFieldsKey(
       cachedTags[ctkDICOMItem::TagKeyStripped(DCM_StudyInstanceUID)], displayedFieldsMapStudy );
     if (displayedFieldsKeyForCurrentStudy.isEmpty())
@@ -3358,6 +4036,7 @@ void ctkDICOMDatabase::updateDisplayedFields()
     displayedFieldsForCurrentStudy["PatientCompositeID"] = compositeId;
 
     // Series
+    moveLoadedDisplayedFields(seriesInstanceUID, loadedSeries, displayedFieldsMapSeries);
     QString displayedFieldsKeyForCurrentSeries = d->getDisplaySeriesFieldsKey(seriesInstanceUID, displayedFieldsMapSeries);
     if (displayedFieldsKeyForCurrentSeries.isEmpty())
     {
@@ -3384,27 +4063,39 @@ void ctkDICOMDatabase::updateDisplayedFields()
   emit displayedFieldsUpdateProgress(++progressValue);
 
   // Update/insert the display values
+  bool success = true;
   if (displayedFieldsMapSeries.count() > 0)
   {
     d->Database.transaction();
 
-    if (d->applyDisplayedFieldsChanges(displayedFieldsMapSeries, displayedFieldsMapStudy, displayedFieldsMapPatient))
+    success = d->applyDisplayedFieldsChanges(displayedFieldsMapSeries, displayedFieldsMapStudy, displayedFieldsMapPatient);
+    if (success)
     {
       // Update image timestamp
-      newFilesQuery.first();
-      newFilesQuery.previous(); // Need to go one before the first record
-      while (newFilesQuery.next())
+      for (int chunkStart = 0; chunkStart < updatedInstances.size(); chunkStart += QueryChunkSize)
       {
+        int chunkSize = qMin(QueryChunkSize, updatedInstances.size() - chunkStart);
         QSqlQuery updateDisplayedFieldsUpdatedTimestampStatement(d->Database);
-        QString updateDisplayedFieldsUpdatedTimestampStatementString =
-          QString("UPDATE IMAGES SET DisplayedFieldsUpdatedTimestamp=CURRENT_TIMESTAMP WHERE SOPInstanceUID='%1';").arg(newFilesQuery.value(0).toString());
-        d->loggedExec(updateDisplayedFieldsUpdatedTimestampStatement, updateDisplayedFieldsUpdatedTimestampStatementString);
+        updateDisplayedFieldsUpdatedTimestampStatement.prepare(
+          "UPDATE Images SET DisplayedFieldsUpdatedTimestamp=CURRENT_TIMESTAMP WHERE SOPInstanceUID IN ("
+          + sqlPlaceholders(chunkSize) + ");");
+        for (int i = chunkStart; i < chunkStart + chunkSize; ++i)
+        {
+          updateDisplayedFieldsUpdatedTimestampStatement.addBindValue(updatedInstances[i]);
+        }
+        d->loggedExec(updateDisplayedFieldsUpdatedTimestampStatement);
       }
     }
 
     d->Database.commit();
   }
 
+  // Keep the keys if the update failed, their instances are still pending
+  if (success)
+  {
+    d->clearDisplayedFieldsDirtyKeys();
+  }
+
   emit displayedFieldsUpdated();
   emit databaseChanged();
 }
@@ -25,6 +25,7 @@
 #include <QObject>
 #include <QStringList>
 #include <QSqlDatabase>
+#include <QVariantMap>
 
 #include "ctkDICOMItem.h"
 #include "ctkDICOMCoreExport.h"
@@ -67,6 +68,8 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMDatabase : public QObject
   Q_PROPERTY(QStringList loadedSeries READ loadedSeries WRITE setLoadedSeries)
   Q_PROPERTY(QStringList visibleSeries READ visibleSeries WRITE setVisibleSeries)
   Q_PROPERTY(bool useShortStoragePath READ useShortStoragePath WRITE setUseShortStoragePath)
+  Q_PROPERTY(QVariantMap tuningProfile READ tuningProfile WRITE setTuningProfile)
+  Q_PROPERTY(int tagValueCacheSize READ tagValueCacheSize WRITE setTagValueCacheSize)
 
 public:
   struct IndexingResult
@@ -123,6 +126,29 @@ public:
   Q_INVOKABLE virtual bool openDatabase(const QString databaseFile,
                                         const QString& connectionName = "");
 
+  /// \brief SQLite settings applied to every connection opened by this object
+  /// (main database and tag cache), including connections that the indexer and the
+  /// scheduler workers open in their own threads for the same database.
+  ///
+  /// Keys are SQLite pragma names, values are the pragma values.
+  /// Supported pragmas: page_size, journal_mode, synchronous, cache_size, mmap_size, temp_store.
+  /// Pragmas that are not in the profile are left at the SQLite default.
+  /// page_size is only effective for newly created database files.
+  /// Settings are applied immediately to the currently open connections,
+  /// tuningProfileChanged() is emitted so that the indexer updates the
+  /// connections it opens afterwards.
+  /// The default profile is defaultTuningProfile().
+  void setTuningProfile(const QVariantMap& profile);
+  QVariantMap tuningProfile() const;
+
+  /// \brief Tuning profile that allows reading the database while another
+  /// connection is importing into it.
+  ///
+  /// The write-ahead log (journal_mode=WAL) lets readers, such as the browser, proceed
+  /// during long write transactions of the indexer, and synchronous=NORMAL is safe in WAL mode.
+  /// Page cache, memory mapping and in-memory temporary storage reduce disk access.
+  Q_INVOKABLE static QVariantMap defaultTuningProfile();
+
   /// Close the database. It must not be used afterwards.
   Q_INVOKABLE void closeDatabase();
 
@@ -349,6 +375,26 @@ public:
   Q_INVOKABLE bool fileValueExists(const QString fileName, const QString tag);
   Q_INVOKABLE bool fileValueExists(const QString fileName, const unsigned short group, const unsigned short element);
 
+  /// \brief Get the values of multiple tags for multiple instances at once.
+  ///
+  /// Values are read from the tag cache using one query per chunk of instances.
+  /// Tags that are not in the tag cache are read from the file headers (in parallel,
+  /// one read per file) and are added to the tag cache.
+  ///
+  /// Returns a column-oriented table: for each requested tag (in upper case "gggg,eeee"
+  /// format) the list of values, in the same order as the instances.
+  /// The "0008,0018" (SOP Instance UID) column is always included to identify the instances.
+  /// As in instanceValue(), empty string is returned for tags that are not present.
+  Q_INVOKABLE QMap<QString, QStringList> instancesTagValues(const QStringList& sopInstanceUIDs, const QStringList& tags);
+  /// Get the values of multiple tags for all instances of a series.
+  /// \sa instancesTagValues
+  Q_INVOKABLE QMap<QString, QStringList> seriesTagValues(const QString& seriesInstanceUID, const QStringList& tags);
+  /// Get the values of multiple tags for a list of files.
+  /// Values are returned in the same order as the files. Files that are not in the database
+  /// are returned with an empty SOP Instance UID and empty values.
+  /// \sa instancesTagValues
+  Q_INVOKABLE QMap<QString, QStringList> filesTagValues(const QStringList& fileNames, const QStringList& tags);
+
   /// \brief Store values of previously requested instance elements
   /// These are meant to be internal methods used by the instanceValue and fileValue
   /// methods, but they can be used by calling classes to populate or access
@@ -373,6 +419,25 @@ public:
   /// Remove all tags corresponding to a SOP instance UID
   Q_INVOKABLE void removeCachedTags(const QString sopInstanceUID);
 
+  /// \brief Maximum number of tag values kept in memory in front of the tag cache.
+  ///
+  /// Values read by cachedTag() or written by cacheTag() and cacheTags() are kept
+  /// in a least recently used in-memory cache so that repeated queries, such as
+  /// sorting slices of a series by instanceValue(), do not hit the tag cache database.
+  /// Set to 0 to disable the in-memory cache. Default is 100000.
+  void setTagValueCacheSize(int size);
+  int tagValueCacheSize() const;
+  /// Number of cachedTag() calls answered from the in-memory cache since the last reset
+  Q_INVOKABLE qint64 tagValueCacheHitCount() const;
+  /// Number of cachedTag() calls that had to query the tag cache database since the last reset
+  Q_INVOKABLE qint64 tagValueCacheMissCount() const;
+  Q_INVOKABLE void resetTagValueCacheStatistics();
+  /// Remove all values from the in-memory tag value cache.
+  /// The in-memory cache only follows the tag cache writes made through this object.
+  /// ctkDICOMIndexer and ctkDICOMScheduler call it when their workers, which write
+  /// through their own connections, have modified the database.
+  Q_INVOKABLE void clearTagValueCache();
+
   /// Get displayed name of a given field
   Q_INVOKABLE QString displayedNameForField(QString table, QString field) const;
   /// Set displayed name of a given field
@@ -445,6 +510,9 @@ Q_SIGNALS:
   /// Indicate that tagsToExcludeFromStorage list changed
   void tagsToExcludeFromStorageChanged();
 
+  /// Indicate that the tuning profile changed
+  void tuningProfileChanged();
+
   /// Indicate that the schema is about to be updated and how many files will be processed
   void schemaUpdateStarted(int);
   /// Indicate progress in updating schema (int is file number, string is file name)
@@ -32,6 +32,11 @@
 // We mean it.
 //
 
+// Qt includes
+#include <QCache>
+#include <QMutex>
+#include <QSqlQuery>
+
 // ctkDICOM includes
 #include "ctkDICOMDatabase.h"
 #include "ctkDICOMDisplayedFieldGenerator.h"
@@ -54,15 +59,28 @@ public:
   bool loggedExec(QSqlQuery& query, const QString& queryString);
   bool loggedExecBatch(QSqlQuery& query);
 
+  /// Get a statement that is prepared only once for the given connection and then reused.
+  /// Bound values are kept from the previous execution, therefore all values must be bound
+  /// again before executing the statement. Statements are released when the database is closed.
+  QSqlQuery& preparedQuery(const QSqlDatabase& database, const QString& queryString);
+  void clearPreparedQueries();
+
   bool removeImage(const QString& sopInstanceUID);
 
   /// Read DICOM tag value from file and store it in the tag cache
   QString readValueFromFile(const QString& fileName, const QString& sopInstanceUID, const QString& tag);
 
+  /// Get values of tags for instances from the tag cache, and from the files (read in parallel) if needed.
+  /// filePaths must have the same size as sopInstanceUIDs, empty file path means that the values
+  /// are not read from file if they are missing from the tag cache.
+  QMap<QString, QStringList> tagValues(const QStringList& sopInstanceUIDs, const QStringList& filePaths, const QStringList& tags);
+
   /// Store copy of the dataset in database folder.
   /// If the original file is available then that will be inserted. If not then a file is created from the dataset object.
+  /// If moveOriginalFile is true, the original file is moved instead of copied.
   bool storeDatasetFile(const ctkDICOMItem& dataset, const QString& originalFilePath,
-    const QString& studyInstanceUID, const QString& seriesInstanceUID, const QString& sopInstanceUID, QString& storedFilePath);
+    const QString& studyInstanceUID, const QString& seriesInstanceUID, const QString& sopInstanceUID, QString& storedFilePath,
+    bool moveOriginalFile = false);
 
   /// Helper function that generates folders for storing an instance in the database.
   /// Folders are based on UIDs, but may be shortened.
@@ -87,6 +105,21 @@ public:
   /// Copy the complete list of files to an extra table
   QStringList allFilesInDatabase();
 
+  /// Keys touched by the instances inserted through this object since the last displayed fields update.
+  /// updateDisplayedFields() only recomputes the displayed fields of these instances, series, studies and patients.
+  QMap<QString /*SOPInstanceUID*/, QString /*SeriesInstanceUID*/> DisplayedFieldsDirtyInstances;
+  QSet<QString> DisplayedFieldsDirtySeries;
+  QSet<QString> DisplayedFieldsDirtyStudies;
+  QSet<QString> DisplayedFieldsDirtyPatientIDs;
+  void markDisplayedFieldsDirty(const QString& sopInstanceUID, const QString& seriesInstanceUID,
+    const QString& studyInstanceUID, const QString& patientID);
+  void clearDisplayedFieldsDirtyKeys();
+  /// Read the records of the dirty series, studies and patients, keyed as in the displayed fields maps,
+  /// with one query per chunk of keys instead of one query per key.
+  void loadDirtyDisplayedFields(QMap<QString, QMap<QString, QString> >& loadedSeries,
+                                QMap<QString, QMap<QString, QString> >& loadedStudies,
+                                QMap<QString, QMap<QString, QString> >& loadedPatients);
+
   /// Update database tables from the displayed fields determined by the plugin rules
   /// \return Success flag
   bool applyDisplayedFieldsChanges( QMap<QString, QMap<QString, QString> > &displayedFieldsMapSeries,
@@ -148,6 +181,10 @@ public:
   QSet<QString> InsertedStudyUIDsCache;
   QSet<QString> InsertedSeriesUIDsCache;
 
+  /// Statements kept prepared across inserts, see preparedQuery().
+  /// Key is the connection name and the query string.
+  QHash<QString, QSharedPointer<QSqlQuery> > PreparedQueries;
+
   /// resets the variables to new inserts won't be fooled by leftover values
   void resetLastInsertedValues();
 
@@ -163,6 +200,24 @@ public:
   bool openTagCacheDatabase();
   void precacheTags(const ctkDICOMItem& dataset, const QString sopInstanceUID);
 
+  /// In-memory least recently used cache in front of the TagCache table.
+  /// Maps SOP instance UID to the tag values (as stored in the TagCache table)
+  /// that have been read or written. Cost of an instance is its number of tags.
+  /// All access must be protected by TagValueCacheMutex.
+  QCache<QString, QHash<QString, QString> > TagValueCache;
+  mutable QMutex TagValueCacheMutex;
+  qint64 TagValueCacheHitCount;
+  qint64 TagValueCacheMissCount;
+  /// Return true and set value if the tag of the instance is in the in-memory cache
+  bool lookupTagValueCache(const QString& sopInstanceUID, const QString& tag, QString& value);
+  void insertTagValueCache(const QString& sopInstanceUID, const QString& tag, const QString& value);
+  void removeFromTagValueCache(const QString& sopInstanceUID);
+  void clearTagValueCache();
+
+  /// Apply TuningProfile settings to the connection
+  void applyTuningProfile(QSqlDatabase& database);
+  QVariantMap TuningProfile;
+
   // Return true if a new item is inserted
   bool insertPatientStudySeries(const ctkDICOMItem& dataset, const QString& patientID, const QString& patientsName);
   bool insertPatient(const ctkDICOMItem& dataset, int& databasePatientID);
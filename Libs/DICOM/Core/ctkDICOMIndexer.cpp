@@ -30,6 +30,7 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QDebug>
+#include <QThreadPool>
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
 #include <QElapsedTimer>
 #endif
@@ -60,11 +61,72 @@ static ctkLogger logger("org.commontk.dicom.DICOMIndexer" );
 /// Increasing cache size increases maximum memory usage, very low cache size
 /// slows down database insertion.
 static int REQUEST_RESULTS_CACHE_MAXIMUM_SIZE = 5000;
+
+/// Parser threads pause when this many results are waiting to be inserted
+/// into the database, to keep memory usage bounded if parsing is faster than insertion.
+static int REQUEST_RESULTS_PARSER_PAUSE_SIZE = 2 * REQUEST_RESULTS_CACHE_MAXIMUM_SIZE;
+
+/// How often the worker thread reports progress and checks if parsing results
+/// have to be written into the database while parser threads are running.
+static int PARSER_PROGRESS_INTERVAL_MSEC = 100;
 //------------------------------------------------------------------------------
 
 
 //------------------------------------------------------------------------------
-// ctkDICOMIndexerPrivate methods
+// ctkDICOMIndexerPrivateParser methods
+
+//------------------------------------------------------------------------------
+ctkDICOMIndexerPrivateParser::ctkDICOMIndexerPrivateParser(DICOMIndexingQueue* queue, DICOMParsingBatch* batch)
+  : RequestQueue(queue)
+  , Batch(batch)
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMIndexerPrivateParser::~ctkDICOMIndexerPrivateParser()
+{
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivateParser::run()
+{
+  while (!this->RequestQueue->isStopRequested())
+  {
+    int fileIndex = this->Batch->NextFileIndex.fetchAndAddOrdered(1);
+    if (fileIndex >= this->Batch->FilePaths.size())
+    {
+      break;
+    }
+    const QString& filePath = this->Batch->FilePaths.at(fileIndex);
+
+    ctkDICOMDatabase::IndexingResult indexingResult;
+    indexingResult.dataset = QSharedPointer<ctkDICOMItem>(new ctkDICOMItem);
+    indexingResult.dataset->InitializeFromFileUntilTag(filePath, this->Batch->StopParsingAtElement);
+    if (indexingResult.dataset->IsInitialized())
+    {
+      indexingResult.filePath = filePath;
+      indexingResult.copyFile = this->Batch->CopyFile;
+      indexingResult.overwriteExistingDataset = this->Batch->AlreadyInDatabase.at(fileIndex);
+      this->RequestQueue->pushIndexingResult(indexingResult);
+    }
+    else
+    {
+      logger.warn(QString("Could not read DICOM file:") + filePath);
+    }
+    this->Batch->ParsedFileCount.ref();
+
+    // Wait for the worker thread to write pending results into the database
+    while (this->RequestQueue->indexingResultsCount() >= REQUEST_RESULTS_PARSER_PAUSE_SIZE
+      && !this->RequestQueue->isStopRequested())
+    {
+      QThread::msleep(10);
+    }
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// ctkDICOMIndexerPrivateWorker methods
 
 
 //------------------------------------------------------------------------------
@@ -87,6 +149,7 @@ void ctkDICOMIndexerPrivateWorker::start()
 {
   emit updatingDatabase(true);
   ctkDICOMDatabase database;
+  database.setTuningProfile(this->RequestQueue->tuningProfile());
   database.openDatabase(this->RequestQueue->databaseFilename());
   database.setTagsToPrecache(this->RequestQueue->tagsToPrecache());
   database.setTagsToExcludeFromStorage(this->RequestQueue->tagsToExcludeFromStorage());
@@ -183,16 +246,13 @@ void ctkDICOMIndexerPrivateWorker::processIndexingRequest(DICOMIndexingQueue::In
 #endif
   timeProbe.start();
 
-  int currentFileIndex = 0;
+  DICOMParsingBatch batch;
+  batch.CopyFile = indexingRequest.copyFile;
+  batch.StopParsingAtElement = this->stopParsingAtElement();
   int alreadyAddedFileCount = 0;
   QStringList alreadyAddedFiles;
   foreach(const QString& filePath, indexingRequest.inputFilesPath)
   {
-    int percent = int(this->TimePercentageIndexing * (this->CompletedRequestCount + double(currentFileIndex++) / double(indexingRequest.inputFilesPath.size()))
-                      / double(this->CompletedRequestCount + this->RemainingRequestCount + 1));
-    emit this->progress(percent);
-    emit progressDetail(filePath);
-
     QDateTime fileModifiedTime = QFileInfo(filePath).lastModified();
     bool datasetAlreadyInDatabase = this->ModifiedTimeForFilepath.contains(filePath);
     if (datasetAlreadyInDatabase && this->ModifiedTimeForFilepath[filePath] >= fileModifiedTime)
@@ -205,15 +265,60 @@ void ctkDICOMIndexerPrivateWorker::processIndexingRequest(DICOMIndexingQueue::In
       continue;
     }
     this->ModifiedTimeForFilepath[filePath] = fileModifiedTime;
+    batch.FilePaths << filePath;
+    batch.AlreadyInDatabase << datasetAlreadyInDatabase;
+  }
+
+  if (alreadyAddedFileCount > 0)
+  {
+    logger.debug(
+        QString("Skipped %1 files that were already in the database: %2...")
+            .arg(alreadyAddedFileCount)
+            .arg(alreadyAddedFiles.join(", "))
+        );
+  }
+
+  int numberOfThreads = qMin(this->RequestQueue->numberOfParserThreads(), batch.FilePaths.size());
+  if (numberOfThreads > 1)
+  {
+    this->parseFilesInParallel(batch, numberOfThreads, database);
+  }
+  else
+  {
+    this->parseFiles(batch, database);
+  }
+
+  if (this->RequestQueue->isIndexingRequestsEmpty())
+  {
+    emit progressStep(ctkDICOMIndexer::tr("Updating database fields"));
+    this->writeIndexingResultsToDatabase(database);
+    emit progressStep(ctkDICOMIndexer::tr("Parsing DICOM files"));
+  }
+
+  float elapsedTimeInSeconds = timeProbe.elapsed() / 1000.0;
+  logger.debug(QString("DICOM indexer has successfully processed %1 files using %2 parser threads [%3s]")
+              .arg(batch.ParsedFileCount.loadAcquire() + alreadyAddedFileCount)
+              .arg(qMax(numberOfThreads, 1))
+              .arg(QString::number(elapsedTimeInSeconds, 'f', 2)));
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivateWorker::parseFiles(DICOMParsingBatch& batch, ctkDICOMDatabase& database)
+{
+  for (int fileIndex = 0; fileIndex < batch.FilePaths.size(); ++fileIndex)
+  {
+    const QString& filePath = batch.FilePaths.at(fileIndex);
+    this->emitParsingProgress(batch, fileIndex);
+    emit progressDetail(filePath);
 
     ctkDICOMDatabase::IndexingResult indexingResult;
     indexingResult.dataset = QSharedPointer<ctkDICOMItem>(new ctkDICOMItem);
-    indexingResult.dataset->InitializeFromFile(filePath);
+    indexingResult.dataset->InitializeFromFileUntilTag(filePath, batch.StopParsingAtElement);
     if (indexingResult.dataset->IsInitialized())
     {
       indexingResult.filePath = filePath;
-      indexingResult.copyFile = indexingRequest.copyFile;
-      indexingResult.overwriteExistingDataset = datasetAlreadyInDatabase;
+      indexingResult.copyFile = batch.CopyFile;
+      indexingResult.overwriteExistingDataset = batch.AlreadyInDatabase.at(fileIndex);
       int resultsCount = this->RequestQueue->pushIndexingResult(indexingResult);
       if (resultsCount >= REQUEST_RESULTS_CACHE_MAXIMUM_SIZE)
       {
@@ -226,34 +331,130 @@ void ctkDICOMIndexerPrivateWorker::processIndexingRequest(DICOMIndexingQueue::In
     {
       logger.warn(QString("Could not read DICOM file:") + filePath);
     }
+    batch.ParsedFileCount.ref();
 
     if (this->RequestQueue->isStopRequested())
     {
       break;
     }
   }
+}
 
-  if (alreadyAddedFileCount > 0)
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivateWorker::parseFilesInParallel(DICOMParsingBatch& batch, int numberOfThreads, ctkDICOMDatabase& database)
+{
+  QThreadPool parserPool;
+  parserPool.setMaxThreadCount(numberOfThreads);
+  for (int threadIndex = 0; threadIndex < numberOfThreads; ++threadIndex)
   {
-    logger.debug(
-        QString("Skipped %1 files that were already in the database: %2...")
-            .arg(alreadyAddedFileCount)
-            .arg(alreadyAddedFiles.join(", "))
-        );
+    parserPool.start(new ctkDICOMIndexerPrivateParser(this->RequestQueue, &batch));
   }
 
-  if (this->RequestQueue->isIndexingRequestsEmpty())
+  // The database connection is owned by this thread, therefore parsing results
+  // are written here while parser threads keep filling the queue.
+  bool parsingCompleted = false;
+  while (!parsingCompleted)
   {
-    emit progressStep(ctkDICOMIndexer::tr("Updating database fields"));
-    this->writeIndexingResultsToDatabase(database);
-    emit progressStep(ctkDICOMIndexer::tr("Parsing DICOM files"));
+    parsingCompleted = parserPool.waitForDone(PARSER_PROGRESS_INTERVAL_MSEC);
+    int parsedFileCount = batch.ParsedFileCount.loadAcquire();
+    this->emitParsingProgress(batch, parsedFileCount);
+    if (parsedFileCount > 0)
+    {
+      emit progressDetail(batch.FilePaths.at(parsedFileCount - 1));
+    }
+    if (!parsingCompleted
+      && this->RequestQueue->indexingResultsCount() >= REQUEST_RESULTS_CACHE_MAXIMUM_SIZE)
+    {
+      emit progressStep(ctkDICOMIndexer::tr("Updating database fields"));
+      this->writeIndexingResultsToDatabase(database);
+      emit progressStep(ctkDICOMIndexer::tr("Parsing DICOM files"));
+    }
   }
+}
 
-  float elapsedTimeInSeconds = timeProbe.elapsed() / 1000.0;
-  logger.debug(QString("DICOM indexer has successfully processed %1 files [%2s]")
-              .arg(currentFileIndex).arg(QString::number(elapsedTimeInSeconds, 'f', 2)));
+//------------------------------------------------------------------------------
+DcmTagKey ctkDICOMIndexerPrivateWorker::stopParsingAtElement()
+{
+  if (!this->RequestQueue->headerOnlyParsing())
+  {
+    return DCM_UndefinedTagKey;
+  }
+
+  // Tags that ctkDICOMDatabase reads from the dataset when inserting it
+  // into the Patients, Studies, Series and Images tables.
+  static const DcmTagKey databaseTags[] =
+  {
+    DCM_SpecificCharacterSet, DCM_SOPInstanceUID,
+    DCM_PatientName, DCM_PatientID, DCM_PatientBirthDate, DCM_PatientBirthTime,
+    DCM_PatientSex, DCM_PatientAge, DCM_PatientComments,
+    DCM_StudyInstanceUID, DCM_StudyID, DCM_StudyDate, DCM_StudyTime, DCM_AccessionNumber,
+    DCM_ModalitiesInStudy, DCM_InstitutionName, DCM_PerformingPhysicianName,
+    DCM_ReferringPhysicianName, DCM_StudyDescription,
+    DCM_SeriesInstanceUID, DCM_SeriesDate, DCM_SeriesTime, DCM_SeriesDescription,
+    DCM_Modality, DCM_BodyPartExamined, DCM_FrameOfReferenceUID, DCM_ContrastBolusAgent,
+    DCM_ScanningSequence, DCM_SeriesNumber, DCM_AcquisitionNumber, DCM_EchoNumbers,
+    DCM_TemporalPositionIdentifier
+  };
+
+  QStringList tagsToParse = this->RequestQueue->tagsToParse();
+  DcmTagKey lastTag(0x0000, 0x0000);
+  if (!tagsToParse.isEmpty())
+  {
+    for (const DcmTagKey& tag : databaseTags)
+    {
+      if (lastTag < tag)
+      {
+        lastTag = tag;
+      }
+    }
+  }
+
+  QStringList tags = tagsToParse + this->RequestQueue->tagsToPrecache();
+  foreach(const QString& tag, tags)
+  {
+    QStringList groupElement = tag.split(",");
+    bool groupValid = false;
+    bool elementValid = false;
+    DcmTagKey tagKey;
+    if (groupElement.size() == 2)
+    {
+      tagKey.set(groupElement[0].toUShort(&groupValid, 16), groupElement[1].toUShort(&elementValid, 16));
+    }
+    if (!groupValid || !elementValid)
+    {
+      logger.warn(QString("Invalid tag, parsing the entire file: %1").arg(tag));
+      return DCM_UndefinedTagKey;
+    }
+    if (lastTag < tagKey)
+    {
+      lastTag = tagKey;
+    }
+  }
+
+  if (tagsToParse.isEmpty() && lastTag < DCM_PixelData)
+  {
+    return DCM_PixelData;
+  }
+
+  // Stop right after the last tag that is needed
+  if (lastTag.getElement() == 0xffff)
+  {
+    if (lastTag.getGroup() == 0xffff)
+    {
+      return DCM_UndefinedTagKey;
+    }
+    return DcmTagKey(lastTag.getGroup() + 1, 0x0000);
+  }
+  return DcmTagKey(lastTag.getGroup(), lastTag.getElement() + 1);
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivateWorker::emitParsingProgress(const DICOMParsingBatch& batch, int parsedFileCount)
+{
+  int percent = int(this->TimePercentageIndexing * (this->CompletedRequestCount + double(parsedFileCount) / double(batch.FilePaths.size()))
+                    / double(this->CompletedRequestCount + this->RemainingRequestCount + 1));
+  emit this->progress(percent);
+}
 
 //------------------------------------------------------------------------------
 void ctkDICOMIndexerPrivateWorker::writeIndexingResultsToDatabase(ctkDICOMDatabase& database)
@@ -294,6 +495,8 @@ ctkDICOMIndexerPrivate::ctkDICOMIndexerPrivate(ctkDICOMIndexer& o)
   , BackgroundImportEnabled(false)
   , FollowSymlinks(true)
 {
+  this->RequestQueue.setNumberOfParserThreads(qMax(QThread::idealThreadCount(), 1));
+
   ctkDICOMIndexerPrivateWorker* worker = new ctkDICOMIndexerPrivateWorker(&this->RequestQueue);
   worker->moveToThread(&this->WorkerThread);
 
@@ -305,6 +508,8 @@ ctkDICOMIndexerPrivate::ctkDICOMIndexerPrivate(ctkDICOMIndexer& o)
   connect(worker, &ctkDICOMIndexerPrivateWorker::progressDetail, q_ptr, &ctkDICOMIndexer::progressDetail);
   connect(worker, &ctkDICOMIndexerPrivateWorker::progressStep, q_ptr, &ctkDICOMIndexer::progressStep);
   connect(worker, &ctkDICOMIndexerPrivateWorker::updatingDatabase, q_ptr, &ctkDICOMIndexer::updatingDatabase);
+  // Connected first, so that the database object is up to date when indexingComplete is emitted
+  connect(worker, &ctkDICOMIndexerPrivateWorker::indexingComplete, this, &ctkDICOMIndexerPrivate::clearDatabaseTagValueCache);
   connect(worker, &ctkDICOMIndexerPrivateWorker::indexingComplete, q_ptr, &ctkDICOMIndexer::indexingComplete);
 
   this->WorkerThread.start();
@@ -320,6 +525,15 @@ ctkDICOMIndexerPrivate::~ctkDICOMIndexerPrivate()
   q->setDatabase(nullptr);
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMIndexerPrivate::clearDatabaseTagValueCache()
+{
+  if (this->Database)
+  {
+    this->Database->clearTagValueCache();
+  }
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMIndexerPrivate::pushIndexingRequest(const DICOMIndexingQueue::IndexingRequest& request)
 {
@@ -344,6 +558,53 @@ CTK_SET_CPP(ctkDICOMIndexer, bool, setBackgroundImportEnabled, BackgroundImportE
 CTK_GET_CPP(ctkDICOMIndexer, bool, followSymlinks, FollowSymlinks);
 CTK_SET_CPP(ctkDICOMIndexer, bool, setFollowSymlinks, FollowSymlinks);
 
+//------------------------------------------------------------------------------
+void ctkDICOMIndexer::setNumberOfParserThreads(int numberOfThreads)
+{
+  Q_D(ctkDICOMIndexer);
+  if (numberOfThreads < 1)
+  {
+    logger.warn(QString("Invalid number of parser threads: %1").arg(numberOfThreads));
+    return;
+  }
+  d->RequestQueue.setNumberOfParserThreads(numberOfThreads);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMIndexer::numberOfParserThreads() const
+{
+  Q_D(const ctkDICOMIndexer);
+  return d->RequestQueue.numberOfParserThreads();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexer::setHeaderOnlyParsing(bool headerOnly)
+{
+  Q_D(ctkDICOMIndexer);
+  d->RequestQueue.setHeaderOnlyParsing(headerOnly);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMIndexer::headerOnlyParsing() const
+{
+  Q_D(const ctkDICOMIndexer);
+  return d->RequestQueue.headerOnlyParsing();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMIndexer::setTagsToParse(const QStringList& tags)
+{
+  Q_D(ctkDICOMIndexer);
+  d->RequestQueue.setTagsToParse(tags);
+}
+
+//------------------------------------------------------------------------------
+QStringList ctkDICOMIndexer::tagsToParse() const
+{
+  Q_D(const ctkDICOMIndexer);
+  return d->RequestQueue.tagsToParse();
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMIndexer methods
 
@@ -372,6 +633,7 @@ void ctkDICOMIndexer::setDatabase(ctkDICOMDatabase* database)
     QObject::disconnect(d->Database, SIGNAL(opened()), this, SLOT(databaseFilenameChanged()));
     QObject::disconnect(d->Database, SIGNAL(tagsToPrecacheChanged()), this, SLOT(tagsToPrecacheChanged()));
     QObject::disconnect(d->Database, SIGNAL(tagsToExcludeFromStorageChanged()), this, SLOT(tagsToExcludeFromStorageChanged()));
+    QObject::disconnect(d->Database, SIGNAL(tuningProfileChanged()), this, SLOT(tuningProfileChanged()));
   }
   d->Database = database;
   if (d->Database)
@@ -379,13 +641,16 @@ void ctkDICOMIndexer::setDatabase(ctkDICOMDatabase* database)
     QObject::connect(d->Database, SIGNAL(opened()), this, SLOT(databaseFilenameChanged()));
     QObject::connect(d->Database, SIGNAL(tagsToPrecacheChanged()), this, SLOT(tagsToPrecacheChanged()));
     QObject::connect(d->Database, SIGNAL(tagsToExcludeFromStorageChanged()), this, SLOT(tagsToExcludeFromStorageChanged()));
+    QObject::connect(d->Database, SIGNAL(tuningProfileChanged()), this, SLOT(tuningProfileChanged()));
     d->RequestQueue.setDatabaseFilename(d->Database->databaseFilename());
+    d->RequestQueue.setTuningProfile(d->Database->tuningProfile());
     d->RequestQueue.setTagsToPrecache(d->Database->tagsToPrecache());
     d->RequestQueue.setTagsToExcludeFromStorage(d->Database->tagsToExcludeFromStorage());
   }
   else
   {
     d->RequestQueue.setDatabaseFilename(QString());
+    d->RequestQueue.setTuningProfile(QVariantMap());
     d->RequestQueue.setTagsToPrecache(QStringList());
     d->RequestQueue.setTagsToExcludeFromStorage(QStringList());
   }
@@ -405,10 +670,12 @@ void ctkDICOMIndexer::databaseFilenameChanged()
   if (d->Database)
   {
     d->RequestQueue.setDatabaseFilename(d->Database->databaseFilename());
+    d->RequestQueue.setTuningProfile(d->Database->tuningProfile());
   }
   else
   {
     d->RequestQueue.setDatabaseFilename(QString());
+    d->RequestQueue.setTuningProfile(QVariantMap());
   }
 }
 
@@ -440,6 +707,20 @@ void ctkDICOMIndexer::tagsToExcludeFromStorageChanged()
   }
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMIndexer::tuningProfileChanged()
+{
+  Q_D(ctkDICOMIndexer);
+  if (d->Database)
+  {
+    d->RequestQueue.setTuningProfile(d->Database->tuningProfile());
+  }
+  else
+  {
+    d->RequestQueue.setTuningProfile(QVariantMap());
+  }
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMIndexer::addFile(ctkDICOMDatabase* db, const QString filePath, bool copyFile/*=false*/)
 {
@@ -41,6 +41,9 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMIndexer : public QObject
   Q_PROPERTY(bool backgroundImportEnabled READ isBackgroundImportEnabled WRITE setBackgroundImportEnabled)
   Q_PROPERTY(bool followSymlinks READ followSymlinks WRITE setFollowSymlinks)
   Q_PROPERTY(bool importing READ isImporting)
+  Q_PROPERTY(int numberOfParserThreads READ numberOfParserThreads WRITE setNumberOfParserThreads)
+  Q_PROPERTY(bool headerOnlyParsing READ headerOnlyParsing WRITE setHeaderOnlyParsing)
+  Q_PROPERTY(QStringList tagsToParse READ tagsToParse WRITE setTagsToParse)
 
 public:
   explicit ctkDICOMIndexer(QObject *parent = 0);
@@ -62,6 +65,30 @@ public:
   void setFollowSymlinks(bool);
   bool followSymlinks() const;
 
+  /// Number of threads used for parsing DICOM files during indexing.
+  /// Parsing results are still written into the database by a single thread.
+  /// If set to 1 then files are parsed in the indexing thread.
+  /// Values smaller than 1 are ignored.
+  /// By default it is the number of processor cores (QThread::idealThreadCount()).
+  void setNumberOfParserThreads(int);
+  int numberOfParserThreads() const;
+
+  /// If enabled, files are only read until the pixel data element (7FE0,0010),
+  /// or until the last element listed in tagsToParse, because the database does not
+  /// use any later elements. This avoids reading large bulk data, such as multiframe
+  /// pixel data, from disk. Tags to precache are always parsed.
+  /// Enabled by default.
+  void setHeaderOnlyParsing(bool);
+  bool headerOnlyParsing() const;
+
+  /// If not empty and header-only parsing is enabled then parsing of each file stops
+  /// right after the largest tag of this list, the tags to precache and the tags
+  /// the database index requires (patient, study, series and instance attributes).
+  /// Tags are specified as "gggg,eeee" hexadecimal strings.
+  /// Empty by default (parsing stops at pixel data).
+  void setTagsToParse(const QStringList& tags);
+  QStringList tagsToParse() const;
+
   /// Returns with true if background importing is currently in progress.
   bool isImporting();
 
@@ -141,6 +168,7 @@ protected Q_SLOTS:
   void databaseFilenameChanged();
   void tagsToPrecacheChanged();
   void tagsToExcludeFromStorageChanged();
+  void tuningProfileChanged();
 
 protected:
   QScopedPointer<ctkDICOMIndexerPrivate> d_ptr;
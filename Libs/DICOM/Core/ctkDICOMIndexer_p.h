@@ -22,6 +22,8 @@
 #define CTKDICOMINDEXERPRIVATE_H
 
 #include <QObject>
+#include <QRunnable>
+#include <QVariantMap>
 
 #include "ctkDICOMIndexer.h"
 #include "ctkDICOMItem.h"
@@ -48,7 +50,9 @@ public:
   };
 
   DICOMIndexingQueue()
-    : IsIndexing(false)
+    : NumberOfParserThreads(1)
+    , HeaderOnlyParsing(true)
+    , IsIndexing(false)
     , StopRequested(false)
     , Mutex(QMutex::Recursive)
   {
@@ -70,6 +74,18 @@ public:
     this->DatabaseFilename = filename;
   }
 
+  QVariantMap tuningProfile()
+  {
+    QMutexLocker locker(&this->Mutex);
+    return this->TuningProfile;
+  }
+
+  void setTuningProfile(const QVariantMap& profile)
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->TuningProfile = profile;
+  }
+
   QStringList tagsToPrecache()
   {
     QMutexLocker locker(&this->Mutex);
@@ -94,6 +110,42 @@ public:
     this->TagsToExcludeFromStorage = tags;
   }
 
+  int numberOfParserThreads() const
+  {
+    QMutexLocker locker(&this->Mutex);
+    return this->NumberOfParserThreads;
+  }
+
+  void setNumberOfParserThreads(int threads)
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->NumberOfParserThreads = threads;
+  }
+
+  bool headerOnlyParsing() const
+  {
+    QMutexLocker locker(&this->Mutex);
+    return this->HeaderOnlyParsing;
+  }
+
+  void setHeaderOnlyParsing(bool headerOnly)
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->HeaderOnlyParsing = headerOnly;
+  }
+
+  QStringList tagsToParse() const
+  {
+    QMutexLocker locker(&this->Mutex);
+    return this->TagsToParse;
+  }
+
+  void setTagsToParse(const QStringList& tags)
+  {
+    QMutexLocker locker(&this->Mutex);
+    this->TagsToParse = tags;
+  }
+
   void clear()
   {
     QMutexLocker locker(&this->Mutex);
@@ -192,9 +244,14 @@ protected:
   QList<ctkDICOMDatabase::IndexingResult> IndexingResults;
 
   QString DatabaseFilename;
+  QVariantMap TuningProfile;
   QStringList TagsToPrecache;
   QStringList TagsToExcludeFromStorage;
 
+  int NumberOfParserThreads;
+  bool HeaderOnlyParsing;
+  QStringList TagsToParse;
+
   bool IsIndexing;
   bool StopRequested;
 
@@ -202,6 +259,40 @@ protected:
 };
 
 
+/// List of files of an indexing request that are shared between parser threads.
+/// Each parser thread takes the next unprocessed file by incrementing NextFileIndex.
+struct DICOMParsingBatch
+{
+  QStringList FilePaths;
+  /// Same size as FilePaths, true if the file is already in the database
+  /// (with an older modification time) and has to be overwritten.
+  QList<bool> AlreadyInDatabase;
+  bool CopyFile;
+  /// Files are parsed until this element (DCM_UndefinedTagKey means entire file)
+  DcmTagKey StopParsingAtElement;
+
+  QAtomicInt NextFileIndex;
+  QAtomicInt ParsedFileCount;
+};
+
+
+/// Parses DICOM files of a DICOMParsingBatch in a thread pool thread and pushes
+/// the parsing results into the indexing queue. Writing the results into the
+/// database remains the responsibility of ctkDICOMIndexerPrivateWorker.
+class ctkDICOMIndexerPrivateParser : public QRunnable
+{
+public:
+  ctkDICOMIndexerPrivateParser(DICOMIndexingQueue* queue, DICOMParsingBatch* batch);
+  virtual ~ctkDICOMIndexerPrivateParser();
+
+  void run() override;
+
+private:
+  DICOMIndexingQueue* RequestQueue;
+  DICOMParsingBatch* Batch;
+};
+
+
 class ctkDICOMIndexerPrivateWorker : public QObject
 {
   Q_OBJECT
@@ -223,6 +314,15 @@ Q_SIGNALS:
 private:
 
   void processIndexingRequest(DICOMIndexingQueue::IndexingRequest& request, ctkDICOMDatabase& database);
+  /// Parse files of the batch one by one in the worker thread.
+  void parseFiles(DICOMParsingBatch& batch, ctkDICOMDatabase& database);
+  /// Parse files of the batch using a pool of parser threads while the
+  /// worker thread writes the parsing results into the database.
+  void parseFilesInParallel(DICOMParsingBatch& batch, int numberOfThreads, ctkDICOMDatabase& database);
+  /// Get the first element that does not need to be parsed, based on the
+  /// header-only parsing settings and the tags that will be cached.
+  DcmTagKey stopParsingAtElement();
+  void emitParsingProgress(const DICOMParsingBatch& batch, int parsedFileCount);
   void writeIndexingResultsToDatabase(ctkDICOMDatabase& database);
 
   DICOMIndexingQueue* RequestQueue;
@@ -259,7 +359,9 @@ public:
 Q_SIGNALS:
   void startWorker();
 
-  //public Q_SLOTS:
+public Q_SLOTS:
+  /// The worker writes through its own connection, drop the tag values that the database object keeps in memory
+  void clearDatabaseTagValueCache();
 
 public:
   DICOMIndexingQueue RequestQueue;
@@ -41,6 +41,7 @@ public:
 
   bool Canceled;
   QString DatabaseFilename;
+  QVariantMap TuningProfile;
   QStringList TagsToPrecache;
   QStringList TagsToExcludeFromStorage;
 };
@@ -88,6 +89,20 @@ QString ctkDICOMInserter::databaseFilename() const
   return d->DatabaseFilename;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMInserter::setTuningProfile(const QVariantMap &tuningProfile)
+{
+  Q_D(ctkDICOMInserter);
+  d->TuningProfile = tuningProfile;
+}
+
+//------------------------------------------------------------------------------
+QVariantMap ctkDICOMInserter::tuningProfile() const
+{
+  Q_D(const ctkDICOMInserter);
+  return d->TuningProfile;
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMInserter::setTagsToPrecache(const QStringList &tagsToPrecache)
 {
@@ -138,6 +153,7 @@ bool ctkDICOMInserter::addJobResponseSets(QList<QSharedPointer<ctkDICOMJobRespon
   QString dbConnectionName =
     "db_" + QString::number(reinterpret_cast<quint64>(QThread::currentThreadId()), 16);
 
+  database.setTuningProfile(d->TuningProfile);
   database.openDatabase(d->DatabaseFilename, dbConnectionName);
   database.setTagsToPrecache(d->TagsToPrecache);
   database.setTagsToExcludeFromStorage(d->TagsToExcludeFromStorage);
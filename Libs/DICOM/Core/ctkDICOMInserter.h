@@ -26,6 +26,7 @@
 
 // Qt includes
 #include <QObject>
+#include <QVariantMap>
 
 // CTK includes
 #include <ctkPimpl.h>
@@ -41,6 +42,7 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMInserter : public QObject
 {
   Q_OBJECT
   Q_PROPERTY(QString databaseFilename READ databaseFilename WRITE setDatabaseFilename);
+  Q_PROPERTY(QVariantMap tuningProfile READ tuningProfile WRITE setTuningProfile);
   Q_PROPERTY(QStringList tagsToPrecache READ tagsToPrecache WRITE setTagsToPrecache);
   Q_PROPERTY(QStringList tagsToExcludeFromStorage READ tagsToExcludeFromStorage WRITE setTagsToExcludeFromStorage);
 
@@ -52,6 +54,11 @@ public:
   void setDatabaseFilename(const QString& databaseFilename);
   QString databaseFilename() const;
 
+  /// Database TuningProfile
+  /// \sa ctkDICOMDatabase::tuningProfile
+  void setTuningProfile(const QVariantMap& tuningProfile);
+  QVariantMap tuningProfile() const;
+
   /// Database TagsToPrecache
   void setTagsToPrecache(const QStringList& tagsToPrecache);
   QStringList tagsToPrecache() const;
@@ -105,6 +105,18 @@ QString ctkDICOMInserterJob::databaseFilename() const
   return this->DatabaseFilename;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMInserterJob::setTuningProfile(const QVariantMap &tuningProfile)
+{
+  this->TuningProfile = tuningProfile;
+}
+
+//------------------------------------------------------------------------------
+QVariantMap ctkDICOMInserterJob::tuningProfile() const
+{
+  return this->TuningProfile;
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMInserterJob::setTagsToPrecache(const QStringList &tagsToPrecache)
 {
@@ -145,6 +157,7 @@ ctkDICOMJob* ctkDICOMInserterJob::generateCopy() const
   newInserterJob->setMaximumConcurrentJobsPerType(this->maximumConcurrentJobsPerType());
   newInserterJob->setPriority(this->priority());
   newInserterJob->setDatabaseFilename(this->databaseFilename());
+  newInserterJob->setTuningProfile(this->tuningProfile());
   newInserterJob->setTagsToPrecache(this->tagsToPrecache());
   newInserterJob->setTagsToExcludeFromStorage(this->tagsToExcludeFromStorage());
 
@@ -26,6 +26,7 @@
 
 // Qt includes 
 #include <QObject>
+#include <QVariantMap>
 #include <QSharedPointer>
 
 // ctkDICOMCore includes
@@ -40,6 +41,7 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMInserterJob : public ctkDICOMJob
 {
   Q_OBJECT
   Q_PROPERTY(QString databaseFilename READ databaseFilename WRITE setDatabaseFilename);
+  Q_PROPERTY(QVariantMap tuningProfile READ tuningProfile WRITE setTuningProfile);
   Q_PROPERTY(QStringList tagsToPrecache READ tagsToPrecache WRITE setTagsToPrecache);
   Q_PROPERTY(QStringList tagsToExcludeFromStorage READ tagsToExcludeFromStorage WRITE setTagsToExcludeFromStorage);
 
@@ -55,6 +57,11 @@ public:
   void setDatabaseFilename(const QString& databaseFilename);
   QString databaseFilename() const;
 
+  /// Database TuningProfile
+  /// \sa ctkDICOMDatabase::tuningProfile
+  void setTuningProfile(const QVariantMap& tuningProfile);
+  QVariantMap tuningProfile() const;
+
   /// Database TagsToPrecache
   void setTagsToPrecache(const QStringList& tagsToPrecache);
   QStringList tagsToPrecache() const;
@@ -71,6 +78,7 @@ public:
 
 protected:
   QString DatabaseFilename;
+  QVariantMap TuningProfile;
   QStringList TagsToPrecache;
   QStringList TagsToExcludeFromStorage;
 
@@ -22,6 +22,7 @@
 =========================================================================*/
 
 // Qt includes
+#include <QHash>
 #include <QThread>
 
 // ctkDICOMCore includes
@@ -89,6 +90,10 @@ void ctkDICOMInserterWorker::run()
 
   if (inserterJob->status() == ctkAbstractJob::JobStatus::Stopped)
     {
+    foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, inserterJob->jobResponseSetsShared())
+      {
+      jobResponseSet->removeTemporaryFile();
+      }
     emit inserterJob->canceled();
     this->onJobCanceled();
     inserterJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -112,9 +117,43 @@ void ctkDICOMInserterWorker::run()
     return;
     }
 
+  // The scheduler coalesces the job response sets of many jobs in one inserter job:
+  // report the progress once per job and series, except for instance level jobs
+  // since their listeners need the instance UIDs.
+  QList<ctkJobDetail> jobDetails;
+  QHash<QString, int> jobDetailIndexes;
   foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, jobResponseSets)
     {
-    emit inserterJob->progressJobDetail(jobResponseSet->jobResponseSetToDetail());
+    ctkJobDetail jobDetail = jobResponseSet->jobResponseSetToDetail().value<ctkJobDetail>();
+    if (jobDetail.TypeOfJob == ctkDICOMJobResponseSet::JobType::RetrieveSOPInstance ||
+        jobDetail.TypeOfJob == ctkDICOMJobResponseSet::JobType::StoreSOPInstance)
+      {
+      jobDetails.append(jobDetail);
+      continue;
+      }
+
+    QString jobDetailKey = QString("%1|%2|%3|%4").arg(jobDetail.JobUID)
+                                                 .arg(static_cast<int>(jobDetail.TypeOfJob))
+                                                 .arg(jobDetail.StudyInstanceUID)
+                                                 .arg(jobDetail.SeriesInstanceUID);
+    QHash<QString, int>::const_iterator indexIt = jobDetailIndexes.constFind(jobDetailKey);
+    if (indexIt == jobDetailIndexes.constEnd())
+      {
+      jobDetailIndexes.insert(jobDetailKey, jobDetails.count());
+      jobDetails.append(jobDetail);
+      continue;
+      }
+
+    ctkJobDetail& groupJobDetail = jobDetails[indexIt.value()];
+    groupJobDetail.SOPInstanceUID = jobDetail.SOPInstanceUID;
+    groupJobDetail.NumberOfDataSets += jobDetail.NumberOfDataSets;
+    }
+
+  foreach (const ctkJobDetail& jobDetail, jobDetails)
+    {
+    QVariant data;
+    data.setValue(jobDetail);
+    emit inserterJob->progressJobDetail(data);
     }
 
   inserterJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -149,6 +188,7 @@ void ctkDICOMInserterWorker::setJob(QSharedPointer<ctkAbstractJob> job)
   Superclass::setJob(job);
 
   d->Inserter->setDatabaseFilename(inserterJob->databaseFilename());
+  d->Inserter->setTuningProfile(inserterJob->tuningProfile());
   d->Inserter->setTagsToPrecache(inserterJob->tagsToPrecache());
   d->Inserter->setTagsToExcludeFromStorage(inserterJob->tagsToExcludeFromStorage());
 }
@@ -128,6 +128,29 @@ void ctkDICOMItem::InitializeFromFile(const QString& filename,
   InitializeFromItem(dataset, true);
 }
 
+void ctkDICOMItem::InitializeFromFileUntilTag(const QString& filename,
+                                                const DcmTagKey& stopParsingAtElement,
+                                                const E_TransferSyntax readXfer,
+                                                const E_GrpLenEncoding groupLength,
+                                                const Uint32 maxReadLength,
+                                                const E_FileReadMode readMode)
+{
+  DcmDataset *dataset;
+
+  DcmFileFormat fileformat;
+  OFCondition status = fileformat.loadFileUntilTag(filename.toUtf8().data(), readXfer, groupLength, maxReadLength, readMode, stopParsingAtElement);
+  dataset = fileformat.getAndRemoveDataset();
+
+  if (!status.good())
+  {
+    qDebug() << "Could not load " << filename << "\nDCMTK says: " << status.text();
+    delete dataset;
+    return;
+  }
+
+  InitializeFromItem(dataset, true);
+}
+
 void ctkDICOMItem::Serialize()
 {
   Q_D(ctkDICOMItem);
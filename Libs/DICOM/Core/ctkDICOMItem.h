@@ -96,6 +96,23 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMItem
                     const Uint32 maxReadLength = DCM_MaxReadLength,
                     const E_FileReadMode readMode = ERM_autoDetect);
 
+    ///
+    /// \brief For initialization from file, reading only the data elements
+    /// that precede stopParsingAtElement in the main dataset.
+    ///
+    /// The stop element and all elements after it are neither parsed nor loaded into memory,
+    /// therefore by default (stopping at PixelData) only the header of the file is read.
+    /// If stopParsingAtElement is DCM_UndefinedTagKey then the entire file is read.
+    ///
+    /// \warning The resulting dataset is incomplete, therefore it must not be used
+    /// for writing the object back to file.
+    virtual void InitializeFromFileUntilTag(const QString& filename,
+                    const DcmTagKey& stopParsingAtElement = DcmTagKey(0x7fe0, 0x0010),
+                    const E_TransferSyntax readXfer = EXS_Unknown,
+                    const E_GrpLenEncoding groupLength = EGL_noChange,
+                    const Uint32 maxReadLength = DCM_MaxReadLength,
+                    const E_FileReadMode readMode = ERM_autoDetect);
+
 
 
     /// \brief Save dataset to file
@@ -21,6 +21,9 @@
 
 =========================================================================*/
 
+// Qt includes
+#include <QFile>
+
 // ctkDICOMCore includes
 #include "ctkDICOMItem.h"
 #include "ctkDICOMJobResponseSet.h"
@@ -45,6 +48,7 @@ public:
 
   QString FilePath;
   bool CopyFile;
+  bool TemporaryFile;
   bool OverwriteExistingDataset;
 
   ctkDICOMJobResponseSet::JobType TypeOfJob;
@@ -72,6 +76,7 @@ ctkDICOMJobResponseSetPrivate::ctkDICOMJobResponseSetPrivate(ctkDICOMJobResponse
   this->SOPInstanceUID = "";
   this->ConnectionName = "";
   this->CopyFile = false;
+  this->TemporaryFile = false;
   this->OverwriteExistingDataset = false;
   this->FilePath = "";
 }
@@ -108,13 +113,13 @@ void ctkDICOMJobResponseSet::setFilePath(const QString &filePath)
     return;
     }
 
+  // the pixel data is not needed for the insertion in the database
   QSharedPointer<ctkDICOMItem> dataset =
     QSharedPointer<ctkDICOMItem>(new ctkDICOMItem);
-  dataset->InitializeFromFile(filePath);
+  dataset->InitializeFromFileUntilTag(filePath);
 
-  DcmItem dcmItem = dataset->GetDcmItem();
   OFString SOPInstanceUID;
-  dcmItem.findAndGetOFString(DCM_SOPInstanceUID, SOPInstanceUID);
+  dataset->GetDcmItem().findAndGetOFString(DCM_SOPInstanceUID, SOPInstanceUID);
 
   d->Datasets.insert(QString(SOPInstanceUID.c_str()), dataset);
 }
@@ -140,6 +145,33 @@ bool ctkDICOMJobResponseSet::copyFile() const
   return d->CopyFile;
 }
 
+//----------------------------------------------------------------------------
+void ctkDICOMJobResponseSet::setTemporaryFile(const bool &temporaryFile)
+{
+  Q_D(ctkDICOMJobResponseSet);
+  d->TemporaryFile = temporaryFile;
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMJobResponseSet::temporaryFile() const
+{
+  Q_D(const ctkDICOMJobResponseSet);
+  return d->TemporaryFile;
+}
+
+//----------------------------------------------------------------------------
+bool ctkDICOMJobResponseSet::removeTemporaryFile()
+{
+  Q_D(ctkDICOMJobResponseSet);
+  if (!d->TemporaryFile || d->FilePath.isEmpty())
+    {
+    return false;
+    }
+
+  d->TemporaryFile = false;
+  return QFile::remove(d->FilePath);
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMJobResponseSet::setOverwriteExistingDataset(const bool &overwriteExistingDataset)
 {
@@ -349,8 +381,10 @@ void ctkDICOMJobResponseSet::deepCopy(ctkDICOMJobResponseSet *node)
     return;
     }
 
-  this->setFilePath(node->filePath());
+  // the datasets are copied below, do not load them again from the file
+  d->FilePath = node->filePath();
   this->setCopyFile(node->copyFile());
+  this->setTemporaryFile(node->temporaryFile());
   this->setOverwriteExistingDataset(node->overwriteExistingDataset());
   this->setTypeOfJob(node->typeOfJob());
   this->setJobUID(node->jobUID());
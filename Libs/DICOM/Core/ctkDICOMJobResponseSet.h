@@ -42,6 +42,7 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMJobResponseSet : public QObject
   Q_ENUMS(JobType)
   Q_PROPERTY(QString filePath READ filePath WRITE setFilePath);
   Q_PROPERTY(bool copyFile READ copyFile WRITE setCopyFile);
+  Q_PROPERTY(bool temporaryFile READ temporaryFile WRITE setTemporaryFile);
   Q_PROPERTY(bool overwriteExistingDataset READ overwriteExistingDataset WRITE setOverwriteExistingDataset);
   Q_PROPERTY(JobType typeOfJob READ typeOfJob WRITE setTypeOfJob);
   Q_PROPERTY(QString jobUID READ jobUID WRITE setJobUID);
@@ -55,7 +56,9 @@ public:
   explicit ctkDICOMJobResponseSet(QObject* parent = 0);
   virtual ~ctkDICOMJobResponseSet();
 
-  /// File Path
+  /// File Path.
+  /// Setting the file path loads the header of the file (the elements before
+  /// the pixel data) as dataset: the database stores the file itself.
   void setFilePath(const QString& filePath);
   QString filePath() const;
 
@@ -64,6 +67,20 @@ public:
   void setCopyFile(const bool& copyFile);
   bool copyFile() const;
 
+  /// Temporary File
+  /// The file at filePath only exists to be inserted in the database
+  /// (e.g. an object received in streaming mode): the database moves it into
+  /// its storage folder instead of copying it, and deletes it otherwise.
+  /// false as default
+  void setTemporaryFile(const bool& temporaryFile);
+  bool temporaryFile() const;
+
+  /// Delete the temporary file at filePath, to be called when the job response
+  /// set is discarded instead of inserted in the database (e.g. canceled job).
+  /// Does nothing if the file is not a temporary file.
+  /// \return true if the file has been deleted
+  bool removeTemporaryFile();
+
   /// Overwrite existing dataset
   /// false as default
   void setOverwriteExistingDataset(const bool& overwriteExistingDataset);
@@ -21,6 +21,9 @@
 #include <stdexcept>
 
 // Qt includes
+#include <QFile>
+#include <QStandardPaths>
+#include <QUuid>
 
 // ctkDICOMCore includes
 #include "ctkDICOMRetrieve.h"
@@ -76,6 +79,43 @@ public:
       return EC_IllegalCall;
     };
 
+  // job response set for an instance received in response to a CGET
+  QSharedPointer<ctkDICOMJobResponseSet> createJobResponseSet(const QString& sopInstanceUID)
+    {
+      QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet =
+        QSharedPointer<ctkDICOMJobResponseSet>(new ctkDICOMJobResponseSet);
+      if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveSOPInstance)
+        {
+        jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::RetrieveSOPInstance);
+        }
+      else if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveSeries)
+        {
+        jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::RetrieveSeries);
+        }
+      else if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveStudy)
+        {
+        jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::RetrieveStudy);
+        }
+      jobResponseSet->setPatientID(this->retrieve->patientID());
+      jobResponseSet->setStudyInstanceUID(this->retrieve->studyInstanceUID());
+      jobResponseSet->setSeriesInstanceUID(this->retrieve->seriesInstanceUID());
+      jobResponseSet->setSOPInstanceUID(sopInstanceUID);
+      jobResponseSet->setConnectionName(this->retrieve->connectionName());
+      jobResponseSet->setJobUID(this->retrieve->jobUID());
+      jobResponseSet->setCopyFile(true);
+      return jobResponseSet;
+    }
+
+  void addJobResponseSet(QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet)
+    {
+      if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveSeries)
+        {
+        emit this->retrieve->progressJobDetail(jobResponseSet->jobResponseSetToDetail());
+        }
+
+      this->retrieve->addJobResponseSet(jobResponseSet);
+    }
+
   // called when a data set is coming in from a server in
   // response to a CGET
   virtual OFCondition handleSTORERequest(const T_ASC_PresentationContextID presID,
@@ -98,38 +138,9 @@ public:
       emit this->retrieve->progress(0);
       if (!this->retrieve->jobUID().isEmpty())
         {
-        QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet =
-          QSharedPointer<ctkDICOMJobResponseSet>(new ctkDICOMJobResponseSet);
-        if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveSOPInstance)
-          {
-          jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::RetrieveSOPInstance);
-          }
-        else if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveSeries)
-          {
-          jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::RetrieveSeries);
-          }
-        else if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveStudy)
-          {
-          jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::RetrieveStudy);
-          }
-        jobResponseSet->setPatientID(this->retrieve->patientID());
-        jobResponseSet->setStudyInstanceUID(this->retrieve->studyInstanceUID());
-        jobResponseSet->setSeriesInstanceUID(this->retrieve->seriesInstanceUID());
-        jobResponseSet->setSOPInstanceUID(qInstanceUID);
-        jobResponseSet->setConnectionName(this->retrieve->connectionName());
+        QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet = this->createJobResponseSet(qInstanceUID);
         jobResponseSet->setDataset(incomingObject);
-        jobResponseSet->setJobUID(this->retrieve->jobUID());
-        jobResponseSet->setCopyFile(true);
-
-        // To Do: this should be emitted for all the RetrieveTypes, but we should change the insert in the
-        // ctkDICOMRetrieveWorker to happen every 10 frames (configurable).
-        // i.e. a slot in ctkDICOMRetrieveWorker with a counter. When the counter > batchLimit -> insert
-        if (this->retrieve->getLastRetrieveType() == ctkDICOMRetrieve::RetrieveType::RetrieveSeries)
-          {
-          emit this->retrieve->progressJobDetail(jobResponseSet->jobResponseSetToDetail());
-          }
-
-        this->retrieve->addJobResponseSet(jobResponseSet);
+        this->addJobResponseSet(jobResponseSet);
         return EC_Normal;
         }
       else if (this->retrieve->dicomDatabase())
@@ -144,6 +155,61 @@ public:
         }
     };
 
+  // called instead of handleSTORERequest in streaming mode (DCMSCU_STORAGE_BIT_PRESERVING):
+  // the data set coming in from a server in response to a CGET is written to file
+  // while it is received, it is never loaded in memory
+  virtual OFCondition handleSTORERequestFile(T_ASC_PresentationContextID* presID,
+                                             const OFString& filename,
+                                             T_DIMSE_C_StoreRQ* request)
+    {
+      if (!this->retrieve || this->retrieve->wasCanceled())
+        {
+        return EC_IllegalCall;
+        }
+
+      // the same instance can be received by several retrieves at the same time
+      QString storedFilename = QString::fromLocal8Bit(filename.c_str());
+      if (storedFilename.endsWith(".dcm", Qt::CaseInsensitive))
+        {
+        storedFilename.chop(4);
+        }
+      storedFilename = QString("%1-%2.dcm")
+        .arg(storedFilename)
+        .arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+      OFCondition status = this->DcmSCU::handleSTORERequestFile(
+        presID, OFString(storedFilename.toLocal8Bit().constData()), request);
+      if (status.bad())
+        {
+        QFile::remove(storedFilename);
+        return status;
+        }
+
+      QString qInstanceUID(request->AffectedSOPInstanceUID);
+      emit this->retrieve->progress(
+        //: %1 is an instance UID
+        ctkDICOMRetrieve::tr("Got STORE request for %1").arg(qInstanceUID)
+      );
+      emit this->retrieve->progress(0);
+      if (!this->retrieve->jobUID().isEmpty())
+        {
+        // only the header travels with the job response set
+        QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet = this->createJobResponseSet(qInstanceUID);
+        jobResponseSet->setFilePath(storedFilename);
+        jobResponseSet->setTemporaryFile(true);
+        this->addJobResponseSet(jobResponseSet);
+        }
+      else if (this->retrieve->dicomDatabase())
+        {
+        bool storeFile = !this->retrieve->dicomDatabase()->isInMemory();
+        this->retrieve->dicomDatabase()->insert(storedFilename, storeFile, false);
+        if (storeFile)
+          {
+          QFile::remove(storedFilename);
+          }
+        }
+      return status;
+    };
+
   // called when status information from remote server
   // comes in from CGET
   virtual OFCondition handleCGETResponse(const T_ASC_PresentationContextID presID,
@@ -186,6 +252,8 @@ public:
   QString SOPInstanceUID;
   QString ConnectionName;
   QString JobUID;
+  bool StreamToDisk;
+  QString StorageDirectory;
 
   QSharedPointer<ctkDICOMDatabase> Database;
   ctkDICOMRetrieveSCUPrivate SCU;
@@ -193,6 +261,9 @@ public:
   QString MoveDestinationAETitle;
   QList<QSharedPointer<ctkDICOMJobResponseSet>> JobResponseSets;
 
+  /// Remove the job response sets and their temporary files
+  void clearJobResponseSets();
+
   bool initializeSCU(const QString& patientID,
                      const QString& studyInstanceUID,
                      const QString& seriesInstanceUID,
@@ -229,6 +300,8 @@ ctkDICOMRetrievePrivate::ctkDICOMRetrievePrivate(ctkDICOMRetrieve& obj)
   this->SeriesInstanceUID = "";
   this->ConnectionName = "";
   this->JobUID = "";
+  this->StreamToDisk = false;
+  this->StorageDirectory = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
 
   // Register the JPEG libraries in case we need them
   // (registration only happens once, so it's okay to call repeatedly)
@@ -259,7 +332,7 @@ ctkDICOMRetrievePrivate::ctkDICOMRetrievePrivate(ctkDICOMRetrieve& obj)
 
   this->SCU.setACSETimeout(3);
   this->SCU.setConnectionTimeout(3);
-  this->SCU.setStorageDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation).toStdString().c_str());
+  this->SCU.setStorageDir(this->StorageDirectory.toStdString().c_str());
 }
 
 //------------------------------------------------------------------------------
@@ -271,7 +344,7 @@ ctkDICOMRetrievePrivate::~ctkDICOMRetrievePrivate()
     this->SCU.releaseAssociation();
     }
 
-  this->JobResponseSets.clear();
+  this->clearJobResponseSets();
 }
 
 //------------------------------------------------------------------------------
@@ -355,6 +428,16 @@ bool ctkDICOMRetrievePrivate::initializeSCU(const QString& patientID,
   return true;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMRetrievePrivate::clearJobResponseSets()
+{
+  foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, this->JobResponseSets)
+    {
+    jobResponseSet->removeTemporaryFile();
+    }
+  this->JobResponseSets.clear();
+}
+
 //------------------------------------------------------------------------------
 bool ctkDICOMRetrievePrivate::move(const QString& patientID,
                                    const QString& studyInstanceUID,
@@ -364,7 +447,7 @@ bool ctkDICOMRetrievePrivate::move(const QString& patientID,
 {
   Q_Q(ctkDICOMRetrieve);
 
-  this->JobResponseSets.clear();
+  this->clearJobResponseSets();
   this->PatientID = patientID;
   this->StudyInstanceUID = studyInstanceUID;
   this->SeriesInstanceUID = seriesInstanceUID;
@@ -531,7 +614,7 @@ bool ctkDICOMRetrievePrivate::get(const QString& patientID,
 {
   Q_Q(ctkDICOMRetrieve);
 
-  this->JobResponseSets.clear();
+  this->clearJobResponseSets();
   this->PatientID = patientID;
   this->StudyInstanceUID = studyInstanceUID;
   this->SeriesInstanceUID = seriesInstanceUID;
@@ -587,6 +670,17 @@ bool ctkDICOMRetrievePrivate::get(const QString& patientID,
   emit q->progress(ctkDICOMRetrieve::tr("Found Presentation Context"));
   emit q->progress(1);
 
+  if (this->StreamToDisk)
+    {
+    QDir().mkpath(this->StorageDirectory);
+    this->SCU.setStorageDir(this->StorageDirectory.toStdString().c_str());
+    this->SCU.setStorageMode(DCMSCU_STORAGE_BIT_PRESERVING);
+    }
+  else
+    {
+    this->SCU.setStorageMode(DCMSCU_STORAGE_DISK);
+    }
+
   // do the actual move request
   OFCondition status = this->SCU.sendCGETRequest(this->PresentationContext, retrieveParameters, &responses);
 
@@ -882,6 +976,13 @@ void ctkDICOMRetrieve::removeJobResponseSet(QSharedPointer<ctkDICOMJobResponseSe
   d->JobResponseSets.removeOne(jobResponseSet);
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMRetrieve::clearJobResponseSets()
+{
+  Q_D(ctkDICOMRetrieve);
+  d->clearJobResponseSets();
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMRetrieve::setJobUID(const QString &jobUID)
 {
@@ -960,6 +1061,34 @@ int ctkDICOMRetrieve::connectionTimeout() const
   return d->SCU.getConnectionTimeout();
 }
 
+//-----------------------------------------------------------------------------
+void ctkDICOMRetrieve::setStreamToDisk(bool streamToDisk)
+{
+  Q_D(ctkDICOMRetrieve);
+  d->StreamToDisk = streamToDisk;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkDICOMRetrieve::streamToDisk() const
+{
+  Q_D(const ctkDICOMRetrieve);
+  return d->StreamToDisk;
+}
+
+//-----------------------------------------------------------------------------
+void ctkDICOMRetrieve::setStorageDirectory(const QString& storageDirectory)
+{
+  Q_D(ctkDICOMRetrieve);
+  d->StorageDirectory = storageDirectory;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkDICOMRetrieve::storageDirectory() const
+{
+  Q_D(const ctkDICOMRetrieve);
+  return d->StorageDirectory;
+}
+
 //-----------------------------------------------------------------------------
 bool ctkDICOMRetrieve::wasCanceled()
 {
@@ -48,6 +48,8 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMRetrieve : public QObject
   Q_PROPERTY(QString moveDestinationAETitle READ moveDestinationAETitle WRITE setMoveDestinationAETitle);
   Q_PROPERTY(bool keepAssociationOpen READ keepAssociationOpen WRITE setKeepAssociationOpen);
   Q_PROPERTY(int connectionTimeout READ connectionTimeout WRITE setConnectionTimeout);
+  Q_PROPERTY(bool streamToDisk READ streamToDisk WRITE setStreamToDisk);
+  Q_PROPERTY(QString storageDirectory READ storageDirectory WRITE setStorageDirectory);
   Q_PROPERTY(QString seriesInstanceUID READ seriesInstanceUID);
   Q_PROPERTY(QString studyInstanceUID READ studyInstanceUID);
   Q_PROPERTY(QString jobUID READ jobUID WRITE setJobUID);
@@ -86,6 +88,18 @@ public:
   /// connection timeout, default 3 sec.
   void setConnectionTimeout(const int timeout);
   int connectionTimeout() const;
+  /// Write the objects received by CGET to storageDirectory while they are received
+  /// (bit preserving), instead of receiving them in memory. The job response sets
+  /// then only hold the header of the objects and the path of their temporary file,
+  /// which the database moves to its storage folder.
+  /// Default false.
+  void setStreamToDisk(bool streamToDisk);
+  bool streamToDisk() const;
+  /// Folder where the objects are written in streaming mode. It should be on the
+  /// same volume as the database folder so the files can be moved without copy.
+  /// Default is the system temporary folder.
+  void setStorageDirectory(const QString& storageDirectory);
+  QString storageDirectory() const;
 
   /// operation is canceled?
   Q_INVOKABLE bool wasCanceled();
@@ -107,6 +121,9 @@ public:
   Q_INVOKABLE void addJobResponseSet(ctkDICOMJobResponseSet& jobResponseSet);
   void addJobResponseSet(QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet);
   void removeJobResponseSet(QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet);
+  /// Remove all the datasets of the last operation and delete the files they
+  /// were streamed to: the datasets that are inserted must be removed first.
+  Q_INVOKABLE void clearJobResponseSets();
   Q_INVOKABLE void setJobUID(const QString& jobUID);
   Q_INVOKABLE QString jobUID() const;
 
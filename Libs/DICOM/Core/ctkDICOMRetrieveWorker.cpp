@@ -22,6 +22,7 @@
 =========================================================================*/
 
 // ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
 #include "ctkDICOMJobResponseSet.h"
 #include "ctkDICOMRetrieveWorker_p.h"
 #include "ctkDICOMRetrieveJob.h"
@@ -156,6 +157,13 @@ void ctkDICOMRetrieveWorker::run()
     return;
     }
 
+  QSharedPointer<ctkDICOMDatabase> database = scheduler->dicomDatabaseShared();
+  if (scheduler->streamToDisk() && database && !database->isInMemory())
+    {
+    d->Retrieve->setStreamToDisk(true);
+    d->Retrieve->setStorageDirectory(database->databaseDirectory() + "/incoming");
+    }
+
   retrieveJob->setStatus(ctkAbstractJob::JobStatus::Running);
   emit retrieveJob->started();
 
@@ -176,6 +184,7 @@ void ctkDICOMRetrieveWorker::run()
           if (!d->Retrieve->getStudy(retrieveJob->studyInstanceUID(),
                                      retrieveJob->patientID()))
             {
+            d->Retrieve->clearJobResponseSets();
             emit retrieveJob->canceled();
             this->onJobCanceled();
             retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -187,6 +196,7 @@ void ctkDICOMRetrieveWorker::run()
                                       retrieveJob->seriesInstanceUID(),
                                       retrieveJob->patientID()))
             {
+            d->Retrieve->clearJobResponseSets();
             emit retrieveJob->canceled();
             this->onJobCanceled();
             retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -199,6 +209,7 @@ void ctkDICOMRetrieveWorker::run()
                                            retrieveJob->sopInstanceUID(),
                                            retrieveJob->patientID()))
             {
+            d->Retrieve->clearJobResponseSets();
             emit retrieveJob->canceled();
             this->onJobCanceled();
             retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -219,6 +230,7 @@ void ctkDICOMRetrieveWorker::run()
           if (!d->Retrieve->moveStudy(retrieveJob->studyInstanceUID(),
                                       retrieveJob->patientID()))
             {
+            d->Retrieve->clearJobResponseSets();
             emit retrieveJob->canceled();
             this->onJobCanceled();
             retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -230,6 +242,7 @@ void ctkDICOMRetrieveWorker::run()
                                        retrieveJob->seriesInstanceUID(),
                                        retrieveJob->patientID()))
             {
+            d->Retrieve->clearJobResponseSets();
             emit retrieveJob->canceled();
             this->onJobCanceled();
             retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -242,6 +255,7 @@ void ctkDICOMRetrieveWorker::run()
                                             retrieveJob->sopInstanceUID(),
                                             retrieveJob->patientID()))
             {
+            d->Retrieve->clearJobResponseSets();
             emit retrieveJob->canceled();
             this->onJobCanceled();
             retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -255,6 +269,7 @@ void ctkDICOMRetrieveWorker::run()
 
   if (retrieveJob->status() == ctkAbstractJob::JobStatus::Stopped)
     {
+    d->Retrieve->clearJobResponseSets();
     emit retrieveJob->canceled();
     this->onJobCanceled();
     retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -268,14 +283,21 @@ void ctkDICOMRetrieveWorker::run()
     newJob->setRetryCounter(0);
     newJob->setServer(*proxyServer);
     scheduler->addJob(newJob);
+    d->Retrieve->clearJobResponseSets();
     }
   else if (d->Retrieve->jobResponseSetsShared().count() > 0)
     {
-    // To Do: this insert should happen in batch of 10 frames (configurable),
+    // The scheduler coalesces the insertion with the responses of the other workers.
+    // To Do: the responses should be handed over while they are received,
     // instead of at the end of operation (all frames requested)).
     // This would avoid memory usage spikes when requesting a series or study with a lot of frames.
-    // NOTE: the memory release should happen as soon as we insert the response.
-    scheduler->insertJobResponseSets(d->Retrieve->jobResponseSetsShared());
+    QList<QSharedPointer<ctkDICOMJobResponseSet>> jobResponseSets = d->Retrieve->jobResponseSetsShared();
+    scheduler->insertJobResponseSets(jobResponseSets);
+    // the scheduler owns the streamed files from now on
+    foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, jobResponseSets)
+      {
+      d->Retrieve->removeJobResponseSet(jobResponseSet);
+      }
     }
 
   retrieveJob->setStatus(ctkAbstractJob::JobStatus::Finished);
@@ -23,6 +23,8 @@
 
 // ctkDICOMCore includes
 #include "ctkDICOMInserterJob.h"
+#include "ctkDICOMItem.h"
+#include "ctkDICOMJobResponseSet.h"
 #include "ctkDICOMQueryJob.h"
 #include "ctkDICOMRetrieveJob.h"
 #include "ctkDICOMScheduler.h"
@@ -39,12 +41,68 @@
 
 static ctkLogger logger ( "org.commontk.dicom.DICOMJobPool" );
 
+//------------------------------------------------------------------------------
+static void addToJobUIDsIndex(QHash<QString, QSet<QString>>& index, const QString& key, const QString& jobUID)
+{
+  if (!key.isEmpty())
+    {
+    index[key].insert(jobUID);
+    }
+}
+
+//------------------------------------------------------------------------------
+static void removeFromJobUIDsIndex(QHash<QString, QSet<QString>>& index, const QString& key, const QString& jobUID)
+{
+  QHash<QString, QSet<QString>>::iterator it = index.find(key);
+  if (it == index.end())
+    {
+    return;
+    }
+  it->remove(jobUID);
+  if (it->isEmpty())
+    {
+    index.erase(it);
+    }
+}
+
+//------------------------------------------------------------------------------
+static qint64 estimateJobResponseSetBytes(QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet)
+{
+  qint64 bytes = 0;
+  foreach (ctkDICOMItem* dataset, jobResponseSet->datasets())
+    {
+    if (dataset)
+      {
+      bytes += dataset->GetDcmItem().getLength();
+      }
+    }
+  return bytes;
+}
+
+//------------------------------------------------------------------------------
+static void findInJobUIDsIndex(const QHash<QString, QSet<QString>>& index, const QStringList& keys, QSet<QString>& jobUIDs)
+{
+  foreach (const QString& key, keys)
+    {
+    if (key.isEmpty())
+      {
+      continue;
+      }
+    QHash<QString, QSet<QString>>::const_iterator it = index.constFind(key);
+    if (it != index.constEnd())
+      {
+      jobUIDs.unite(it.value());
+      }
+    }
+}
+
 //------------------------------------------------------------------------------
 // ctkDICOMSchedulerPrivate methods
 
 //------------------------------------------------------------------------------
 ctkDICOMSchedulerPrivate::ctkDICOMSchedulerPrivate(ctkDICOMScheduler& obj)
   : q_ptr(&obj)
+  , mMutex(QMutex::Recursive)
 {
   ctk::setDICOMLogLevel(ctkErrorLogLevel::Info);
 
@@ -54,6 +112,18 @@ ctkDICOMSchedulerPrivate::ctkDICOMSchedulerPrivate(ctkDICOMScheduler& obj)
   this->RetryDelay = 100;
   this->MaximumNumberOfRetry = 3;
   this->MaximumPatientsQuery = 25;
+  this->NextReadyJobSequence = 0;
+
+  this->PendingJobResponseSetsBytes = 0;
+  this->PendingJobResponseSetsPriority = QThread::IdlePriority;
+  this->InsertBatchSize = 100;
+  this->InsertBatchBytes = 64 * 1024 * 1024;
+  this->InsertBatchInterval = 250;
+  this->StreamToDisk = false;
+  this->InsertTimer = new QTimer(this);
+  this->InsertTimer->setSingleShot(true);
+  this->InsertTimer->setInterval(this->InsertBatchInterval);
+  QObject::connect(this->InsertTimer, SIGNAL(timeout()), &obj, SLOT(flushJobResponseSets()));
 }
 
 //------------------------------------------------------------------------------
@@ -66,25 +136,145 @@ ctkDICOMSchedulerPrivate::~ctkDICOMSchedulerPrivate()
 //------------------------------------------------------------------------------
 int ctkDICOMSchedulerPrivate::getSameTypeJobsInThreadPoolQueueOrRunning(QSharedPointer<ctkDICOMJob> job)
 {
+  QMutexLocker ml(&this->mMutex);
+
+  // Only dispatched jobs can be queued or running
+  QSet<QString>& dispatchedJobUIDs = this->DispatchedJobUIDs[job->className()];
   int count = 0;
-  foreach (QSharedPointer<ctkDICOMJob> queuedJob, this->JobsQueue)
+  QSet<QString>::iterator it = dispatchedJobUIDs.begin();
+  while (it != dispatchedJobUIDs.end())
     {
-    if (queuedJob->jobUID() == job->jobUID())
+    QSharedPointer<ctkDICOMJob> dispatchedJob = this->JobsQueue.value(*it);
+    if (!dispatchedJob ||
+        (dispatchedJob->status() != ctkAbstractJob::JobStatus::Queued &&
+         dispatchedJob->status() != ctkAbstractJob::JobStatus::Running))
       {
+      // finished, canceled or stopped jobs do not become queued or running again
+      it = dispatchedJobUIDs.erase(it);
       continue;
       }
-
-    if ((queuedJob->status() == ctkAbstractJob::JobStatus::Queued ||
-         queuedJob->status() == ctkAbstractJob::JobStatus::Running) &&
-        queuedJob->className() == job->className())
+    if (*it != job->jobUID())
       {
       count++;
       }
+    ++it;
     }
 
   return count;
 }
 
+//------------------------------------------------------------------------------
+void ctkDICOMSchedulerPrivate::addReadyJob(QSharedPointer<ctkDICOMJob> job)
+{
+  ReadyJobKey key;
+  key.Priority = job->priority();
+  key.JobType = job->className();
+  key.Sequence = this->NextReadyJobSequence++;
+  this->ReadyJobs[key.Priority][key.JobType].insert(key.Sequence, job);
+  this->ReadyJobKeys.insert(job->jobUID(), key);
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMSchedulerPrivate::removeReadyJob(const QString& jobUID)
+{
+  QHash<QString, ReadyJobKey>::iterator keyIt = this->ReadyJobKeys.find(jobUID);
+  if (keyIt == this->ReadyJobKeys.end())
+    {
+    return false;
+    }
+
+  const ReadyJobKey& key = keyIt.value();
+  QMap<int, QMap<QString, QMap<quint64, QSharedPointer<ctkDICOMJob>>>>::iterator priorityIt =
+    this->ReadyJobs.find(key.Priority);
+  if (priorityIt != this->ReadyJobs.end())
+    {
+    QMap<QString, QMap<quint64, QSharedPointer<ctkDICOMJob>>>::iterator jobTypeIt = priorityIt->find(key.JobType);
+    if (jobTypeIt != priorityIt->end())
+      {
+      jobTypeIt->remove(key.Sequence);
+      if (jobTypeIt->isEmpty())
+        {
+        priorityIt->erase(jobTypeIt);
+        }
+      }
+    if (priorityIt->isEmpty())
+      {
+      this->ReadyJobs.erase(priorityIt);
+      }
+    }
+
+  this->ReadyJobKeys.erase(keyIt);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSchedulerPrivate::setJobPriority(QSharedPointer<ctkDICOMJob> job, QThread::Priority priority)
+{
+  bool ready = this->removeReadyJob(job->jobUID());
+  job->setPriority(priority);
+  if (ready)
+    {
+    this->addReadyJob(job);
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSchedulerPrivate::flushJobResponseSets()
+{
+  QList<QSharedPointer<ctkDICOMJobResponseSet>> jobResponseSets;
+  QThread::Priority priority;
+  {
+  QMutexLocker ml(&this->PendingJobResponseSetsMutex);
+  if (this->PendingJobResponseSets.isEmpty())
+    {
+    return;
+    }
+  jobResponseSets.swap(this->PendingJobResponseSets);
+  priority = this->PendingJobResponseSetsPriority;
+  this->PendingJobResponseSetsBytes = 0;
+  this->PendingJobResponseSetsPriority = QThread::IdlePriority;
+  }
+
+  logger.debug(QString("ctkDICOMScheduler: inserting %1 job response sets")
+                   .arg(jobResponseSets.count()));
+
+  QSharedPointer<ctkDICOMInserterJob> job =
+    QSharedPointer<ctkDICOMInserterJob>(new ctkDICOMInserterJob);
+  job->setJobResponseSets(jobResponseSets);
+  job->setMaximumNumberOfRetry(this->MaximumNumberOfRetry);
+  job->setRetryDelay(this->RetryDelay);
+  job->setDatabaseFilename(this->DicomDatabase->databaseFilename());
+  job->setTuningProfile(this->DicomDatabase->tuningProfile());
+  job->setTagsToPrecache(this->DicomDatabase->tagsToPrecache());
+  job->setTagsToExcludeFromStorage(this->DicomDatabase->tagsToExcludeFromStorage());
+  job->setPriority(priority);
+
+  this->insertJob(job);
+}
+
+//------------------------------------------------------------------------------
+QSet<QString> ctkDICOMSchedulerPrivate::jobUIDsByUIDs(const QStringList& patientIDs,
+                                                      const QStringList& studyInstanceUIDs,
+                                                      const QStringList& seriesInstanceUIDs,
+                                                      const QStringList& sopInstanceUIDs)
+{
+  QSet<QString> jobUIDs;
+  findInJobUIDsIndex(this->JobUIDsByPatientID, patientIDs, jobUIDs);
+  findInJobUIDsIndex(this->JobUIDsByStudyInstanceUID, studyInstanceUIDs, jobUIDs);
+  findInJobUIDsIndex(this->JobUIDsBySeriesInstanceUID, seriesInstanceUIDs, jobUIDs);
+  findInJobUIDsIndex(this->JobUIDsBySOPInstanceUID, sopInstanceUIDs, jobUIDs);
+  return jobUIDs;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMSchedulerPrivate::clearDatabaseTagValueCache(ctkDICOMJob* job)
+{
+  if (qobject_cast<ctkDICOMInserterJob*>(job) && this->DicomDatabase)
+    {
+    this->DicomDatabase->clearTagValueCache();
+    }
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMSchedulerPrivate::insertJob(QSharedPointer<ctkDICOMJob> job)
 {
@@ -109,6 +299,14 @@ void ctkDICOMSchedulerPrivate::insertJob(QSharedPointer<ctkDICOMJob> job)
 
   QMutexLocker ml(&this->mMutex);
   this->JobsQueue.insert(job->jobUID(), job);
+  if (job->status() == ctkAbstractJob::JobStatus::Initialized)
+    {
+    this->addReadyJob(job);
+    }
+  addToJobUIDsIndex(this->JobUIDsByPatientID, job->patientID(), job->jobUID());
+  addToJobUIDsIndex(this->JobUIDsByStudyInstanceUID, job->studyInstanceUID(), job->jobUID());
+  addToJobUIDsIndex(this->JobUIDsBySeriesInstanceUID, job->seriesInstanceUID(), job->jobUID());
+  addToJobUIDsIndex(this->JobUIDsBySOPInstanceUID, job->sopInstanceUID(), job->jobUID());
   emit q->queueJobs();
 }
 
@@ -121,6 +319,7 @@ void ctkDICOMSchedulerPrivate::removeJob(QString jobUID)
     .arg(jobUID)
     .arg(QString::number(reinterpret_cast<quint64>(QThread::currentThreadId()), 16)));
 
+  QMutexLocker ml(&this->mMutex);
   QSharedPointer<ctkDICOMJob> job = this->JobsQueue.value(jobUID);
   if (!job)
     {
@@ -133,6 +332,16 @@ void ctkDICOMSchedulerPrivate::removeJob(QString jobUID)
   QObject::disconnect(job.data(), SIGNAL(finished()), q, SLOT(onJobFinished()));
   QObject::disconnect(job.data(), SIGNAL(progressJobDetail(QVariant)), q, SIGNAL(progressJobDetail(QVariant)));
 
+  this->removeReadyJob(jobUID);
+  QHash<QString, QSet<QString>>::iterator dispatchedIt = this->DispatchedJobUIDs.find(job->className());
+  if (dispatchedIt != this->DispatchedJobUIDs.end())
+    {
+    dispatchedIt->remove(jobUID);
+    }
+  removeFromJobUIDsIndex(this->JobUIDsByPatientID, job->patientID(), jobUID);
+  removeFromJobUIDsIndex(this->JobUIDsByStudyInstanceUID, job->studyInstanceUID(), jobUID);
+  removeFromJobUIDsIndex(this->JobUIDsBySeriesInstanceUID, job->seriesInstanceUID(), jobUID);
+  removeFromJobUIDsIndex(this->JobUIDsBySOPInstanceUID, job->sopInstanceUID(), jobUID);
   this->JobsQueue.remove(jobUID);
   emit q->queueJobs();
 }
@@ -413,17 +622,63 @@ void ctkDICOMScheduler::insertJobResponseSets(QList<QSharedPointer<ctkDICOMJobRe
 {
   Q_D(ctkDICOMScheduler);
 
-  QSharedPointer<ctkDICOMInserterJob> job =
-    QSharedPointer<ctkDICOMInserterJob>(new ctkDICOMInserterJob);
-  job->copyJobResponseSets(jobResponseSets);
-  job->setMaximumNumberOfRetry(d->MaximumNumberOfRetry);
-  job->setRetryDelay(d->RetryDelay);
-  job->setDatabaseFilename(d->DicomDatabase->databaseFilename());
-  job->setTagsToPrecache(d->DicomDatabase->tagsToPrecache());
-  job->setTagsToExcludeFromStorage(d->DicomDatabase->tagsToExcludeFromStorage());
-  job->setPriority(priority);
+  if (jobResponseSets.isEmpty())
+    {
+    return;
+    }
 
-  d->insertJob(job);
+  // The callers release their job response sets once inserted: buffer copies
+  QList<QSharedPointer<ctkDICOMJobResponseSet>> jobResponseSetsCopy;
+  qint64 bytes = 0;
+  foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, jobResponseSets)
+    {
+    QSharedPointer<ctkDICOMJobResponseSet> jobResponseSetCopy =
+      QSharedPointer<ctkDICOMJobResponseSet>(new ctkDICOMJobResponseSet);
+    jobResponseSetCopy->deepCopy(jobResponseSet.data());
+    bytes += estimateJobResponseSetBytes(jobResponseSetCopy);
+    jobResponseSetsCopy.append(jobResponseSetCopy);
+    }
+
+  bool flush = false;
+  bool startTimer = false;
+  {
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  startTimer = d->PendingJobResponseSets.isEmpty();
+  d->PendingJobResponseSets.append(jobResponseSetsCopy);
+  d->PendingJobResponseSetsBytes += bytes;
+  if (priority > d->PendingJobResponseSetsPriority)
+    {
+    d->PendingJobResponseSetsPriority = priority;
+    }
+  flush = d->PendingJobResponseSets.count() >= d->InsertBatchSize ||
+          d->PendingJobResponseSetsBytes >= d->InsertBatchBytes ||
+          d->InsertBatchInterval <= 0;
+  }
+
+  if (flush)
+    {
+    d->flushJobResponseSets();
+    }
+  else if (startTimer)
+    {
+    // this method is called from the worker threads, the timer lives in the scheduler thread
+    QMetaObject::invokeMethod(d->InsertTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMScheduler::flushJobResponseSets()
+{
+  Q_D(ctkDICOMScheduler);
+  d->flushJobResponseSets();
+}
+
+//----------------------------------------------------------------------------
+int ctkDICOMScheduler::numberOfPendingJobResponseSets()
+{
+  Q_D(ctkDICOMScheduler);
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  return d->PendingJobResponseSets.count();
 }
 
 //----------------------------------------------------------------------------
@@ -620,8 +875,17 @@ void ctkDICOMScheduler::waitForFinish()
   Q_D(ctkDICOMScheduler);
 
   int numberOfPersistentJobs = this->numberOfPersistentJobs();
-  while(this->numberOfJobs() > numberOfPersistentJobs)
+  forever
     {
+    if (this->numberOfJobs() <= numberOfPersistentJobs)
+      {
+      // no more job can add job response sets: insert the buffered ones without waiting
+      if (this->numberOfPendingJobResponseSets() == 0)
+        {
+        break;
+        }
+      this->flushJobResponseSets();
+      }
     QCoreApplication::processEvents();
     d->ThreadPool->waitForDone(300);
   }
@@ -775,6 +1039,18 @@ void ctkDICOMScheduler::stopAllJobs(bool stopPersistentJobs)
 
   QMutexLocker ml(&d->mMutex);
 
+  // Drops the job response sets waiting for insertion
+  {
+  QMutexLocker pendingLocker(&d->PendingJobResponseSetsMutex);
+  foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, d->PendingJobResponseSets)
+    {
+    jobResponseSet->removeTemporaryFile();
+    }
+  d->PendingJobResponseSets.clear();
+  d->PendingJobResponseSetsBytes = 0;
+  d->PendingJobResponseSetsPriority = QThread::IdlePriority;
+  }
+
   // Stops jobs without a worker (in waiting)
   foreach (QSharedPointer<ctkDICOMJob> job, d->JobsQueue)
     {
@@ -788,6 +1064,16 @@ void ctkDICOMScheduler::stopAllJobs(bool stopPersistentJobs)
       continue;
       }
 
+    QSharedPointer<ctkDICOMInserterJob> inserterJob =
+      qobject_cast<QSharedPointer<ctkDICOMInserterJob>>(job);
+    if (inserterJob)
+      {
+      foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, inserterJob->jobResponseSetsShared())
+        {
+        jobResponseSet->removeTemporaryFile();
+        }
+      }
+
     job->setStatus(ctkAbstractJob::JobStatus::Stopped);
     this->deleteJob(job->jobUID());
     }
@@ -830,9 +1116,10 @@ void ctkDICOMScheduler::stopJobsByUIDs(const QStringList& patientIDs,
 
   QMutexLocker ml(&d->mMutex);
 
-  // Stops jobs without a worker (in waiting)
-  foreach (QSharedPointer<ctkDICOMJob> job, d->JobsQueue)
+  QSet<QString> jobUIDs = d->jobUIDsByUIDs(patientIDs, studyInstanceUIDs, seriesInstanceUIDs, sopInstanceUIDs);
+  foreach (const QString& jobUID, jobUIDs)
     {
+    QSharedPointer<ctkDICOMJob> job = d->JobsQueue.value(jobUID);
     if (!job)
       {
       continue;
@@ -843,40 +1130,17 @@ void ctkDICOMScheduler::stopJobsByUIDs(const QStringList& patientIDs,
       continue;
       }
 
-    if (job->status() != ctkAbstractJob::JobStatus::Initialized)
-      {
-      continue;
-      }
-
-    if ((!job->patientID().isEmpty() && patientIDs.contains(job->patientID())) ||
-        (!job->studyInstanceUID().isEmpty() && studyInstanceUIDs.contains(job->studyInstanceUID())) ||
-        (!job->seriesInstanceUID().isEmpty() && seriesInstanceUIDs.contains(job->seriesInstanceUID())) ||
-        (!job->sopInstanceUID().isEmpty() && sopInstanceUIDs.contains(job->sopInstanceUID())))
+    // Stops jobs without a worker (in waiting)
+    if (job->status() == ctkAbstractJob::JobStatus::Initialized)
       {
       job->setStatus(ctkAbstractJob::JobStatus::Stopped);
-      this->deleteJob(job->jobUID());
-      }
-    }
-
-  // Stops queued and running jobs
-  foreach (QSharedPointer<ctkDICOMWorker> worker, d->Workers)
-    {
-    QSharedPointer<ctkDICOMJob> job =
-      qobject_cast<QSharedPointer<ctkDICOMJob>>(worker->jobShared());
-    if (!job)
-      {
+      this->deleteJob(jobUID);
       continue;
       }
 
-    if (job->isPersistent())
-      {
-      continue;
-      }
-
-    if ((!job->patientID().isEmpty() && patientIDs.contains(job->patientID())) ||
-        (!job->studyInstanceUID().isEmpty() && studyInstanceUIDs.contains(job->studyInstanceUID())) ||
-        (!job->seriesInstanceUID().isEmpty() && seriesInstanceUIDs.contains(job->seriesInstanceUID())) ||
-        (!job->sopInstanceUID().isEmpty() && sopInstanceUIDs.contains(job->sopInstanceUID())))
+    // Stops queued and running jobs
+    QSharedPointer<ctkDICOMWorker> worker = d->Workers.value(jobUID);
+    if (worker)
       {
       job->setStatus(ctkAbstractJob::JobStatus::Stopped);
       worker->cancel();
@@ -896,19 +1160,46 @@ void ctkDICOMScheduler::raiseJobsPriorityForSeries(const QStringList& selectedSe
     }
 
   QMutexLocker ml(&d->mMutex);
-  foreach (QSharedPointer<ctkDICOMJob> job, d->JobsQueue)
+
+  QSet<QString> selectedJobUIDs =
+    d->jobUIDsByUIDs(QStringList(), QStringList(), selectedSeriesInstanceUIDs, QStringList());
+
+  // Jobs of the other series that are still waiting for a worker fall back to low priority.
+  // Jobs already stored with low priority are left untouched.
+  QList<QSharedPointer<ctkDICOMJob>> jobsToLower;
+  QMap<int, QMap<QString, QMap<quint64, QSharedPointer<ctkDICOMJob>>>>::const_iterator priorityIt;
+  for (priorityIt = d->ReadyJobs.constBegin(); priorityIt != d->ReadyJobs.constEnd(); ++priorityIt)
     {
-    if (job->isPersistent())
+    if (priorityIt.key() == QThread::Priority::LowPriority)
       {
       continue;
       }
 
-    if (!selectedSeriesInstanceUIDs.contains(job->seriesInstanceUID()))
+    foreach (const auto& jobs, priorityIt.value())
       {
-      priority = QThread::Priority::LowPriority;
+      foreach (QSharedPointer<ctkDICOMJob> job, jobs)
+        {
+        if (!job->isPersistent() && !selectedJobUIDs.contains(job->jobUID()))
+          {
+          jobsToLower.append(job);
+          }
+        }
       }
+    }
+  foreach (QSharedPointer<ctkDICOMJob> job, jobsToLower)
+    {
+    d->setJobPriority(job, QThread::Priority::LowPriority);
+    }
 
-    job->setPriority(priority);
+  foreach (const QString& jobUID, selectedJobUIDs)
+    {
+    QSharedPointer<ctkDICOMJob> job = d->JobsQueue.value(jobUID);
+    if (!job || job->isPersistent())
+      {
+      continue;
+      }
+
+    d->setJobPriority(job, priority);
     }
 }
 
@@ -969,6 +1260,71 @@ int ctkDICOMScheduler::maximumPatientsQuery()
   return d->MaximumPatientsQuery;
 }
 
+//------------------------------------------------------------------------------
+int ctkDICOMScheduler::insertBatchSize() const
+{
+  Q_D(const ctkDICOMScheduler);
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  return d->InsertBatchSize;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMScheduler::setInsertBatchSize(int insertBatchSize)
+{
+  Q_D(ctkDICOMScheduler);
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  d->InsertBatchSize = insertBatchSize;
+}
+
+//------------------------------------------------------------------------------
+qint64 ctkDICOMScheduler::insertBatchBytes() const
+{
+  Q_D(const ctkDICOMScheduler);
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  return d->InsertBatchBytes;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMScheduler::setInsertBatchBytes(qint64 insertBatchBytes)
+{
+  Q_D(ctkDICOMScheduler);
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  d->InsertBatchBytes = insertBatchBytes;
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMScheduler::insertBatchInterval() const
+{
+  Q_D(const ctkDICOMScheduler);
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  return d->InsertBatchInterval;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMScheduler::setInsertBatchInterval(int insertBatchInterval)
+{
+  Q_D(ctkDICOMScheduler);
+  {
+  QMutexLocker ml(&d->PendingJobResponseSetsMutex);
+  d->InsertBatchInterval = insertBatchInterval;
+  }
+  d->InsertTimer->setInterval(qMax(insertBatchInterval, 0));
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMScheduler::streamToDisk() const
+{
+  Q_D(const ctkDICOMScheduler);
+  return d->StreamToDisk;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMScheduler::setStreamToDisk(bool streamToDisk)
+{
+  Q_D(ctkDICOMScheduler);
+  d->StreamToDisk = streamToDisk;
+}
+
 //----------------------------------------------------------------------------
 ctkDICOMStorageListenerJob *ctkDICOMScheduler::listenerJob()
 {
@@ -1030,6 +1386,7 @@ void ctkDICOMScheduler::onJobStarted()
 //----------------------------------------------------------------------------
 void ctkDICOMScheduler::onJobCanceled()
 {
+  Q_D(ctkDICOMScheduler);
   ctkDICOMJob* job = qobject_cast<ctkDICOMJob*>(this->sender());
   if (!job)
     {
@@ -1037,6 +1394,7 @@ void ctkDICOMScheduler::onJobCanceled()
     }
 
   logger.debug(job->loggerReport("canceled"));
+  d->clearDatabaseTagValueCache(job);
   QString jobType = job->className();
   emit this->jobCanceled(job->jobUID(), jobType);
 }
@@ -1044,6 +1402,7 @@ void ctkDICOMScheduler::onJobCanceled()
 //----------------------------------------------------------------------------
 void ctkDICOMScheduler::onJobFailed()
 {
+  Q_D(ctkDICOMScheduler);
   ctkDICOMJob* job = qobject_cast<ctkDICOMJob*>(this->sender());
   if (!job)
     {
@@ -1051,6 +1410,7 @@ void ctkDICOMScheduler::onJobFailed()
     }
 
   logger.debug(job->loggerReport("failed"));
+  d->clearDatabaseTagValueCache(job);
 
   QString jobUID = job->jobUID();
   QString jobType = job->className();
@@ -1063,6 +1423,7 @@ void ctkDICOMScheduler::onJobFailed()
 //----------------------------------------------------------------------------
 void ctkDICOMScheduler::onJobFinished()
 {
+  Q_D(ctkDICOMScheduler);
   ctkDICOMJob* job = qobject_cast<ctkDICOMJob*>(this->sender());
   if (!job)
     {
@@ -1070,6 +1431,7 @@ void ctkDICOMScheduler::onJobFinished()
     }
 
   logger.debug(job->loggerReport("finished"));
+  d->clearDatabaseTagValueCache(job);
 
   QString jobUID = job->jobUID();
   QString jobType = job->className();
@@ -1084,46 +1446,73 @@ void ctkDICOMScheduler::onQueueJobsInThreadPool()
 {
   Q_D(ctkDICOMScheduler);
 
-  QList<QThread::Priority> threadPriorityEnums;
-  threadPriorityEnums.append(QThread::Priority::HighestPriority);
-  threadPriorityEnums.append(QThread::Priority::HighPriority);
-  threadPriorityEnums.append(QThread::Priority::NormalPriority);
-  threadPriorityEnums.append(QThread::Priority::LowPriority);
-  threadPriorityEnums.append(QThread::Priority::LowestPriority);
-
   QMutexLocker ml(&d->mMutex);
-  foreach (QThread::Priority priority, threadPriorityEnums)
+
+  // Ready jobs are filed by priority, then by type, in insertion order:
+  // visit the priorities from the highest one and, for each type, dispatch
+  // the oldest jobs until the type limit of concurrent jobs is reached.
+  bool requeue = false;
+  QList<int> priorities = d->ReadyJobs.keys();
+  for (int priorityIndex = priorities.count() - 1; priorityIndex >= 0; --priorityIndex)
     {
-    foreach(QSharedPointer<ctkDICOMJob> job, d->JobsQueue)
+    int priority = priorities.at(priorityIndex);
+    QStringList jobTypes = d->ReadyJobs.value(priority).keys();
+    foreach (const QString& jobType, jobTypes)
       {
-      if (job->priority() != priority)
+      forever
         {
-        continue;
-        }
+        auto priorityIt = d->ReadyJobs.find(priority);
+        if (priorityIt == d->ReadyJobs.end())
+          {
+          break;
+          }
+        auto jobTypeIt = priorityIt->find(jobType);
+        if (jobTypeIt == priorityIt->end())
+          {
+          break;
+          }
 
-      if (job->status() != ctkAbstractJob::JobStatus::Initialized)
-        {
-        continue;
-        }
+        QSharedPointer<ctkDICOMJob> job = jobTypeIt->first();
+        if (job->status() != ctkAbstractJob::JobStatus::Initialized)
+          {
+          d->removeReadyJob(job->jobUID());
+          continue;
+          }
 
-      int numberOfRunningJobsWithSameType = d->getSameTypeJobsInThreadPoolQueueOrRunning(job);
-      if (numberOfRunningJobsWithSameType >= job->maximumConcurrentJobsPerType())
-        {
-        continue;
-        }
+        if (job->priority() != priority)
+          {
+          // priority changed directly on the job: file it again
+          d->setJobPriority(job, job->priority());
+          requeue = true;
+          continue;
+          }
 
-      logger.debug(QString("ctkDICOMScheduler: creating worker for job %1 in thread %2")
-                       .arg(job->jobUID())
-                       .arg(QString::number(reinterpret_cast<quint64>(QThread::currentThreadId())), 16));
+        int numberOfRunningJobsWithSameType = d->getSameTypeJobsInThreadPoolQueueOrRunning(job);
+        if (numberOfRunningJobsWithSameType >= job->maximumConcurrentJobsPerType())
+          {
+          break;
+          }
 
-      job->setStatus(ctkAbstractJob::JobStatus::Queued);
+        logger.debug(QString("ctkDICOMScheduler: creating worker for job %1 in thread %2")
+                         .arg(job->jobUID())
+                         .arg(QString::number(reinterpret_cast<quint64>(QThread::currentThreadId())), 16));
 
-      QSharedPointer<ctkDICOMWorker> worker =
-        QSharedPointer<ctkDICOMWorker>(job->createWorker());
-      worker->setScheduler(*this);
+        d->removeReadyJob(job->jobUID());
+        job->setStatus(ctkAbstractJob::JobStatus::Queued);
 
-      d->Workers.insert(job->jobUID(), worker);
-      d->ThreadPool->start(worker.data(), job->priority());
+        QSharedPointer<ctkDICOMWorker> worker =
+          QSharedPointer<ctkDICOMWorker>(job->createWorker());
+        worker->setScheduler(*this);
+
+        d->Workers.insert(job->jobUID(), worker);
+        d->DispatchedJobUIDs[jobType].insert(job->jobUID());
+        d->ThreadPool->start(worker.data(), job->priority());
+        }
       }
     }
+
+  if (requeue)
+    {
+    emit this->queueJobs();
+    }
 }
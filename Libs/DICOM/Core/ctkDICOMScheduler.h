@@ -50,6 +50,10 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMScheduler : public ctkAbstractScheduler
   Q_PROPERTY(int maximumNumberOfRetry READ maximumNumberOfRetry WRITE setMaximumNumberOfRetry);
   Q_PROPERTY(int retryDelay READ retryDelay WRITE setRetryDelay);
   Q_PROPERTY(int maximumPatientsQuery READ maximumPatientsQuery WRITE setMaximumPatientsQuery);
+  Q_PROPERTY(int insertBatchSize READ insertBatchSize WRITE setInsertBatchSize);
+  Q_PROPERTY(qint64 insertBatchBytes READ insertBatchBytes WRITE setInsertBatchBytes);
+  Q_PROPERTY(int insertBatchInterval READ insertBatchInterval WRITE setInsertBatchInterval);
+  Q_PROPERTY(bool streamToDisk READ streamToDisk WRITE setStreamToDisk);
 
 public:
   typedef ctkAbstractScheduler Superclass;
@@ -104,7 +108,11 @@ public:
                                  const QString &AETitle,
                                  QThread::Priority priority = QThread::LowPriority);
 
-  /// Insert results from a job
+  /// Insert results from a job.
+  /// The job response sets are buffered (across all the workers) and inserted in the database
+  /// by a single inserter job, i.e. in a single transaction, when the buffer reaches
+  /// insertBatchSize sets or insertBatchBytes bytes, or insertBatchInterval msec after the
+  /// first buffered set. See flushJobResponseSets().
   void insertJobResponseSet(QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet,
                             QThread::Priority priority = QThread::HighPriority);
   void insertJobResponseSets(QList<QSharedPointer<ctkDICOMJobResponseSet>> jobResponseSets,
@@ -194,6 +202,26 @@ public:
   /// when query is at Patient level. Default is 25.
   void setMaximumPatientsQuery(const int maximumPatientsQuery);
   int maximumPatientsQuery();
+  /// Maximum number of job response sets buffered before they are inserted in the database.
+  /// Default is 100.
+  int insertBatchSize() const;
+  void setInsertBatchSize(int insertBatchSize);
+  /// Maximum estimated size in bytes of the datasets buffered before they are inserted in the database.
+  /// Default is 64 MB.
+  qint64 insertBatchBytes() const;
+  void setInsertBatchBytes(qint64 insertBatchBytes);
+  /// Maximum time in msec a job response set is buffered before it is inserted in the database.
+  /// A value <= 0 disables the buffering. Default is 250 msec.
+  int insertBatchInterval() const;
+  void setInsertBatchInterval(int insertBatchInterval);
+  /// If true, the retrieve and storage listener jobs write the received objects
+  /// directly to the "incoming" folder of the database while they are received,
+  /// and only their header is kept in memory until they are moved into the database.
+  /// Ignored if the database is in memory. Default is false.
+  bool streamToDisk() const;
+  void setStreamToDisk(bool streamToDisk);
+  /// Return the number of job response sets waiting to be inserted in the database.
+  Q_INVOKABLE int numberOfPendingJobResponseSets();
 
   /// Return the listener Job.
   Q_INVOKABLE ctkDICOMStorageListenerJob* listenerJob();
@@ -215,6 +243,8 @@ public Q_SLOTS:
   void onJobFailed();
   void onJobFinished();
   void onQueueJobsInThreadPool();
+  /// Insert the buffered job response sets now.
+  void flushJobResponseSets();
 
 protected:
   QScopedPointer<ctkDICOMSchedulerPrivate> d_ptr;
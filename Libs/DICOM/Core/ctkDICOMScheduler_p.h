@@ -24,6 +24,11 @@
 #ifndef __ctkDICOMQueryJobPrivate_h
 #define __ctkDICOMQueryJobPrivate_h
 
+// Qt includes
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+
 // ctkDICOMCore includes
 #include "ctkDICOMScheduler.h"
 
@@ -37,6 +42,14 @@ struct ThumbnailUID
   QString SOPInstanceUID;
 } ;
 
+/// Position of a job waiting for dispatch in ctkDICOMSchedulerPrivate::ReadyJobs
+struct ReadyJobKey
+{
+  int Priority;
+  QString JobType;
+  quint64 Sequence;
+};
+
 //------------------------------------------------------------------------------
 class ctkDICOMSchedulerPrivate : public QObject
 {
@@ -53,6 +66,22 @@ public:
   int getSameTypeJobsInThreadPoolQueueOrRunning(QSharedPointer<ctkDICOMJob> job);
   void insertJob(QSharedPointer<ctkDICOMJob> job);
   void removeJob(QString jobUID);
+
+  /// Add/remove a job to/from the jobs waiting for dispatch
+  void addReadyJob(QSharedPointer<ctkDICOMJob> job);
+  bool removeReadyJob(const QString& jobUID);
+  /// Change the priority of a job, moving it in the ready queues if it is waiting for dispatch
+  void setJobPriority(QSharedPointer<ctkDICOMJob> job, QThread::Priority priority);
+  /// Return the UIDs of the jobs matching any of the UIDs
+  QSet<QString> jobUIDsByUIDs(const QStringList& patientIDs,
+                              const QStringList& studyInstanceUIDs,
+                              const QStringList& seriesInstanceUIDs,
+                              const QStringList& sopInstanceUIDs);
+  /// Create an inserter job for the buffered job response sets
+  void flushJobResponseSets();
+  /// Drop the tag values kept in memory by the database object after an inserter job,
+  /// as the inserter writes through its own connection
+  void clearDatabaseTagValueCache(ctkDICOMJob* job);
   QString generateUniqueJobUID();
   ctkDICOMServer* getServerFromProxyServersByConnectionName(const QString&);
 
@@ -63,6 +92,34 @@ public:
   QMap<QString, QSharedPointer<ctkDICOMWorker>> Workers;
   QMap<QString, QVariant> Filters;
   QMutex mMutex;
+
+  /// Indexes of JobsQueue, they allow dispatching and finding jobs without scanning all the jobs.
+  /// Jobs waiting for dispatch (Initialized status) by priority, then job type, in insertion order.
+  QMap<int, QMap<QString, QMap<quint64, QSharedPointer<ctkDICOMJob>>>> ReadyJobs;
+  QHash<QString, ReadyJobKey> ReadyJobKeys;
+  quint64 NextReadyJobSequence;
+  /// UIDs of the jobs that have been dispatched to the thread pool, by job type.
+  /// Entries of jobs that are not queued or running anymore are removed when counting.
+  QHash<QString, QSet<QString>> DispatchedJobUIDs;
+  /// UIDs of the jobs by the UIDs of the DICOM object they work on
+  QHash<QString, QSet<QString>> JobUIDsByPatientID;
+  QHash<QString, QSet<QString>> JobUIDsByStudyInstanceUID;
+  QHash<QString, QSet<QString>> JobUIDsBySeriesInstanceUID;
+  QHash<QString, QSet<QString>> JobUIDsBySOPInstanceUID;
+
+  /// Job response sets waiting to be inserted in the database by a single inserter job.
+  /// They are filled from the worker threads and protected by their own mutex,
+  /// which also protects the InsertBatch settings read by the worker threads.
+  QList<QSharedPointer<ctkDICOMJobResponseSet>> PendingJobResponseSets;
+  qint64 PendingJobResponseSetsBytes;
+  QThread::Priority PendingJobResponseSetsPriority;
+  mutable QMutex PendingJobResponseSetsMutex;
+  QTimer* InsertTimer;
+  int InsertBatchSize;
+  qint64 InsertBatchBytes;
+  int InsertBatchInterval;
+  bool StreamToDisk;
+
   int RetryDelay;
   int MaximumNumberOfRetry;
   int MaximumPatientsQuery;
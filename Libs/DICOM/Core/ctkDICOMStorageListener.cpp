@@ -20,9 +20,13 @@
 
 // Qt includes
 #include <QDebug>
+#include <QDir>
+#include <QFile>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QString>
 #include <QStringList>
+#include <QUuid>
 
 // ctkDICOMCore includes
 #include "ctkDICOMStorageListener.h"
@@ -89,34 +93,59 @@ public:
           // handle incoming C-STORE request
           T_DIMSE_C_StoreRQ &storeReq = incomingMsg->msg.CStoreRQ;
           Uint16 rspStatusCode = STATUS_STORE_Error_CannotUnderstand;
-          DcmDataset *reqDataset = new DcmDataset;
-          // receive dataset in memory
-          status = receiveSTORERequest(storeReq, presInfo.presentationContextID, reqDataset);
+          QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet =
+            QSharedPointer<ctkDICOMJobResponseSet>(new ctkDICOMJobResponseSet);
+          if (this->listener->streamToDisk())
+            {
+            // receive dataset directly to file, only its header is loaded in memory.
+            // The same instance can be received by several associations at the same time.
+            QDir().mkpath(this->listener->storageDirectory());
+            QString filename = QDir(this->listener->storageDirectory()).filePath(
+              QString("%1-%2.dcm").arg(storeReq.AffectedSOPInstanceUID)
+                                  .arg(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+            status = receiveSTORERequest(storeReq, presInfo.presentationContextID,
+                                         OFString(filename.toLocal8Bit().constData()));
+            if (status.good())
+              {
+              jobResponseSet->setFilePath(filename);
+              jobResponseSet->setTemporaryFile(true);
+              }
+            else
+              {
+              QFile::remove(filename);
+              }
+            }
+          else
+            {
+            DcmDataset *reqDataset = new DcmDataset;
+            // receive dataset in memory
+            status = receiveSTORERequest(storeReq, presInfo.presentationContextID, reqDataset);
+            jobResponseSet->setDataset(reqDataset);
+            }
           if (status.good())
             {
             rspStatusCode = STATUS_Success;
             }
 
-          OFString instanceUID;
-          reqDataset->findAndGetOFString(DCM_SOPInstanceUID, instanceUID);
-          OFString seriesUID;
-          reqDataset->findAndGetOFString(DCM_SeriesInstanceUID, seriesUID);
-          OFString studyUID;
-          reqDataset->findAndGetOFString(DCM_StudyInstanceUID, studyUID);
+          QString instanceUID, seriesUID, studyUID;
+          ctkDICOMItem* dataset = jobResponseSet->dataset();
+          if (dataset)
+            {
+            instanceUID = dataset->GetElementAsString(DCM_SOPInstanceUID);
+            seriesUID = dataset->GetElementAsString(DCM_SeriesInstanceUID);
+            studyUID = dataset->GetElementAsString(DCM_StudyInstanceUID);
+            }
           emit this->listener->progress(
-            ctkDICOMStorageListener::tr("Got STORE request for %1").arg(instanceUID.c_str())
+            ctkDICOMStorageListener::tr("Got STORE request for %1").arg(instanceUID)
             );
           emit this->listener->progress(0);
           if (!this->listener->jobUID().isEmpty() && !this->listener->wasCanceled())
             {
-            QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet =
-              QSharedPointer<ctkDICOMJobResponseSet>(new ctkDICOMJobResponseSet);
             jobResponseSet->setTypeOfJob(ctkDICOMJobResponseSet::JobType::StoreSOPInstance);
-            jobResponseSet->setStudyInstanceUID(studyUID.c_str());
-            jobResponseSet->setSeriesInstanceUID(seriesUID.c_str());
-            jobResponseSet->setSOPInstanceUID(instanceUID.c_str());
+            jobResponseSet->setStudyInstanceUID(studyUID);
+            jobResponseSet->setSeriesInstanceUID(seriesUID);
+            jobResponseSet->setSOPInstanceUID(instanceUID);
             jobResponseSet->setConnectionName(this->listener->AETitle());
-            jobResponseSet->setDataset(reqDataset);
             jobResponseSet->setJobUID(this->listener->jobUID());
             jobResponseSet->setCopyFile(true);
 
@@ -124,6 +153,10 @@ public:
 
             emit this->listener->progressJobDetail(jobResponseSet->jobResponseSetToDetail());
             }
+          else
+            {
+            jobResponseSet->removeTemporaryFile();
+            }
           // send C-STORE response (with DIMSE status code)
           if (status.good())
             {
@@ -165,6 +198,8 @@ public:
   QString AETitle;
   int Port;
   QString JobUID;
+  bool StreamToDisk;
+  QString StorageDirectory;
   QList<QSharedPointer<ctkDICOMJobResponseSet>> JobResponseSets;
 
   ctkDICOMStorageListenerSCUPrivate SCU;
@@ -180,6 +215,8 @@ ctkDICOMStorageListenerPrivate::ctkDICOMStorageListenerPrivate()
   this->Port = 11112;
   this->AETitle = "CTKSTORE";
   this->Canceled = false;
+  this->StreamToDisk = false;
+  this->StorageDirectory = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
 
   this->SCU.setConnectionBlockingMode(DUL_NOBLOCK);
   this->SCU.setACSETimeout(1);
@@ -250,6 +287,11 @@ ctkDICOMStorageListener::ctkDICOMStorageListener(QObject* parentObject)
 ctkDICOMStorageListener::~ctkDICOMStorageListener()
 {
   Q_D(ctkDICOMStorageListener);
+  // the job response sets handed over for insertion have been removed
+  foreach (QSharedPointer<ctkDICOMJobResponseSet> jobResponseSet, d->JobResponseSets)
+    {
+    jobResponseSet->removeTemporaryFile();
+    }
   d->JobResponseSets.clear();
 }
 
@@ -388,6 +430,34 @@ int ctkDICOMStorageListener::connectionTimeout()
   return d->SCU.getConnectionTimeout();
 }
 
+//-----------------------------------------------------------------------------
+void ctkDICOMStorageListener::setStreamToDisk(bool streamToDisk)
+{
+  Q_D(ctkDICOMStorageListener);
+  d->StreamToDisk = streamToDisk;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkDICOMStorageListener::streamToDisk() const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->StreamToDisk;
+}
+
+//-----------------------------------------------------------------------------
+void ctkDICOMStorageListener::setStorageDirectory(const QString& storageDirectory)
+{
+  Q_D(ctkDICOMStorageListener);
+  d->StorageDirectory = storageDirectory;
+}
+
+//-----------------------------------------------------------------------------
+QString ctkDICOMStorageListener::storageDirectory() const
+{
+  Q_D(const ctkDICOMStorageListener);
+  return d->StorageDirectory;
+}
+
 //------------------------------------------------------------------------------
 QList<ctkDICOMJobResponseSet *> ctkDICOMStorageListener::jobResponseSets() const
 {
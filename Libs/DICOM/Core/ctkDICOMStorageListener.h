@@ -44,6 +44,8 @@ class CTK_DICOM_CORE_EXPORT ctkDICOMStorageListener : public QObject
   Q_PROPERTY(QString AETitle READ AETitle WRITE setAETitle);
   Q_PROPERTY(int port READ port WRITE setPort);
   Q_PROPERTY(int connectionTimeout READ connectionTimeout WRITE setConnectionTimeout);
+  Q_PROPERTY(bool streamToDisk READ streamToDisk WRITE setStreamToDisk);
+  Q_PROPERTY(QString storageDirectory READ storageDirectory WRITE setStorageDirectory);
 
 public:
   explicit ctkDICOMStorageListener(QObject* parent = 0);
@@ -61,6 +63,16 @@ public:
   /// 1 sec by default
   void setConnectionTimeout(const int timeout);
   int connectionTimeout();
+  /// Write the received objects to storageDirectory while they are received
+  /// (bit preserving), instead of receiving them in memory.
+  /// See ctkDICOMRetrieve::streamToDisk.
+  /// false by default
+  void setStreamToDisk(bool streamToDisk);
+  bool streamToDisk() const;
+  /// Folder where the objects are written in streaming mode.
+  /// System temporary folder by default
+  void setStorageDirectory(const QString& storageDirectory);
+  QString storageDirectory() const;
 
   /// Access the list of datasets from the last operation.
   Q_INVOKABLE QList<ctkDICOMJobResponseSet*> jobResponseSets() const;
@@ -25,6 +25,7 @@
 #include <QThread>
 
 // ctkDICOMCore includes
+#include "ctkDICOMDatabase.h"
 #include "ctkDICOMJobResponseSet.h"
 #include "ctkDICOMScheduler.h"
 #include "ctkDICOMStorageListenerWorker_p.h"
@@ -74,12 +75,9 @@ void ctkDICOMStorageListenerWorkerPrivate::setStorageListenerParameters()
 void ctkDICOMStorageListenerWorkerPrivate::init()
 {
   Q_Q(ctkDICOMStorageListenerWorker);
-  // To Do: this insert should happen in batch of 10 frames (configurable),
-  // instead of every 1 sec.
-  // This would avoid memory usage spikes when requesting a series or study with a lot of frames.
-  // i.e. the slot should be connected to progressJobDetail from this->StorageListener.
-  // The slot should have a counter. When the counter > batchLimit -> insert
-  // NOTE: the memory release should happen as soon as we insert the response.
+  // The received datasets are handed over to the scheduler every 1 sec.
+  // The scheduler buffers them with the responses of the other workers
+  // and inserts them in batches (see ctkDICOMScheduler::insertBatchSize).
   QTimer *timer = new QTimer(this);
   connect(timer, SIGNAL(timeout()), q, SLOT(onInsertJobDetail()));
   timer->start(1000);
@@ -143,6 +141,13 @@ void ctkDICOMStorageListenerWorker::run()
     return;
     }
 
+  QSharedPointer<ctkDICOMDatabase> database = scheduler->dicomDatabaseShared();
+  if (scheduler->streamToDisk() && database && !database->isInMemory())
+    {
+    d->StorageListener->setStreamToDisk(true);
+    d->StorageListener->setStorageDirectory(database->databaseDirectory() + "/incoming");
+    }
+
   storageListenerJob->setStatus(ctkAbstractJob::JobStatus::Running);
   emit storageListenerJob->started();
 
@@ -0,0 +1,119 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QImage>
+#include <QVector>
+
+// ctk includes
+#include "ctkCoreTestingMacros.h"
+
+// ctkDICOMWidgets includes
+#include "ctkDICOMImage.h"
+
+// DCMTK includes
+#include <dcmtk/dcmdata/dcdatset.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <dcmtk/dcmimgle/dcmimage.h>
+
+// STD includes
+#include <iostream>
+
+int ctkDICOMImageTest2( int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  // Multi-frame image of 20 frames of 6x4 pixels, frame i filled with 10 * i.
+  // Rows of 6 bytes are not aligned like the QImage rows.
+  const int width = 6;
+  const int height = 4;
+  const int frameCount = 20;
+  QVector<Uint8> pixels(width * height * frameCount);
+  for (int i = 0; i < pixels.size(); ++i)
+    {
+    pixels[i] = static_cast<Uint8>(10 * (i / (width * height)));
+    }
+  DcmDataset dataset;
+  dataset.putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+  dataset.putAndInsertUint16(DCM_SamplesPerPixel, 1);
+  dataset.putAndInsertUint16(DCM_Rows, height);
+  dataset.putAndInsertUint16(DCM_Columns, width);
+  dataset.putAndInsertUint16(DCM_BitsAllocated, 8);
+  dataset.putAndInsertUint16(DCM_BitsStored, 8);
+  dataset.putAndInsertUint16(DCM_HighBit, 7);
+  dataset.putAndInsertUint16(DCM_PixelRepresentation, 0);
+  dataset.putAndInsertString(DCM_NumberOfFrames, "20");
+  dataset.putAndInsertUint8Array(DCM_PixelData, pixels.constData(), pixels.size());
+
+  DicomImage dcmtkImage(&dataset, EXS_LittleEndianExplicit);
+  CHECK_BOOL(dcmtkImage.getStatus() == EIS_Normal, true);
+
+  ctkDICOMImage image(&dcmtkImage);
+  image.setWindow(127.5, 256);
+  CHECK_INT(static_cast<int>(image.frameCount()), frameCount);
+  CHECK_INT(image.frameCacheSize(), 32);
+  CHECK_INT(image.prefetchCount(), 8);
+
+  // Without cache, each frame is rendered on request
+  image.setFrameCacheSize(0);
+  QImage uncachedFrame = image.frame(0);
+  CHECK_BOOL(uncachedFrame.isNull(), false);
+  CHECK_INT(uncachedFrame.width(), width);
+  CHECK_INT(uncachedFrame.height(), height);
+  CHECK_INT(image.cachedFrameCount(), 0);
+  image.setFrameCacheSize(32);
+  image.resetCacheStatistics();
+
+  // The next frames are prefetched in the scroll direction
+  image.frame(0);
+  image.waitForPrefetchDone();
+  CHECK_INT(image.cachedFrameCount(), 9);
+  QImage previousFrame = image.frame(0);
+  for (int i = 1; i <= 8; ++i)
+    {
+    QImage currentFrame = image.frame(i);
+    CHECK_BOOL(qGray(currentFrame.pixel(width - 1, height - 1)) >
+               qGray(previousFrame.pixel(width - 1, height - 1)), true);
+    previousFrame = currentFrame;
+    }
+  // All the requests but the first one are served by the cache
+  CHECK_BOOL(image.cacheHitRate() == 0.9, true);
+  CHECK_BOOL(image.frame(0) == uncachedFrame, true);
+
+  // Changing the window discards the cached frames
+  image.setWindow(100, 50);
+  CHECK_INT(image.cachedFrameCount(), 0);
+  CHECK_BOOL(image.frame(8) == previousFrame, false);
+
+  // Scrolling backward prefetches the previous frames
+  image.waitForPrefetchDone();
+  image.resetCacheStatistics();
+  image.frame(19);
+  image.frame(18);
+  image.waitForPrefetchDone();
+  for (int i = 17; i >= 10; --i)
+    {
+    image.frame(i);
+    }
+  CHECK_BOOL(image.cacheHitRate() == 0.8, true);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+
+// ctk includes
+#include "ctkCoreTestingMacros.h"
+
+// ctkDICOMWidgets includes
+#include "ctkDICOMThumbnailService.h"
+
+// STD includes
+#include <iostream>
+
+int ctkDICOMThumbnailServiceTest1( int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  if (argc <= 1)
+    {
+    std::cerr << "Usage: ctkDICOMThumbnailServiceTest1 <dicom file>" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QString file = QString(argv[1]);
+
+  QTemporaryDir cacheDirectory;
+  CHECK_BOOL(cacheDirectory.isValid(), true);
+
+  ctkDICOMThumbnailService service;
+  // Test the default values
+  CHECK_BOOL(service.maximumThreadCount() >= 1, true);
+  CHECK_INT(service.maximumCacheSize(), 500);
+  CHECK_QSTRING(service.cacheDirectory(), "");
+
+  service.setMaximumThreadCount(1);
+  CHECK_INT(service.maximumThreadCount(), 1);
+  service.setCacheDirectory(cacheDirectory.path());
+  CHECK_QSTRING(service.cacheDirectory(), cacheDirectory.path());
+
+  QStringList readyThumbnails;
+  QObject::connect(&service, &ctkDICOMThumbnailService::thumbnailReady,
+                   [&readyThumbnails](const QString& sopInstanceUID, int size, const QImage& image)
+                   {
+                   readyThumbnails << QString("%1:%2:%3").arg(sopInstanceUID).arg(size).arg(image.isNull() ? "null" : "image");
+                   });
+
+  QImage image;
+  CHECK_BOOL(service.cachedThumbnail("1.2.3", 64, image), false);
+
+  // Requests are generated off the GUI thread, then cached in memory and on disk
+  service.requestThumbnail("1.2.3", file, 64, QThread::LowPriority);
+  service.requestThumbnail("1.2.3", file, 64, QThread::HighPriority);
+  service.requestThumbnail("1.2.4", "not-a-dicom-file", 64);
+  service.waitForDone();
+  CHECK_INT(service.numberOfPendingThumbnails(), 0);
+  CHECK_INT(readyThumbnails.count(), 2);
+  CHECK_BOOL(readyThumbnails.contains("1.2.3:64:image"), true);
+  CHECK_BOOL(readyThumbnails.contains("1.2.4:64:null"), true);
+
+  CHECK_BOOL(service.cachedThumbnail("1.2.3", 64, image), true);
+  CHECK_BOOL(image.isNull(), false);
+  CHECK_BOOL(image.width() <= 64 && image.height() <= 64, true);
+  CHECK_BOOL(image.width() == 64 || image.height() == 64, true);
+  CHECK_BOOL(QFile::exists(QDir(cacheDirectory.path()).filePath("64/1.2.3.png")), true);
+
+  // Not cached for another size
+  CHECK_BOOL(service.cachedThumbnail("1.2.3", 32, image), false);
+
+  // Loaded from the disk cache once the memory cache is cleared
+  service.clearCache();
+  CHECK_BOOL(service.cachedThumbnail("1.2.3", 64, image), false);
+  service.requestThumbnail("1.2.3", file, 64);
+  service.waitForDone();
+  CHECK_BOOL(service.cachedThumbnail("1.2.3", 64, image), true);
+  CHECK_BOOL(image.isNull(), false);
+
+  // Cancelled requests are not generated
+  readyThumbnails.clear();
+  service.clearCache(true);
+  CHECK_BOOL(QFile::exists(QDir(cacheDirectory.path()).filePath("64/1.2.3.png")), false);
+  service.setMaximumThreadCount(1);
+  for (int index = 0; index < 20; ++index)
+    {
+    service.requestThumbnail(QString("1.2.5.%1").arg(index), file, 32, QThread::LowPriority);
+    }
+  service.cancelAllThumbnails();
+  service.waitForDone();
+  CHECK_BOOL(readyThumbnails.count() <= 1, true);
+  CHECK_INT(service.numberOfPendingThumbnails(), 0);
+
+  // A request shared by several requesters is kept until all of them cancel it
+  readyThumbnails.clear();
+  QObject firstRequester;
+  QObject secondRequester;
+  service.requestThumbnail("1.2.6", file, 48, QThread::NormalPriority, &firstRequester);
+  service.requestThumbnail("1.2.6", file, 48, QThread::NormalPriority, &secondRequester);
+  service.cancelThumbnail("1.2.6", 48, &firstRequester);
+  service.cancelThumbnail("1.2.6", 48, &firstRequester);
+  service.waitForDone();
+  CHECK_BOOL(readyThumbnails.contains("1.2.6:48:image"), true);
+
+  return EXIT_SUCCESS;
+}
@@ -20,8 +20,13 @@
 =========================================================================*/
 
 // Qt includes
+#include <QAtomicInt>
+#include <QCache>
 #include <QDebug>
+#include <QMutex>
+#include <QRunnable>
 #include <QString>
+#include <QThreadPool>
 
 // ctkDICOMCore includes
 #include "ctkDICOMImage.h"
@@ -31,18 +36,66 @@
 #include <dcmtk/dcmimgle/dcmimage.h>
 #include <dcmtk/ofstd/ofbmanip.h>
 
+// STD includes
+#include <cstring>
+
 static ctkLogger logger ( "org.commontk.dicom.DICOMImage" );
 struct Node;
 
+class ctkDICOMImagePrivate;
+
+//------------------------------------------------------------------------------
+/// Rendered frame of the cache. Its buffer goes back to the pool of the image
+/// when it is evicted, unless it is still shared with a caller of frame().
+struct ctkDICOMImageCachedFrame
+{
+  ctkDICOMImageCachedFrame(ctkDICOMImagePrivate* owner, const QImage& image)
+    : Owner(owner), Image(image)
+  {
+  }
+  ~ctkDICOMImageCachedFrame();
+
+  ctkDICOMImagePrivate* Owner;
+  QImage Image;
+};
+
 //------------------------------------------------------------------------------
 class ctkDICOMImagePrivate
 {
   Q_DECLARE_PUBLIC(ctkDICOMImage);
 public:
   ctkDICOMImagePrivate(ctkDICOMImage&);
+  ~ctkDICOMImagePrivate();
+
+  /// Cache key of a frame rendered with the current window. Requires Mutex.
+  QString frameKey(int frame) const;
+  /// Render a frame into a buffer of the pool. Requires Mutex.
+  QImage renderFrame(int frame);
+  /// Take a buffer of the pool, or allocate one. Requires Mutex.
+  QImage acquireBuffer(int width, int height, QImage::Format format);
+  /// Give back a buffer to the pool. Requires Mutex.
+  void releaseBuffer(const QImage& image);
+
+  /// Cancel the running prefetch, and start a new one from the given frame.
+  void schedulePrefetch(int frame, int step);
+  /// Render the frames after the given one. Called from the pool thread.
+  void prefetch(int frame, int step, int generation);
 
   ::DicomImage* DicomImage;
 
+  mutable QMutex Mutex;
+  QList<QImage> BufferPool;
+  QByteArray UnalignedBuffer;
+  QCache<QString, ctkDICOMImageCachedFrame> Cache;
+  int PrefetchCount;
+  int LastFrame;
+  int CacheHits;
+  int CacheMisses;
+
+  /// Incremented to cancel the running prefetch
+  QAtomicInt Generation;
+  QThreadPool ThreadPool;
+
 protected:
   ctkDICOMImage* const q_ptr;
 
@@ -51,8 +104,188 @@ private:
 };
 
 //------------------------------------------------------------------------------
-ctkDICOMImagePrivate::ctkDICOMImagePrivate(ctkDICOMImage& o):q_ptr(&o)
+class ctkDICOMImagePrefetchRunnable : public QRunnable
+{
+public:
+  ctkDICOMImagePrefetchRunnable(ctkDICOMImagePrivate* image, int frame, int step, int generation)
+    : Image(image), Frame(frame), Step(step), Generation(generation)
+  {
+  }
+
+  void run() override
+  {
+    this->Image->prefetch(this->Frame, this->Step, this->Generation);
+  }
+
+protected:
+  ctkDICOMImagePrivate* Image;
+  int Frame;
+  int Step;
+  int Generation;
+};
+
+//------------------------------------------------------------------------------
+ctkDICOMImageCachedFrame::~ctkDICOMImageCachedFrame()
+{
+  this->Owner->releaseBuffer(this->Image);
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMImagePrivate::ctkDICOMImagePrivate(ctkDICOMImage& o)
+  : DicomImage(NULL)
+  , PrefetchCount(8)
+  , LastFrame(-1)
+  , CacheHits(0)
+  , CacheMisses(0)
+  , q_ptr(&o)
+{
+  this->Cache.setMaxCost(32);
+  // Frames are rendered one at a time, the DicomImage is not thread-safe
+  this->ThreadPool.setMaxThreadCount(1);
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMImagePrivate::~ctkDICOMImagePrivate()
+{
+  this->Generation.fetchAndAddOrdered(1);
+  this->ThreadPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMImagePrivate::frameKey(int frame) const
+{
+  double center = 0.;
+  double width = 0.;
+  if (this->DicomImage)
+    {
+    this->DicomImage->getWindow(center, width);
+    }
+  return QString("%1|%2|%3").arg(frame).arg(center, 0, 'g', 17).arg(width, 0, 'g', 17);
+}
+
+//------------------------------------------------------------------------------
+QImage ctkDICOMImagePrivate::acquireBuffer(int width, int height, QImage::Format format)
+{
+  for (int i = 0; i < this->BufferPool.size(); ++i)
+    {
+    const QImage& buffer = this->BufferPool[i];
+    if (buffer.width() == width && buffer.height() == height && buffer.format() == format)
+      {
+      return this->BufferPool.takeAt(i);
+      }
+    }
+  QImage buffer(width, height, format);
+  if (format == QImage::Format_Indexed8)
+    {
+    // Same image as the PGM previously loaded by frame()
+    QVector<QRgb> grayTable(256);
+    for (int i = 0; i < 256; ++i)
+      {
+      grayTable[i] = qRgb(i, i, i);
+      }
+    buffer.setColorTable(grayTable);
+    }
+  return buffer;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImagePrivate::releaseBuffer(const QImage& image)
+{
+  // A buffer still shared with a caller of frame() would be detached on reuse.
+  if (image.isNull() || !image.isDetached() || this->BufferPool.size() >= 4)
+    {
+    return;
+    }
+  this->BufferPool.append(image);
+}
+
+//------------------------------------------------------------------------------
+QImage ctkDICOMImagePrivate::renderFrame(int frame)
+{
+  if (this->DicomImage == NULL || this->DicomImage->getStatus() != EIS_Normal ||
+      frame < 0 || static_cast<unsigned long>(frame) >= this->DicomImage->getFrameCount())
+    {
+    return QImage();
+    }
+
+  const bool monochrome = this->DicomImage->isMonochrome();
+  const int width = static_cast<int>(this->DicomImage->getWidth());
+  const int height = static_cast<int>(this->DicomImage->getHeight());
+  const int bytesPerLine = width * (monochrome ? 1 : 3 /* RGB */);
+  const unsigned long length = static_cast<unsigned long>(bytesPerLine) * height;
+
+  QImage image = this->acquireBuffer(width, height,
+    monochrome ? QImage::Format_Indexed8 : QImage::Format_RGB888);
+  bool rendered = false;
+  if (image.bytesPerLine() == bytesPerLine)
+    {
+    rendered = this->DicomImage->getOutputData(static_cast<void *>(image.bits()), length, 8, frame);
+    }
+  else
+    {
+    // DicomImage rows are not padded, QImage rows are 32-bit aligned
+    this->UnalignedBuffer.resize(length);
+    rendered = this->DicomImage->getOutputData(
+      static_cast<void *>(this->UnalignedBuffer.data()), length, 8, frame);
+    for (int row = 0; rendered && row < height; ++row)
+      {
+      memcpy(image.scanLine(row), this->UnalignedBuffer.constData() + row * bytesPerLine, bytesPerLine);
+      }
+    }
+  if (!rendered)
+    {
+    logger.error("QImage couldn't created");
+    this->releaseBuffer(image);
+    return QImage();
+    }
+  return image;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImagePrivate::schedulePrefetch(int frame, int step)
+{
+  int generation = this->Generation.fetchAndAddOrdered(1) + 1;
+  {
+  QMutexLocker locker(&this->Mutex);
+  if (this->PrefetchCount <= 0 || this->Cache.maxCost() <= 1)
+    {
+    return;
+    }
+  }
+  // Superseded prefetches waiting for the thread return immediately
+  this->ThreadPool.start(new ctkDICOMImagePrefetchRunnable(this, frame, step, generation));
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImagePrivate::prefetch(int frame, int step, int generation)
 {
+  for (int i = 1; ; ++i)
+    {
+    if (this->Generation.loadAcquire() != generation)
+      {
+      return;
+      }
+    QMutexLocker locker(&this->Mutex);
+    // Keep the requested frame in the cache
+    const int count = qMin(this->PrefetchCount, this->Cache.maxCost() - 1);
+    const int prefetched = frame + i * step;
+    if (i > count || prefetched < 0 ||
+        static_cast<unsigned long>(prefetched) >= this->DicomImage->getFrameCount())
+      {
+      return;
+      }
+    QString key = this->frameKey(prefetched);
+    if (this->Cache.contains(key))
+      {
+      continue;
+      }
+    QImage image = this->renderFrame(prefetched);
+    if (image.isNull())
+      {
+      return;
+      }
+    this->Cache.insert(key, new ctkDICOMImageCachedFrame(this, image));
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -105,33 +338,119 @@ DicomImage* ctkDICOMImage::dicomImage() const
 QImage ctkDICOMImage::frame(int frame) const
 {
   Q_D(const ctkDICOMImage);
+  ctkDICOMImagePrivate* mutable_d = const_cast<ctkDICOMImagePrivate*>(d);
 
-  // this way of converting the dicom image to a qpixmap was adopted from some code from
-  // the DCMTK forum, posted by Joerg Riesmayer, see http://forum.dcmtk.org/viewtopic.php?t=120
+  QMutexLocker locker(&mutable_d->Mutex);
+  QString key = d->frameKey(frame);
   QImage image;
-  if ((d->DicomImage != NULL) && (d->DicomImage->getStatus() == EIS_Normal))
-    {
-    /* get image extension */
-    const unsigned long width = d->DicomImage->getWidth();
-    const unsigned long height = d->DicomImage->getHeight();
-    QString header = QString("P5 %1 %2 255\n").arg(width).arg(height);
-    const unsigned long offset = header.length();
-    const unsigned long length = width * height + offset;
-    /* create output buffer for DicomImage class */
-    QByteArray buffer;
-    buffer.append(header.toUtf8());
-    buffer.resize(length);
-
-    /* copy PGM header to buffer */
-
-    if (d->DicomImage->getOutputData(static_cast<void *>(buffer.data() + offset), length - offset, 8, frame))
+  ctkDICOMImageCachedFrame* cachedFrame = mutable_d->Cache.object(key);
+  if (cachedFrame)
+    {
+    ++mutable_d->CacheHits;
+    image = cachedFrame->Image;
+    }
+  else
+    {
+    ++mutable_d->CacheMisses;
+    image = mutable_d->renderFrame(frame);
+    if (!image.isNull() && d->Cache.maxCost() > 0)
       {
-
-      if (!image.loadFromData( buffer ))
-        {
-        logger.error("QImage couldn't created");
-        }
+      mutable_d->Cache.insert(key, new ctkDICOMImageCachedFrame(mutable_d, image));
       }
     }
+  const int step = frame < d->LastFrame ? -1 : 1;
+  mutable_d->LastFrame = frame;
+  locker.unlock();
+
+  if (!image.isNull())
+    {
+    mutable_d->schedulePrefetch(frame, step);
+    }
   return image;
 }
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::setWindow(double center, double width)
+{
+  Q_D(ctkDICOMImage);
+  d->Generation.fetchAndAddOrdered(1);
+  QMutexLocker locker(&d->Mutex);
+  if (d->DicomImage)
+    {
+    d->DicomImage->setWindow(center, width);
+    }
+  d->Cache.clear();
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMImage::window(double& center, double& width) const
+{
+  Q_D(const ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  return d->DicomImage && d->DicomImage->getWindow(center, width);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::setFrameCacheSize(int frameCount)
+{
+  Q_D(ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  d->Cache.setMaxCost(qMax(0, frameCount));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMImage::frameCacheSize() const
+{
+  Q_D(const ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  return d->Cache.maxCost();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::setPrefetchCount(int count)
+{
+  Q_D(ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  d->PrefetchCount = qMax(0, count);
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMImage::prefetchCount() const
+{
+  Q_D(const ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  return d->PrefetchCount;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::waitForPrefetchDone()
+{
+  Q_D(ctkDICOMImage);
+  d->ThreadPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMImage::cachedFrameCount() const
+{
+  Q_D(const ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  return d->Cache.size();
+}
+
+//------------------------------------------------------------------------------
+double ctkDICOMImage::cacheHitRate() const
+{
+  Q_D(const ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  const int requests = d->CacheHits + d->CacheMisses;
+  return requests > 0 ? static_cast<double>(d->CacheHits) / requests : 0.;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMImage::resetCacheStatistics()
+{
+  Q_D(ctkDICOMImage);
+  QMutexLocker locker(&d->Mutex);
+  d->CacheHits = 0;
+  d->CacheMisses = 0;
+}
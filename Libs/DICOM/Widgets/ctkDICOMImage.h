@@ -37,10 +37,18 @@ class DicomImage;
 ///
 /// This class wraps a DicomImage object and exposes it as a Qt class.
 ///
+/// The rendered frames are kept in a cache keyed by frame index and window.
+/// Each call to frame() renders in the background the next frames in the
+/// scroll direction, such that scrolling through a multi-frame image does
+/// not render the frames on the calling thread.
+///
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMImage : public QObject
 {
   Q_OBJECT
   Q_PROPERTY(unsigned long frameCount READ frameCount);
+  Q_PROPERTY(int frameCacheSize READ frameCacheSize WRITE setFrameCacheSize);
+  Q_PROPERTY(int prefetchCount READ prefetchCount WRITE setPrefetchCount);
+  Q_PROPERTY(double cacheHitRate READ cacheHitRate);
 public:
   ///  \brief Construct a ctkDICOMImage
   /// The dicomImage pointer must remain valid during all the life of
@@ -61,8 +69,62 @@ public:
   ///
   /// \brief Returns a specific frame of the dicom image
   ///
+  /// The frame is returned from the cache if it was already rendered with
+  /// the current window, and rendered otherwise. The following frames in the
+  /// direction of the previous call are then prefetched in the background.
+  /// \sa setFrameCacheSize(), setPrefetchCount()
+  ///
   QImage frame(int frame = 0) const;
 
+  ///
+  /// \brief Set the window of a monochrome image.
+  ///
+  /// The pending prefetch is cancelled and the cached frames are discarded.
+  /// \sa DicomImage::setWindow()
+  ///
+  void setWindow(double center, double width);
+
+  ///
+  /// \brief Get the window of a monochrome image.
+  /// Returns false if no window is set.
+  ///
+  bool window(double& center, double& width) const;
+
+  ///
+  /// \brief Set the maximum number of rendered frames kept in memory.
+  ///
+  /// 32 by default. 0 disables the cache and the prefetch.
+  ///
+  void setFrameCacheSize(int frameCount);
+  int frameCacheSize() const;
+
+  ///
+  /// \brief Set the number of frames rendered in the background after
+  /// each call to frame().
+  ///
+  /// 8 by default, and at most frameCacheSize() - 1. 0 disables the prefetch.
+  ///
+  void setPrefetchCount(int count);
+  int prefetchCount() const;
+
+  ///
+  /// \brief Wait for the frames being prefetched to be rendered.
+  ///
+  void waitForPrefetchDone();
+
+  ///
+  /// \brief Returns the number of frames currently in the cache.
+  ///
+  int cachedFrameCount() const;
+
+  ///
+  /// \brief Returns the ratio of the calls to frame() served by the cache,
+  /// between 0 and 1.
+  /// \sa resetCacheStatistics()
+  ///
+  double cacheHitRate() const;
+  void resetCacheStatistics();
+
   ///
   /// \brief Returns the number of frames contained in the dicom image.
   /// \sa DicomImage::getFrameCount()
@@ -31,6 +31,7 @@
 // ctkDICOMCore includes
 #include "ctkDICOMDatabase.h"
 #include "ctkDICOMScheduler.h"
+#include "ctkDICOMThumbnailService.h"
 #include "ctkDICOMJobResponseSet.h"
 
 // ctkDICOMWidgets includes
@@ -71,6 +72,7 @@ public:
 
   QSharedPointer<ctkDICOMDatabase> DicomDatabase;
   QSharedPointer<ctkDICOMScheduler> Scheduler;
+  QSharedPointer<ctkDICOMThumbnailService> ThumbnailService;
   QSharedPointer<QWidget> VisualDICOMBrowser;
 
   int NumberOfStudiesPerPatient;
@@ -516,6 +518,34 @@ void ctkDICOMPatientItemWidget::setScheduler(QSharedPointer<ctkDICOMScheduler> s
     }
 }
 
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailService* ctkDICOMPatientItemWidget::thumbnailService()const
+{
+  Q_D(const ctkDICOMPatientItemWidget);
+  return d->ThumbnailService.data();
+}
+
+//----------------------------------------------------------------------------
+QSharedPointer<ctkDICOMThumbnailService> ctkDICOMPatientItemWidget::thumbnailServiceShared()const
+{
+  Q_D(const ctkDICOMPatientItemWidget);
+  return d->ThumbnailService;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMPatientItemWidget::setThumbnailService(ctkDICOMThumbnailService& thumbnailService)
+{
+  Q_D(ctkDICOMPatientItemWidget);
+  d->ThumbnailService = QSharedPointer<ctkDICOMThumbnailService>(&thumbnailService, skipDelete);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMPatientItemWidget::setThumbnailService(QSharedPointer<ctkDICOMThumbnailService> thumbnailService)
+{
+  Q_D(ctkDICOMPatientItemWidget);
+  d->ThumbnailService = thumbnailService;
+}
+
 //----------------------------------------------------------------------------
 ctkDICOMDatabase* ctkDICOMPatientItemWidget::dicomDatabase()const
 {
@@ -628,6 +658,7 @@ void ctkDICOMPatientItemWidget::addStudyItemWidget(const QString &studyItem)
   studyItemWidget->setFilteringModalities(d->FilteringModalities);
   studyItemWidget->setDicomDatabase(d->DicomDatabase);
   studyItemWidget->setScheduler(d->Scheduler);
+  studyItemWidget->setThumbnailService(d->ThumbnailService);
   // Show in default (and start query/retrieve) only for the first 2 studies
   // NOTE: in the layout for each studyItemWidget there is a QSpacerItem
   if (d->StudiesListWidget->layout()->count() < d->NumberOfStudiesPerPatient * 2)
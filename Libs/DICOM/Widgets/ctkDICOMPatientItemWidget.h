@@ -34,6 +34,7 @@ class ctkDICOMPatientItemWidgetPrivate;
 
 class ctkDICOMDatabase;
 class ctkDICOMScheduler;
+class ctkDICOMThumbnailService;
 class ctkDICOMStudyItemWidget;
 
 /// \ingroup DICOM_Widgets
@@ -118,6 +119,17 @@ public:
   /// (not Python-wrappable).
   void setScheduler(QSharedPointer<ctkDICOMScheduler> scheduler);
 
+  /// Return the thumbnail service.
+  Q_INVOKABLE ctkDICOMThumbnailService* thumbnailService() const;
+  /// Return the thumbnail service as a shared pointer
+  /// (not Python-wrappable).
+  QSharedPointer<ctkDICOMThumbnailService> thumbnailServiceShared() const;
+  /// Set the thumbnail service used by the series widgets.
+  Q_INVOKABLE void setThumbnailService(ctkDICOMThumbnailService& thumbnailService);
+  /// Set the thumbnail service as a shared pointer
+  /// (not Python-wrappable).
+  void setThumbnailService(QSharedPointer<ctkDICOMThumbnailService> thumbnailService);
+
   /// Return the Dicom Database.
   Q_INVOKABLE ctkDICOMDatabase* dicomDatabase() const;
   /// Return Dicom Database as a shared pointer
@@ -38,6 +38,7 @@
 #include "ctkDICOMScheduler.h"
 #include "ctkDICOMJobResponseSet.h"
 #include "ctkDICOMThumbnailGenerator.h"
+#include "ctkDICOMThumbnailService.h"
 
 // ctkDICOMWidgets includes
 #include "ctkDICOMSeriesItemWidget.h"
@@ -62,6 +63,11 @@ public:
   void createThumbnail(ctkJobDetail td);
   void drawModalityThumbnail();
   void drawThumbnail(const QString& file, int numberOfFrames);
+  void setThumbnailImage(const QImage& image);
+  void renderThumbnail(int numberOfFrames);
+  QThread::Priority thumbnailPriority() const;
+  QSharedPointer<ctkDICOMThumbnailService> thumbnailService();
+  void setThumbnailService(QSharedPointer<ctkDICOMThumbnailService> thumbnailService);
   void drawTextWithShadow(QPainter *painter,
                           const QRect &r,
                           int flags,
@@ -70,6 +76,7 @@ public:
 
   QSharedPointer<ctkDICOMDatabase> DicomDatabase;
   QSharedPointer<ctkDICOMScheduler> Scheduler;
+  QSharedPointer<ctkDICOMThumbnailService> ThumbnailService;
 
   QString PatientID;
   QString SeriesItem;
@@ -86,7 +93,10 @@ public:
   int ThumbnailSize;
   int NumberOfDownloads;
   QImage ThumbnailImage;
+  int ThumbnailImageSize;
   bool isThumbnailDocument;
+  QString PendingThumbnailSOPInstanceUID;
+  int PendingNumberOfFrames;
 };
 
 //----------------------------------------------------------------------------
@@ -111,6 +121,8 @@ ctkDICOMSeriesItemWidgetPrivate::ctkDICOMSeriesItemWidgetPrivate(ctkDICOMSeriesI
   this->RaiseJobsPriority = false;
   this->isThumbnailDocument = false;
   this->ThumbnailSize = 300;
+  this->ThumbnailImageSize = 0;
+  this->PendingNumberOfFrames = 0;
   this->NumberOfDownloads = 0;
 
   this->DicomDatabase = nullptr;
@@ -120,6 +132,11 @@ ctkDICOMSeriesItemWidgetPrivate::ctkDICOMSeriesItemWidgetPrivate(ctkDICOMSeriesI
 //----------------------------------------------------------------------------
 ctkDICOMSeriesItemWidgetPrivate::~ctkDICOMSeriesItemWidgetPrivate()
 {
+  if (this->ThumbnailService && !this->PendingThumbnailSOPInstanceUID.isEmpty())
+    {
+    this->ThumbnailService->cancelThumbnail(this->PendingThumbnailSOPInstanceUID,
+                                            this->ThumbnailSize, this->q_ptr);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -359,6 +376,65 @@ void ctkDICOMSeriesItemWidgetPrivate::drawThumbnail(const QString &file, int num
     return;
     }
 
+  if (this->isThumbnailDocument)
+    {
+    return;
+    }
+
+  if (this->ThumbnailImage.isNull() || this->ThumbnailImageSize != this->ThumbnailSize)
+    {
+    // The image is decoded by the thumbnail service off the GUI thread,
+    // the thumbnail is drawn when it is ready (see onThumbnailReady).
+    QSharedPointer<ctkDICOMThumbnailService> thumbnailService = this->thumbnailService();
+    QImage image;
+    if (!thumbnailService->cachedThumbnail(this->CentralFrameSOPInstanceUID, this->ThumbnailSize, image))
+      {
+      this->PendingThumbnailSOPInstanceUID = this->CentralFrameSOPInstanceUID;
+      this->PendingNumberOfFrames = numberOfFrames;
+      thumbnailService->requestThumbnail(this->CentralFrameSOPInstanceUID, file,
+                                         this->ThumbnailSize, this->thumbnailPriority(), this->q_ptr);
+      return;
+      }
+    this->setThumbnailImage(image);
+    if (this->isThumbnailDocument)
+      {
+      return;
+      }
+    }
+
+  this->renderThumbnail(numberOfFrames);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidgetPrivate::setThumbnailImage(const QImage& image)
+{
+  this->ThumbnailImageSize = this->ThumbnailSize;
+  if (!image.isNull())
+    {
+    this->ThumbnailImage = image;
+    return;
+    }
+
+  this->isThumbnailDocument = true;
+  ctkDICOMThumbnailGenerator thumbnailGenerator;
+  thumbnailGenerator.setWidth(this->ThumbnailSize);
+  thumbnailGenerator.setHeight(this->ThumbnailSize);
+  thumbnailGenerator.generateBlankThumbnail(this->ThumbnailImage, Qt::white);
+  QPixmap resultPixmap = QPixmap::fromImage(this->ThumbnailImage);
+  QPainter painter;
+  if (painter.begin(&resultPixmap))
+    {
+    painter.setRenderHint(QPainter::Antialiasing);
+    QSvgRenderer renderer(QString(":Icons/text_document.svg"));
+    renderer.render(&painter);
+    painter.end();
+    }
+  this->SeriesThumbnail->setPixmap(resultPixmap);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidgetPrivate::renderThumbnail(int numberOfFrames)
+{
   int margin = 10;
   int fontSize = 12;
   if (!this->SeriesThumbnail->text().isEmpty())
@@ -369,81 +445,104 @@ void ctkDICOMSeriesItemWidgetPrivate::drawThumbnail(const QString &file, int num
 
   QPixmap resultPixmap(this->ThumbnailSize, this->ThumbnailSize);
   resultPixmap.fill(Qt::transparent);
-  ctkDICOMThumbnailGenerator thumbnailGenerator;
-  thumbnailGenerator.setWidth(this->ThumbnailSize);
-  thumbnailGenerator.setHeight(this->ThumbnailSize);
-  bool thumbnailGenerated = true;
-  bool emptyThumbnailGenerated = false;
   QPainter painter;
-  if (this->ThumbnailImage.width() != this->ThumbnailSize)
+  if (painter.begin(&resultPixmap))
     {
-    if (!thumbnailGenerator.generateThumbnail(file, this->ThumbnailImage))
+    painter.setRenderHint(QPainter::Antialiasing);
+    QRect rect = resultPixmap.rect();
+    painter.setFont(QFont("Arial", fontSize, QFont::Bold));
+    int x = int((rect.width() / 2) - (this->ThumbnailImage.rect().width() / 2));
+    int y = int((rect.height() / 2) - (this->ThumbnailImage.rect().height() / 2));
+    painter.drawPixmap(x, y, QPixmap::fromImage(this->ThumbnailImage));
+    QString topLeft = ctkDICOMSeriesItemWidget::tr("Series: %1\n%2").arg(this->SeriesNumber).arg(this->Modality);
+    this->drawTextWithShadow(&painter, rect.adjusted(margin, margin, margin, margin), Qt::AlignTop | Qt::AlignLeft, topLeft);
+    QString bottomLeft = ctkDICOMSeriesItemWidget::tr("N.frames: %1").arg(numberOfFrames);
+    this->drawTextWithShadow(&painter, rect.adjusted(margin, -margin, margin, -margin), Qt::AlignBottom | Qt::AlignLeft, bottomLeft);
+    QString rows = this->DicomDatabase->instanceValue(this->CentralFrameSOPInstanceUID, "0028,0010");
+    QString columns = this->DicomDatabase->instanceValue(this->CentralFrameSOPInstanceUID, "0028,0011");
+    QString bottomRight = rows + "x" + columns;
+    this->drawTextWithShadow(&painter, rect.adjusted(-margin, -margin, -margin, -margin), Qt::AlignBottom | Qt::AlignRight, bottomRight);
+    QSvgRenderer renderer;
+
+    if (this->IsCloud)
       {
-      thumbnailGenerated = false;
-      emptyThumbnailGenerated = true;
-      this->isThumbnailDocument = true;
-      thumbnailGenerator.generateBlankThumbnail(this->ThumbnailImage, Qt::white);
-      resultPixmap = QPixmap::fromImage(this->ThumbnailImage);
-      if (painter.begin(&resultPixmap))
+      if (this->NumberOfDownloads > 0)
         {
-        painter.setRenderHint(QPainter::Antialiasing);
-        QSvgRenderer renderer(QString(":Icons/text_document.svg"));
-        renderer.render(&painter);
-        painter.end();
+        renderer.load(QString(":Icons/downloading.svg"));
         }
+        else
+        {
+        renderer.load(QString(":Icons/cloud.svg"));
+        }
+      }
+    else if (this->IsVisible)
+      {
+      renderer.load(QString(":Icons/visible.svg"));
       }
+    else if (this->IsLoaded)
+      {
+      renderer.load(QString(":Icons/loaded.svg"));
+      }
+
+    QPoint topRight = rect.topRight();
+    QRectF bounds(topRight.x() - 48 - margin, topRight.y() + margin, 48, 48);
+    renderer.render(&painter, bounds);
+    painter.end();
+    }
+
+  this->SeriesThumbnail->setPixmap(resultPixmap);
+}
+
+//----------------------------------------------------------------------------
+QThread::Priority ctkDICOMSeriesItemWidgetPrivate::thumbnailPriority() const
+{
+  Q_Q(const ctkDICOMSeriesItemWidget);
+  if (this->RaiseJobsPriority)
+    {
+    return QThread::HighestPriority;
     }
+  return q->isVisible() ? QThread::HighPriority : QThread::LowPriority;
+}
 
-  if (thumbnailGenerated && !this->isThumbnailDocument)
+//----------------------------------------------------------------------------
+QSharedPointer<ctkDICOMThumbnailService> ctkDICOMSeriesItemWidgetPrivate::thumbnailService()
+{
+  if (!this->ThumbnailService)
     {
-    if (painter.begin(&resultPixmap))
+    // Share the default service, so that the number of decoding threads stays bounded
+    static QWeakPointer<ctkDICOMThumbnailService> defaultThumbnailService;
+    QSharedPointer<ctkDICOMThumbnailService> thumbnailService = defaultThumbnailService.toStrongRef();
+    if (!thumbnailService)
       {
-      painter.setRenderHint(QPainter::Antialiasing);
-      QRect rect = resultPixmap.rect();
-      painter.setFont(QFont("Arial", fontSize, QFont::Bold));
-      int x = int((rect.width() / 2) - (this->ThumbnailImage.rect().width() / 2));
-      int y = int((rect.height() / 2) - (this->ThumbnailImage.rect().height() / 2));
-      painter.drawPixmap(x, y, QPixmap::fromImage(this->ThumbnailImage));
-      QString topLeft = ctkDICOMSeriesItemWidget::tr("Series: %1\n%2").arg(this->SeriesNumber).arg(this->Modality);
-      this->drawTextWithShadow(&painter, rect.adjusted(margin, margin, margin, margin), Qt::AlignTop | Qt::AlignLeft, topLeft);
-      QString bottomLeft = ctkDICOMSeriesItemWidget::tr("N.frames: %1").arg(numberOfFrames);
-      this->drawTextWithShadow(&painter, rect.adjusted(margin, -margin, margin, -margin), Qt::AlignBottom | Qt::AlignLeft, bottomLeft);
-      QString rows = this->DicomDatabase->instanceValue(this->CentralFrameSOPInstanceUID, "0028,0010");
-      QString columns = this->DicomDatabase->instanceValue(this->CentralFrameSOPInstanceUID, "0028,0011");
-      QString bottomRight = rows + "x" + columns;
-      this->drawTextWithShadow(&painter, rect.adjusted(-margin, -margin, -margin, -margin), Qt::AlignBottom | Qt::AlignRight, bottomRight);
-      QSvgRenderer renderer;
-
-      if (this->IsCloud)
-        {
-        if (this->NumberOfDownloads > 0)
-          {
-          renderer.load(QString(":Icons/downloading.svg"));
-          }
-          else
-          {
-          renderer.load(QString(":Icons/cloud.svg"));
-          }
-        }
-      else if (this->IsVisible)
-        {
-        renderer.load(QString(":Icons/visible.svg"));
-        }
-      else if (this->IsLoaded)
-        {
-        renderer.load(QString(":Icons/loaded.svg"));
-        }
+      thumbnailService = QSharedPointer<ctkDICOMThumbnailService>(new ctkDICOMThumbnailService);
+      defaultThumbnailService = thumbnailService;
+      }
+    this->setThumbnailService(thumbnailService);
+    }
+  return this->ThumbnailService;
+}
 
-      QPoint topRight = rect.topRight();
-      QRectF bounds(topRight.x() - 48 - margin, topRight.y() + margin, 48, 48);
-      renderer.render(&painter, bounds);
-      painter.end();
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidgetPrivate::setThumbnailService(QSharedPointer<ctkDICOMThumbnailService> thumbnailService)
+{
+  Q_Q(ctkDICOMSeriesItemWidget);
+  if (this->ThumbnailService)
+    {
+    QObject::disconnect(this->ThumbnailService.data(), SIGNAL(thumbnailReady(QString,int,QImage)),
+                        q, SLOT(onThumbnailReady(QString,int,QImage)));
+    if (!this->PendingThumbnailSOPInstanceUID.isEmpty())
+      {
+      this->ThumbnailService->cancelThumbnail(this->PendingThumbnailSOPInstanceUID, this->ThumbnailSize, q);
+      this->PendingThumbnailSOPInstanceUID.clear();
       }
     }
 
-  if ((thumbnailGenerated && !this->isThumbnailDocument) || emptyThumbnailGenerated)
+  this->ThumbnailService = thumbnailService;
+
+  if (this->ThumbnailService)
     {
-    this->SeriesThumbnail->setPixmap(resultPixmap);
+    QObject::connect(this->ThumbnailService.data(), SIGNAL(thumbnailReady(QString,int,QImage)),
+                     q, SLOT(onThumbnailReady(QString,int,QImage)));
     }
 }
 
@@ -762,6 +861,34 @@ void ctkDICOMSeriesItemWidget::setDicomDatabase(QSharedPointer<ctkDICOMDatabase>
   d->DicomDatabase = dicomDatabase;
 }
 
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailService* ctkDICOMSeriesItemWidget::thumbnailService()const
+{
+  Q_D(const ctkDICOMSeriesItemWidget);
+  return d->ThumbnailService.data();
+}
+
+//----------------------------------------------------------------------------
+QSharedPointer<ctkDICOMThumbnailService> ctkDICOMSeriesItemWidget::thumbnailServiceShared()const
+{
+  Q_D(const ctkDICOMSeriesItemWidget);
+  return d->ThumbnailService;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidget::setThumbnailService(ctkDICOMThumbnailService& thumbnailService)
+{
+  Q_D(ctkDICOMSeriesItemWidget);
+  d->setThumbnailService(QSharedPointer<ctkDICOMThumbnailService>(&thumbnailService, skipDelete));
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidget::setThumbnailService(QSharedPointer<ctkDICOMThumbnailService> thumbnailService)
+{
+  Q_D(ctkDICOMSeriesItemWidget);
+  d->setThumbnailService(thumbnailService);
+}
+
 //------------------------------------------------------------------------------
 void ctkDICOMSeriesItemWidget::generateInstances()
 {
@@ -824,3 +951,44 @@ void ctkDICOMSeriesItemWidget::updateSeriesProgressBar(QVariant data)
 
   d->updateThumbnailProgressBar();
 }
+
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidget::onThumbnailReady(const QString& sopInstanceUID, int size, const QImage& image)
+{
+  Q_D(ctkDICOMSeriesItemWidget);
+  if (sopInstanceUID != d->PendingThumbnailSOPInstanceUID || size != d->ThumbnailSize)
+    {
+    return;
+    }
+
+  d->PendingThumbnailSOPInstanceUID.clear();
+  d->setThumbnailImage(image);
+  if (!d->isThumbnailDocument)
+    {
+    d->renderThumbnail(d->PendingNumberOfFrames);
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidget::showEvent(QShowEvent* event)
+{
+  Q_D(ctkDICOMSeriesItemWidget);
+  this->Superclass::showEvent(event);
+  if (d->ThumbnailService && !d->PendingThumbnailSOPInstanceUID.isEmpty())
+    {
+    d->ThumbnailService->setThumbnailPriority(d->PendingThumbnailSOPInstanceUID,
+                                              d->ThumbnailSize, d->thumbnailPriority());
+    }
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMSeriesItemWidget::hideEvent(QHideEvent* event)
+{
+  Q_D(ctkDICOMSeriesItemWidget);
+  this->Superclass::hideEvent(event);
+  if (d->ThumbnailService && !d->PendingThumbnailSOPInstanceUID.isEmpty())
+    {
+    d->ThumbnailService->setThumbnailPriority(d->PendingThumbnailSOPInstanceUID,
+                                              d->ThumbnailSize, d->thumbnailPriority());
+    }
+}
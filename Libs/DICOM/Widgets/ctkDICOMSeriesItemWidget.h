@@ -27,12 +27,14 @@
 #include "ctkDICOMWidgetsExport.h"
 
 // Qt includes 
+#include <QImage>
 #include <QWidget>
 #include <QVariant>
 
 class ctkDICOMSeriesItemWidgetPrivate;
 class ctkDICOMDatabase;
 class ctkDICOMScheduler;
+class ctkDICOMThumbnailService;
 
 /// \ingroup DICOM_Widgets
 class CTK_DICOM_WIDGETS_EXPORT ctkDICOMSeriesItemWidget : public QWidget
@@ -127,14 +129,34 @@ public:
   /// (not Python-wrappable).
   void setDicomDatabase(QSharedPointer<ctkDICOMDatabase> dicomDatabase);
 
+  /// Return the thumbnail service.
+  /// If none has been set, a service shared by all the series widgets
+  /// is set when the first thumbnail is drawn.
+  Q_INVOKABLE ctkDICOMThumbnailService* thumbnailService() const;
+  /// Return the thumbnail service as a shared pointer
+  /// (not Python-wrappable).
+  QSharedPointer<ctkDICOMThumbnailService> thumbnailServiceShared() const;
+  /// Set the thumbnail service.
+  Q_INVOKABLE void setThumbnailService(ctkDICOMThumbnailService& thumbnailService);
+  /// Set the thumbnail service as a shared pointer
+  /// (not Python-wrappable).
+  void setThumbnailService(QSharedPointer<ctkDICOMThumbnailService> thumbnailService);
+
 public Q_SLOTS:
   void generateInstances();
   void updateGUIFromScheduler(QVariant data);
   void updateSeriesProgressBar(QVariant data);
 
+protected Q_SLOTS:
+  void onThumbnailReady(const QString& sopInstanceUID, int size, const QImage& image);
+
 protected:
   QScopedPointer<ctkDICOMSeriesItemWidgetPrivate> d_ptr;
 
+  /// Raise the priority of the thumbnail of the visible series
+  void showEvent(QShowEvent* event) override;
+  void hideEvent(QHideEvent* event) override;
+
 private:
   Q_DECLARE_PRIVATE(ctkDICOMSeriesItemWidget);
   Q_DISABLE_COPY(ctkDICOMSeriesItemWidget);
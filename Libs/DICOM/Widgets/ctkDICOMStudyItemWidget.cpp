@@ -32,6 +32,7 @@
 // ctkDICOMCore includes
 #include "ctkDICOMDatabase.h"
 #include "ctkDICOMScheduler.h"
+#include "ctkDICOMThumbnailService.h"
 #include "ctkDICOMJobResponseSet.h"
 
 // ctkDICOMWidgets includes
@@ -75,6 +76,7 @@ public:
 
   QSharedPointer<ctkDICOMDatabase> DicomDatabase;
   QSharedPointer<ctkDICOMScheduler> Scheduler;
+  QSharedPointer<ctkDICOMThumbnailService> ThumbnailService;
   QSharedPointer<QWidget> VisualDICOMBrowser;
 
   int ThumbnailSize;
@@ -493,6 +495,34 @@ void ctkDICOMStudyItemWidget::setScheduler(QSharedPointer<ctkDICOMScheduler> sch
     }
 }
 
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailService* ctkDICOMStudyItemWidget::thumbnailService()const
+{
+  Q_D(const ctkDICOMStudyItemWidget);
+  return d->ThumbnailService.data();
+}
+
+//----------------------------------------------------------------------------
+QSharedPointer<ctkDICOMThumbnailService> ctkDICOMStudyItemWidget::thumbnailServiceShared()const
+{
+  Q_D(const ctkDICOMStudyItemWidget);
+  return d->ThumbnailService;
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMStudyItemWidget::setThumbnailService(ctkDICOMThumbnailService& thumbnailService)
+{
+  Q_D(ctkDICOMStudyItemWidget);
+  d->ThumbnailService = QSharedPointer<ctkDICOMThumbnailService>(&thumbnailService, skipDelete);
+}
+
+//----------------------------------------------------------------------------
+void ctkDICOMStudyItemWidget::setThumbnailService(QSharedPointer<ctkDICOMThumbnailService> thumbnailService)
+{
+  Q_D(ctkDICOMStudyItemWidget);
+  d->ThumbnailService = thumbnailService;
+}
+
 //----------------------------------------------------------------------------
 ctkDICOMDatabase* ctkDICOMStudyItemWidget::dicomDatabase()const
 {
@@ -582,6 +612,10 @@ void ctkDICOMStudyItemWidget::addSeriesItemWidget(const int& tableIndex,
   seriesItemWidget->setThumbnailSize(d->ThumbnailSize);
   seriesItemWidget->setDicomDatabase(d->DicomDatabase);
   seriesItemWidget->setScheduler(d->Scheduler);
+  if (d->ThumbnailService)
+    {
+    seriesItemWidget->setThumbnailService(d->ThumbnailService);
+    }
   seriesItemWidget->generateInstances();
   seriesItemWidget->setContextMenuPolicy(Qt::CustomContextMenu);
 
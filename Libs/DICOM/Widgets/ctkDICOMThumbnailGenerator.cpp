@@ -27,10 +27,14 @@
 #include <QDebug>
 #include <QDir>
 #include <QImage>
+#include <QScopedPointer>
 
 // DCMTK includes
 #include "dcmtk/dcmimgle/dcmimage.h"
 
+// STD includes
+#include <cstring>
+
 static ctkLogger logger ( "org.commontk.dicom.DICOMThumbnailGenerator" );
 
 //------------------------------------------------------------------------------
@@ -134,57 +138,60 @@ bool ctkDICOMThumbnailGenerator::generateThumbnail(DicomImage *dcmImage, QImage&
     logger.warn(QString("Rendering of DICOM image failed for thumbnail failed: ") + DicomImage::getString(result));
     return false;
   }
+
+  // Scale the intermediate pixel data to the thumbnail size before rendering it,
+  // instead of rendering the full size image and scaling the rendered image.
+  const unsigned long sourceWidth = dcmImage->getWidth();
+  const unsigned long sourceHeight = dcmImage->getHeight();
+  QScopedPointer<DicomImage> scaledImage;
+  if (sourceWidth > 0 && sourceHeight > 0 && d->Width > 0 && d->Height > 0)
+  {
+    const double factor = qMin(double(d->Width) / sourceWidth, double(d->Height) / sourceHeight);
+    const unsigned long scaledWidth = qMax(1UL, static_cast<unsigned long>(sourceWidth * factor + 0.5));
+    const unsigned long scaledHeight = qMax(1UL, static_cast<unsigned long>(sourceHeight * factor + 0.5));
+    if (scaledWidth != sourceWidth || scaledHeight != sourceHeight)
+    {
+      scaledImage.reset(dcmImage->createScaledImage(scaledWidth, scaledHeight,
+        d->SmoothResize ? 1 : 0 /* interpolate */, 0 /* aspect ratio already applied */));
+    }
+  }
+  DicomImage* renderedImage = scaledImage ? scaledImage.data() : dcmImage;
+
   // Select first window defined in image. If none, compute min/max window as best guess.
   // Only relevant for monochrome.
-  if (dcmImage->isMonochrome())
+  if (renderedImage->isMonochrome())
   {
-    if (dcmImage->getWindowCount() > 0)
+    if (renderedImage->getWindowCount() > 0)
     {
-      dcmImage->setWindow(0);
+      renderedImage->setWindow(0);
     }
     else
     {
-      dcmImage->setMinMaxWindow(OFTrue /* ignore extreme values */);
+      renderedImage->setMinMaxWindow(OFTrue /* ignore extreme values */);
     }
   }
-  /* get image extension and prepare image header */
-  const unsigned long width = dcmImage->getWidth();
-  const unsigned long height = dcmImage->getHeight();
-  unsigned long offset = 0;
-  unsigned long length = 0;
-  QString header;
-
-  if (dcmImage->isMonochrome())
-  {
-    // write PGM header (binary monochrome image format)
-    header = QString("P5 %1 %2 255\n").arg(width).arg(height);
-    offset = header.length();
-    length = width * height + offset;
-  }
-  else
+
+  const int width = static_cast<int>(renderedImage->getWidth());
+  const int height = static_cast<int>(renderedImage->getHeight());
+  const int bytesPerPixel = renderedImage->isMonochrome() ? 1 : 3 /* RGB */;
+  const int bytesPerLine = width * bytesPerPixel;
+
+  /* render pixel data to buffer */
+  QByteArray buffer;
+  buffer.resize(bytesPerLine * height);
+  if (!renderedImage->getOutputData(static_cast<void *>(buffer.data()), buffer.size(), 8, 0))
   {
-    // write PPM header (binary color image format)
-    header = QString("P6 %1 %2 255\n").arg(width).arg(height);
-    offset = header.length();
-    length = width * height * 3 /* RGB */ + offset;
+    qCritical() << Q_FUNC_INFO << "QImage couldn't created";
+    return false;
   }
-  /* create output buffer for DicomImage class */
-  QByteArray buffer;
-  /* copy header to output buffer and resize it for pixel data */
-  buffer.append(header.toUtf8());
-  buffer.resize(length);
 
-  /* render pixel data to buffer */
-  if (dcmImage->getOutputData(static_cast<void *>(buffer.data() + offset), length - offset, 8, 0))
-  {  
-    if (!image.loadFromData( buffer ))
-    {
-      qCritical() << Q_FUNC_INFO << "QImage couldn't created";
-      return false;
-    }
+  // DicomImage rows are not padded, QImage rows are 32-bit aligned
+  image = QImage(width, height,
+    renderedImage->isMonochrome() ? QImage::Format_Grayscale8 : QImage::Format_RGB888);
+  for (int row = 0; row < height; ++row)
+  {
+    memcpy(image.scanLine(row), buffer.constData() + row * bytesPerLine, bytesPerLine);
   }
-  image = image.scaled( d->Width, d->Height, Qt::KeepAspectRatio,
-    (d->SmoothResize ? Qt::SmoothTransformation : Qt::FastTransformation) );
   return true;
 }
 
@@ -202,14 +209,17 @@ bool ctkDICOMThumbnailGenerator::generateThumbnail(DicomImage *dcmImage, const Q
 //------------------------------------------------------------------------------
 bool ctkDICOMThumbnailGenerator::generateThumbnail(const QString dcmImagePath, QImage& image)
 {
-  DicomImage dcmImage(QDir::toNativeSeparators(dcmImagePath).toUtf8());
+  // Only the first frame is needed
+  DicomImage dcmImage(QDir::toNativeSeparators(dcmImagePath).toUtf8(),
+                      CIF_UsePartialAccessToPixelData, 0, 1);
   return this->generateThumbnail(&dcmImage, image); 
 }
 
 //------------------------------------------------------------------------------
 bool ctkDICOMThumbnailGenerator::generateThumbnail(const QString dcmImagePath, const QString& thumbnailPath)
 {
-  DicomImage dcmImage(QDir::toNativeSeparators(dcmImagePath).toUtf8());
+  DicomImage dcmImage(QDir::toNativeSeparators(dcmImagePath).toUtf8(),
+                      CIF_UsePartialAccessToPixelData, 0, 1);
   return this->generateThumbnail(&dcmImage, thumbnailPath); 
 }
 
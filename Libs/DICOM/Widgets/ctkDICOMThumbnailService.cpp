@@ -0,0 +1,439 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCache>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QRunnable>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+
+// CTK includes
+#include <ctkLogger.h>
+
+// ctkDICOMWidgets includes
+#include "ctkDICOMThumbnailGenerator.h"
+#include "ctkDICOMThumbnailService.h"
+
+static ctkLogger logger("org.commontk.DICOM.Widgets.ctkDICOMThumbnailService");
+
+//------------------------------------------------------------------------------
+struct ctkDICOMThumbnailRequest
+{
+  QString SOPInstanceUID;
+  QString File;
+  int Size;
+  int Priority;
+  /// Objects waiting for the thumbnail (nullptr for anonymous requests).
+  QSet<const QObject*> Requesters;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMThumbnailServicePrivate
+{
+  Q_DECLARE_PUBLIC(ctkDICOMThumbnailService);
+
+protected:
+  ctkDICOMThumbnailService* const q_ptr;
+
+public:
+  ctkDICOMThumbnailServicePrivate(ctkDICOMThumbnailService& obj);
+  ~ctkDICOMThumbnailServicePrivate();
+
+  static QString requestKey(const QString& sopInstanceUID, int size);
+  QString cacheFilePath(const QString& sopInstanceUID, int size) const;
+
+  /// Remove the request from the queue of its priority. Requires Mutex.
+  void unqueueRequest(const QString& key, int priority);
+  /// Pop the pending request with the highest priority.
+  bool takeNextRequest(ctkDICOMThumbnailRequest& request);
+  /// Load the thumbnail from the disk cache, or generate it. Called from the pool threads.
+  void processRequest(const ctkDICOMThumbnailRequest& request);
+
+  QThreadPool ThreadPool;
+  QCache<QString, QImage> Cache;
+
+  /// Pending requests, by key and by priority (first in, first out).
+  mutable QMutex Mutex;
+  QHash<QString, ctkDICOMThumbnailRequest> PendingRequests;
+  QMap<int, QStringList> PendingKeysByPriority;
+  QSet<QString> RunningKeys;
+  QString CacheDirectory;
+};
+
+//------------------------------------------------------------------------------
+class ctkDICOMThumbnailServiceRunnable : public QRunnable
+{
+public:
+  ctkDICOMThumbnailServiceRunnable(ctkDICOMThumbnailServicePrivate* service)
+    : Service(service)
+  {
+  }
+
+  void run() override
+  {
+    // The request is selected when a thread is available, so that the requests
+    // whose priority changed in the meantime are served in the right order.
+    ctkDICOMThumbnailRequest request;
+    if (this->Service->takeNextRequest(request))
+      {
+      this->Service->processRequest(request);
+      }
+  }
+
+protected:
+  ctkDICOMThumbnailServicePrivate* Service;
+};
+
+//------------------------------------------------------------------------------
+// ctkDICOMThumbnailServicePrivate methods
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailServicePrivate::ctkDICOMThumbnailServicePrivate(ctkDICOMThumbnailService& obj)
+  : q_ptr(&obj)
+{
+  this->ThreadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+  this->Cache.setMaxCost(500);
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailServicePrivate::~ctkDICOMThumbnailServicePrivate()
+{
+  {
+  QMutexLocker locker(&this->Mutex);
+  this->PendingRequests.clear();
+  this->PendingKeysByPriority.clear();
+  }
+  this->ThreadPool.waitForDone();
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMThumbnailServicePrivate::requestKey(const QString& sopInstanceUID, int size)
+{
+  return sopInstanceUID + "|" + QString::number(size);
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMThumbnailServicePrivate::cacheFilePath(const QString& sopInstanceUID, int size) const
+{
+  QMutexLocker locker(&this->Mutex);
+  if (this->CacheDirectory.isEmpty())
+    {
+    return QString();
+    }
+  return QDir(this->CacheDirectory).filePath(QString("%1/%2.png").arg(size).arg(sopInstanceUID));
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailServicePrivate::unqueueRequest(const QString& key, int priority)
+{
+  QMap<int, QStringList>::iterator it = this->PendingKeysByPriority.find(priority);
+  if (it == this->PendingKeysByPriority.end())
+    {
+    return;
+    }
+  it.value().removeOne(key);
+  if (it.value().isEmpty())
+    {
+    this->PendingKeysByPriority.erase(it);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailServicePrivate::takeNextRequest(ctkDICOMThumbnailRequest& request)
+{
+  QMutexLocker locker(&this->Mutex);
+  if (this->PendingKeysByPriority.isEmpty())
+    {
+    return false;
+    }
+
+  QMap<int, QStringList>::iterator highest = this->PendingKeysByPriority.end() - 1;
+  QString key = highest.value().takeFirst();
+  if (highest.value().isEmpty())
+    {
+    this->PendingKeysByPriority.erase(highest);
+    }
+  request = this->PendingRequests.take(key);
+  this->RunningKeys.insert(key);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailServicePrivate::processRequest(const ctkDICOMThumbnailRequest& request)
+{
+  Q_Q(ctkDICOMThumbnailService);
+
+  QImage image;
+  bool loaded = false;
+  QString cacheFilePath = this->cacheFilePath(request.SOPInstanceUID, request.Size);
+  if (!cacheFilePath.isEmpty())
+    {
+    QFileInfo cacheFileInfo(cacheFilePath);
+    if (cacheFileInfo.exists() &&
+        cacheFileInfo.lastModified() >= QFileInfo(request.File).lastModified())
+      {
+      loaded = image.load(cacheFilePath, "PNG");
+      }
+    }
+
+  if (!loaded)
+    {
+    ctkDICOMThumbnailGenerator thumbnailGenerator;
+    thumbnailGenerator.setWidth(request.Size);
+    thumbnailGenerator.setHeight(request.Size);
+    thumbnailGenerator.setSmoothResize(true);
+    if (!thumbnailGenerator.generateThumbnail(request.File, image))
+      {
+      image = QImage();
+      }
+    else if (!cacheFilePath.isEmpty())
+      {
+      QDir().mkpath(QFileInfo(cacheFilePath).absolutePath());
+      if (!image.save(cacheFilePath, "PNG"))
+        {
+        logger.warn("Failed to write thumbnail cache file " + cacheFilePath);
+        }
+      }
+    }
+
+  QMetaObject::invokeMethod(q, "onThumbnailGenerated", Qt::QueuedConnection,
+                            Q_ARG(QString, request.SOPInstanceUID),
+                            Q_ARG(int, request.Size),
+                            Q_ARG(QImage, image));
+}
+
+//------------------------------------------------------------------------------
+// ctkDICOMThumbnailService methods
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailService::ctkDICOMThumbnailService(QObject* parentObject)
+  : Superclass(parentObject)
+  , d_ptr(new ctkDICOMThumbnailServicePrivate(*this))
+{
+}
+
+//------------------------------------------------------------------------------
+ctkDICOMThumbnailService::~ctkDICOMThumbnailService()
+{
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailService::maximumThreadCount() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  return d->ThreadPool.maxThreadCount();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::setMaximumThreadCount(int maximumThreadCount)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->ThreadPool.setMaxThreadCount(qMax(1, maximumThreadCount));
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailService::maximumCacheSize() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  return d->Cache.maxCost();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::setMaximumCacheSize(int maximumCacheSize)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->Cache.setMaxCost(qMax(0, maximumCacheSize));
+}
+
+//------------------------------------------------------------------------------
+QString ctkDICOMThumbnailService::cacheDirectory() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  QMutexLocker locker(&d->Mutex);
+  return d->CacheDirectory;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::setCacheDirectory(const QString& cacheDirectory)
+{
+  Q_D(ctkDICOMThumbnailService);
+  QMutexLocker locker(&d->Mutex);
+  d->CacheDirectory = cacheDirectory;
+}
+
+//------------------------------------------------------------------------------
+bool ctkDICOMThumbnailService::cachedThumbnail(const QString& sopInstanceUID, int size, QImage& image)
+{
+  Q_D(ctkDICOMThumbnailService);
+  QImage* cachedImage = d->Cache.object(ctkDICOMThumbnailServicePrivate::requestKey(sopInstanceUID, size));
+  if (!cachedImage)
+    {
+    return false;
+    }
+  image = *cachedImage;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::requestThumbnail(const QString& sopInstanceUID,
+                                                const QString& file,
+                                                int size,
+                                                QThread::Priority priority,
+                                                const QObject* requester)
+{
+  Q_D(ctkDICOMThumbnailService);
+  if (sopInstanceUID.isEmpty() || file.isEmpty() || size <= 0)
+    {
+    return;
+    }
+
+  QString key = ctkDICOMThumbnailServicePrivate::requestKey(sopInstanceUID, size);
+  {
+  QMutexLocker locker(&d->Mutex);
+  if (d->RunningKeys.contains(key))
+    {
+    return;
+    }
+
+  QHash<QString, ctkDICOMThumbnailRequest>::iterator it = d->PendingRequests.find(key);
+  if (it != d->PendingRequests.end())
+    {
+    it.value().File = file;
+    it.value().Requesters.insert(requester);
+    if (it.value().Priority != priority)
+      {
+      d->unqueueRequest(key, it.value().Priority);
+      it.value().Priority = priority;
+      d->PendingKeysByPriority[priority].append(key);
+      }
+    return;
+    }
+
+  ctkDICOMThumbnailRequest request;
+  request.SOPInstanceUID = sopInstanceUID;
+  request.File = file;
+  request.Size = size;
+  request.Priority = priority;
+  request.Requesters.insert(requester);
+  d->PendingRequests.insert(key, request);
+  d->PendingKeysByPriority[priority].append(key);
+  }
+
+  d->ThreadPool.start(new ctkDICOMThumbnailServiceRunnable(d));
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::setThumbnailPriority(const QString& sopInstanceUID,
+                                                    int size,
+                                                    QThread::Priority priority)
+{
+  Q_D(ctkDICOMThumbnailService);
+  QString key = ctkDICOMThumbnailServicePrivate::requestKey(sopInstanceUID, size);
+  QMutexLocker locker(&d->Mutex);
+  QHash<QString, ctkDICOMThumbnailRequest>::iterator it = d->PendingRequests.find(key);
+  if (it == d->PendingRequests.end() || it.value().Priority == priority)
+    {
+    return;
+    }
+  d->unqueueRequest(key, it.value().Priority);
+  it.value().Priority = priority;
+  d->PendingKeysByPriority[priority].append(key);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::cancelThumbnail(const QString& sopInstanceUID, int size,
+                                               const QObject* requester)
+{
+  Q_D(ctkDICOMThumbnailService);
+  QString key = ctkDICOMThumbnailServicePrivate::requestKey(sopInstanceUID, size);
+  QMutexLocker locker(&d->Mutex);
+  QHash<QString, ctkDICOMThumbnailRequest>::iterator it = d->PendingRequests.find(key);
+  if (it == d->PendingRequests.end())
+    {
+    return;
+    }
+  // Other objects still wait for the same thumbnail
+  it.value().Requesters.remove(requester);
+  if (!it.value().Requesters.isEmpty())
+    {
+    return;
+    }
+  d->unqueueRequest(key, it.value().Priority);
+  d->PendingRequests.erase(it);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::cancelAllThumbnails()
+{
+  Q_D(ctkDICOMThumbnailService);
+  QMutexLocker locker(&d->Mutex);
+  d->PendingRequests.clear();
+  d->PendingKeysByPriority.clear();
+}
+
+//------------------------------------------------------------------------------
+int ctkDICOMThumbnailService::numberOfPendingThumbnails() const
+{
+  Q_D(const ctkDICOMThumbnailService);
+  QMutexLocker locker(&d->Mutex);
+  return d->PendingRequests.count();
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::waitForDone()
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->ThreadPool.waitForDone();
+  QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::clearCache(bool clearDiskCache)
+{
+  Q_D(ctkDICOMThumbnailService);
+  d->Cache.clear();
+
+  QString cacheDirectory = this->cacheDirectory();
+  if (clearDiskCache && !cacheDirectory.isEmpty())
+    {
+    QDir(cacheDirectory).removeRecursively();
+    }
+}
+
+//------------------------------------------------------------------------------
+void ctkDICOMThumbnailService::onThumbnailGenerated(const QString& sopInstanceUID, int size, const QImage& image)
+{
+  Q_D(ctkDICOMThumbnailService);
+  QString key = ctkDICOMThumbnailServicePrivate::requestKey(sopInstanceUID, size);
+  {
+  QMutexLocker locker(&d->Mutex);
+  d->RunningKeys.remove(key);
+  }
+
+  d->Cache.insert(key, new QImage(image));
+  emit this->thumbnailReady(sopInstanceUID, size, image);
+}
@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkDICOMThumbnailService_h
+#define __ctkDICOMThumbnailService_h
+
+// Qt includes
+#include <QImage>
+#include <QObject>
+#include <QThread>
+
+#include "ctkDICOMWidgetsExport.h"
+
+class ctkDICOMThumbnailServicePrivate;
+
+/// \ingroup DICOM_Widgets
+///
+/// \brief Generate the thumbnails of DICOM instances off the GUI thread.
+///
+/// Thumbnails are generated by a bounded pool of threads. The pending requests
+/// are served by priority, and their priority can be changed while they wait
+/// (e.g. when the widget displaying the thumbnail is shown or hidden).
+///
+/// Generated thumbnails are kept in a memory cache (least recently used) and,
+/// if cacheDirectory is set, in a disk cache keyed by SOPInstanceUID and size.
+/// Cached files older than their DICOM file are regenerated.
+///
+/// The service must be used from the thread it lives in (usually the GUI thread):
+/// thumbnailReady() is emitted in that thread.
+class CTK_DICOM_WIDGETS_EXPORT ctkDICOMThumbnailService : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(int maximumThreadCount READ maximumThreadCount WRITE setMaximumThreadCount);
+  Q_PROPERTY(int maximumCacheSize READ maximumCacheSize WRITE setMaximumCacheSize);
+  Q_PROPERTY(QString cacheDirectory READ cacheDirectory WRITE setCacheDirectory);
+
+public:
+  typedef QObject Superclass;
+  explicit ctkDICOMThumbnailService(QObject* parent = nullptr);
+  virtual ~ctkDICOMThumbnailService();
+
+  /// Maximum number of threads generating thumbnails.
+  /// Default is half the number of cores (at least 1).
+  int maximumThreadCount() const;
+  void setMaximumThreadCount(int maximumThreadCount);
+
+  /// Maximum number of thumbnails kept in memory. Default is 500.
+  int maximumCacheSize() const;
+  void setMaximumCacheSize(int maximumCacheSize);
+
+  /// Folder of the disk cache. The disk cache is disabled if empty (default).
+  QString cacheDirectory() const;
+  void setCacheDirectory(const QString& cacheDirectory);
+
+  /// Return true and set image if the thumbnail is in the memory cache.
+  /// A null image means that the thumbnail could not be generated
+  /// (e.g. the instance is not an image).
+  Q_INVOKABLE bool cachedThumbnail(const QString& sopInstanceUID, int size, QImage& image);
+
+  /// Queue the generation of the thumbnail of file, thumbnailReady() is emitted when done.
+  /// Requesting a thumbnail already pending only updates its priority and adds
+  /// requester to the objects waiting for it.
+  Q_INVOKABLE void requestThumbnail(const QString& sopInstanceUID,
+                                    const QString& file,
+                                    int size,
+                                    QThread::Priority priority = QThread::NormalPriority,
+                                    const QObject* requester = nullptr);
+  /// Change the priority of a pending request.
+  Q_INVOKABLE void setThumbnailPriority(const QString& sopInstanceUID,
+                                        int size,
+                                        QThread::Priority priority);
+  /// Withdraw requester from a pending request. The request is removed once no
+  /// requester is left, so that the other objects waiting for the same thumbnail
+  /// still get it. A thumbnail already being generated is still reported.
+  Q_INVOKABLE void cancelThumbnail(const QString& sopInstanceUID, int size,
+                                   const QObject* requester = nullptr);
+  /// Remove all the pending requests.
+  Q_INVOKABLE void cancelAllThumbnails();
+
+  /// Number of thumbnails waiting to be generated.
+  Q_INVOKABLE int numberOfPendingThumbnails() const;
+
+  /// Block until all the requested thumbnails are generated.
+  /// thumbnailReady() is emitted for all of them before returning.
+  Q_INVOKABLE void waitForDone();
+
+  /// Clear the memory cache and, if clearDiskCache is true, the disk cache.
+  Q_INVOKABLE void clearCache(bool clearDiskCache = false);
+
+Q_SIGNALS:
+  /// Emitted when a requested thumbnail is generated or loaded from the disk cache.
+  /// image is null if the thumbnail could not be generated.
+  void thumbnailReady(const QString& sopInstanceUID, int size, const QImage& image);
+
+protected Q_SLOTS:
+  void onThumbnailGenerated(const QString& sopInstanceUID, int size, const QImage& image);
+
+protected:
+  QScopedPointer<ctkDICOMThumbnailServicePrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(ctkDICOMThumbnailService);
+  Q_DISABLE_COPY(ctkDICOMThumbnailService);
+};
+
+#endif
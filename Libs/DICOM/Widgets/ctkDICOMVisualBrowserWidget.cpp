@@ -44,6 +44,7 @@
 #include "ctkDICOMDatabase.h"
 #include "ctkDICOMIndexer.h"
 #include "ctkDICOMScheduler.h"
+#include "ctkDICOMThumbnailService.h"
 #include "ctkDICOMServer.h"
 #include "ctkDICOMJobResponseSet.h"
 #include "ctkUtils.h"
@@ -205,6 +206,7 @@ public:
 
   QSharedPointer<ctkDICOMDatabase> DicomDatabase;
   QSharedPointer<ctkDICOMScheduler> Scheduler;
+  QSharedPointer<ctkDICOMThumbnailService> ThumbnailService;
   QSharedPointer<ctkDICOMIndexer> Indexer;
 
   QString FilteringPatientID;
@@ -243,6 +245,8 @@ ctkDICOMVisualBrowserWidgetPrivate::ctkDICOMVisualBrowserWidgetPrivate(ctkDICOMV
   this->Scheduler = QSharedPointer<ctkDICOMScheduler> (new ctkDICOMScheduler);
   this->Scheduler->setDicomDatabase(this->DicomDatabase);
 
+  this->ThumbnailService = QSharedPointer<ctkDICOMThumbnailService> (new ctkDICOMThumbnailService);
+
   this->Indexer = QSharedPointer<ctkDICOMIndexer> (new ctkDICOMIndexer);
   this->Indexer->setDatabase(this->DicomDatabase.data());
 
@@ -1307,6 +1311,13 @@ QSharedPointer<ctkDICOMScheduler> ctkDICOMVisualBrowserWidget::schedulerShared()
   return d->Scheduler;
 }
 
+//----------------------------------------------------------------------------
+ctkDICOMThumbnailService* ctkDICOMVisualBrowserWidget::thumbnailService()const
+{
+  Q_D(const ctkDICOMVisualBrowserWidget);
+  return d->ThumbnailService.data();
+}
+
 //----------------------------------------------------------------------------
 void ctkDICOMVisualBrowserWidget::setScheduler(ctkDICOMScheduler& Scheduler)
 {
@@ -1658,6 +1669,9 @@ void ctkDICOMVisualBrowserWidget::addPatientItemWidget(const QString& patientIte
   patientItemWidget->setNumberOfStudiesPerPatient(d->NumberOfStudiesPerPatient);
   patientItemWidget->setDicomDatabase(d->DicomDatabase);
   patientItemWidget->setScheduler(d->Scheduler);
+  d->ThumbnailService->setCacheDirectory(d->DicomDatabase->isInMemory() ?
+    QString() : d->DicomDatabase->databaseDirectory() + "/thumbs/browser");
+  patientItemWidget->setThumbnailService(d->ThumbnailService);
   patientItemWidget->setContextMenuPolicy(Qt::CustomContextMenu);
   this->connect(patientItemWidget, SIGNAL(customContextMenuRequested(const QPoint&)),
                 this, SLOT(showPatientContextMenu(const QPoint&)));
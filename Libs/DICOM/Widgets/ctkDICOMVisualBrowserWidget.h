@@ -40,6 +40,7 @@ class ctkDICOMVisualBrowserWidgetPrivate;
 class ctkDICOMDatabase;
 class ctkFileDialog;
 class ctkDICOMScheduler;
+class ctkDICOMThumbnailService;
 class ctkDICOMServer;
 class ctkDICOMServerNodeWidget2;
 class ctkDICOMJobResponseSet;
@@ -118,6 +119,10 @@ public:
   /// (not Python-wrappable).
   void setScheduler(QSharedPointer<ctkDICOMScheduler> scheduler);
 
+  /// Return the service generating the series thumbnails.
+  /// Its disk cache is stored in the database folder.
+  Q_INVOKABLE ctkDICOMThumbnailService* thumbnailService() const;
+
   /// Return the Dicom Database.
   Q_INVOKABLE ctkDICOMDatabase* dicomDatabase() const;
   /// Return Dicom Database as a shared pointer
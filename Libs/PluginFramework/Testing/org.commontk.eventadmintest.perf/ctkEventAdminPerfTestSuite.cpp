@@ -22,20 +22,23 @@
 
 #include "ctkEventAdminPerfTestSuite_p.h"
 
+#include <ctkPluginConstants.h>
 #include <ctkPluginContext.h>
 #include <ctkServiceEvent.h>
 
 #include <service/event/ctkEventAdmin.h>
 #include <service/event/ctkEventConstants.h>
+#include <service/cm/ctkManagedService.h>
 
 #include <QTest>
 #include <QDebug>
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
 #include <QElapsedTimer>
-#else
+#if (QT_VERSION < QT_VERSION_CHECK(5, 14, 0))
 #include <QTime>
 #endif
 
+#include <algorithm>
+
 
 //----------------------------------------------------------------------------
 TestEventHandler::TestEventHandler(int& counter)
@@ -48,6 +51,30 @@ void TestEventHandler::handleEvent(const ctkEvent& )
   counter++;
 }
 
+//----------------------------------------------------------------------------
+AtomicCountEventHandler::AtomicCountEventHandler(QAtomicInt& counter)
+  : counter(counter)
+{}
+
+//----------------------------------------------------------------------------
+void AtomicCountEventHandler::handleEvent(const ctkEvent& )
+{
+  counter.ref();
+}
+
+//----------------------------------------------------------------------------
+LatencyEventHandler::LatencyEventHandler(const QElapsedTimer& timer, QMutex& mutex, QList<qint64>& latencies)
+  : timer(timer), mutex(mutex), latencies(latencies)
+{}
+
+//----------------------------------------------------------------------------
+void LatencyEventHandler::handleEvent(const ctkEvent& event)
+{
+  qint64 latency = timer.nsecsElapsed() - event.getProperty("timestamp").toLongLong();
+  QMutexLocker l(&mutex);
+  latencies.push_back(latency);
+}
+
 //----------------------------------------------------------------------------
 ctkEventAdminPerfTestSuite::ctkEventAdminPerfTestSuite(ctkPluginContext *context, int pluginId)
   : pc(context)
@@ -56,6 +83,11 @@ ctkEventAdminPerfTestSuite::ctkEventAdminPerfTestSuite(ctkPluginContext *context
   , nHandlers(40)
   , nEvent1Handled(0)
   , nEvent2Handled(0)
+  , nTopicHandlers(1000)
+  , nTopics(10000)
+  , nTopicEventsHandled(0)
+  , nLatencyHandlers(10)
+  , nLatencyEvents(20000)
   , eventAdmin(0)
 {
 }
@@ -138,6 +170,63 @@ void ctkEventAdminPerfTestSuite::postEvents()
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::addTopicHandlers()
+{
+  // The first handlers listen to all the topics of a group, the
+  // other ones to a single topic
+  qDebug() << "Adding" << nTopicHandlers << "event handlers for distinct topics";
+  for (int i = 0; i < nTopicHandlers; ++i)
+  {
+    AtomicCountEventHandler* h = new AtomicCountEventHandler(nTopicEventsHandled);
+    handlers.push_back(h);
+    ctkDictionary props;
+    if (i < 100)
+    {
+      props.insert(ctkEventConstants::EVENT_TOPIC, QString("org/commontk/perf/%1/*").arg(i));
+    }
+    else
+    {
+      props.insert(ctkEventConstants::EVENT_TOPIC, QString("org/commontk/perf/%1/%2").arg(i % 100).arg(i));
+    }
+    handlerRegistrations.push_back(pc->registerService<ctkEventHandler>(h, props));
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::configureEventAdmin(const ctkDictionary& config)
+{
+  QList<ctkServiceReference> refs = pc->getServiceReferences<ctkManagedService>(
+        QString("(") + ctkPluginConstants::SERVICE_PID + "=org.commontk.eventadmin.impl.EventAdmin)");
+  QVERIFY(!refs.isEmpty());
+  ctkManagedService* managedService = pc->getService<ctkManagedService>(refs.front());
+  QVERIFY(managedService);
+
+  managedService->updated(config);
+  pc->ungetService(refs.front());
+
+  // the configuration is updated in the background
+  QTest::qWait(1000);
+}
+
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::sendTopicEvents()
+{
+  for (int i = 0; i < nTopics; ++i)
+  {
+    eventAdmin->sendEvent(ctkEvent(QString("org/commontk/perf/%1/%2").arg(i % 100).arg(i)));
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::postTopicEvents()
+{
+  for (int i = 0; i < nTopics; ++i)
+  {
+    eventAdmin->postEvent(ctkEvent(QString("org/commontk/perf/%1/%2").arg(i % 100).arg(i)));
+  }
+}
+
 //----------------------------------------------------------------------------
 void ctkEventAdminPerfTestSuite::initTestCase()
 {
@@ -185,6 +274,128 @@ void ctkEventAdminPerfTestSuite::testPostEvents()
   QTest::qWait(10000);
 }
 
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::testTopicIndex()
+{
+  addTopicHandlers();
+
+  // Every event goes to the handler of its group, and to
+  // the handler of its topic if there is one
+  const int nExpected = nTopics + qMin(nTopics, nTopicHandlers) - 100;
+
+  QList<bool> topicIndexModes;
+  topicIndexModes << false << true;
+  foreach (bool topicIndex, topicIndexModes)
+  {
+    ctkDictionary config;
+    config.insert("org.commontk.eventadmin.ThreadPoolSize", 10);
+    config.insert("org.commontk.eventadmin.TopicIndex", topicIndex);
+    configureEventAdmin(config);
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    QElapsedTimer t;
+#else
+    QTime t;
+#endif
+    nTopicEventsHandled.storeRelease(0);
+    t.start();
+    sendTopicEvents();
+    int sendMs = t.elapsed();
+    QCOMPARE(nTopicEventsHandled.loadAcquire(), nExpected);
+
+    nTopicEventsHandled.storeRelease(0);
+    t.start();
+    postTopicEvents();
+    QTRY_COMPARE_WITH_TIMEOUT(nTopicEventsHandled.loadAcquire(), nExpected, 60000);
+    int postMs = t.elapsed();
+
+    qDebug() << (topicIndex ? "Topic index:" : "Topic filter:")
+             << "sending" << nTopics << "synchronous events took" << sendMs << "ms,"
+             << "delivering" << nTopics << "asynchronous events took" << postMs << "ms,"
+             << nTopicHandlers << "handlers";
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkEventAdminPerfTestSuite::testAsyncDelivery()
+{
+  QElapsedTimer timer;
+  timer.start();
+  QMutex mutex;
+  QList<qint64> latencies;
+
+  QList<ctkServiceRegistration> registrations;
+  QList<ctkEventHandler*> latencyHandlers;
+  for (int i = 0; i < nLatencyHandlers; ++i)
+  {
+    LatencyEventHandler* h = new LatencyEventHandler(timer, mutex, latencies);
+    latencyHandlers.push_back(h);
+    ctkDictionary props;
+    props.insert(ctkEventConstants::EVENT_TOPIC, "org/commontk/perf/latency");
+    registrations.push_back(pc->registerService<ctkEventHandler>(h, props));
+  }
+
+  QList<bool> ringBufferModes;
+  ringBufferModes << false << true;
+  foreach (bool ringBuffer, ringBufferModes)
+  {
+    ctkDictionary config;
+    config.insert("org.commontk.eventadmin.ThreadPoolSize", 10);
+    config.insert("org.commontk.eventadmin.Timeout", 0);
+    config.insert("org.commontk.eventadmin.AsyncRingBuffer", ringBuffer);
+    configureEventAdmin(config);
+
+    {
+      QMutexLocker l(&mutex);
+      latencies.clear();
+    }
+
+    qint64 start = timer.nsecsElapsed();
+    for (int i = 0; i < nLatencyEvents; ++i)
+    {
+      ctkDictionary props;
+      props.insert("timestamp", timer.nsecsElapsed());
+      eventAdmin->postEvent(ctkEvent("org/commontk/perf/latency", props));
+    }
+    qint64 postNs = timer.nsecsElapsed() - start;
+
+    const int nExpected = nLatencyEvents * nLatencyHandlers;
+    int nHandled = 0;
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    while (nHandled < nExpected && waitTimer.elapsed() < 60000)
+    {
+      QTest::qWait(10);
+      QMutexLocker l(&mutex);
+      nHandled = latencies.size();
+    }
+    qint64 deliverNs = timer.nsecsElapsed() - start;
+    QCOMPARE(nHandled, nExpected);
+
+    QList<qint64> sorted;
+    {
+      QMutexLocker l(&mutex);
+      sorted = latencies;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    qDebug() << (ringBuffer ? "Ring buffer:" : "Thread pool:")
+             << "posting" << nLatencyEvents << "events took" << postNs / 1000000 << "ms,"
+             << nExpected * 1000000000.0 / deliverNs << "deliveries/s to" << nLatencyHandlers << "handlers,"
+             << "latency p50" << sorted[nExpected / 2] / 1000 << "us,"
+             << "p99" << sorted[nExpected * 99 / 100] / 1000 << "us,"
+             << "p99.9" << sorted[nExpected * 999 / 1000] / 1000 << "us";
+  }
+
+  foreach(ctkServiceRegistration sr, registrations)
+  {
+    sr.unregister();
+  }
+  // let the pending deliveries to the unregistered handlers finish
+  QTest::qWait(1000);
+  qDeleteAll(latencyHandlers);
+}
+
 //----------------------------------------------------------------------------
 void ctkEventAdminPerfTestSuite::cleanupTestCase()
 {
@@ -28,8 +28,11 @@
 #include <service/event/ctkEventHandler.h>
 #include <ctkServiceRegistration.h>
 
+#include <QAtomicInt>
 #include <QDebug>
+#include <QMutex>
 
+class QElapsedTimer;
 struct ctkEventAdmin;
 
 class ctkEventAdminPerfTestSuite : public QObject, public ctkTestSuiteInterface
@@ -48,6 +51,13 @@ private:
   int nEvent1Handled;
   int nEvent2Handled;
 
+  int nTopicHandlers;
+  int nTopics;
+  QAtomicInt nTopicEventsHandled;
+
+  int nLatencyHandlers;
+  int nLatencyEvents;
+
   ctkEventAdmin* eventAdmin;
 
   QList<ctkEventHandler*> handlers;
@@ -65,11 +75,18 @@ private:
   void sendEvents();
   void postEvents();
 
+  void addTopicHandlers();
+  void configureEventAdmin(const ctkDictionary& config);
+  void sendTopicEvents();
+  void postTopicEvents();
+
 private Q_SLOTS:
 
   void initTestCase();
   void testSendEvents();
   void testPostEvents();
+  void testTopicIndex();
+  void testAsyncDelivery();
   void cleanupTestCase();
 };
 
@@ -84,4 +101,35 @@ public:
   void handleEvent(const ctkEvent& );
 };
 
+/**
+ * Counts the events it handles, the events may be delivered by several threads.
+ */
+class AtomicCountEventHandler : public QObject, public ctkEventHandler
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkEventHandler)
+private:
+  QAtomicInt& counter;
+public:
+  AtomicCountEventHandler(QAtomicInt& counter);
+  void handleEvent(const ctkEvent& );
+};
+
+/**
+ * Records the time between the posting and the delivery of the events,
+ * using the nanoseconds of a shared timer stored in the "timestamp" property.
+ */
+class LatencyEventHandler : public QObject, public ctkEventHandler
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkEventHandler)
+private:
+  const QElapsedTimer& timer;
+  QMutex& mutex;
+  QList<qint64>& latencies;
+public:
+  LatencyEventHandler(const QElapsedTimer& timer, QMutex& mutex, QList<qint64>& latencies);
+  void handleEvent(const ctkEvent& event);
+};
+
 #endif // CTKEAPERFTESTSUITE_P_H
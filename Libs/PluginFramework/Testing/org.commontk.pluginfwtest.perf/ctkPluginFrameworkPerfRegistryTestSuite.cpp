@@ -37,6 +37,8 @@ ctkPluginFrameworkPerfRegistryTestSuite::ctkPluginFrameworkPerfRegistryTestSuite
   , pc(context)
   , nListeners(100)
   , nServices(1000)
+  , nLookupServices(5000)
+  , nLookups(2000)
   , nRegistered(0)
   , nUnregistering(0)
   , nModified(0)
@@ -194,6 +196,55 @@ void ctkPluginFrameworkPerfRegistryTestSuite::unregisterServices()
   regs.clear();
 }
 
+//----------------------------------------------------------------------------
+void ctkPluginFrameworkPerfRegistryTestSuite::testLookupServices()
+{
+  qDebug() << "Register" << nLookupServices << "services and look them up"
+           << "by indexed and non-indexed properties";
+
+  QString pid("my.lookup.service.%1");
+  QString topic("org/commontk/lookup/%1/*");
+  for(int i = 0; i < nLookupServices; i++)
+  {
+    ctkDictionary props;
+    props.insert("service.pid", pid.arg(i));
+    props.insert("event.topics", QStringList() << topic.arg(i));
+    props.insert("perf.lookup.group", i % 10);
+
+    QObject* service = new PerfTestService();
+    services.push_back(service);
+    regs.push_back(pc->registerService<IPerfTestService>(service, props));
+  }
+
+  // Same kind of filter as the one built by the EventAdmin for a topic
+  QString topicFilter("(|(event.topics=\\*)(event.topics=org/\\*)"
+                      "(event.topics=org/commontk/\\*)(event.topics=org/commontk/lookup/\\*)"
+                      "(event.topics=org/commontk/lookup/%1/\\*))");
+
+  QCOMPARE(lookupServices(QString("(service.pid=") + pid + ")", nLookups), nLookups);
+  QCOMPARE(lookupServices(topicFilter, nLookups), nLookups);
+  QCOMPARE(lookupServices("(perf.lookup.group=3)", nLookups / 10),
+           nLookups / 10 * nLookupServices / 10);
+
+  unregisterServices();
+}
+
+//----------------------------------------------------------------------------
+int ctkPluginFrameworkPerfRegistryTestSuite::lookupServices(const QString& filter, int n)
+{
+  int nFound = 0;
+  ctkHighPrecisionTimer t;
+  t.start();
+  for(int i = 0; i < n; i++)
+  {
+    QString f = filter.contains("%1") ? filter.arg((i * 7919) % nLookupServices) : filter;
+    nFound += pc->getServiceReferences<IPerfTestService>(f).size();
+  }
+  qint64 us = t.elapsedMicro();
+  log() << n << "lookups with" << filter << "took" << us / 1000 << "ms ("
+        << (us > 0 ? n * 1000000 / us : n) << "lookups/s)";
+  return nFound;
+}
 
 //----------------------------------------------------------------------------
 ctkServiceListener::ctkServiceListener(ctkPluginFrameworkPerfRegistryTestSuite* ts)
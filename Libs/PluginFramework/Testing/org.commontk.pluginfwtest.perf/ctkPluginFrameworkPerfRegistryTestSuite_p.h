@@ -44,6 +44,8 @@ private:
 
   int nListeners;
   int nServices;
+  int nLookupServices;
+  int nLookups;
 
   int nRegistered;
   int nUnregistering;
@@ -70,6 +72,7 @@ private:
   void registerServices(int n);
   void modifyServices();
   void unregisterServices();
+  int lookupServices(const QString& filter, int n);
 
 private Q_SLOTS:
 
@@ -81,6 +84,8 @@ private Q_SLOTS:
 
   void testModifyServices();
   void testUnregisterServices();
+
+  void testLookupServices();
 };
 
 class ctkServiceListener : public QObject
@@ -99,19 +99,26 @@ class ctkLDAPExprData : public QSharedData
 public:
 
   ctkLDAPExprData( int op, QList<ctkLDAPExpr> args )
-    : m_operator(op), m_args(args)
+    : m_operator(op), m_args(args), m_hasWildcard(false)
   {
   }
 
   ctkLDAPExprData( int op, QString attrName, QString attrValue )
-    : m_operator(op), m_attrName(attrName), m_attrValue(attrValue)
+    : m_operator(op), m_attrName(attrName), m_attrValue(attrValue),
+    m_attrNameLower(attrName.toLower()),
+    m_hasWildcard(attrValue.indexOf(ctkLDAPExpr::WILDCARD) >= 0)
   {
+    if (op == ctkLDAPExpr::APPROX)
+    {
+      m_approxValue = ctkLDAPExpr::fixupString(attrValue);
+    }
   }
 
   ctkLDAPExprData( const ctkLDAPExprData& other )
     : QSharedData(other), m_operator(other.m_operator),
     m_args(other.m_args), m_attrName(other.m_attrName),
-    m_attrValue(other.m_attrValue)
+    m_attrValue(other.m_attrValue), m_attrNameLower(other.m_attrNameLower),
+    m_hasWildcard(other.m_hasWildcard), m_approxValue(other.m_approxValue)
   {
   }
 
@@ -123,6 +130,17 @@ public:
   QString m_attrName;
   //!
   QString m_attrValue;
+
+  // The following members are computed once when parsing the filter,
+  // so that evaluating it against many property sets does not redo
+  // the same work for every comparison.
+
+  //! The attribute name in lower case, for case-insensitive lookups
+  QString m_attrNameLower;
+  //! Whether the attribute value contains a wildcard
+  bool m_hasWildcard;
+  //! The attribute value prepared for APPROX comparisons
+  QString m_approxValue;
 };
 
 //----------------------------------------------------------------------------
@@ -186,13 +204,18 @@ ctkLDAPExpr::~ctkLDAPExpr()
 
 //----------------------------------------------------------------------------
 bool ctkLDAPExpr::getMatchedObjectClasses(QSet<QString>& objClasses) const
+{
+  return getMatchedValues(ctkPluginConstants::OBJECTCLASS, objClasses);
+}
+
+//----------------------------------------------------------------------------
+bool ctkLDAPExpr::getMatchedValues(const QString& attrName, QSet<QString>& values) const
 {
   if (d->m_operator == EQ)
   {
-    if (d->m_attrName.compare(ctkPluginConstants::OBJECTCLASS, Qt::CaseInsensitive) == 0 &&
-      d->m_attrValue.indexOf(WILDCARD) < 0) 
+    if (d->m_attrNameLower == attrName && !d->m_hasWildcard)
     {
-      objClasses.insert( d->m_attrValue );
+      values.insert( d->m_attrValue );
       return true;
     }
     return false;
@@ -203,19 +226,19 @@ bool ctkLDAPExpr::getMatchedObjectClasses(QSet<QString>& objClasses) const
     for (int i = 0; i < d->m_args.size( ); i++)
     {
       QSet<QString> r;
-      if(d->m_args[i].getMatchedObjectClasses(r))
+      if(d->m_args[i].getMatchedValues(attrName, r))
       {
-        result = true;
-        if (objClasses.empty())
+        if (!result)
         {
-          objClasses = r;
+          values = r;
         }
         else
         {
-          // if AND op and classes in several operands,
+          // if AND op and values in several operands,
           // then only the intersection is possible.
-          objClasses.intersect(r);
+          values.intersect(r);
         }
+        result = true;
       }
     }
     return result;
@@ -225,13 +248,13 @@ bool ctkLDAPExpr::getMatchedObjectClasses(QSet<QString>& objClasses) const
     for (int i = 0; i < d->m_args.length( ); i++)
     {
       QSet<QString> r;
-      if (d->m_args[i].getMatchedObjectClasses(r))
+      if (d->m_args[i].getMatchedValues(attrName, r))
       {
-        objClasses += r;
+        values += r;
       }
       else
       {
-        objClasses.clear();
+        values.clear();
         return false;
       }
     }
@@ -253,8 +276,8 @@ bool ctkLDAPExpr::isSimple(
 
   if (d->m_operator == EQ) {
     int index;
-    if ((index = keywords.indexOf(matchCase ? d->m_attrName : d->m_attrName.toLower())) >= 0 &&
-      d->m_attrValue.indexOf(WILDCARD) < 0) {
+    if ((index = keywords.indexOf(matchCase ? d->m_attrName : d->m_attrNameLower)) >= 0 &&
+      !d->m_hasWildcard) {
         cache[index] = QStringList(d->m_attrValue);
         return true;
     }
@@ -286,7 +309,7 @@ bool ctkLDAPExpr::evaluate( const ctkServiceProperties &p, bool matchCase ) cons
   if ((d->m_operator & SIMPLE) != 0) {
     // try case sensitive match first
     int index = p.findCaseSensitive(d->m_attrName);
-    if (index < 0 && !matchCase) index = p.find(d->m_attrName);
+    if (index < 0 && !matchCase) index = p.findLowerCase(d->m_attrNameLower);
     return index < 0 ? false : compare(p.value(index), d->m_operator, d->m_attrValue);
   } else { // (d->m_operator & COMPLEX) != 0
     switch (d->m_operator) {
@@ -319,9 +342,9 @@ bool ctkLDAPExpr::compare( const QVariant &obj, int op, const QString &s ) const
     return true;
   try {
     if ( obj.canConvert<QString>( ) ) {
-      return compareString(obj.toString(), op, s);
+      return compareValue(obj.toString());
     } else if (obj.canConvert<char>( ) ) {
-      return compareString(obj.toString(), op, s);
+      return compareValue(obj.toString());
     } else if (obj.canConvert<bool>( ) ) {
       if (op==LE || op==GE)
         return false;
@@ -400,6 +423,22 @@ bool ctkLDAPExpr::compareString( const QString &s1, int op, const QString &s2 )
   }
 }
 
+//----------------------------------------------------------------------------
+bool ctkLDAPExpr::compareValue( const QString &s1 ) const
+{
+  switch(d->m_operator) {
+  case EQ:
+    // without wildcard, the pattern match is a plain string comparison
+    if (!d->m_hasWildcard)
+      return !s1.isNull() && s1 == d->m_attrValue;
+    return patSubstr(s1, d->m_attrValue);
+  case APPROX:
+    return d->m_approxValue == fixupString(s1);
+  default:
+    return compareString(s1, d->m_operator, d->m_attrValue);
+  }
+}
+
 //----------------------------------------------------------------------------
 QString ctkLDAPExpr::fixupString( const QString &s )
 {
@@ -569,7 +608,7 @@ ctkLDAPExpr::ParseState::ParseState( const QString &str )
 //----------------------------------------------------------------------------
 bool ctkLDAPExpr::ParseState::prefix( const QString &pre )
 {
-  if (!m_str.mid(m_pos).startsWith(pre))
+  if (!m_str.midRef(m_pos).startsWith(pre))
     return false;
   m_pos += pre.length();
   return true;
@@ -84,6 +84,18 @@ public:
    */
   bool getMatchedObjectClasses(QSet<QString>& objClasses) const;
 
+  /**
+   * Get the set of values of an attribute matched by this LDAP expression.
+   * This is the generalization of getMatchedObjectClasses() to any
+   * attribute, and has the same restrictions.
+   *
+   * \param attrName The attribute name, in lower case.
+   * \param values The set of matched values will be added to values.
+   * \return If the set cannot be determined, <code>false</code> is returned,
+   *         <code>true</code> otherwise.
+   */
+  bool getMatchedValues(const QString& attrName, QSet<QString>& values) const;
+
   /**
    * Checks if this LDAP expression is "simple". The definition of
    * a simple filter is:
@@ -152,6 +164,9 @@ private:
   //!
   static bool compareString(const QString &s1, int op, const QString &s2);
 
+  //! Compare \a s1 using the operator and value of this simple expression
+  bool compareValue(const QString &s1) const;
+
   //!
   static QString fixupString(const QString &s);
 
@@ -171,6 +186,8 @@ private:
   const static QString MALFORMED;// = "Malformed query";
   const static QString OPERATOR;//  = "Undefined m_operator";
 
+  friend class ctkLDAPExprData;
+
   //! Shared pointer
   QSharedDataPointer<ctkLDAPExprData> d;
 
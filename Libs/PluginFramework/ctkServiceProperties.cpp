@@ -29,13 +29,15 @@ ctkServiceProperties::ctkServiceProperties(const ctkProperties& props)
   for(ctkProperties::ConstIterator i = props.begin(), end = props.end();
       i != end; ++i)
   {
-    if (find(i.key()) != -1)
+    QString lowerCaseKey = i.key().toLower();
+    if (findLowerCase(lowerCaseKey) != -1)
     {
       QString msg("ctkProperties object contains case variants of the key: ");
       msg += i.key();
       throw ctkInvalidArgumentException(msg);
     }
     ks.append(i.key());
+    lks.append(lowerCaseKey);
     vs.append(i.value());
   }
 }
@@ -68,9 +70,15 @@ QStringList ctkServiceProperties::keys() const
 //----------------------------------------------------------------------------
 int ctkServiceProperties::find(const QString &key) const
 {
-  for (int i = 0; i < ks.size(); ++i)
+  return findLowerCase(key.toLower());
+}
+
+//----------------------------------------------------------------------------
+int ctkServiceProperties::findLowerCase(const QString &lowerCaseKey) const
+{
+  for (int i = 0; i < lks.size(); ++i)
   {
-    if (ks[i].compare(key, Qt::CaseInsensitive) == 0)
+    if (lks[i] == lowerCaseKey)
       return i;
   }
   return -1;
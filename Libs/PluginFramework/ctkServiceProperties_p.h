@@ -33,6 +33,7 @@ class ctkServiceProperties
 private:
 
   QVarLengthArray<QString,10> ks;
+  QVarLengthArray<QString,10> lks;
   QVarLengthArray<QVariant,10> vs;
 
   QMap<QString, QVariant> map;
@@ -47,6 +48,12 @@ public:
   int find(const QString& key) const;
   int findCaseSensitive(const QString& key) const;
 
+  /**
+   * Same as find(), but for a key which is already in lower case. This
+   * avoids the case-insensitive comparison against every key.
+   */
+  int findLowerCase(const QString& lowerCaseKey) const;
+
   QStringList keys() const;
 
 };
@@ -24,6 +24,7 @@
 #include <QStringListIterator>
 #include <QMutexLocker>
 #include <QBuffer>
+#include <QSet>
 
 #include <algorithm>
 
@@ -43,6 +44,54 @@ struct ServiceRegistrationComparator
   }
 };
 
+//----------------------------------------------------------------------------
+// The values under which a property value is indexed. An EQ filter
+// matches either the string form of the value, or one of the elements
+// of a list.
+static QSet<QString> indexValues(const QVariant& value)
+{
+  QSet<QString> values;
+  if (value.canConvert<QString>())
+  {
+    values.insert(value.toString());
+  }
+  if (value.type() == QVariant::StringList || value.type() == QVariant::List)
+  {
+    foreach (const QVariant& element, value.toList())
+    {
+      values.insert(element.toString());
+    }
+  }
+  values.remove(QString());
+  return values;
+}
+
+//----------------------------------------------------------------------------
+// The union of the registrations indexed under the given values
+static QList<ctkServiceRegistration> uniteIndexed(
+    const QHash<QString, QList<ctkServiceRegistration> >& index,
+    const QSet<QString>& values)
+{
+  if (values.size() == 1)
+  {
+    return index.value(*values.begin());
+  }
+  QList<ctkServiceRegistration> res;
+  QSet<ctkServiceRegistration> seen;
+  foreach (const QString& value, values)
+  {
+    foreach (const ctkServiceRegistration& sr, index.value(value))
+    {
+      if (!seen.contains(sr))
+      {
+        seen.insert(sr);
+        res.push_back(sr);
+      }
+    }
+  }
+  return res;
+}
+
 //----------------------------------------------------------------------------
 ctkDictionary ctkServices::createServiceProperties(const ctkDictionary& in,
                                                        const QStringList& classes,
@@ -63,7 +112,7 @@ ctkDictionary ctkServices::createServiceProperties(const ctkDictionary& in,
 
 //----------------------------------------------------------------------------
 ctkServices::ctkServices(ctkPluginFrameworkContext* fwCtx)
-  : mutex(), framework(fwCtx)
+  : mutex(), framework(fwCtx), ldapExprCache(256)
 {
 
 }
@@ -79,6 +128,8 @@ void ctkServices::clear()
 {
   services.clear();
   classServices.clear();
+  propertyServices.clear();
+  ldapExprCache.clear();
   framework = 0;
 }
 
@@ -126,6 +177,7 @@ ctkServiceRegistration ctkServices::registerService(ctkPluginPrivate* plugin,
           std::lower_bound(s.begin(), s.end(), res, ServiceRegistrationComparator());
       s.insert(ip, res);
     }
+    addToPropertyIndexes_unlocked(res, res.d_func()->properties);
   }
 
   ctkServiceReference r = res.getReference();
@@ -148,6 +200,87 @@ void ctkServices::updateServiceRegistrationOrder(const ctkServiceRegistration& s
   }
 }
 
+//----------------------------------------------------------------------------
+void ctkServices::updateServiceRegistrationProperties(const ctkServiceRegistration& sr,
+                                                      const ctkServiceProperties& oldProperties)
+{
+  QMutexLocker lock(&mutex);
+  removeFromPropertyIndexes_unlocked(sr, oldProperties);
+  addToPropertyIndexes_unlocked(sr, sr.d_func()->properties);
+}
+
+//----------------------------------------------------------------------------
+const QStringList& ctkServices::indexedProperties()
+{
+  // event.topics is the property used by the EventAdmin to
+  // select the handlers of an event
+  static const QStringList properties = QStringList()
+      << ctkPluginConstants::SERVICE_PID << "event.topics";
+  return properties;
+}
+
+//----------------------------------------------------------------------------
+bool ctkServices::lessThan_unlocked(const ctkServiceRegistration& a,
+                                    const ctkServiceRegistration& b)
+{
+  // Same order as ServiceRegistrationComparator, without locking the
+  // properties: the indexes are updated while a registration is modified.
+  const ctkServiceProperties& pa = a.d_func()->properties;
+  const ctkServiceProperties& pb = b.d_func()->properties;
+  int r1 = pa.value(ctkPluginConstants::SERVICE_RANKING).toInt();
+  int r2 = pb.value(ctkPluginConstants::SERVICE_RANKING).toInt();
+  if (r1 != r2)
+  {
+    return r1 < r2;
+  }
+  return pb.value(ctkPluginConstants::SERVICE_ID).toLongLong() <
+      pa.value(ctkPluginConstants::SERVICE_ID).toLongLong();
+}
+
+//----------------------------------------------------------------------------
+void ctkServices::addToPropertyIndexes_unlocked(const ctkServiceRegistration& sr,
+                                                const ctkServiceProperties& properties)
+{
+  foreach (const QString& key, indexedProperties())
+  {
+    QVariant value = properties.value(properties.findLowerCase(key));
+    if (value.isNull())
+    {
+      continue;
+    }
+    QHash<QString, QList<ctkServiceRegistration> >& index = propertyServices[key];
+    foreach (const QString& indexValue, indexValues(value))
+    {
+      QList<ctkServiceRegistration>& s = index[indexValue];
+      s.insert(std::lower_bound(s.begin(), s.end(), sr, &ctkServices::lessThan_unlocked), sr);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void ctkServices::removeFromPropertyIndexes_unlocked(const ctkServiceRegistration& sr,
+                                                     const ctkServiceProperties& properties)
+{
+  foreach (const QString& key, indexedProperties())
+  {
+    QVariant value = properties.value(properties.findLowerCase(key));
+    if (value.isNull())
+    {
+      continue;
+    }
+    QHash<QString, QList<ctkServiceRegistration> >& index = propertyServices[key];
+    foreach (const QString& indexValue, indexValues(value))
+    {
+      QList<ctkServiceRegistration>& s = index[indexValue];
+      s.removeAll(sr);
+      if (s.isEmpty())
+      {
+        index.remove(indexValue);
+      }
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 bool ctkServices::checkServiceClass(QObject* service, const QString& cls) const
 {
@@ -196,76 +329,89 @@ QList<ctkServiceReference> ctkServices::get_unlocked(const QString& clazz, const
 {
   Q_UNUSED(plugin)
 
-  QListIterator<ctkServiceRegistration>* s = 0;
+  // Select the smallest list of candidates using the class and
+  // property indexes, before evaluating the filter on each of them.
   QList<ctkServiceRegistration> v;
+  bool haveCandidates = false;
+  bool checkClass = false;
   ctkLDAPExpr ldap;
-  if (clazz.isEmpty())
+  if (!clazz.isEmpty())
   {
-    if (!filter.isEmpty())
-    {
-      ldap = ctkLDAPExpr(filter);
-      QSet<QString> matched;
-      if (ldap.getMatchedObjectClasses(matched))
-      {
-        v.clear();
-        foreach (QString className, matched)
-        {
-          const QList<ctkServiceRegistration>& cl = classServices[className];
-          v += cl;
-        }
-        if (!v.isEmpty())
-        {
-          s = new QListIterator<ctkServiceRegistration>(v);
-        }
-        else
-        {
-          return QList<ctkServiceReference>();
-        }
-      }
-      else
-      {
-        s = new QListIterator<ctkServiceRegistration>(services.keys());
-      }
-    }
-    else
+    v = classServices.value(clazz);
+    if (v.isEmpty())
     {
-      s = new QListIterator<ctkServiceRegistration>(services.keys());
+      return QList<ctkServiceReference>();
     }
+    haveCandidates = true;
   }
-  else
+  if (!filter.isEmpty())
   {
-    QList<ctkServiceRegistration> v = classServices.value(clazz);
-    if (!v.isEmpty())
+    ldap = getLDAPExpr_unlocked(filter);
+    QSet<QString> matched;
+    if (clazz.isEmpty() && ldap.getMatchedObjectClasses(matched))
     {
-      s = new QListIterator<ctkServiceRegistration>(v);
-    }
-    else
-    {
-      return QList<ctkServiceReference>();
+      v = uniteIndexed(classServices, matched);
+      if (v.isEmpty())
+      {
+        return QList<ctkServiceReference>();
+      }
+      haveCandidates = true;
     }
-    if (!filter.isEmpty())
+    foreach (const QString& key, indexedProperties())
     {
-      ldap = ctkLDAPExpr(filter);
+      matched.clear();
+      if (!ldap.getMatchedValues(key, matched))
+      {
+        continue;
+      }
+      QList<ctkServiceRegistration> iv = uniteIndexed(propertyServices.value(key), matched);
+      if (iv.isEmpty())
+      {
+        return QList<ctkServiceReference>();
+      }
+      if (!haveCandidates || iv.size() < v.size())
+      {
+        v = iv;
+        haveCandidates = true;
+        checkClass = !clazz.isEmpty();
+      }
     }
   }
+  if (!haveCandidates)
+  {
+    v = services.keys();
+  }
 
   QList<ctkServiceReference> res;
-  while (s->hasNext())
+  foreach (const ctkServiceRegistration& sr, v)
   {
-    ctkServiceRegistration sr = s->next();
-    ctkServiceReference sri = sr.getReference();
-
+    if (checkClass && !services.value(sr).contains(clazz))
+    {
+      continue;
+    }
     if (filter.isEmpty() || ldap.evaluate(sr.d_func()->properties, false))
     {
-      res.push_back(sri);
+      res.push_back(sr.getReference());
     }
   }
 
-  delete s;
-
   return res;
 }
 
+//----------------------------------------------------------------------------
+ctkLDAPExpr ctkServices::getLDAPExpr_unlocked(const QString& filter) const
+{
+  if (ctkLDAPExpr* ldap = ldapExprCache.object(filter))
+  {
+    return *ldap;
+  }
+  // Throws ctkInvalidArgumentException for an invalid filter,
+  // which is then not cached.
+  ctkLDAPExpr ldap(filter);
+  ldapExprCache.insert(filter, new ctkLDAPExpr(ldap));
+  return ldap;
+}
+
 //----------------------------------------------------------------------------
 void ctkServices::removeServiceRegistration(const ctkServiceRegistration& sr)
 {
@@ -286,6 +432,7 @@ void ctkServices::removeServiceRegistration(const ctkServiceRegistration& sr)
       classServices.remove(currClass);
     }
   }
+  removeFromPropertyIndexes_unlocked(sr, sr.d_func()->properties);
 }
 
 //----------------------------------------------------------------------------
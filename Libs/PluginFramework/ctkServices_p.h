@@ -23,6 +23,7 @@
 #ifndef CTKSERVICES_P_H
 #define CTKSERVICES_P_H
 
+#include <QCache>
 #include <QHash>
 #include <QObject>
 #include <QMutex>
@@ -31,6 +32,9 @@
 #include "ctkPlugin_p.h"
 #include "ctkServiceRegistration.h"
 
+class ctkLDAPExpr;
+class ctkServiceProperties;
+
 
 /**
  * \ingroup PluginFramework
@@ -70,6 +74,20 @@ public:
    */
   QHash<QString, QList<ctkServiceRegistration> > classServices;
 
+  /**
+   * Mapping of (lower case) property name to property value to
+   * registered services, for the properties listed by
+   * indexedProperties(). The lists are ordered like the ones of
+   * classServices.
+   */
+  QHash<QString, QHash<QString, QList<ctkServiceRegistration> > > propertyServices;
+
+  /**
+   * The names of the service properties, besides objectclass, indexed
+   * in propertyServices.
+   */
+  static const QStringList& indexedProperties();
+
 
   ctkPluginFrameworkContext* framework;
 
@@ -111,6 +129,17 @@ public:
                                       const QStringList& classes);
 
 
+  /**
+   * The properties of a service changed, update the property
+   * indexes. Must be called with the new properties in place.
+   *
+   * @param sr The ctkServiceRegistration object.
+   * @param oldProperties The properties before the change.
+   */
+  void updateServiceRegistrationProperties(const ctkServiceRegistration& sr,
+                                           const ctkServiceProperties& oldProperties);
+
+
   /**
    * Checks that a given service object is an instance of the given
    * class name.
@@ -181,9 +210,26 @@ public:
 
 private:
 
+  /**
+   * Parsed filters, keyed by filter string. Services are usually looked up
+   * over and over again with the same few filters.
+   */
+  mutable QCache<QString, ctkLDAPExpr> ldapExprCache;
+
   QList<ctkServiceReference> get_unlocked(const QString& clazz, const QString& filter,
                                           ctkPluginPrivate* plugin) const;
 
+  ctkLDAPExpr getLDAPExpr_unlocked(const QString& filter) const;
+
+  static bool lessThan_unlocked(const ctkServiceRegistration& a,
+                                const ctkServiceRegistration& b);
+
+  void addToPropertyIndexes_unlocked(const ctkServiceRegistration& sr,
+                                     const ctkServiceProperties& properties);
+
+  void removeFromPropertyIndexes_unlocked(const ctkServiceRegistration& sr,
+                                          const ctkServiceProperties& properties);
+
 };
 
 
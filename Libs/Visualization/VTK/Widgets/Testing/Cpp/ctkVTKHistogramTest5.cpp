@@ -0,0 +1,160 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QSignalSpy>
+#include <QVector>
+
+// CTKVTK includes
+#include "ctkVTKHistogram.h"
+
+// VTK includes
+#include <vtkShortArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+bool checkBins(ctkVTKHistogram& histogram, const QVector<int>& expectedBins, int line)
+{
+  if (histogram.count() != expectedBins.size())
+    {
+    std::cerr << "Line " << line << " - Wrong number of bins: "
+              << histogram.count() << " instead of " << expectedBins.size() << std::endl;
+    return false;
+    }
+  for (int i = 0; i < expectedBins.size(); ++i)
+    {
+    QScopedPointer<ctkControlPoint> point(histogram.controlPoint(i));
+    if (point->value().toInt() != expectedBins[i])
+      {
+      std::cerr << "Line " << line << " - Wrong count in bin " << i << ": "
+                << point->value().toInt() << " instead of " << expectedBins[i] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int ctkVTKHistogramTest5( int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+  //------Multithreaded build of regular bins------------
+  // Large enough to be split between several threads
+  const vtkIdType tupleCount = 1500000;
+  vtkSmartPointer<vtkUnsignedCharArray> charArray =
+    vtkSmartPointer<vtkUnsignedCharArray>::New();
+  charArray->SetNumberOfComponents(3);
+  charArray->SetNumberOfTuples(tupleCount);
+  QVector<int> expectedCharBins(256, 0);
+  for (vtkIdType i = 0; i < tupleCount; ++i)
+    {
+    unsigned char value = static_cast<unsigned char>((i * 7) % 251);
+    charArray->SetTypedComponent(i, 0, 0);
+    charArray->SetTypedComponent(i, 1, value);
+    charArray->SetTypedComponent(i, 2, 255);
+    ++expectedCharBins[value];
+    }
+
+  ctkVTKHistogram histogram;
+  histogram.setMaximumThreadCount(4);
+  histogram.setDataArray(charArray);
+  histogram.setComponent(1);
+  histogram.build();
+  if (!checkBins(histogram, expectedCharBins, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //------Multithreaded build of irregular bins------------
+  vtkSmartPointer<vtkShortArray> shortArray = vtkSmartPointer<vtkShortArray>::New();
+  shortArray->SetNumberOfTuples(tupleCount);
+  for (vtkIdType i = 0; i < tupleCount; ++i)
+    {
+    shortArray->SetValue(i, static_cast<short>((i * 13) % 4000 - 1000));
+    }
+  histogram.setComponent(0);
+  histogram.setDataArray(shortArray);
+  histogram.setNumberOfBins(100);
+
+  double range[2];
+  histogram.range(range[0], range[1]);
+  const double binWidth = 99. / (range[1] - range[0]);
+  QVector<int> expectedShortBins(100, 0);
+  for (vtkIdType i = 0; i < tupleCount; ++i)
+    {
+    ++expectedShortBins[static_cast<int>((shortArray->GetValue(i) - range[0]) * binWidth)];
+    }
+
+  histogram.build();
+  if (!checkBins(histogram, expectedShortBins, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  //------Asynchronous build with a preview------------
+  histogram.setAsynchronous(true);
+  histogram.setPreviewSampleCount(10000);
+  histogram.setDataArray(charArray);
+  histogram.setComponent(1);
+  histogram.setNumberOfBins(-1);
+  histogram.resetRange();
+
+  QSignalSpy changedSpy(&histogram, SIGNAL(changed()));
+  histogram.build();
+  if (!histogram.isBuilding())
+    {
+    std::cerr << "Line " << __LINE__ << " - Asynchronous build not started" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Building again cancels the running build
+  histogram.build();
+  while (histogram.isBuilding())
+    {
+    if (!changedSpy.wait(10000))
+      {
+      std::cerr << "Line " << __LINE__ << " - Asynchronous build not finished" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (histogram.isPreview() || changedSpy.count() < 1 || changedSpy.count() > 2)
+    {
+    std::cerr << "Line " << __LINE__ << " - Unexpected asynchronous build: "
+              << changedSpy.count() << " changed() signals" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!checkBins(histogram, expectedCharBins, __LINE__))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
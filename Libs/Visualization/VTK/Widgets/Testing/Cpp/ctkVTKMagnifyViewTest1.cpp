@@ -20,6 +20,8 @@
 
 // Qt includes
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QMouseEvent>
 #include <QSharedPointer>
 #include <QTimer>
 
@@ -62,7 +64,10 @@ int ctkVTKMagnifyViewTest1(int argc, char * argv [] )
       magnify.magnification() != 1.0 ||
       magnify.observeRenderWindowEvents() != true ||
       magnify.updateInterval() != 20 ||
-      magnify.numberObserved() != 0)
+      magnify.numberObserved() != 0 ||
+      magnify.lastUpdateDuration() != 0. ||
+      magnify.updateCount() != 0 ||
+      magnify.readbackCount() != 0)
     {
     std::cerr << "ctkVTKMagnifyView: Wrong default values. " << std::endl
               << " " << magnify.showCrosshair()
@@ -232,6 +237,61 @@ int ctkVTKMagnifyViewTest1(int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // Mouse moves within the captured region don't read the render window again.
+  // The observed widget must be mapped for its pixels to be read, and the
+  // updates are processed as the events come (no update interval).
+  magnify.setObserveRenderWindowEvents(true);
+  magnify.setUpdateInterval(0);
+  magnify.resize(40, 40);
+  magnify.show();
+  allVTKWidgets[1]->resize(100, 100);
+  allVTKWidgets[1]->show();
+  QElapsedTimer exposeTime;
+  exposeTime.start();
+  while (exposeTime.elapsed() < 200)
+    {
+    app.processEvents();
+    }
+#if VTK_MAJOR_VERSION >= 9 || (VTK_MAJOR_VERSION >= 8 && VTK_MINOR_VERSION >= 90)
+  vtkRenderWindow* observedRenderWindow = allVTKWidgets[1]->renderWindow();
+#else
+  vtkRenderWindow* observedRenderWindow = allVTKWidgets[1]->GetRenderWindow();
+#endif
+  observedRenderWindow->Render();
+  if (observedRenderWindow->GetSize()[0] < 60 || observedRenderWindow->GetSize()[1] < 60)
+    {
+    std::cerr << "ctkVTKMagnifyView: observed render window is not mapped. Size = "
+              << observedRenderWindow->GetSize()[0] << "x"
+              << observedRenderWindow->GetSize()[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+  int readbackCount = magnify.readbackCount();
+  int updateCount = magnify.updateCount();
+  QMouseEvent firstMove(QEvent::MouseMove, QPointF(50, 50), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+  QApplication::sendEvent(allVTKWidgets[1], &firstMove);
+  QMouseEvent secondMove(QEvent::MouseMove, QPointF(51, 50), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+  QApplication::sendEvent(allVTKWidgets[1], &secondMove);
+  if (magnify.updateCount() != updateCount + 2 ||
+      magnify.readbackCount() != readbackCount + 1)
+    {
+    std::cerr << "ctkVTKMagnifyView: captured region not reused. "
+              << magnify.updateCount() - updateCount << " updates, "
+              << magnify.readbackCount() - readbackCount << " readbacks" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A render of the observed window invalidates the captured region
+  readbackCount = magnify.readbackCount();
+  observedRenderWindow->Render();
+  QMouseEvent thirdMove(QEvent::MouseMove, QPointF(50, 51), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+  QApplication::sendEvent(allVTKWidgets[1], &thirdMove);
+  if (magnify.readbackCount() == readbackCount)
+    {
+    std::cerr << "ctkVTKMagnifyView: render window not read again after a render."
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
   magnify.show();
   if (argc < 2 || QString(argv[1]) != "-I" )
     {
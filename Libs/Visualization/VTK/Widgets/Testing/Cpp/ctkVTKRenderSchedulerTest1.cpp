@@ -0,0 +1,135 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QElapsedTimer>
+
+// CTK includes
+#include "ctkCoreTestingMacros.h"
+#include "ctkVTKRenderScheduler.h"
+#include "ctkVTKRenderView.h"
+#include "ctkVTKWidgetsUtils.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+int ctkVTKRenderSchedulerTest1(int argc, char * argv [] )
+{
+  ctk::vtkSetSurfaceDefaultFormat();
+
+  QApplication app(argc, argv);
+
+  ctkVTKRenderScheduler scheduler;
+  CHECK_BOOL(scheduler.maximumUpdateRate() == 60., true);
+  CHECK_BOOL(scheduler.frameBudget() == 16., true);
+  CHECK_INT(scheduler.interactionTimeout(), 500);
+
+  ctkVTKRenderView view1;
+  ctkVTKRenderView view2;
+  ctkVTKRenderView view3;
+  view1.show();
+  view2.show();
+  view3.show();
+  CHECK_NULL(view1.renderScheduler());
+  view1.setRenderScheduler(&scheduler);
+  view2.setRenderScheduler(&scheduler);
+  view3.setRenderScheduler(&scheduler);
+  CHECK_POINTER(view1.renderScheduler(), &scheduler);
+  CHECK_INT(scheduler.views().count(), 3);
+
+  // Let the views be exposed before counting the renders
+  QElapsedTimer timeout;
+  timeout.start();
+  while (timeout.elapsed() < 200)
+    {
+    app.processEvents();
+    }
+  view1.resetRenderStatistics();
+  view2.resetRenderStatistics();
+  view3.resetRenderStatistics();
+
+  // Repeated requests of several views are rendered in a single frame
+  for (int i = 0; i < 3; ++i)
+    {
+    view1.scheduleRender();
+    view2.scheduleRender();
+    view3.scheduleRender();
+    }
+  CHECK_BOOL(scheduler.isRenderPending(&view2), true);
+  int frameCount = scheduler.frameCount();
+  timeout.start();
+  while (scheduler.isRenderPending(&view1) && timeout.elapsed() < 5000)
+    {
+    app.processEvents();
+    }
+  CHECK_INT(scheduler.frameCount(), frameCount + 1);
+  CHECK_INT(view1.renderCount(), 1);
+  CHECK_INT(view2.renderCount(), 1);
+  CHECK_INT(view3.renderCount(), 1);
+  CHECK_BOOL(view1.lastRenderTime() > 0., true);
+  CHECK_BOOL(view1.averageRenderTime() == view1.lastRenderTime(), true);
+
+  // When the budget is exceeded, the view interacted with is rendered first,
+  // then the oldest request, and the other views are deferred.
+  scheduler.setFrameBudget(0.000001);
+  scheduler.setInteractingView(&view3);
+  CHECK_POINTER(scheduler.interactingView(), &view3);
+  view1.scheduleRender();
+  view2.scheduleRender();
+  view3.scheduleRender();
+  scheduler.renderFrame();
+  CHECK_INT(view1.renderCount(), 2);
+  CHECK_INT(view2.renderCount(), 1);
+  CHECK_INT(view3.renderCount(), 2);
+  CHECK_BOOL(scheduler.isRenderPending(&view2), true);
+  CHECK_INT(scheduler.deferredRenderCount(&view2), 1);
+  CHECK_INT(scheduler.deferredRenderCount(&view1), 0);
+
+  // The deferred view is rendered in the next frame
+  scheduler.renderFrame();
+  CHECK_INT(view2.renderCount(), 2);
+  CHECK_BOOL(scheduler.isRenderPending(&view2), false);
+
+  // A paused view keeps its request until it is resumed
+  view1.pauseRender();
+  view1.scheduleRender();
+  scheduler.renderFrame();
+  CHECK_INT(view1.renderCount(), 2);
+  view1.resumeRender();
+  CHECK_BOOL(scheduler.isRenderPending(&view1), true);
+  scheduler.renderFrame();
+  CHECK_INT(view1.renderCount(), 3);
+
+  // A render forced outside of a frame cancels the request
+  view2.scheduleRender();
+  view2.forceRender();
+  CHECK_BOOL(scheduler.isRenderPending(&view2), false);
+
+  // Unregistered views render on their own timer again
+  view3.setRenderScheduler(0);
+  CHECK_INT(scheduler.views().count(), 2);
+  view3.scheduleRender();
+  CHECK_BOOL(scheduler.isRenderPending(&view3), false);
+
+  return EXIT_SUCCESS;
+}
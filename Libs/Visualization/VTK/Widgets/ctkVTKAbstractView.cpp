@@ -19,6 +19,7 @@
 =========================================================================*/
 
 // Qt includes
+#include <QElapsedTimer>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <QDebug>
@@ -62,6 +63,9 @@ ctkVTKAbstractViewPrivate::ctkVTKAbstractViewPrivate(ctkVTKAbstractView& object)
   this->FPSTimer = 0;
   this->FPS = 0;
   this->PauseRenderCount = 0;
+  this->RenderCount = 0;
+  this->LastRenderTime = 0.;
+  this->TotalRenderTime = 0.;
 }
 
 // --------------------------------------------------------------------------
@@ -176,6 +180,11 @@ ctkVTKAbstractView::ctkVTKAbstractView(ctkVTKAbstractViewPrivate* pimpl, QWidget
 //----------------------------------------------------------------------------
 ctkVTKAbstractView::~ctkVTKAbstractView()
 {
+  Q_D(ctkVTKAbstractView);
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->unregisterView(this);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -205,6 +214,16 @@ void ctkVTKAbstractView::scheduleRender()
     // render must be done immediately.
     this->requestRender();
     }
+  else if (d->RenderScheduler)
+    {
+    // The render is done in the next frame of the scheduler, RequestTime
+    // only keeps track of the pending request for resumeRender().
+    if (!d->RequestTime.isValid())
+      {
+      d->RequestTime.start();
+      }
+    d->RenderScheduler->scheduleRender(this);
+    }
   else if (!d->RequestTime.isValid())
     {
     d->RequestTime.start();
@@ -248,6 +267,10 @@ void ctkVTKAbstractView::forceRender()
 
   // The timer can be stopped if it hasn't timed out yet.
   d->RequestTimer->stop();
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->cancelRender(this);
+    }
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
   d->RequestTime.invalidate();
 #else
@@ -261,7 +284,12 @@ void ctkVTKAbstractView::forceRender()
     {
     return;
     }
+  QElapsedTimer renderTime;
+  renderTime.start();
   d->RenderWindow->Render();
+  d->LastRenderTime = renderTime.nsecsElapsed() / 1000000.;
+  d->TotalRenderTime += d->LastRenderTime;
+  ++d->RenderCount;
 }
 
 //----------------------------------------------------------------------------
@@ -580,3 +608,70 @@ void ctkVTKAbstractView::setMaximumUpdateRate(double fps)
   Q_D(ctkVTKAbstractView);
   d->MaximumUpdateRate = fps;
 }
+
+//----------------------------------------------------------------------------
+ctkVTKRenderScheduler* ctkVTKAbstractView::renderScheduler()const
+{
+  Q_D(const ctkVTKAbstractView);
+  return d->RenderScheduler;
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::setRenderScheduler(ctkVTKRenderScheduler* scheduler)
+{
+  Q_D(ctkVTKAbstractView);
+  if (d->RenderScheduler == scheduler)
+    {
+    return;
+    }
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->unregisterView(this);
+    }
+  d->RenderScheduler = scheduler;
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->registerView(this);
+    }
+  // A pending render request is moved to the new scheduler.
+  if (d->RequestTime.isValid())
+    {
+    d->RequestTimer->stop();
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    d->RequestTime.invalidate();
+#else
+    d->RequestTime = QTime();
+#endif
+    this->scheduleRender();
+    }
+}
+
+//----------------------------------------------------------------------------
+int ctkVTKAbstractView::renderCount()const
+{
+  Q_D(const ctkVTKAbstractView);
+  return d->RenderCount;
+}
+
+//----------------------------------------------------------------------------
+double ctkVTKAbstractView::lastRenderTime()const
+{
+  Q_D(const ctkVTKAbstractView);
+  return d->LastRenderTime;
+}
+
+//----------------------------------------------------------------------------
+double ctkVTKAbstractView::averageRenderTime()const
+{
+  Q_D(const ctkVTKAbstractView);
+  return d->RenderCount > 0 ? d->TotalRenderTime / d->RenderCount : 0.;
+}
+
+//----------------------------------------------------------------------------
+void ctkVTKAbstractView::resetRenderStatistics()
+{
+  Q_D(ctkVTKAbstractView);
+  d->RenderCount = 0;
+  d->LastRenderTime = 0.;
+  d->TotalRenderTime = 0.;
+}
@@ -29,6 +29,7 @@
 #include "ctkVTKObject.h"
 #include "ctkVisualizationVTKWidgetsExport.h"
 class ctkVTKAbstractViewPrivate;
+class ctkVTKRenderScheduler;
 
 class vtkCornerAnnotation;
 class vtkInteractorObserver;
@@ -55,6 +56,14 @@ class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKAbstractView : public QWidget
   Q_PROPERTY(bool useDepthPeeling READ useDepthPeeling WRITE setUseDepthPeeling)
   /// Set a maximum rate (in frames per second) for rendering.
   Q_PROPERTY(double maximumUpdateRate READ maximumUpdateRate WRITE setMaximumUpdateRate)
+  /// Number of times the render window has been rendered since the last
+  /// resetRenderStatistics().
+  Q_PROPERTY(int renderCount READ renderCount)
+  /// Duration (in milliseconds) of the last render of the render window.
+  Q_PROPERTY(double lastRenderTime READ lastRenderTime)
+  /// Average duration (in milliseconds) of the renders of the render window
+  /// since the last resetRenderStatistics().
+  Q_PROPERTY(double averageRenderTime READ averageRenderTime)
 
 public:
 
@@ -127,9 +136,22 @@ public Q_SLOTS:
   /// suppressing repeated update requests (after a rendering has been completed,
   /// repeated rendering requests will be ignored for 17 milliseconds).
   ///
-  /// \sa scheduleRender
+  /// \sa scheduleRender, setRenderScheduler
   void setMaximumUpdateRate(double fps);
 
+  /// Register the view to a render scheduler shared with other views, or
+  /// unregister it if \a scheduler is 0.
+  /// While registered, scheduleRender() adds the render requests to the
+  /// frames of the scheduler instead of using the view's own timer and
+  /// maximum update rate.
+  /// No scheduler by default.
+  /// \sa ctkVTKRenderScheduler::instance()
+  void setRenderScheduler(ctkVTKRenderScheduler* scheduler);
+
+  /// Reset the render count and times.
+  /// \sa renderCount, lastRenderTime, averageRenderTime
+  void resetRenderStatistics();
+
   /// Set the background color of the rendering screen.
   virtual void setBackgroundColor(const QColor& newBackgroundColor);
 
@@ -198,6 +220,17 @@ public:
   /// \\sa setMaximumUpdateRate
   double maximumUpdateRate()const;
 
+  /// Returns the render scheduler the view is registered to, 0 if none.
+  /// \sa setRenderScheduler
+  ctkVTKRenderScheduler* renderScheduler()const;
+
+  /// \sa renderCount
+  int renderCount()const;
+  /// \sa lastRenderTime
+  double lastRenderTime()const;
+  /// \sa averageRenderTime
+  double averageRenderTime()const;
+
   /// Returns true if depth peeling is enabled.
   /// \sa setUseDepthPeeling
   bool useDepthPeeling()const;
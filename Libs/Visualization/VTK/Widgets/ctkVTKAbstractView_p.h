@@ -27,11 +27,13 @@
 #include <QElapsedTimer>
 #endif
 #include <QObject>
+#include <QPointer>
 #include <QTime>
 class QTimer;
 
 // CTK includes
 #include "ctkVTKAbstractView.h"
+#include "ctkVTKRenderScheduler.h"
 
 // VTK includes
 #include <vtkCornerAnnotation.h>
@@ -81,6 +83,10 @@ public:
   int                                           FPS;
   static int                                    MultiSamples;
   int                                           PauseRenderCount;
+  QPointer<ctkVTKRenderScheduler>               RenderScheduler;
+  int                                           RenderCount;
+  double                                        LastRenderTime;
+  double                                        TotalRenderTime;
 
   vtkSmartPointer<vtkCornerAnnotation>          CornerAnnotation;
 };
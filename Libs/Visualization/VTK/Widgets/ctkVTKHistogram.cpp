@@ -19,8 +19,14 @@
 =========================================================================*/
 
 /// Qt includes
+#include <QAtomicInt>
 #include <QColor>
 #include <QDebug>
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QVector>
 
 /// CTK includes
 #include "ctkVTKHistogram.h"
@@ -33,17 +39,35 @@
 #include <vtkSmartPointer.h>
 
 /// STL include
+#include <algorithm>
+#include <cstring>
 #include <limits>
+#include <type_traits>
 
 //--------------------------------------------------------------------------
 static ctkLogger logger("org.commontk.libs.visualization.core.ctkVTKHistogram");
 //--------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+/// Parameters of a computation of the bins
+struct ctkVTKHistogramBuildRequest
+{
+  vtkSmartPointer<vtkDataArray> DataArray;
+  const void*                   Data;
+  int                           Component;
+  double                        Range[2];
+  int                           BinCount;
+  int                           Generation;
+};
+
 //-----------------------------------------------------------------------------
 class ctkVTKHistogramPrivate
 {
+  Q_DECLARE_PUBLIC(ctkVTKHistogram);
+protected:
+  ctkVTKHistogram* const q_ptr;
 public:
-  ctkVTKHistogramPrivate();
+  ctkVTKHistogramPrivate(ctkVTKHistogram& object);
   vtkSmartPointer<vtkDataArray> DataArray;
   vtkSmartPointer<vtkIntArray>  Bins;
   int                           UserNumberOfBins;
@@ -52,11 +76,234 @@ public:
   int                           MinBin;
   int                           MaxBin;
 
+  bool                          Asynchronous;
+  int                           PreviewSampleCount;
+  bool                          Building;
+  bool                          Preview;
+
+  /// Incremented by each build, canceling the running computations.
+  QAtomicInt                    Generation;
+  /// Threads counting the values
+  mutable QThreadPool           ThreadPool;
+  /// Thread running the asynchronous builds
+  QThreadPool                   BuildThreadPool;
+
+  /// Bins computed in the background, not applied yet. Protected by Mutex.
+  QMutex                        Mutex;
+  vtkSmartPointer<vtkIntArray>  ComputedBins;
+  int                           ComputedGeneration;
+  bool                          ComputedPreview;
+
   int computeNumberOfBins()const;
+
+  /// Cancel the running computations and wait for them to be done.
+  void cancelBuild();
+  bool isCanceled(const ctkVTKHistogramBuildRequest& request)const;
+
+  /// Count the sampled values of the array in the bins of the request, using
+  /// one bin array per thread. Every stride-th tuple is counted, and the
+  /// counts are scaled by stride. Returns 0 if the computation was canceled.
+  vtkSmartPointer<vtkIntArray> computeBins(const ctkVTKHistogramBuildRequest& request,
+                                           vtkIdType stride)const;
+  /// Count the values of the chunks processed by one thread.
+  void populateBins(const ctkVTKHistogramBuildRequest& request, vtkIdType stride,
+                    int threadIndex, int threadCount, int* bins)const;
+  /// Called from the build thread
+  void postBins(const ctkVTKHistogramBuildRequest& request,
+                vtkIntArray* bins, bool preview);
+  void setBins(vtkIntArray* bins, bool preview);
 };
 
 //-----------------------------------------------------------------------------
-ctkVTKHistogramPrivate::ctkVTKHistogramPrivate()
+namespace
+{
+
+/// Number of sampled tuples counted by a thread before checking if the
+/// computation was canceled.
+const vtkIdType ChunkSize = 1 << 18;
+/// Minimum number of sampled tuples worth starting a thread
+const vtkIdType MinimumTuplesPerThread = 1 << 16;
+/// Number of values whose bin indices are computed at once
+const int BlockSize = 256;
+
+//-----------------------------------------------------------------------------
+/// Regular bins of integer values: one bin per value of the range.
+/// The indices of a block of values are computed first, without branches
+/// such that the compiler vectorizes the loop. Out of range values are
+/// counted in the extra bin at index binCount, which is discarded.
+template <class T>
+void populateRegularBins(const T* ptr, vtkIdType count, vtkIdType step,
+                         double offset, int binCount, int* bins, std::true_type)
+{
+  typedef typename std::conditional<(sizeof(T) < sizeof(int)), int, long long>::type IndexType;
+  typedef typename std::make_unsigned<IndexType>::type UnsignedIndexType;
+
+  const IndexType first = static_cast<IndexType>(offset);
+  const UnsignedIndexType size = static_cast<UnsignedIndexType>(binCount);
+  UnsignedIndexType indices[BlockSize];
+  while (count > 0)
+    {
+    const int blockSize = static_cast<int>(std::min<vtkIdType>(count, BlockSize));
+    for (int i = 0; i < blockSize; ++i)
+      {
+      const UnsignedIndexType index =
+        static_cast<UnsignedIndexType>(static_cast<IndexType>(ptr[i * step]) - first);
+      indices[i] = index < size ? index : size;
+      }
+    for (int i = 0; i < blockSize; ++i)
+      {
+      ++bins[indices[i]];
+      }
+    ptr += blockSize * step;
+    count -= blockSize;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Regular bins of real values
+template <class T>
+void populateRegularBins(const T* ptr, vtkIdType count, vtkIdType step,
+                         double offsetValue, int binCount, int* bins, std::false_type)
+{
+  T offset = static_cast<T>(offsetValue);
+  for (; count > 0; --count, ptr += step)
+    {
+    int index = static_cast<int>(*ptr - offset);
+    if (index < 0 || index >= binCount)
+      {
+      // This happens when scalar range is not computed correctly
+      // (scalar range may be read from file, so VTK does not have full control over it)
+      continue;
+      }
+    bins[index]++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+template <class T>
+void populateIrregularBins(const T* ptr, vtkIdType count, vtkIdType step,
+                           const double range[2], int binCount, int* bins)
+{
+  double offset = range[0];
+
+  double binWidth = 1.;
+  if (range[1] != range[0])
+    {
+    binWidth = static_cast<double>(binCount-1) / (range[1] - range[0]);
+    }
+
+  for (; count > 0; --count, ptr += step)
+    {
+    if ((std::numeric_limits<T>::has_quiet_NaN &&
+      vtkMath::IsNan(*ptr)) || vtkMath::IsInf(*ptr))
+      {
+      continue;
+      }
+    int index = vtkMath::Floor((static_cast<double>(*ptr) - offset) * binWidth);
+    if (index < 0 || index >= binCount)
+      {
+      // This happens when scalar range is not computed correctly
+      // (scalar range may be read from file, so VTK does not have full control over it)
+      continue;
+      }
+    bins[index]++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Count the tuples [begin, end[ sampled with stride
+template <class T>
+void populateChunkBins(const ctkVTKHistogramBuildRequest& request,
+                  vtkIdType begin, vtkIdType end, vtkIdType stride, int* bins)
+{
+  const vtkIdType componentNumber = request.DataArray->GetNumberOfComponents();
+  const T* ptr = static_cast<const T*>(request.Data) + begin * componentNumber + request.Component;
+  const vtkIdType count = (end - begin + stride - 1) / stride;
+  const vtkIdType step = componentNumber * stride;
+
+  // What is the type of the array, discrete or reals
+  if (static_cast<double>(request.BinCount) != (request.Range[1] - request.Range[0] + 1))
+    {
+    populateIrregularBins<T>(ptr, count, step, request.Range, request.BinCount, bins);
+    }
+  else
+    {
+    populateRegularBins<T>(ptr, count, step, request.Range[0], request.BinCount, bins,
+                           typename std::is_integral<T>::type());
+    }
+}
+
+//-----------------------------------------------------------------------------
+class ctkVTKHistogramBinsRunnable : public QRunnable
+{
+public:
+  ctkVTKHistogramBinsRunnable(const ctkVTKHistogramPrivate* histogram,
+                              const ctkVTKHistogramBuildRequest& request,
+                              vtkIdType stride, int threadIndex, int threadCount,
+                              int* bins, QSemaphore* done)
+    : Histogram(histogram), Request(request), Stride(stride)
+    , ThreadIndex(threadIndex), ThreadCount(threadCount), Bins(bins), Done(done)
+  {
+  }
+
+  void run() override
+  {
+    this->Histogram->populateBins(this->Request, this->Stride,
+                                  this->ThreadIndex, this->ThreadCount, this->Bins);
+    this->Done->release();
+  }
+
+protected:
+  const ctkVTKHistogramPrivate* Histogram;
+  const ctkVTKHistogramBuildRequest& Request;
+  vtkIdType Stride;
+  int ThreadIndex;
+  int ThreadCount;
+  int* Bins;
+  QSemaphore* Done;
+};
+
+//-----------------------------------------------------------------------------
+class ctkVTKHistogramBuildRunnable : public QRunnable
+{
+public:
+  ctkVTKHistogramBuildRunnable(ctkVTKHistogramPrivate* histogram,
+                               const ctkVTKHistogramBuildRequest& request,
+                               vtkIdType previewStride)
+    : Histogram(histogram), Request(request), PreviewStride(previewStride)
+  {
+  }
+
+  void run() override
+  {
+    if (this->PreviewStride > 1)
+      {
+      vtkSmartPointer<vtkIntArray> preview =
+        this->Histogram->computeBins(this->Request, this->PreviewStride);
+      if (!preview)
+        {
+        return;
+        }
+      this->Histogram->postBins(this->Request, preview, true);
+      }
+    vtkSmartPointer<vtkIntArray> bins = this->Histogram->computeBins(this->Request, 1);
+    if (bins)
+      {
+      this->Histogram->postBins(this->Request, bins, false);
+      }
+  }
+
+protected:
+  ctkVTKHistogramPrivate* Histogram;
+  ctkVTKHistogramBuildRequest Request;
+  vtkIdType PreviewStride;
+};
+
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKHistogramPrivate::ctkVTKHistogramPrivate(ctkVTKHistogram& object)
+  : q_ptr(&object)
 {
   this->Bins = vtkSmartPointer<vtkIntArray>::New();
   this->UserNumberOfBins = -1;
@@ -64,6 +311,13 @@ ctkVTKHistogramPrivate::ctkVTKHistogramPrivate()
   this->Range[0] = this->Range[1] = 0.;
   this->MinBin = 0;
   this->MaxBin = 0;
+  this->Asynchronous = false;
+  this->PreviewSampleCount = 0;
+  this->Building = false;
+  this->Preview = false;
+  this->ComputedGeneration = 0;
+  this->ComputedPreview = false;
+  this->BuildThreadPool.setMaxThreadCount(1);
 }
 
 //-----------------------------------------------------------------------------
@@ -82,10 +336,135 @@ int ctkVTKHistogramPrivate::computeNumberOfBins()const
   return static_cast<int>(this->Range[1] - this->Range[0]) + 1;
 }
 
+//-----------------------------------------------------------------------------
+void ctkVTKHistogramPrivate::cancelBuild()
+{
+  this->Generation.fetchAndAddOrdered(1);
+  this->BuildThreadPool.waitForDone();
+  this->Building = false;
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKHistogramPrivate::isCanceled(const ctkVTKHistogramBuildRequest& request)const
+{
+  return this->Generation.loadAcquire() != request.Generation;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkIntArray> ctkVTKHistogramPrivate::computeBins(
+  const ctkVTKHistogramBuildRequest& request, vtkIdType stride)const
+{
+  const vtkIdType sampleCount = (request.DataArray->GetNumberOfTuples() + stride - 1) / stride;
+  const int threadCount = static_cast<int>(qBound<vtkIdType>(
+    1, sampleCount / MinimumTuplesPerThread, this->ThreadPool.maxThreadCount()));
+
+  // One more bin per thread for the out of range values
+  QVector<QVector<int> > threadBins(threadCount);
+  QSemaphore done;
+  for (int i = 1; i < threadCount; ++i)
+    {
+    threadBins[i].fill(0, request.BinCount + 1);
+    this->ThreadPool.start(new ctkVTKHistogramBinsRunnable(
+      this, request, stride, i, threadCount, threadBins[i].data(), &done));
+    }
+  threadBins[0].fill(0, request.BinCount + 1);
+  this->populateBins(request, stride, 0, threadCount, threadBins[0].data());
+  done.acquire(threadCount - 1);
+
+  if (this->isCanceled(request))
+    {
+    return vtkSmartPointer<vtkIntArray>();
+    }
+
+  vtkSmartPointer<vtkIntArray> bins = vtkSmartPointer<vtkIntArray>::New();
+  bins->SetNumberOfComponents(1);
+  bins->SetNumberOfTuples(request.BinCount);
+  int* binsPtr = bins->GetPointer(0);
+  memcpy(binsPtr, threadBins[0].constData(), request.BinCount * sizeof(int));
+  for (int i = 1; i < threadCount; ++i)
+    {
+    const int* threadBinsPtr = threadBins[i].constData();
+    for (int bin = 0; bin < request.BinCount; ++bin)
+      {
+      binsPtr[bin] += threadBinsPtr[bin];
+      }
+    }
+  if (stride > 1)
+    {
+    for (int bin = 0; bin < request.BinCount; ++bin)
+      {
+      binsPtr[bin] *= stride;
+      }
+    }
+  return bins;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogramPrivate::populateBins(const ctkVTKHistogramBuildRequest& request,
+                                          vtkIdType stride, int threadIndex,
+                                          int threadCount, int* bins)const
+{
+  // The threads count interleaved chunks, which start on a sampled tuple
+  const vtkIdType tupleNumber = request.DataArray->GetNumberOfTuples();
+  const vtkIdType chunkTuples = ChunkSize * stride;
+  for (vtkIdType begin = threadIndex * chunkTuples; begin < tupleNumber;
+       begin += threadCount * chunkTuples)
+    {
+    if (this->isCanceled(request))
+      {
+      return;
+      }
+    vtkIdType end = qMin(begin + chunkTuples, tupleNumber);
+    switch(request.DataArray->GetDataType())
+      {
+      vtkTemplateMacro(populateChunkBins<VTK_TT>(request, begin, end, stride, bins));
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogramPrivate::postBins(const ctkVTKHistogramBuildRequest& request,
+                                      vtkIntArray* bins, bool preview)
+{
+  Q_Q(ctkVTKHistogram);
+  {
+  QMutexLocker locker(&this->Mutex);
+  this->ComputedBins = bins;
+  this->ComputedGeneration = request.Generation;
+  this->ComputedPreview = preview;
+  }
+  QMetaObject::invokeMethod(q, "onBinsComputed", Qt::QueuedConnection);
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogramPrivate::setBins(vtkIntArray* bins, bool preview)
+{
+  this->Bins = bins;
+  this->Preview = preview;
+
+  // update Min/Max values
+  const int binCount = bins->GetNumberOfTuples();
+  if (binCount <= 0)
+    {
+    this->MinBin = 0;
+    this->MaxBin = 0;
+    return;
+    }
+  int* binPtr = bins->GetPointer(0);
+  int* endPtr = bins->GetPointer(binCount-1);
+  this->MinBin = *endPtr;
+  this->MaxBin = *endPtr;
+  for (;binPtr < endPtr; ++binPtr)
+    {
+    this->MinBin = qMin(*binPtr, this->MinBin);
+    this->MaxBin = qMax(*binPtr, this->MaxBin);
+    }
+}
+
 //-----------------------------------------------------------------------------
 ctkVTKHistogram::ctkVTKHistogram(QObject* parentObject)
   :ctkHistogram(parentObject)
-  , d_ptr(new ctkVTKHistogramPrivate)
+  , d_ptr(new ctkVTKHistogramPrivate(*this))
 {
 }
 
@@ -93,7 +472,7 @@ ctkVTKHistogram::ctkVTKHistogram(QObject* parentObject)
 ctkVTKHistogram::ctkVTKHistogram(vtkDataArray* dataArray, 
                                  QObject* parentObject)
   :ctkHistogram(parentObject)
-  , d_ptr(new ctkVTKHistogramPrivate)
+  , d_ptr(new ctkVTKHistogramPrivate(*this))
 {
   this->setDataArray(dataArray);
 }
@@ -101,6 +480,9 @@ ctkVTKHistogram::ctkVTKHistogram(vtkDataArray* dataArray,
 //-----------------------------------------------------------------------------
 ctkVTKHistogram::~ctkVTKHistogram()
 {
+  Q_D(ctkVTKHistogram);
+  d->cancelBuild();
+  d->ThreadPool.waitForDone();
 }
 
 //-----------------------------------------------------------------------------
@@ -287,84 +669,59 @@ void ctkVTKHistogram::setNumberOfBins(int number)
 }
 
 //-----------------------------------------------------------------------------
-template <class T>
-void populateBins(vtkIntArray* bins, const ctkVTKHistogram* histogram)
+bool ctkVTKHistogram::isAsynchronous()const
 {
-  vtkDataArray* scalars = histogram->dataArray();
-  int* binsPtr = bins->WritePointer(0, bins->GetNumberOfTuples());
-
-  // reset bins to 0
-  memset(binsPtr, 0, bins->GetNumberOfComponents()*bins->GetNumberOfTuples()*sizeof(int));
-
-  const vtkIdType componentNumber = scalars->GetNumberOfComponents();
-  const vtkIdType tupleNumber = scalars->GetNumberOfTuples();
-  int component = histogram->component();
-
-  double range[2];
-  histogram->range(range[0], range[1]);
-  T offset = static_cast<T>(range[0]);
+  Q_D(const ctkVTKHistogram);
+  return d->Asynchronous;
+}
 
-  T* ptr = static_cast<T*>(scalars->WriteVoidPointer(0, tupleNumber));
-  T* endPtr = ptr + tupleNumber * componentNumber;
-  ptr += component;
-  vtkIdType histogramSize = bins->GetNumberOfTuples();
-  for (; ptr < endPtr; ptr += componentNumber)
-    {
-    int index = static_cast<int>(*ptr - offset);
-    if (index < 0 || index >= histogramSize)
-      {
-      // This happens when scalar range is not computed correctly
-      // (scalar range may be read from file, so VTK does not have full control over it)
-      continue;
-      }
-    binsPtr[index]++;
-    }
+//-----------------------------------------------------------------------------
+void ctkVTKHistogram::setAsynchronous(bool asynchronous)
+{
+  Q_D(ctkVTKHistogram);
+  d->Asynchronous = asynchronous;
 }
 
 //-----------------------------------------------------------------------------
-template <class T>
-void populateIrregularBins(vtkIntArray* bins, const ctkVTKHistogram* histogram)
+int ctkVTKHistogram::previewSampleCount()const
 {
-  vtkDataArray* scalars = histogram->dataArray();
+  Q_D(const ctkVTKHistogram);
+  return d->PreviewSampleCount;
+}
 
-  int* binsPtr = bins->WritePointer(0, bins->GetNumberOfComponents()*bins->GetNumberOfTuples());
-  // reset bins to 0
-  memset(binsPtr, 0, bins->GetNumberOfTuples() * sizeof(int));
+//-----------------------------------------------------------------------------
+void ctkVTKHistogram::setPreviewSampleCount(int count)
+{
+  Q_D(ctkVTKHistogram);
+  d->PreviewSampleCount = qMax(0, count);
+}
 
-  const vtkIdType componentNumber = scalars->GetNumberOfComponents();
-  const vtkIdType tupleNumber = scalars->GetNumberOfTuples();
-  int component = histogram->component();
+//-----------------------------------------------------------------------------
+int ctkVTKHistogram::maximumThreadCount()const
+{
+  Q_D(const ctkVTKHistogram);
+  return d->ThreadPool.maxThreadCount();
+}
 
-  double range[2];
-  histogram->range(range[0], range[1]);
-  double offset = range[0];
+//-----------------------------------------------------------------------------
+void ctkVTKHistogram::setMaximumThreadCount(int count)
+{
+  Q_D(ctkVTKHistogram);
+  d->ThreadPool.setMaxThreadCount(qMax(1, count));
+}
 
-  double binWidth = 1.;
-  if (range[1] != range[0])
-    {
-    binWidth = static_cast<double>(bins->GetNumberOfTuples()-1) / (range[1] - range[0]);
-    }
+//-----------------------------------------------------------------------------
+bool ctkVTKHistogram::isBuilding()const
+{
+  Q_D(const ctkVTKHistogram);
+  return d->Building;
+}
 
-  T* ptr = static_cast<T*>(scalars->WriteVoidPointer(0, tupleNumber));
-  T* endPtr = ptr + tupleNumber * componentNumber;
-  ptr += component;
-  vtkIdType histogramSize = bins->GetNumberOfTuples();
-  for (; ptr < endPtr; ptr += componentNumber)
-    {
-    if ((std::numeric_limits<T>::has_quiet_NaN &&
-      vtkMath::IsNan(*ptr)) || vtkMath::IsInf(*ptr))
-      {
-      continue;
-      }
-    int index = vtkMath::Floor((static_cast<double>(*ptr) - offset) * binWidth);
-    if (index < 0 || index >= histogramSize)
-      {
-      // This happens when scalar range is not computed correctly
-      // (scalar range may be read from file, so VTK does not have full control over it)
-      continue;
-      }
-    binsPtr[index]++;
-    }
+//-----------------------------------------------------------------------------
+bool ctkVTKHistogram::isPreview()const
+{
+  Q_D(const ctkVTKHistogram);
+  return d->Preview;
 }
 
 //-----------------------------------------------------------------------------
@@ -372,6 +729,9 @@ void ctkVTKHistogram::build()
 {
   Q_D(ctkVTKHistogram);
 
+  d->cancelBuild();
+  d->Preview = false;
+
   if (d->DataArray.GetPointer() == 0)
     {
     d->MinBin = 0;
@@ -382,41 +742,63 @@ void ctkVTKHistogram::build()
 
   const int binCount = d->computeNumberOfBins();
 
-  d->Bins->SetNumberOfComponents(1);
-  d->Bins->SetNumberOfTuples(binCount);
-
   if (binCount <= 0)
     {
+    d->Bins->SetNumberOfComponents(1);
+    d->Bins->SetNumberOfTuples(binCount);
     d->MinBin = 0;
     d->MaxBin = 0;
     return;
     }
 
-  // What is the type of the array, discrete or reals
-  if (static_cast<double>(binCount) != (d->Range[1] - d->Range[0] + 1))
+  ctkVTKHistogramBuildRequest request;
+  request.DataArray = d->DataArray;
+  request.Data = d->DataArray->GetVoidPointer(0);
+  request.Component = d->Component;
+  request.Range[0] = d->Range[0];
+  request.Range[1] = d->Range[1];
+  request.BinCount = binCount;
+  request.Generation = d->Generation.loadAcquire();
+
+  if (d->Asynchronous)
     {
-    switch(d->DataArray->GetDataType())
+    vtkIdType previewStride = 1;
+    if (d->PreviewSampleCount > 0)
       {
-      vtkTemplateMacro(populateIrregularBins<VTK_TT>(d->Bins, this));
+      previewStride = (d->DataArray->GetNumberOfTuples() + d->PreviewSampleCount - 1) /
+        d->PreviewSampleCount;
       }
+    d->Building = true;
+    d->BuildThreadPool.start(new ctkVTKHistogramBuildRunnable(d, request, previewStride));
+    return;
     }
-  else
+
+  d->setBins(d->computeBins(request, 1), false);
+  emit changed();
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKHistogram::onBinsComputed()
+{
+  Q_D(ctkVTKHistogram);
+  vtkSmartPointer<vtkIntArray> bins;
+  bool preview = false;
+  {
+  QMutexLocker locker(&d->Mutex);
+  // Ignore the bins of a canceled build
+  if (d->ComputedGeneration == d->Generation.loadAcquire())
     {
-    switch(d->DataArray->GetDataType())
-      {
-      vtkTemplateMacro(populateBins<VTK_TT>(d->Bins, this));
-      }
+    bins = d->ComputedBins;
+    preview = d->ComputedPreview;
     }
-  // update Min/Max values
-  int* binPtr = d->Bins->GetPointer(0);
-  int* endPtr = d->Bins->GetPointer(binCount-1);
-  d->MinBin = *endPtr;
-  d->MaxBin = *endPtr;
-  for (;binPtr < endPtr; ++binPtr)
+  d->ComputedBins = vtkSmartPointer<vtkIntArray>();
+  }
+  if (!bins)
     {
-    d->MinBin = qMin(*binPtr, d->MinBin);
-    d->MaxBin = qMax(*binPtr, d->MaxBin);
+    return;
     }
+  d->setBins(bins, preview);
+  d->Building = preview;
   emit changed();
 }
 
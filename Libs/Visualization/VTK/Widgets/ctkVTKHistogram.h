@@ -34,6 +34,14 @@ class ctkVTKHistogramPrivate;
 ///
 /// Transfer function for a vtkColorTransferFunction. 
 /// The value is an RGB QColor (no alpha supported)
+///
+/// The bins are computed by maximumThreadCount() threads, each counting the
+/// values of a part of the array in its own bins.
+/// When \a asynchronous is true, build() returns immediately and the bins are
+/// computed in a background thread: changed() is emitted when they are
+/// available. If \a previewSampleCount is set, a preview computed from
+/// a subset of the values is made available first.
+/// The data array must not be modified while the bins are computed.
 class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKHistogram: public ctkHistogram
 {
   Q_OBJECT;
@@ -42,6 +50,9 @@ class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKHistogram: public ctkHistogram
   Q_PROPERTY(QVariant maxValue READ maxValue)
   Q_PROPERTY(QVariant minValue READ minValue)
   Q_PROPERTY(int numberOfBins READ numberOfBins WRITE setNumberOfBins)
+  Q_PROPERTY(bool asynchronous READ isAsynchronous WRITE setAsynchronous)
+  Q_PROPERTY(int previewSampleCount READ previewSampleCount WRITE setPreviewSampleCount)
+  Q_PROPERTY(int maximumThreadCount READ maximumThreadCount WRITE setMaximumThreadCount)
 public:
   ctkVTKHistogram(QObject* parent = 0);
   ctkVTKHistogram(vtkDataArray* dataArray, QObject* parent = 0);
@@ -75,9 +86,36 @@ public:
   int numberOfBins()const;
   void setNumberOfBins(int number);
 
+  /// If true, build() computes the bins in a background thread and returns
+  /// immediately. The current bins are kept until the new ones are available.
+  /// False by default.
+  bool isAsynchronous()const;
+  void setAsynchronous(bool asynchronous);
+
+  /// Number of values used to compute a preview of the bins before the full
+  /// histogram, in asynchronous mode. The preview counts every Nth value of
+  /// the array and scales the counts by N.
+  /// 0 (default) disables the preview.
+  int previewSampleCount()const;
+  void setPreviewSampleCount(int count);
+
+  /// Maximum number of threads computing the bins.
+  /// QThread::idealThreadCount() by default.
+  int maximumThreadCount()const;
+  void setMaximumThreadCount(int count);
+
+  /// Returns true while an asynchronous build is running.
+  bool isBuilding()const;
+
+  /// Returns true if the current bins are a preview, see previewSampleCount.
+  bool isPreview()const;
+
   Q_INVOKABLE virtual void removeControlPoint( qreal pos );
 
   Q_INVOKABLE virtual void build();
+protected Q_SLOTS:
+  void onBinsComputed();
+
 protected:
   qreal indexToPos(int index)const;
   int posToIndex(qreal pos)const;
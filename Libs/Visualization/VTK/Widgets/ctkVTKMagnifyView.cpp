@@ -19,6 +19,7 @@
 =========================================================================*/
 
 // Qt includes
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QMouseEvent>
 #include <QPointF>
@@ -60,6 +61,9 @@ ctkVTKMagnifyViewPrivate::ctkVTKMagnifyViewPrivate(ctkVTKMagnifyView& object)
   this->EventHandler.UpdateInterval = 20;
   this->EventHandler.TimerId = 0;
 
+  this->LastUpdateDuration = 0.;
+  this->UpdateCount = 0;
+  this->ReadbackCount = 0;
 }
 
 // --------------------------------------------------------------------------
@@ -169,6 +173,14 @@ void ctkVTKMagnifyViewPrivate::pushRemovePixmapEvent()
     }
 }
 
+// --------------------------------------------------------------------------
+void ctkVTKMagnifyViewPrivate::onRenderWindowEndEvent()
+{
+  // The captured pixels are outdated
+  this->CapturedRegion = QRect();
+  this->pushUpdatePixmapEvent();
+}
+
 // --------------------------------------------------------------------------
 void ctkVTKMagnifyViewPrivate::connectRenderWindow(ctkVTKOpenGLNativeWidget * widget)
 {
@@ -183,7 +195,7 @@ void ctkVTKMagnifyViewPrivate::connectRenderWindow(ctkVTKOpenGLNativeWidget * wi
   if (renderWindow)
     {
     this->qvtkConnect(renderWindow, vtkCommand::EndEvent,
-                      this, SLOT(pushUpdatePixmapEvent()));
+                      this, SLOT(onRenderWindowEndEvent()));
     }
 }
 
@@ -200,7 +212,7 @@ void ctkVTKMagnifyViewPrivate::disconnectRenderWindow(ctkVTKOpenGLNativeWidget *
   if (renderWindow)
     {
     this->qvtkDisconnect(renderWindow, vtkCommand::EndEvent,
-                         this, SLOT(pushUpdatePixmapEvent()));
+                         this, SLOT(onRenderWindowEndEvent()));
     }
 }
 
@@ -254,6 +266,40 @@ void ctkVTKMagnifyViewPrivate::removePixmap()
   this->resetEventHandler();
 }
 
+// -------------------------------------------------------------------------
+bool ctkVTKMagnifyViewPrivate::captureRegion(vtkRenderWindow * renderWindow,
+                                             const QRect& region)
+{
+  // Capture a margin around the region, such that the next mouse moves can be
+  // served without reading the render window again.
+  int * windowSize = renderWindow->GetSize();
+  int marginX = region.width() / 2;
+  int marginY = region.height() / 2;
+  QRect capturedRegion = region.adjusted(-marginX, -marginY, marginX, marginY)
+    .intersected(QRect(0, 0, windowSize[0], windowSize[1]));
+
+  // Retrieve the pixel data into a QImage (flip vertically to move from render
+  // window coordinates to Qt coordinates)
+  QImage image(capturedRegion.width(), capturedRegion.height(), QImage::Format_RGB32);
+  vtkUnsignedCharArray * pixelData = vtkUnsignedCharArray::New();
+  pixelData->SetArray(image.bits(), capturedRegion.width() * capturedRegion.height() * 4, 1);
+  int front = renderWindow->GetDoubleBuffer();
+  int success = renderWindow->GetRGBACharPixelData(
+      capturedRegion.left(), capturedRegion.top(),
+      capturedRegion.right(), capturedRegion.bottom(), front, pixelData);
+  pixelData->Delete();
+  ++this->ReadbackCount;
+  if (!success)
+    {
+    this->CapturedRegion = QRect();
+    return false;
+    }
+  this->CapturedImage = image.rgbSwapped().mirrored();
+  this->CapturedRegion = capturedRegion;
+  this->CapturedWidget = this->EventHandler.Widget;
+  return true;
+}
+
 // -------------------------------------------------------------------------
 void ctkVTKMagnifyViewPrivate::updatePixmap()
 {
@@ -261,6 +307,9 @@ void ctkVTKMagnifyViewPrivate::updatePixmap()
   Q_ASSERT(!this->EventHandler.Widget.isNull());
   Q_Q(ctkVTKMagnifyView);
 
+  QElapsedTimer updateTime;
+  updateTime.start();
+
   // Retrieve buffer of given QVTKWidget from its render window
 #if VTK_MAJOR_VERSION >= 9 || (VTK_MAJOR_VERSION >= 8 && VTK_MINOR_VERSION >= 90)
   vtkRenderWindow * renderWindow = this->EventHandler.Widget.data()->renderWindow();
@@ -367,22 +416,24 @@ void ctkVTKMagnifyViewPrivate::updatePixmap()
     }
   q->setAlignment(alignment);
 
-  // Retrieve the pixel data into a QImage (flip vertically to move from render
-  // window coordinates to Qt coordinates)
-  QSize actualSize(indexRight-indexLeft+1, indexTop-indexBottom+1);
-  QImage image(actualSize.width(), actualSize.height(), QImage::Format_RGB32);
-  vtkUnsignedCharArray * pixelData = vtkUnsignedCharArray::New();
-  pixelData->SetArray(image.bits(), actualSize.width() * actualSize.height() * 4, 1);
-  int front = renderWindow->GetDoubleBuffer();
-  int success = renderWindow->GetRGBACharPixelData(
-      indexLeft, indexBottom, indexRight, indexTop, front, pixelData);
-  if (!success)
+  // Read the render window only if the region was not captured since its last
+  // render. Without render window events, a render can't be detected.
+  // The region is in render window coordinates: its QRect "bottom" is the top.
+  QRect region(QPoint(indexLeft, indexBottom), QPoint(indexRight, indexTop));
+  if (!this->ObserveRenderWindowEvents ||
+      this->CapturedWidget != this->EventHandler.Widget ||
+      !this->CapturedRegion.contains(region))
     {
-    return;
+    if (!this->captureRegion(renderWindow, region))
+      {
+      return;
+      }
     }
-  pixelData->Delete();
-  image = image.rgbSwapped();
-  image = image.mirrored();
+  QSize actualSize = region.size();
+  QImage image = this->CapturedImage.copy(
+    region.left() - this->CapturedRegion.left(),
+    this->CapturedRegion.bottom() - region.bottom(),
+    actualSize.width(), actualSize.height());
 
   // Scale the image to zoom, using FastTransformation to prevent smoothing
   QSize imageSize = actualSize * this->Magnification;
@@ -450,6 +501,9 @@ void ctkVTKMagnifyViewPrivate::updatePixmap()
   q->setPixmap(QPixmap::fromImage(image));
   q->update();
   this->resetEventHandler();
+
+  ++this->UpdateCount;
+  this->LastUpdateDuration = updateTime.nsecsElapsed() / 1000000.;
 }
 
 //---------------------------------------------------------------------------
@@ -499,6 +553,8 @@ void ctkVTKMagnifyView::setObserveRenderWindowEvents(bool newObserve)
     }
 
   d->ObserveRenderWindowEvents = newObserve;
+  // Renders may have been missed
+  d->CapturedRegion = QRect();
 
   // Connect/disconnect observations on vtkRenderWindow EndEvents, depending
   // on whether we are switching from not-observing to observing or from
@@ -538,6 +594,27 @@ void ctkVTKMagnifyView::setUpdateInterval(int newInterval)
   d->restartTimer();
 }
 
+// --------------------------------------------------------------------------
+double ctkVTKMagnifyView::lastUpdateDuration() const
+{
+  Q_D(const ctkVTKMagnifyView);
+  return d->LastUpdateDuration;
+}
+
+// --------------------------------------------------------------------------
+int ctkVTKMagnifyView::updateCount() const
+{
+  Q_D(const ctkVTKMagnifyView);
+  return d->UpdateCount;
+}
+
+// --------------------------------------------------------------------------
+int ctkVTKMagnifyView::readbackCount() const
+{
+  Q_D(const ctkVTKMagnifyView);
+  return d->ReadbackCount;
+}
+
 // --------------------------------------------------------------------------
 void ctkVTKMagnifyView::observe(ctkVTKOpenGLNativeWidget * widget)
 {
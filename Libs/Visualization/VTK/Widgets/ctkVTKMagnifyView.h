@@ -44,6 +44,7 @@ class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKMagnifyView
   Q_PROPERTY(bool observeRenderWindowEvents
              READ observeRenderWindowEvents WRITE setObserveRenderWindowEvents)
   Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval)
+  Q_PROPERTY(double lastUpdateDuration READ lastUpdateDuration)
 
 public:
   /// Constructors
@@ -69,6 +70,17 @@ public:
   int updateInterval() const;
   void setUpdateInterval(int newInterval);
 
+  /// Time spent in the last update of the magnified pixmap, in milliseconds.
+  double lastUpdateDuration() const;
+
+  /// Number of updates of the magnified pixmap, and number of them that read
+  /// pixels back from an observed render window. When observing render
+  /// window events, the pixels are read with a margin around the magnified
+  /// region, and reused by the mouse moves staying within it until the
+  /// render window renders again.
+  int updateCount() const;
+  int readbackCount() const;
+
   /// Add a QVTKWidget to observe mouse events on.  You can call this function
   /// multiple times to observe multiple QVTKWidgets.
   /// \sa observe
@@ -22,7 +22,9 @@
 #define __ctkVTKMagnifyView_p_h
 
 // Qt includes
+#include <QImage>
 #include <QPointer>
+#include <QRect>
 class QPointF;
 class QTimerEvent;
 
@@ -31,6 +33,8 @@ class QTimerEvent;
 #include <ctkVTKObject.h>
 #include "ctkVTKOpenGLNativeWidget.h"
 
+class vtkRenderWindow;
+
 /// \ingroup Visualization_VTK_Widgets
 class ctkVTKMagnifyViewPrivate : public QObject
 {
@@ -53,6 +57,9 @@ public:
 protected:
   void updatePixmap();
   void removePixmap();
+  /// Read back a region of the render window, with a margin around it, into
+  /// CapturedImage. The region is in render window coordinates.
+  bool captureRegion(vtkRenderWindow * renderWindow, const QRect& region);
   void timerEvent(QTimerEvent * event);
   void restartTimer();
   void resetEventHandler();
@@ -76,12 +83,23 @@ public Q_SLOTS:
   void pushUpdatePixmapEvent();
   void pushUpdatePixmapEvent(QPointF pos);
   void pushRemovePixmapEvent();
+  void onRenderWindowEndEvent();
 
 public:
   QList<ctkVTKOpenGLNativeWidget *> ObservedQVTKWidgets;
   double Magnification;
   bool ObserveRenderWindowEvents;
   EventHandlerStruct EventHandler;
+
+  /// Pixels read back from the render window of CapturedWidget, reused by the
+  /// updates whose region is within CapturedRegion until the next render.
+  QPointer<ctkVTKOpenGLNativeWidget> CapturedWidget;
+  QRect CapturedRegion;
+  QImage CapturedImage;
+
+  double LastUpdateDuration;
+  int UpdateCount;
+  int ReadbackCount;
 };
 
 #endif
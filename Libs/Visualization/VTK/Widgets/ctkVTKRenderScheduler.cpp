@@ -0,0 +1,374 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QHash>
+#include <QMouseEvent>
+#include <QPointer>
+#include <QTimer>
+
+// CTK includes
+#include "ctkVTKAbstractView.h"
+#include "ctkVTKRenderScheduler.h"
+
+//-----------------------------------------------------------------------------
+class ctkVTKRenderSchedulerPrivate
+{
+  Q_DECLARE_PUBLIC(ctkVTKRenderScheduler);
+protected:
+  ctkVTKRenderScheduler* const q_ptr;
+public:
+  ctkVTKRenderSchedulerPrivate(ctkVTKRenderScheduler& object);
+
+  void init();
+  /// Start the frame timer, respecting the maximum update rate.
+  void startFrameTimer();
+  ctkVTKAbstractView* viewFromWidget(QObject* object)const;
+
+  static QPointer<ctkVTKRenderScheduler> Instance;
+
+  QList<QPointer<ctkVTKAbstractView> > Views;
+  /// Views waiting for a frame, in the order of their requests
+  QList<QPointer<ctkVTKAbstractView> > PendingViews;
+  QHash<ctkVTKAbstractView*, int> DeferredRenderCounts;
+
+  QTimer* FrameTimer;
+  QElapsedTimer FrameTime;
+  int FrameCount;
+  double MaximumUpdateRate;
+  double FrameBudget;
+
+  QPointer<ctkVTKAbstractView> InteractingView;
+  QElapsedTimer InteractionTime;
+  int InteractionTimeout;
+};
+
+//-----------------------------------------------------------------------------
+QPointer<ctkVTKRenderScheduler> ctkVTKRenderSchedulerPrivate::Instance;
+
+//-----------------------------------------------------------------------------
+ctkVTKRenderSchedulerPrivate::ctkVTKRenderSchedulerPrivate(ctkVTKRenderScheduler& object)
+  : q_ptr(&object)
+{
+  this->FrameTimer = 0;
+  this->FrameCount = 0;
+  this->MaximumUpdateRate = 60.0;
+  this->FrameBudget = 16.0;
+  this->InteractionTimeout = 500;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderSchedulerPrivate::init()
+{
+  Q_Q(ctkVTKRenderScheduler);
+  this->FrameTimer = new QTimer(q);
+  this->FrameTimer->setSingleShot(true);
+  QObject::connect(this->FrameTimer, SIGNAL(timeout()),
+                   q, SLOT(renderFrame()));
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderSchedulerPrivate::startFrameTimer()
+{
+  if (this->FrameTimer->isActive())
+    {
+    return;
+    }
+  // If the MaximumUpdateRate is 0, the frame is rendered next time the
+  // application is idle.
+  qint64 msecsBeforeFrame = 0;
+  if (this->MaximumUpdateRate > 0.0 && this->FrameTime.isValid())
+    {
+    msecsBeforeFrame = static_cast<qint64>(1000. / this->MaximumUpdateRate)
+      - this->FrameTime.elapsed();
+    }
+  this->FrameTimer->start(static_cast<int>(qMax<qint64>(0, msecsBeforeFrame)));
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKAbstractView* ctkVTKRenderSchedulerPrivate::viewFromWidget(QObject* object)const
+{
+  foreach(const QPointer<ctkVTKAbstractView>& view, this->Views)
+    {
+    if (view && view->VTKWidget() == object)
+      {
+      return view;
+      }
+    }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKRenderScheduler::ctkVTKRenderScheduler(QObject* parentObject)
+  : Superclass(parentObject)
+  , d_ptr(new ctkVTKRenderSchedulerPrivate(*this))
+{
+  Q_D(ctkVTKRenderScheduler);
+  d->init();
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKRenderScheduler::~ctkVTKRenderScheduler()
+{
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKRenderScheduler* ctkVTKRenderScheduler::instance()
+{
+  if (!ctkVTKRenderSchedulerPrivate::Instance)
+    {
+    ctkVTKRenderSchedulerPrivate::Instance =
+      new ctkVTKRenderScheduler(QCoreApplication::instance());
+    }
+  return ctkVTKRenderSchedulerPrivate::Instance;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::setMaximumUpdateRate(double fps)
+{
+  Q_D(ctkVTKRenderScheduler);
+  d->MaximumUpdateRate = fps;
+}
+
+//-----------------------------------------------------------------------------
+double ctkVTKRenderScheduler::maximumUpdateRate()const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  return d->MaximumUpdateRate;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::setFrameBudget(double msecs)
+{
+  Q_D(ctkVTKRenderScheduler);
+  d->FrameBudget = qMax(0., msecs);
+}
+
+//-----------------------------------------------------------------------------
+double ctkVTKRenderScheduler::frameBudget()const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  return d->FrameBudget;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::setInteractionTimeout(int msecs)
+{
+  Q_D(ctkVTKRenderScheduler);
+  d->InteractionTimeout = msecs;
+}
+
+//-----------------------------------------------------------------------------
+int ctkVTKRenderScheduler::interactionTimeout()const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  return d->InteractionTimeout;
+}
+
+//-----------------------------------------------------------------------------
+QList<ctkVTKAbstractView*> ctkVTKRenderScheduler::views()const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  QList<ctkVTKAbstractView*> viewList;
+  foreach(const QPointer<ctkVTKAbstractView>& view, d->Views)
+    {
+    if (view)
+      {
+      viewList << view;
+      }
+    }
+  return viewList;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::registerView(ctkVTKAbstractView* view)
+{
+  Q_D(ctkVTKRenderScheduler);
+  if (!view || d->Views.contains(view))
+    {
+    return;
+    }
+  d->Views << view;
+  view->VTKWidget()->installEventFilter(this);
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::unregisterView(ctkVTKAbstractView* view)
+{
+  Q_D(ctkVTKRenderScheduler);
+  if (!d->Views.removeAll(view))
+    {
+    return;
+    }
+  d->PendingViews.removeAll(view);
+  d->DeferredRenderCounts.remove(view);
+  if (d->InteractingView == view)
+    {
+    d->InteractingView = 0;
+    }
+  view->VTKWidget()->removeEventFilter(this);
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::scheduleRender(ctkVTKAbstractView* view)
+{
+  Q_D(ctkVTKRenderScheduler);
+  if (!view || !d->Views.contains(view))
+    {
+    return;
+    }
+  if (!d->PendingViews.contains(view))
+    {
+    d->PendingViews << view;
+    }
+  d->startFrameTimer();
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::cancelRender(ctkVTKAbstractView* view)
+{
+  Q_D(ctkVTKRenderScheduler);
+  d->PendingViews.removeAll(view);
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKRenderScheduler::isRenderPending(ctkVTKAbstractView* view)const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  return view && d->PendingViews.contains(view);
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKAbstractView* ctkVTKRenderScheduler::interactingView()const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  if (!d->InteractingView || !d->InteractionTime.isValid() ||
+      d->InteractionTime.elapsed() > d->InteractionTimeout)
+    {
+    return 0;
+    }
+  return d->InteractingView;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::setInteractingView(ctkVTKAbstractView* view)
+{
+  Q_D(ctkVTKRenderScheduler);
+  d->InteractingView = view;
+  d->InteractionTime.start();
+}
+
+//-----------------------------------------------------------------------------
+int ctkVTKRenderScheduler::deferredRenderCount(ctkVTKAbstractView* view)const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  return d->DeferredRenderCounts.value(view, 0);
+}
+
+//-----------------------------------------------------------------------------
+int ctkVTKRenderScheduler::frameCount()const
+{
+  Q_D(const ctkVTKRenderScheduler);
+  return d->FrameCount;
+}
+
+//-----------------------------------------------------------------------------
+void ctkVTKRenderScheduler::renderFrame()
+{
+  Q_D(ctkVTKRenderScheduler);
+  d->FrameTimer->stop();
+  d->FrameTime.start();
+  ++d->FrameCount;
+
+  // Requests received while rendering (e.g. from observers of the render)
+  // are rendered in the next frame.
+  QList<QPointer<ctkVTKAbstractView> > viewsToRender = d->PendingViews;
+  d->PendingViews.clear();
+
+  // The view interacted with is rendered first, whatever the budget.
+  ctkVTKAbstractView* interactingView = this->interactingView();
+  if (interactingView && viewsToRender.removeAll(interactingView))
+    {
+    QMetaObject::invokeMethod(interactingView, "requestRender", Qt::DirectConnection);
+    }
+
+  QList<QPointer<ctkVTKAbstractView> > deferredViews;
+  bool backgroundViewRendered = false;
+  foreach(const QPointer<ctkVTKAbstractView>& view, viewsToRender)
+    {
+    if (!view)
+      {
+      continue;
+      }
+    double frameTime = d->FrameTime.nsecsElapsed() / 1000000.;
+    if (d->FrameBudget > 0. && backgroundViewRendered &&
+        frameTime + view->averageRenderTime() > d->FrameBudget)
+      {
+      deferredViews << view;
+      ++d->DeferredRenderCounts[view];
+      continue;
+      }
+    QMetaObject::invokeMethod(view, "requestRender", Qt::DirectConnection);
+    backgroundViewRendered = true;
+    }
+
+  // Deferred views keep their priority over the newer requests.
+  foreach(const QPointer<ctkVTKAbstractView>& view, d->PendingViews)
+    {
+    if (!deferredViews.contains(view))
+      {
+      deferredViews << view;
+      }
+    }
+  d->PendingViews = deferredViews;
+  if (!d->PendingViews.isEmpty())
+    {
+    d->startFrameTimer();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool ctkVTKRenderScheduler::eventFilter(QObject* object, QEvent* event)
+{
+  Q_D(ctkVTKRenderScheduler);
+  switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+      this->setInteractingView(d->viewFromWidget(object));
+      break;
+    case QEvent::MouseMove:
+      if (static_cast<QMouseEvent*>(event)->buttons() != Qt::NoButton)
+        {
+        this->setInteractingView(d->viewFromWidget(object));
+        }
+      break;
+    default:
+      break;
+    }
+  return this->Superclass::eventFilter(object, event);
+}
@@ -0,0 +1,134 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+#ifndef __ctkVTKRenderScheduler_h
+#define __ctkVTKRenderScheduler_h
+
+// Qt includes
+#include <QObject>
+
+// CTK includes
+#include "ctkVisualizationVTKWidgetsExport.h"
+class ctkVTKAbstractView;
+class ctkVTKRenderSchedulerPrivate;
+
+/// \ingroup Visualization_VTK_Widgets
+/// Render scheduler shared by several views.
+/// Without scheduler, each ctkVTKAbstractView renders on its own timer. Views
+/// registered to a scheduler with ctkVTKAbstractView::setRenderScheduler()
+/// instead add their render requests to the scheduler that renders them all
+/// in a single frame, at most maximumUpdateRate times per second.
+/// The view the user is interacting with is rendered first in the frame. The
+/// other views are rendered afterwards while the rendering time of the frame
+/// stays within frameBudget, the remaining views are deferred to the next
+/// frame. At least one deferred view is rendered per frame, in the order of
+/// the requests, so that no view is starved.
+/// \code{.cpp}
+/// foreach(ctkVTKAbstractView* view, layoutViews)
+///   {
+///   view->setRenderScheduler(ctkVTKRenderScheduler::instance());
+///   }
+/// \endcode
+/// \sa ctkVTKAbstractView::setRenderScheduler
+class CTK_VISUALIZATION_VTK_WIDGETS_EXPORT ctkVTKRenderScheduler : public QObject
+{
+  Q_OBJECT
+  /// Maximum rate (in frames per second) of the frames rendering the views.
+  /// It replaces the maximum update rate of the registered views.
+  /// 60 by default.
+  /// \sa ctkVTKAbstractView::maximumUpdateRate
+  Q_PROPERTY(double maximumUpdateRate READ maximumUpdateRate WRITE setMaximumUpdateRate)
+  /// Time (in milliseconds) after which the views not interacted with are
+  /// deferred to the next frame. The time of a view is estimated from its
+  /// average render time. 0 means no limit.
+  /// 16 by default.
+  /// \sa ctkVTKAbstractView::averageRenderTime
+  Q_PROPERTY(double frameBudget READ frameBudget WRITE setFrameBudget)
+  /// Time (in milliseconds) during which a view is considered as interacted
+  /// with after it received a mouse or key event.
+  /// 500 by default.
+  Q_PROPERTY(int interactionTimeout READ interactionTimeout WRITE setInteractionTimeout)
+
+public:
+  typedef QObject Superclass;
+  explicit ctkVTKRenderScheduler(QObject* parent = 0);
+  virtual ~ctkVTKRenderScheduler();
+
+  /// Scheduler shared by the application. It is created on first use and
+  /// deleted with the application.
+  static ctkVTKRenderScheduler* instance();
+
+  void setMaximumUpdateRate(double fps);
+  double maximumUpdateRate()const;
+
+  void setFrameBudget(double msecs);
+  double frameBudget()const;
+
+  void setInteractionTimeout(int msecs);
+  int interactionTimeout()const;
+
+  /// Views registered to the scheduler.
+  QList<ctkVTKAbstractView*> views()const;
+
+  /// Add a render request of \a view to the next frame.
+  /// Requests of a view already pending are merged.
+  void scheduleRender(ctkVTKAbstractView* view);
+
+  /// Return true if \a view has a render request waiting for a frame.
+  bool isRenderPending(ctkVTKAbstractView* view)const;
+
+  /// Return the view interacted with within the last interactionTimeout
+  /// milliseconds, 0 if none.
+  ctkVTKAbstractView* interactingView()const;
+
+  /// Set the view that is interacted with. Views receiving mouse or key
+  /// events are automatically set.
+  void setInteractingView(ctkVTKAbstractView* view);
+
+  /// Number of times a render request of \a view has been deferred to a
+  /// later frame because the frame budget was exceeded.
+  int deferredRenderCount(ctkVTKAbstractView* view)const;
+
+  /// Number of frames rendered since the creation of the scheduler.
+  int frameCount()const;
+
+public Q_SLOTS:
+  /// Render now the views with pending render requests, within the frame
+  /// budget.
+  void renderFrame();
+
+protected:
+  virtual bool eventFilter(QObject* object, QEvent* event);
+
+  QScopedPointer<ctkVTKRenderSchedulerPrivate> d_ptr;
+
+private:
+  friend class ctkVTKAbstractView;
+  /// Called by ctkVTKAbstractView::setRenderScheduler()
+  void registerView(ctkVTKAbstractView* view);
+  void unregisterView(ctkVTKAbstractView* view);
+  /// Called when \a view is rendered outside of a frame.
+  void cancelRender(ctkVTKAbstractView* view);
+
+  Q_DECLARE_PRIVATE(ctkVTKRenderScheduler);
+  Q_DISABLE_COPY(ctkVTKRenderScheduler);
+};
+
+#endif
@@ -0,0 +1,176 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+
+// CTK includes
+#include "ctkCoreTestingMacros.h"
+#include "ctkErrorLogContext.h"
+#include "ctkErrorLogModel.h"
+
+// STL includes
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+class PostEntryThread : public QThread
+{
+public:
+  PostEntryThread(ctkErrorLogModel& model, int numberOfEntries)
+    : Model(model), NumberOfEntries(numberOfEntries) {}
+protected:
+  virtual void run()
+  {
+    for (int i = 0; i < this->NumberOfEntries; ++i)
+      {
+      this->Model.postEntry(QDateTime::currentDateTime(), QString::number(quintptr(this)),
+                            ctkErrorLogLevel::Info, "ctkErrorLogModelBatchTest1",
+                            ctkErrorLogContext(), QString("message %1").arg(i));
+      }
+  }
+  ctkErrorLogModel& Model;
+  int NumberOfEntries;
+};
+
+//-----------------------------------------------------------------------------
+void addEntry(ctkErrorLogModel& model, const QString& text)
+{
+  model.addEntry(QDateTime::currentDateTime(), "0", ctkErrorLogLevel::Info,
+                 "ctkErrorLogModelBatchTest1", ctkErrorLogContext(), text);
+}
+
+//-----------------------------------------------------------------------------
+QString descriptionText(const ctkErrorLogModel& model, int row)
+{
+  return model.index(row, ctkErrorLogModel::DescriptionColumn)
+    .data(ctkErrorLogModel::DescriptionTextRole).toString();
+}
+
+//-----------------------------------------------------------------------------
+int postEntriesFromThreads(ctkErrorLogModel& model, int numberOfThreads, int numberOfEntriesPerThread)
+{
+  int insertionCount = 0;
+  int addedCount = 0;
+  QMetaObject::Connection insertionConnection = QObject::connect(
+    &model, &QAbstractItemModel::rowsInserted, [&insertionCount]() { ++insertionCount; });
+  QMetaObject::Connection entryConnection = QObject::connect(
+    &model, static_cast<void (ctkErrorLogModel::*)(ctkErrorLogLevel::LogLevel)>(&ctkErrorLogModel::entryAdded),
+    [&addedCount]() { ++addedCount; });
+
+  const int numberOfEntries = numberOfThreads * numberOfEntriesPerThread;
+  QList<QThread*> threads;
+  for (int i = 0; i < numberOfThreads; ++i)
+    {
+    threads << new PostEntryThread(model, numberOfEntriesPerThread);
+    }
+  QElapsedTimer timer;
+  timer.start();
+  foreach(QThread* thread, threads)
+    {
+    thread->start();
+    }
+  while (addedCount < numberOfEntries && timer.elapsed() < 60000)
+    {
+    QCoreApplication::processEvents();
+    }
+  qint64 elapsed = timer.elapsed();
+  foreach(QThread* thread, threads)
+    {
+    thread->wait();
+    }
+  qDeleteAll(threads);
+  QObject::disconnect(insertionConnection);
+  QObject::disconnect(entryConnection);
+
+  std::cout << "entryBatchInterval " << model.entryBatchInterval() << " ms: "
+            << numberOfEntries << " entries added in "
+            << elapsed << " ms with " << insertionCount << " insertions" << std::endl;
+  return insertionCount;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+int ctkErrorLogModelBatchTest1(int argc, char * argv [])
+{
+  QCoreApplication app(argc, argv);
+
+  ctkErrorLogModel model;
+  CHECK_INT(model.entryBatchInterval(), 0);
+  CHECK_INT(model.maximumEntryCount(), 0);
+
+  // Oldest entries are removed when the maximum count is reached
+  model.setMaximumEntryCount(3);
+  for (int i = 0; i < 5; ++i)
+    {
+    addEntry(model, QString("entry %1").arg(i));
+    }
+  CHECK_INT(model.rowCount(), 3);
+  CHECK_QSTRING(descriptionText(model, 0), QString("entry 2"));
+  CHECK_QSTRING(descriptionText(model, 2), QString("entry 4"));
+
+  // Grouping still applies to the last entry once the buffer wrapped
+  model.setLogEntryGrouping(true);
+  addEntry(model, "entry 5");
+  CHECK_INT(model.rowCount(), 3);
+  CHECK_QSTRING(descriptionText(model, 2), QString("entry 4\nentry 5"));
+  model.setLogEntryGrouping(false);
+
+  // Lowering the maximum drops the oldest entries
+  model.setMaximumEntryCount(2);
+  CHECK_INT(model.rowCount(), 2);
+  CHECK_QSTRING(descriptionText(model, 0), QString("entry 3"));
+
+  model.setMaximumEntryCount(0);
+  model.clear();
+  CHECK_INT(model.rowCount(), 0);
+
+  const int numberOfThreads = 4;
+  const int numberOfEntriesPerThread = 5000;
+
+  // Without batching, every entry is inserted on its own
+  int insertionCount = postEntriesFromThreads(model, numberOfThreads, numberOfEntriesPerThread);
+  CHECK_INT(model.rowCount(), numberOfThreads * numberOfEntriesPerThread);
+  CHECK_INT(insertionCount, numberOfThreads * numberOfEntriesPerThread);
+
+  // With batching, entries are inserted at most once per interval
+  model.clear();
+  model.setEntryBatchInterval(50);
+  insertionCount = postEntriesFromThreads(model, numberOfThreads, numberOfEntriesPerThread);
+  CHECK_INT(model.rowCount(), numberOfThreads * numberOfEntriesPerThread);
+  CHECK_BOOL(insertionCount < numberOfThreads * numberOfEntriesPerThread / 10, true);
+
+  // The maximum count applies to the batches as well
+  model.clear();
+  model.setMaximumEntryCount(1000);
+  postEntriesFromThreads(model, 1, 1000);
+  postEntriesFromThreads(model, 1, 10);
+  CHECK_INT(model.rowCount(), 1000);
+  CHECK_QSTRING(descriptionText(model, 999), QString("message 9"));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*=========================================================================
+
+  Library:   CTK
+
+  Copyright (c) Kitware Inc.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=========================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QLabel>
+#include <QPixmap>
+#include <QVector>
+
+// CTK includes
+#include "ctkQImageView.h"
+#include "ctkTest.h"
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// 16x16 slice, 1000 on the left half and 3000 on the right half
+QVector<quint16> halfSlice()
+{
+  QVector<quint16> pixels(16 * 16);
+  for (int i = 0; i < pixels.size(); ++i)
+    {
+    pixels[i] = (i % 16) < 8 ? 1000 : 3000;
+    }
+  return pixels;
+}
+
+//-----------------------------------------------------------------------------
+// Gray level displayed at the middle of the left (or right) half of the view
+int displayedGray(ctkQImageView& view, bool right)
+{
+  QLabel* label = view.findChild<QLabel*>();
+  if (!label || !label->pixmap())
+    {
+    return -1;
+    }
+  QImage image = label->pixmap()->toImage();
+  return qGray(image.pixel(image.width() * (right ? 3 : 1) / 4, image.height() / 2));
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+class ctkQImageViewTester : public QObject
+{
+  Q_OBJECT
+
+private slots:
+
+  void testRawImageWindowLevel();
+  void testRawImageFlipInvert();
+  void testRawImageWithoutCache();
+  void testQImageInvert();
+
+  void benchmarkWindowLevel();
+};
+
+//-----------------------------------------------------------------------------
+void ctkQImageViewTester::testRawImageWindowLevel()
+{
+  ctkQImageView view;
+  // Small enough for the view not to draw any text
+  view.resize(100, 100);
+  view.addImage(halfSlice(), 16, 16);
+
+  // the window/level is set to the range of the slice
+  QCOMPARE(view.intensityWindow(), 2000.);
+  QCOMPARE(view.intensityLevel(), 2000.);
+  QCOMPARE(displayedGray(view, false), 0);
+  QCOMPARE(displayedGray(view, true), 255);
+
+  view.setIntensityWindowLevel(4000, 2000);
+  QCOMPARE(displayedGray(view, false), 64);
+  QCOMPARE(displayedGray(view, true), 191);
+
+  // the raw value is reported, not the displayed one
+  view.setPosition(12, 3);
+  QCOMPARE(view.positionValue(), 3000.);
+}
+
+//-----------------------------------------------------------------------------
+void ctkQImageViewTester::testRawImageFlipInvert()
+{
+  ctkQImageView view;
+  view.resize(100, 100);
+  view.addImage(halfSlice(), 16, 16);
+
+  view.setFlipXAxis(true);
+  QCOMPARE(displayedGray(view, false), 255);
+  QCOMPARE(displayedGray(view, true), 0);
+
+  view.setInvertImage(true);
+  QCOMPARE(displayedGray(view, false), 0);
+  QCOMPARE(displayedGray(view, true), 255);
+
+  view.setFlipXAxis(false);
+  QCOMPARE(displayedGray(view, false), 255);
+  QCOMPARE(displayedGray(view, true), 0);
+}
+
+//-----------------------------------------------------------------------------
+void ctkQImageViewTester::testRawImageWithoutCache()
+{
+  ctkQImageView view;
+  view.setPixmapCacheLimit(0);
+  QCOMPARE(view.pixmapCacheLimit(), 0);
+  view.resize(100, 100);
+  view.addImage(halfSlice(), 16, 16);
+
+  view.setIntensityWindowLevel(4000, 2000);
+  QCOMPARE(displayedGray(view, false), 64);
+  QCOMPARE(displayedGray(view, true), 191);
+}
+
+//-----------------------------------------------------------------------------
+void ctkQImageViewTester::testQImageInvert()
+{
+  ctkQImageView view;
+  view.resize(100, 100);
+  QImage image(16, 16, QImage::Format_RGB32);
+  image.fill(qRgb(10, 20, 30));
+  view.addImage(image);
+
+  view.setInvertImage(true);
+  QLabel* label = view.findChild<QLabel*>();
+  QVERIFY(label && label->pixmap());
+  QImage displayed = label->pixmap()->toImage();
+  QCOMPARE(displayed.pixel(displayed.width() / 2, displayed.height() / 2),
+           qRgb(245, 235, 225));
+}
+
+//-----------------------------------------------------------------------------
+void ctkQImageViewTester::benchmarkWindowLevel()
+{
+  // Each iteration renders a frame as when dragging the window/level
+  QVector<quint16> pixels(512 * 512);
+  for (int i = 0; i < pixels.size(); ++i)
+    {
+    pixels[i] = static_cast<quint16>(i % 4096);
+    }
+  ctkQImageView view;
+  view.resize(512, 512);
+  view.addImage(pixels, 512, 512);
+
+  int frame = 0;
+  QBENCHMARK
+    {
+    ++frame;
+    view.setIntensityWindowLevel(1000 + frame % 1000, 2048);
+    }
+}
+
+// ----------------------------------------------------------------------------
+CTK_TEST_MAIN(ctkQImageViewTest)
+#include "moc_ctkQImageViewTest.cpp"
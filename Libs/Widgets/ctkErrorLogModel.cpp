@@ -19,11 +19,279 @@
 =========================================================================*/
 
 // Qt includes
-#include <QStandardItem>
+#include <QAbstractTableModel>
+#include <QVector>
 
 // CTK includes
 #include "ctkErrorLogModel.h"
 
+// --------------------------------------------------------------------------
+// ctkErrorLogItemModel
+
+// --------------------------------------------------------------------------
+/// \internal
+/// Read-only table of the log entries, stored in a ring buffer so that
+/// removing the oldest entries when the maximum count is reached is cheap.
+class ctkErrorLogItemModel : public QAbstractTableModel
+{
+public:
+  typedef QAbstractTableModel Superclass;
+  ctkErrorLogItemModel(QObject* parentObject = 0);
+
+  int maximumEntryCount()const;
+  void setMaximumEntryCount(int count);
+
+  /// Add entries given as one string per column
+  void addEntries(const QList<QStringList>& entries);
+
+  virtual int rowCount(const QModelIndex& parent = QModelIndex())const;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex())const;
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole)const;
+  virtual bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
+  virtual Qt::ItemFlags flags(const QModelIndex& index)const;
+  virtual bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex());
+
+protected:
+  struct Entry
+  {
+    QString Columns[ctkErrorLogAbstractModel::MaxColumn + 1];
+    /// Display text of the description if it was set, computed otherwise
+    QString DescriptionDisplay;
+  };
+
+  Entry& entry(int row);
+  const Entry& entry(int row)const;
+
+  /// Store the entries from the first slot of the buffer
+  void linearize();
+
+  QVector<Entry> Entries;
+  int First;
+  int Count;
+  int MaximumEntryCount;
+};
+
+// --------------------------------------------------------------------------
+ctkErrorLogItemModel::ctkErrorLogItemModel(QObject* parentObject)
+  : Superclass(parentObject)
+  , First(0)
+  , Count(0)
+  , MaximumEntryCount(0)
+{
+}
+
+// --------------------------------------------------------------------------
+ctkErrorLogItemModel::Entry& ctkErrorLogItemModel::entry(int row)
+{
+  return this->Entries[(this->First + row) % this->Entries.size()];
+}
+
+// --------------------------------------------------------------------------
+const ctkErrorLogItemModel::Entry& ctkErrorLogItemModel::entry(int row)const
+{
+  return this->Entries[(this->First + row) % this->Entries.size()];
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogItemModel::linearize()
+{
+  if (this->First == 0 && this->Entries.size() == this->Count)
+    {
+    return;
+    }
+  QVector<Entry> entries;
+  entries.reserve(this->Count);
+  for (int row = 0; row < this->Count; ++row)
+    {
+    entries.append(this->entry(row));
+    }
+  this->Entries.swap(entries);
+  this->First = 0;
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogItemModel::maximumEntryCount()const
+{
+  return this->MaximumEntryCount;
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogItemModel::setMaximumEntryCount(int count)
+{
+  count = qMax(0, count);
+  this->MaximumEntryCount = count;
+  if (count > 0 && this->Count > count)
+    {
+    this->removeRows(0, this->Count - count);
+    }
+  this->linearize();
+}
+
+// --------------------------------------------------------------------------
+void ctkErrorLogItemModel::addEntries(const QList<QStringList>& entries)
+{
+  int first = 0;
+  int count = entries.count();
+  if (this->MaximumEntryCount > 0)
+    {
+    // Only the last entries are kept
+    first = qMax(0, count - this->MaximumEntryCount);
+    count -= first;
+
+    int removedCount = this->Count + count - this->MaximumEntryCount;
+    if (removedCount > 0)
+      {
+      this->beginRemoveRows(QModelIndex(), 0, removedCount - 1);
+      if (this->Entries.size() < this->MaximumEntryCount)
+        {
+        // The buffer wraps from now on
+        this->linearize();
+        this->Entries.resize(this->MaximumEntryCount);
+        }
+      this->First = (this->First + removedCount) % this->Entries.size();
+      this->Count -= removedCount;
+      this->endRemoveRows();
+      }
+    }
+  if (count <= 0)
+    {
+    return;
+    }
+
+  this->beginInsertRows(QModelIndex(), this->Count, this->Count + count - 1);
+  for (int index = first; index < entries.count(); ++index)
+    {
+    const QStringList& columns = entries[index];
+    Entry newEntry;
+    for (int column = 0; column <= ctkErrorLogAbstractModel::MaxColumn && column < columns.count(); ++column)
+      {
+      newEntry.Columns[column] = columns[column];
+      }
+    if (this->First == 0 && this->Count == this->Entries.size())
+      {
+      this->Entries.append(newEntry);
+      }
+    else
+      {
+      this->entry(this->Count) = newEntry;
+      }
+    ++this->Count;
+    }
+  this->endInsertRows();
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogItemModel::rowCount(const QModelIndex& parent)const
+{
+  return parent.isValid() ? 0 : this->Count;
+}
+
+// --------------------------------------------------------------------------
+int ctkErrorLogItemModel::columnCount(const QModelIndex& parent)const
+{
+  return parent.isValid() ? 0 : ctkErrorLogAbstractModel::MaxColumn + 1;
+}
+
+// --------------------------------------------------------------------------
+QVariant ctkErrorLogItemModel::data(const QModelIndex& index, int role)const
+{
+  if (!index.isValid() || index.row() >= this->Count)
+    {
+    return QVariant();
+    }
+  const Entry& rowEntry = this->entry(index.row());
+  if (index.column() == ctkErrorLogAbstractModel::DescriptionColumn)
+    {
+    const QString& descriptionText = rowEntry.Columns[ctkErrorLogAbstractModel::DescriptionColumn];
+    if (role == ctkErrorLogAbstractModel::DescriptionTextRole)
+      {
+      return descriptionText;
+      }
+    if (role == Qt::DisplayRole || role == Qt::EditRole)
+      {
+      if (!rowEntry.DescriptionDisplay.isNull())
+        {
+        return rowEntry.DescriptionDisplay;
+        }
+      return descriptionText.left(160).append((descriptionText.size() > 160) ? "..." : "");
+      }
+    return QVariant();
+    }
+  if (role == Qt::DisplayRole || role == Qt::EditRole)
+    {
+    return rowEntry.Columns[index.column()];
+    }
+  return QVariant();
+}
+
+// --------------------------------------------------------------------------
+bool ctkErrorLogItemModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+  if (!index.isValid() || index.row() >= this->Count)
+    {
+    return false;
+    }
+  Entry& rowEntry = this->entry(index.row());
+  if (index.column() == ctkErrorLogAbstractModel::DescriptionColumn
+      && (role == Qt::DisplayRole || role == Qt::EditRole))
+    {
+    rowEntry.DescriptionDisplay = value.toString();
+    }
+  else if (index.column() == ctkErrorLogAbstractModel::DescriptionColumn
+           && role == ctkErrorLogAbstractModel::DescriptionTextRole)
+    {
+    // The display text is independent from the full text once set
+    if (rowEntry.DescriptionDisplay.isNull())
+      {
+      rowEntry.DescriptionDisplay = this->data(index, Qt::DisplayRole).toString();
+      }
+    rowEntry.Columns[ctkErrorLogAbstractModel::DescriptionColumn] = value.toString();
+    }
+  else if (role == Qt::DisplayRole || role == Qt::EditRole)
+    {
+    rowEntry.Columns[index.column()] = value.toString();
+    }
+  else
+    {
+    return false;
+    }
+  emit this->dataChanged(index, index);
+  return true;
+}
+
+// --------------------------------------------------------------------------
+Qt::ItemFlags ctkErrorLogItemModel::flags(const QModelIndex& index)const
+{
+  if (!index.isValid())
+    {
+    return Qt::NoItemFlags;
+    }
+  return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+// --------------------------------------------------------------------------
+bool ctkErrorLogItemModel::removeRows(int row, int count, const QModelIndex& parent)
+{
+  if (parent.isValid() || row < 0 || count <= 0 || row + count > this->Count)
+    {
+    return false;
+    }
+  this->beginRemoveRows(parent, row, row + count - 1);
+  if (count == this->Count)
+    {
+    this->Entries.clear();
+    this->First = 0;
+    this->Count = 0;
+    }
+  else
+    {
+    this->linearize();
+    this->Entries.remove(row, count);
+    this->Count -= count;
+    }
+  this->endRemoveRows();
+  return true;
+}
 
 // --------------------------------------------------------------------------
 // ctkErrorLogModelPrivate
@@ -37,6 +305,8 @@ protected:
 public:
   ctkErrorLogModelPrivate(ctkErrorLogModel& object);
   ~ctkErrorLogModelPrivate();
+
+  ctkErrorLogItemModel* itemModel()const;
 };
 
 // --------------------------------------------------------------------------
@@ -53,17 +323,23 @@ ctkErrorLogModelPrivate::~ctkErrorLogModelPrivate()
 {
 }
 
+// --------------------------------------------------------------------------
+ctkErrorLogItemModel* ctkErrorLogModelPrivate::itemModel()const
+{
+  Q_Q(const ctkErrorLogModel);
+  ctkErrorLogItemModel* itemModel = static_cast<ctkErrorLogItemModel*>(q->sourceModel());
+  Q_ASSERT(itemModel);
+  return itemModel;
+}
+
 // --------------------------------------------------------------------------
 // ctkErrorLogModel methods
 
 //------------------------------------------------------------------------------
 ctkErrorLogModel::ctkErrorLogModel(QObject * parentObject)
-  : Superclass(new QStandardItemModel(), parentObject)
+  : Superclass(new ctkErrorLogItemModel(), parentObject)
   , d_ptr(new ctkErrorLogModelPrivate(*this))
 {
-  QStandardItemModel* itemModel = qobject_cast<QStandardItemModel*>(this->sourceModel());
-  Q_ASSERT(itemModel);
-  itemModel->setColumnCount(ctkErrorLogAbstractModel::MaxColumn);
 }
 
 //------------------------------------------------------------------------------
@@ -71,42 +347,31 @@ ctkErrorLogModel::~ctkErrorLogModel()
 {
 }
 
+//------------------------------------------------------------------------------
+int ctkErrorLogModel::maximumEntryCount()const
+{
+  Q_D(const ctkErrorLogModel);
+  return d->itemModel()->maximumEntryCount();
+}
+
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::setMaximumEntryCount(int count)
+{
+  Q_D(ctkErrorLogModel);
+  d->itemModel()->setMaximumEntryCount(count);
+}
+
 //------------------------------------------------------------------------------
 void ctkErrorLogModel::addModelEntry(const QString& currentDateTime, const QString& threadId,
                                      const QString& logLevel, const QString& origin, const QString& text)
 {
-  QList<QStandardItem*> itemList;
-
-  // Time item
-  QStandardItem * timeItem = new QStandardItem(currentDateTime);
-  timeItem->setEditable(false);
-  itemList << timeItem;
-
-  // ThreadId item
-  QStandardItem * threadIdItem = new QStandardItem(threadId);
-  threadIdItem->setEditable(false);
-  itemList << threadIdItem;
-
-  // LogLevel item
-  QStandardItem * logLevelItem = new QStandardItem(logLevel);
-  logLevelItem->setEditable(false);
-  itemList << logLevelItem;
-
-  // Origin item
-  QStandardItem * originItem = new QStandardItem(origin);
-  originItem->setEditable(false);
-  itemList << originItem;
-
-  // Description item
-  QStandardItem * descriptionItem = new QStandardItem();
-  QString descriptionText(text);
-  descriptionItem->setData(descriptionText.left(160).append((descriptionText.size() > 160) ? "..." : ""), Qt::DisplayRole);
-  descriptionItem->setData(descriptionText, ctkErrorLogModel::DescriptionTextRole);
-  descriptionItem->setEditable(false);
-  itemList << descriptionItem;
-
-  QStandardItemModel* itemModel = qobject_cast<QStandardItemModel*>(this->sourceModel());
-  Q_ASSERT(itemModel);
-  itemModel->invisibleRootItem()->appendRow(itemList);
+  this->addModelEntries(QList<QStringList>()
+                        << (QStringList() << currentDateTime << threadId << logLevel << origin << text));
 }
 
+//------------------------------------------------------------------------------
+void ctkErrorLogModel::addModelEntries(const QList<QStringList>& entries)
+{
+  Q_D(ctkErrorLogModel);
+  d->itemModel()->addEntries(entries);
+}
@@ -30,20 +30,29 @@ class ctkErrorLogModelPrivate;
 
 //------------------------------------------------------------------------------
 /// \ingroup Widgets
+/// Error log model storing its entries in a compact ring buffer.
+/// When \a maximumEntryCount is set, the oldest entries are removed
+/// as new ones are added beyond that count.
 class CTK_WIDGETS_EXPORT ctkErrorLogModel : public ctkErrorLogAbstractModel
 {
   Q_OBJECT
+  Q_PROPERTY(int maximumEntryCount READ maximumEntryCount WRITE setMaximumEntryCount)
 public:
   typedef ctkErrorLogAbstractModel Superclass;
   typedef ctkErrorLogModel Self;
   explicit ctkErrorLogModel(QObject* parentObject = 0);
   virtual ~ctkErrorLogModel();
 
+  /// Maximum number of entries kept in the model. 0 (default) means no limit.
+  int maximumEntryCount()const;
+  void setMaximumEntryCount(int count);
+
 protected:
   QScopedPointer<ctkErrorLogModelPrivate> d_ptr;
 
   virtual void addModelEntry(const QString& currentDateTime, const QString& threadId,
                              const QString& logLevel, const QString& origin, const QString& text);
+  virtual void addModelEntries(const QList<QStringList>& entries);
 
 private:
   Q_DECLARE_PRIVATE(ctkErrorLogModel)
@@ -35,6 +35,7 @@
 #include <QColor>
 #include <QTextEdit>
 #include <QDialog>
+#include <QCache>
 
 #include <cmath>
 
@@ -74,6 +75,34 @@ public:
 
   QList< QImage > ImageList;
 
+  /// 16-bit slices, at the same index as a null image in ImageList.
+  /// Empty for the slices added as a QImage.
+  struct RawSlice
+    {
+    RawSlice() : Width( 0 ), Height( 0 ) {}
+    QVector< quint16 > Pixels;
+    int Width;
+    int Height;
+    };
+  QList< RawSlice > RawImageList;
+
+  /// Window/level lookup table of the 16-bit slices, recomputed only when
+  /// the window, the level or the inversion changes.
+  QVector< QRgb > LookupTable;
+  double LookupTableWindow;
+  double LookupTableLevel;
+  bool   LookupTableInvert;
+  int    LookupTableId;
+  QImage RenderBuffer;
+
+  /// Converted pixmap of a slice with the lookup table it was rendered with
+  struct CachedPixmap
+    {
+    QPixmap Pixmap;
+    int LookupTableId;
+    };
+  QCache< int, CachedPixmap > PixmapCache;
+
   QPixmap TmpImage;
   int     TmpXMin;
   int     TmpXMax;
@@ -94,6 +123,14 @@ public:
   double clamp( double x, double xMin, double xMax );
 
   void fitImageRectangle( double x0, double y0, double x1, double y1 );
+
+  bool isRawSlice( int slice ) const;
+  bool isGrayscaleSlice( int slice ) const;
+  QSize sliceSize( int slice ) const;
+
+  void updateLookupTable();
+  void renderRawSlice( const RawSlice & slice );
+  QPixmap slicePixmap( int slice );
   
 };
 
@@ -138,6 +175,14 @@ void ctkQImageViewPrivate::init()
   this->TransposeXY = false;
 
   this->ImageList.clear();
+  this->RawImageList.clear();
+
+  this->LookupTableWindow = 0;
+  this->LookupTableLevel = 0;
+  this->LookupTableInvert = false;
+  this->LookupTableId = 0;
+  // Cost of the cached pixmaps in kilobytes
+  this->PixmapCache.setMaxCost( 64 * 1024 );
 
   this->TmpXMin = 0;
   this->TmpXMax = 0;
@@ -177,16 +222,128 @@ void ctkQImageViewPrivate::fitImageRectangle( double x0,
   if( this->SliceNumber >= 0 && this->SliceNumber < this->ImageList.size() )
     {
     this->TmpXMin = this->clamp( x0, 0,
-      this->ImageList[ this->SliceNumber ].width() );
+      this->sliceSize( this->SliceNumber ).width() );
     this->TmpXMax = this->clamp( x1, this->TmpXMin,
-      this->ImageList[ this->SliceNumber ].width() );
+      this->sliceSize( this->SliceNumber ).width() );
     this->TmpYMin = this->clamp( y0, 0,
-      this->ImageList[ this->SliceNumber ].height() );
+      this->sliceSize( this->SliceNumber ).height() );
     this->TmpYMax = this->clamp( y1, this->TmpYMin,
-      this->ImageList[ this->SliceNumber ].height() );
+      this->sliceSize( this->SliceNumber ).height() );
+    }
+}
+
+//--------------------------------------------------------------------------
+bool ctkQImageViewPrivate::isRawSlice( int slice ) const
+{
+  return slice >= 0 && slice < this->RawImageList.size()
+    && !this->RawImageList[ slice ].Pixels.isEmpty();
+}
+
+//--------------------------------------------------------------------------
+bool ctkQImageViewPrivate::isGrayscaleSlice( int slice ) const
+{
+  return this->isRawSlice( slice ) || this->ImageList[ slice ].isGrayscale();
+}
+
+//--------------------------------------------------------------------------
+QSize ctkQImageViewPrivate::sliceSize( int slice ) const
+{
+  if( this->isRawSlice( slice ) )
+    {
+    return QSize( this->RawImageList[ slice ].Width,
+      this->RawImageList[ slice ].Height );
+    }
+  return this->ImageList[ slice ].size();
+}
+
+//--------------------------------------------------------------------------
+void ctkQImageViewPrivate::updateLookupTable()
+{
+  if( !this->LookupTable.isEmpty()
+    && this->LookupTableWindow == this->IntensityWindow
+    && this->LookupTableLevel == this->IntensityLevel
+    && this->LookupTableInvert == this->InvertImage )
+    {
+    return;
+    }
+  this->LookupTableWindow = this->IntensityWindow;
+  this->LookupTableLevel = this->IntensityLevel;
+  this->LookupTableInvert = this->InvertImage;
+  ++this->LookupTableId;
+
+  double window = qMax( this->IntensityWindow, 1.0 );
+  double lower = this->IntensityLevel - window / 2.0;
+  double scale = 255.0 / window;
+  this->LookupTable.resize( 65536 );
+  QRgb * lut = this->LookupTable.data();
+  for( int i = 0; i < 65536; ++i )
+    {
+    int gray = static_cast<int>(
+      qBound( 0.0, ( i - lower ) * scale + 0.5, 255.0 ) );
+    if( this->InvertImage )
+      {
+      gray = 255 - gray;
+      }
+    lut[ i ] = qRgb( gray, gray, gray );
     }
 }
 
+//--------------------------------------------------------------------------
+void ctkQImageViewPrivate::renderRawSlice( const RawSlice & slice )
+{
+  if( this->RenderBuffer.width() != slice.Width
+    || this->RenderBuffer.height() != slice.Height )
+    {
+    this->RenderBuffer = QImage( slice.Width, slice.Height,
+      QImage::Format_RGB32 );
+    }
+  // One table lookup per pixel, without any branch or conversion
+  const QRgb * lut = this->LookupTable.constData();
+  const quint16 * in = slice.Pixels.constData();
+  for( int y = 0; y < slice.Height; ++y )
+    {
+    QRgb * out = reinterpret_cast< QRgb * >( this->RenderBuffer.scanLine( y ) );
+    for( int x = 0; x < slice.Width; ++x )
+      {
+      out[ x ] = lut[ in[ x ] ];
+      }
+    in += slice.Width;
+    }
+}
+
+//--------------------------------------------------------------------------
+QPixmap ctkQImageViewPrivate::slicePixmap( int slice )
+{
+  bool raw = this->isRawSlice( slice );
+  if( raw )
+    {
+    this->updateLookupTable();
+    }
+  CachedPixmap * cached = this->PixmapCache.object( slice );
+  if( cached && ( !raw || cached->LookupTableId == this->LookupTableId ) )
+    {
+    return cached->Pixmap;
+    }
+
+  QPixmap pixmap;
+  if( raw )
+    {
+    this->renderRawSlice( this->RawImageList[ slice ] );
+    pixmap = QPixmap::fromImage( this->RenderBuffer );
+    }
+  else
+    {
+    pixmap = QPixmap::fromImage( this->ImageList[ slice ] );
+    }
+  cached = new CachedPixmap;
+  cached->Pixmap = pixmap;
+  cached->LookupTableId = this->LookupTableId;
+  int cost = qMax( 1, static_cast<int>( static_cast<qint64>( pixmap.width() )
+    * pixmap.height() * pixmap.depth() / 8 / 1024 ) );
+  this->PixmapCache.insert( slice, cached, cost );
+  return pixmap;
+}
+
 
 // -------------------------------------------------------------------------
 ctkQImageView::ctkQImageView( QWidget* _parent )
@@ -219,6 +376,7 @@ void ctkQImageView::addImage( const QImage & image )
 {
   Q_D( ctkQImageView );
   d->ImageList.push_back( image );
+  d->RawImageList.push_back( ctkQImageViewPrivate::RawSlice() );
   d->TmpXMin = 0;
   d->TmpXMax = image.width();
   d->TmpYMin = 0;
@@ -239,14 +397,69 @@ void ctkQImageView::clearImages( void )
 {
   Q_D( ctkQImageView );
   d->ImageList.clear();
+  d->RawImageList.clear();
+  d->PixmapCache.clear();
   this->update( true, true );
 }
 
+// -------------------------------------------------------------------------
+void ctkQImageView::addImage( const QVector< quint16 > & pixels, int width,
+  int height )
+{
+  Q_D( ctkQImageView );
+  if( width <= 0 || height <= 0 || pixels.size() != width * height )
+    {
+    qWarning() << "ctkQImageView::addImage: expected" << width << "x"
+      << height << "pixels, got" << pixels.size();
+    return;
+    }
+  ctkQImageViewPrivate::RawSlice slice;
+  slice.Pixels = pixels;
+  slice.Width = width;
+  slice.Height = height;
+  d->ImageList.push_back( QImage() );
+  d->RawImageList.push_back( slice );
+
+  quint16 minValue = pixels[ 0 ];
+  quint16 maxValue = pixels[ 0 ];
+  for( int i = 1; i < pixels.size(); ++i )
+    {
+    minValue = qMin( minValue, pixels[ i ] );
+    maxValue = qMax( maxValue, pixels[ i ] );
+    }
+
+  d->TmpXMin = 0;
+  d->TmpXMax = width;
+  d->TmpYMin = 0;
+  d->TmpYMax = height;
+  d->IntensityMin = minValue;
+  d->IntensityMax = maxValue;
+  this->setIntensityWindowLevel( qMax( maxValue - minValue, 1 ),
+    ( minValue + maxValue ) / 2.0 );
+  this->update( true, false );
+  this->setCenter( width / 2.0, height / 2.0 );
+}
+
+// -------------------------------------------------------------------------
+void ctkQImageView::setPixmapCacheLimit( int kbytes )
+{
+  Q_D( ctkQImageView );
+  d->PixmapCache.setMaxCost( kbytes );
+}
+
+// -------------------------------------------------------------------------
+int ctkQImageView::pixmapCacheLimit( void ) const
+{
+  Q_D( const ctkQImageView );
+  return d->PixmapCache.maxCost();
+}
+
 // -------------------------------------------------------------------------
 double ctkQImageView::xSpacing( void )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size()
+    && !d->isRawSlice( d->SliceNumber ) )
     {
     return( 1000.0 / d->ImageList[ d->SliceNumber ].dotsPerMeterX() );
     }
@@ -260,7 +473,8 @@ double ctkQImageView::xSpacing( void )
 double ctkQImageView::ySpacing( void )
 {
   Q_D( ctkQImageView );
-  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
+  if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size()
+    && !d->isRawSlice( d->SliceNumber ) )
     {
     return( 1000.0 / d->ImageList[ d->SliceNumber ].dotsPerMeterY() );
     }
@@ -307,6 +521,18 @@ double ctkQImageView::slicePosition( void )
 double ctkQImageView::positionValue( void )
 {
   Q_D( ctkQImageView );
+  if( d->isRawSlice( d->SliceNumber ) )
+    {
+    const ctkQImageViewPrivate::RawSlice & slice =
+      d->RawImageList[ d->SliceNumber ];
+    int x = static_cast<int>( d->PositionX );
+    int y = static_cast<int>( d->PositionY );
+    if( x < 0 || y < 0 || x >= slice.Width || y >= slice.Height )
+      {
+      return 0;
+      }
+    return slice.Pixels[ y * slice.Width + x ];
+    }
   if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
     {
     QColor vc( d->ImageList[ d->SliceNumber ].pixel( d->PositionX,
@@ -475,14 +701,14 @@ void ctkQImageView::setCenter( double x, double y )
   if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
     {
 	  int tmpXRange = d->TmpXMax - d->TmpXMin;
-    if( tmpXRange > d->ImageList[ d->SliceNumber ].width() )
+    if( tmpXRange > d->sliceSize( d->SliceNumber ).width() )
       {
-      tmpXRange = d->ImageList[ d->SliceNumber ].width();
+      tmpXRange = d->sliceSize( d->SliceNumber ).width();
       }
     int tmpYRange = d->TmpYMax - d->TmpYMin;
-    if( tmpYRange > d->ImageList[ d->SliceNumber ].height() )
+    if( tmpYRange > d->sliceSize( d->SliceNumber ).height() )
       {
-      tmpYRange = d->ImageList[ d->SliceNumber ].height();
+      tmpYRange = d->sliceSize( d->SliceNumber ).height();
       }
   
     int xMin2 = static_cast<int>(x) - tmpXRange/2.0;
@@ -491,9 +717,9 @@ void ctkQImageView::setCenter( double x, double y )
       xMin2 = 0;
       }
     int xMax2 = xMin2 + tmpXRange;
-    if( xMax2 > d->ImageList[ d->SliceNumber ].width() )
+    if( xMax2 > d->sliceSize( d->SliceNumber ).width() )
       {
-      xMax2 = d->ImageList[ d->SliceNumber ].width();
+      xMax2 = d->sliceSize( d->SliceNumber ).width();
       xMin2 = xMax2 - tmpXRange;
       }
     int yMin2 = static_cast<int>(y) - tmpYRange/2.0;
@@ -502,9 +728,9 @@ void ctkQImageView::setCenter( double x, double y )
       yMin2 = 0;
       }
     int yMax2 = yMin2 + tmpYRange;
-    if( yMax2 > d->ImageList[ d->SliceNumber ].height() )
+    if( yMax2 > d->sliceSize( d->SliceNumber ).height() )
       {
-      yMax2 = d->ImageList[ d->SliceNumber ].height();
+      yMax2 = d->sliceSize( d->SliceNumber ).height();
       yMin2 = yMax2 - tmpYRange;
       }
     d->fitImageRectangle( xMin2, xMax2, yMin2, yMax2 );
@@ -524,8 +750,8 @@ void ctkQImageView::setPosition( double x, double y )
 {
   Q_D( ctkQImageView );
   if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() 
-    && x >= 0 && y >= 0 && x < d->ImageList[ d->SliceNumber ].width()
-    && y < d->ImageList[ d->SliceNumber ].height() )
+    && x >= 0 && y >= 0 && x < d->sliceSize( d->SliceNumber ).width()
+    && y < d->sliceSize( d->SliceNumber ).height() )
     {
     d->PositionX = x;
     d->PositionY = y;
@@ -555,21 +781,21 @@ void ctkQImageView::setZoom( double factor )
   Q_D( ctkQImageView );
   if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
     {
-    const QImage * img = & d->ImageList[ d->SliceNumber ];
-    if( factor < 2.0 / img->width() )
+    const QSize img = d->sliceSize( d->SliceNumber );
+    if( factor < 2.0 / img.width() )
       {
-      factor = 2.0 / img->width();
+      factor = 2.0 / img.width();
       }
-    if( factor > img->width()/2.0 )
+    if( factor > img.width()/2.0 )
       {
-      factor = img->width()/2.0;
+      factor = img.width()/2.0;
       }
     d->Zoom = factor;
 
     double cx = d->CenterX;
     double cy = d->CenterY;
-    double x2 = img->width() / factor;
-    double y2 = img->height() / factor;
+    double x2 = img.width() / factor;
+    double y2 = img.height() / factor;
 	  
     int xMin2 = static_cast<int>(cx) - x2 / 2.0;
     if( xMin2 < 0 )
@@ -577,9 +803,9 @@ void ctkQImageView::setZoom( double factor )
       xMin2 = 0;
       }
     int xMax2 = xMin2 + x2;
-    if( xMax2 > d->ImageList[ d->SliceNumber ].width() )
+    if( xMax2 > d->sliceSize( d->SliceNumber ).width() )
       {
-      xMax2 = d->ImageList[ d->SliceNumber ].width();
+      xMax2 = d->sliceSize( d->SliceNumber ).width();
       xMin2 = xMax2 - x2;
       }
     int yMin2 = static_cast<int>(cy) - y2 / 2.0;
@@ -588,9 +814,9 @@ void ctkQImageView::setZoom( double factor )
       yMin2 = 0;
       }
     int yMax2 = yMin2 + y2;
-    if( yMax2 > d->ImageList[ d->SliceNumber ].height() )
+    if( yMax2 > d->sliceSize( d->SliceNumber ).height() )
       {
-      yMax2 = d->ImageList[ d->SliceNumber ].height();
+      yMax2 = d->sliceSize( d->SliceNumber ).height();
       yMin2 = yMax2 - y2;
       }
     d->fitImageRectangle( xMin2, xMax2, yMin2, yMax2 );
@@ -616,8 +842,8 @@ void ctkQImageView::reset( )
 
   if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
     {
-    this->setCenter( d->ImageList[ d->SliceNumber ].width()/2,
-      d->ImageList[ d->SliceNumber ].height()/2 );
+    this->setCenter( d->sliceSize( d->SliceNumber ).width()/2,
+      d->sliceSize( d->SliceNumber ).height()/2 );
     }
 }
 
@@ -894,7 +1120,7 @@ void ctkQImageView::update( bool zoomChanged,
   Q_D( ctkQImageView );
   if( d->SliceNumber >= 0 && d->SliceNumber < d->ImageList.size() )
     {
-    const QImage * img = & ( d->ImageList[ d->SliceNumber ] );
+    const QSize img = d->sliceSize( d->SliceNumber );
     if( zoomChanged || sizeChanged )
       {
       if( this->width() > 0 &&  this->height() > 0 
@@ -908,7 +1134,7 @@ void ctkQImageView::update( bool zoomChanged,
         if( screenAspectRatio > tmpAspectRatio )
           {
           int extraTmpYAbove = d->TmpYMin;
-          int extraTmpYBelow = img->height() - d->TmpYMax;
+          int extraTmpYBelow = img.height() - d->TmpYMax;
           int extraTmpYNeeded = tmpXRange * screenAspectRatio 
             - tmpYRange;
           int minExtra = extraTmpYAbove;
@@ -932,14 +1158,14 @@ void ctkQImageView::update( bool zoomChanged,
               }
             else
               {
-              d->TmpYMax = img->height();
+              d->TmpYMax = img.height();
               d->TmpYMin -= extraTmpYNeeded - extraTmpYBelow;
               }
             }
           else
             {
             d->TmpYMin = 0;
-            d->TmpYMax = img->height();
+            d->TmpYMax = img.height();
             }
           d->TmpImage = QPixmap( this->width(),
             static_cast<unsigned int>( 
@@ -950,7 +1176,7 @@ void ctkQImageView::update( bool zoomChanged,
         else if(screenAspectRatio < tmpAspectRatio)
           {
           int extraTmpXLeft = d->TmpXMin;
-          int extraTmpXRight = img->width() - d->TmpXMax;
+          int extraTmpXRight = img.width() - d->TmpXMax;
           int extraTmpXNeeded = static_cast<double>(tmpYRange) 
             / screenAspectRatio - tmpXRange;
           int minExtra = extraTmpXLeft;
@@ -974,14 +1200,14 @@ void ctkQImageView::update( bool zoomChanged,
               }
             else
               {
-              d->TmpXMax = img->width();
+              d->TmpXMax = img.width();
               d->TmpXMin -= extraTmpXNeeded - extraTmpXRight;
               }
             }
            else
             {
             d->TmpXMin = 0;
-            d->TmpXMax = img->width();
+            d->TmpXMax = img.width();
             }
           d->TmpImage = QPixmap( static_cast<unsigned int>( this->height()
             / ( static_cast<double>(d->TmpYMax - d->TmpYMin) 
@@ -998,30 +1224,25 @@ void ctkQImageView::update( bool zoomChanged,
     if( d->TmpImage.width() > 0 &&  d->TmpImage.height() > 0)
       {
       QRectF target( 0, 0, d->TmpImage.width(), d->TmpImage.height() );
-      double sourceX = d->TmpXMin;
-      double sourceY = d->TmpYMin;
-      double sourceW = d->TmpXMax - d->TmpXMin;
-      double sourceH = d->TmpYMax - d->TmpYMin;
+      QRectF source( d->TmpXMin, d->TmpYMin,
+        d->TmpXMax - d->TmpXMin, d->TmpYMax - d->TmpYMin );
       QPainter painter( &(d->TmpImage) );
-      QImage tmpI = *img;
-      if( d->InvertImage )
+      // Flip the target instead of mirroring a copy of the image
+      if( d->FlipXAxis || d->FlipYAxis )
         {
-        tmpI.invertPixels();
+        painter.translate( d->FlipXAxis ? target.width() : 0,
+          d->FlipYAxis ? target.height() : 0 );
+        painter.scale( d->FlipXAxis ? -1 : 1, d->FlipYAxis ? -1 : 1 );
         }
-      if( d->FlipXAxis || d->FlipYAxis )
+      painter.drawPixmap( target, d->slicePixmap( d->SliceNumber ), source );
+      painter.resetTransform();
+      // The lookup table of the 16-bit slices already inverts the intensities
+      if( d->InvertImage && !d->isRawSlice( d->SliceNumber ) )
         {
-        tmpI = tmpI.mirrored( d->FlipXAxis, d->FlipYAxis );
-        if( d->FlipXAxis )
-          {
-          sourceX = tmpI.width() - (d->TmpXMax - d->TmpXMin) - d->TmpXMin;
-          }
-        if( d->FlipYAxis )
-          {
-          sourceY = tmpI.height() - (d->TmpYMax - d->TmpYMin) - d->TmpYMin;
-          }
+        painter.setCompositionMode( QPainter::CompositionMode_Difference );
+        painter.fillRect( target, Qt::white );
+        painter.setCompositionMode( QPainter::CompositionMode_SourceOver );
         }
-      QRectF source( sourceX, sourceY, sourceW, sourceH );
-      painter.drawPixmap( target, QPixmap::fromImage( tmpI ), source );
 
       //if( ! sizeChanged )
         {
@@ -1047,7 +1268,7 @@ void ctkQImageView::update( bool zoomChanged,
           QRectF spaceBound = painter.boundingRect( pointRect, textFlags,
             "X" );
     
-          if( img->isGrayscale() )
+          if( d->isGrayscaleSlice( d->SliceNumber ) )
             {
             QString intString = tr("Intensity Range = %1 .. %2").arg(
               QString::number( d->IntensityMin, 'f', 3 ),
@@ -1088,8 +1309,8 @@ void ctkQImageView::update( bool zoomChanged,
             &spacingBound );
     
           QString dimString = tr("Size = %1, %2, %3")
-            .arg(QString::number( d->ImageList[ d->SliceNumber ].width()))
-            .arg(QString::number(d->ImageList[d->SliceNumber].height()))
+            .arg(QString::number( d->sliceSize( d->SliceNumber ).width()))
+            .arg(QString::number(d->sliceSize( d->SliceNumber ).height()))
             .arg(QString::number(d->ImageList.size()));
           QRectF dimBound = painter.boundingRect( pointRect, textFlags,
             dimString );
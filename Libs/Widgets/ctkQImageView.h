@@ -24,6 +24,7 @@
 /// Qt includes
 #include <QWidget>
 #include <QImage>
+#include <QVector>
 
 /// CTK includes
 #include "ctkPimpl.h"
@@ -77,6 +78,18 @@ public:
 
   double zoom( void );
 
+  /// Add a 16-bit grayscale slice of \a width x \a height pixels, stored
+  /// row by row. The pixels are kept as is (implicitly shared) and displayed
+  /// through the intensity window/level, which is set to the range of the
+  /// slice.
+  void addImage( const QVector< quint16 > & pixels, int width, int height );
+
+  /// Set the maximum size, in kilobytes, of the pixmaps cached for the
+  /// displayed slices. The pixmap of a 16-bit slice is rendered again when
+  /// the window, the level or the inversion changed. 65536 by default.
+  void setPixmapCacheLimit( int kbytes );
+  int pixmapCacheLimit( void ) const;
+
 public Q_SLOTS:
 
   void addImage( const QImage & image );
@@ -41,6 +41,9 @@ const QString ctkEAConfiguration::PROP_THREAD_POOL_SIZE = "org.commontk.eventadm
 const QString ctkEAConfiguration::PROP_TIMEOUT = "org.commontk.eventadmin.Timeout";
 const QString ctkEAConfiguration::PROP_REQUIRE_TOPIC = "org.commontk.eventadmin.RequireTopic";
 const QString ctkEAConfiguration::PROP_IGNORE_TIMEOUT = "org.commontk.eventadmin.IgnoreTimeout";
+const QString ctkEAConfiguration::PROP_TOPIC_INDEX = "org.commontk.eventadmin.TopicIndex";
+const QString ctkEAConfiguration::PROP_ASYNC_RING_BUFFER = "org.commontk.eventadmin.AsyncRingBuffer";
+const QString ctkEAConfiguration::PROP_ASYNC_QUEUE_SIZE = "org.commontk.eventadmin.AsyncQueueSize";
 const QString ctkEAConfiguration::PROP_LOG_LEVEL = "org.commontk.eventadmin.LogLevel";
 
 
@@ -124,6 +127,19 @@ void ctkEAConfiguration::configure(const ctkDictionary& config )
     // that handlers without a topic are receiving all events
     // (i.e., they are treated the same as with a topic=*).
     requireTopic = getBoolProperty(pluginContext->getProperty(PROP_REQUIRE_TOPIC), true);
+
+    // Are the handlers of an event looked up in an index of the handler topics? -
+    // The default is true. Setting this value to false will query the framework
+    // for the handlers of each event.
+    topicIndex = getBoolProperty(pluginContext->getProperty(PROP_TOPIC_INDEX), true);
+
+    // Are posted events queued per EventHandler? - The default is false:
+    // the events posted from a thread are delivered one after the other by
+    // a pooled thread. Setting this value to true queues them in a bounded
+    // ring buffer per handler of AsyncQueueSize events (1024 by default).
+    asyncRingBuffer = getBoolProperty(pluginContext->getProperty(PROP_ASYNC_RING_BUFFER), false);
+    asyncQueueSize = getIntProperty(PROP_ASYNC_QUEUE_SIZE,
+                                    pluginContext->getProperty(PROP_ASYNC_QUEUE_SIZE), 1024, 2);
     QVariant value = pluginContext->getProperty(PROP_IGNORE_TIMEOUT);
     if (value.isValid())
     {
@@ -144,6 +160,9 @@ void ctkEAConfiguration::configure(const ctkDictionary& config )
     threadPoolSize = getIntProperty(PROP_THREAD_POOL_SIZE, config.value(PROP_THREAD_POOL_SIZE), 20, 2);
     timeout = getIntProperty(PROP_TIMEOUT, config.value(PROP_TIMEOUT), 5000, INT_MIN);
     requireTopic = getBoolProperty(config.value(PROP_REQUIRE_TOPIC), true);
+    topicIndex = getBoolProperty(config.value(PROP_TOPIC_INDEX), true);
+    asyncRingBuffer = getBoolProperty(config.value(PROP_ASYNC_RING_BUFFER), false);
+    asyncQueueSize = getIntProperty(PROP_ASYNC_QUEUE_SIZE, config.value(PROP_ASYNC_QUEUE_SIZE), 1024, 2);
     ignoreTimeout.clear();
     QVariant value = config.value(PROP_IGNORE_TIMEOUT);
     if (value.canConvert<QStringList>())
@@ -222,6 +241,12 @@ void ctkEAConfiguration::startOrUpdate()
       << PROP_TIMEOUT << "=" << timeout;
   CTK_DEBUG(ctkEventAdminActivator::getLogService())
       << PROP_REQUIRE_TOPIC << "=" << requireTopic;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_TOPIC_INDEX << "=" << topicIndex;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_ASYNC_RING_BUFFER << "=" << asyncRingBuffer;
+  CTK_DEBUG(ctkEventAdminActivator::getLogService())
+      << PROP_ASYNC_QUEUE_SIZE << "=" << asyncQueueSize;
 
   ctkEventAdminService::TopicHandlerFiltersInterface* topicHandlerFilters =
       new ctkEventAdminService::TopicHandlerFilters(
@@ -260,12 +285,14 @@ void ctkEAConfiguration::startOrUpdate()
   // below (and not in this HandlerTasks object!)
   ctkEventAdminService::HandlerTasksInterface* handlerTasks =
       new ctkEventAdminService::BlacklistingHandlerTasks(
-        pluginContext, new ctkEventAdminService::BlackList(), topicHandlerFilters, filters);
+        pluginContext, new ctkEventAdminService::BlackList(), topicHandlerFilters, filters,
+        topicIndex ? new ctkEATopicHandlerIndex(pluginContext, requireTopic) : 0);
 
   if (admin == 0)
   {
     admin = new ctkEventAdminService(pluginContext, handlerTasks, sync_pool, async_pool,
-                                     timeout, ignoreTimeout);
+                                     timeout, ignoreTimeout,
+                                     asyncRingBuffer, asyncQueueSize);
 
     // Finally, adapt the outside events to our kind of events as per spec
     adaptEvents(admin);
@@ -280,7 +307,8 @@ void ctkEAConfiguration::startOrUpdate()
   }
   else
   {
-    admin->update(handlerTasks, timeout, ignoreTimeout);
+    admin->update(handlerTasks, timeout, ignoreTimeout,
+                  asyncRingBuffer, asyncQueueSize);
   }
 
 }
@@ -298,7 +326,8 @@ QObject* ctkEAConfiguration::tryToCreateMetaTypeProvider(ctkManagedService* mana
   try
   {
     return new ctkEAMetaTypeProvider(managedService, cacheSize, threadPoolSize,
-                                     timeout, requireTopic, ignoreTimeout);
+                                     timeout, requireTopic, ignoreTimeout, topicIndex,
+                                     asyncRingBuffer, asyncQueueSize);
   }
   catch (...)
   {
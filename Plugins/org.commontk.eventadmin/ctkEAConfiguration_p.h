@@ -89,6 +89,35 @@ class ctkEAAbstractAdapter;
  * pure optimization!
  * The value is a list of strings (separated by comma) which is assumed to define
  * exact class names.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.TopicIndex</tt> - Look up the
+ *          <tt>ctkEventHandler</tt>s of an event in a topic index?
+ * </p>
+ * The default is <tt>true</tt>: the event handlers are kept in a trie of their topics,
+ * updated as they come and go, and their event filters are parsed once. Setting this
+ * value to <tt>false</tt> queries the framework with an ldap-filter for each event.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.AsyncRingBuffer</tt> - Queue posted events
+ *          per <tt>ctkEventHandler</tt>?
+ * </p>
+ * The default is <tt>false</tt>: the events posted from a thread are delivered one
+ * after the other by a pooled thread. Setting this value to <tt>true</tt> queues the
+ * events in a lock-free ring buffer per event handler, drained in batches by worker
+ * threads. The events are still delivered to each handler in the order they were
+ * posted, and a slow handler does not delay the other ones.
+ * </p>
+ * <p>
+ * <p>
+ *      <tt>org.commontk.eventadmin.AsyncQueueSize</tt> - The capacity of the
+ *          queue of each <tt>ctkEventHandler</tt>.
+ * </p>
+ * The default value is 1024, rounded up to a power of two. Events posted while the
+ * queue of a handler is full are kept in a slower overflow list. A value of less
+ * then 2 triggers the default value.
  *
  * These properties are read at startup and serve as a default configuration.
  * If a configuration admin is configured, the event admin can be configured
@@ -109,6 +138,9 @@ public:
   static const QString PROP_TIMEOUT; // = "org.commontk.eventadmin.Timeout"
   static const QString PROP_REQUIRE_TOPIC; // = "org.commontk.eventadmin.RequireTopic"
   static const QString PROP_IGNORE_TIMEOUT; // = "org.commontk.eventadmin.IgnoreTimeout"
+  static const QString PROP_TOPIC_INDEX; // = "org.commontk.eventadmin.TopicIndex"
+  static const QString PROP_ASYNC_RING_BUFFER; // = "org.commontk.eventadmin.AsyncRingBuffer"
+  static const QString PROP_ASYNC_QUEUE_SIZE; // = "org.commontk.eventadmin.AsyncQueueSize"
   static const QString PROP_LOG_LEVEL; // = "org.commontk.eventadmin.LogLevel"
 
 private:
@@ -126,6 +158,12 @@ private:
 
   bool requireTopic;
 
+  bool topicIndex;
+
+  bool asyncRingBuffer;
+
+  int asyncQueueSize;
+
   QStringList ignoreTimeout;
 
   int logLevel;
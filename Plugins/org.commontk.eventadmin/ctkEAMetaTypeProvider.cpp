@@ -147,9 +147,12 @@ public:
 
 ctkEAMetaTypeProvider::ctkEAMetaTypeProvider(ctkManagedService* delegatee, int cacheSize,
                                              int threadPoolSize, int timeout, bool requireTopic,
-                                             const QStringList& ignoreTimeout)
+                                             const QStringList& ignoreTimeout, bool topicIndex,
+                                             bool asyncRingBuffer, int asyncQueueSize)
   : m_cacheSize(cacheSize), m_threadPoolSize(threadPoolSize), m_timeout(timeout),
-    m_requireTopic(requireTopic), m_ignoreTimeout(ignoreTimeout), m_delegatee(delegatee)
+    m_requireTopic(requireTopic), m_ignoreTimeout(ignoreTimeout), m_topicIndex(topicIndex),
+    m_asyncRingBuffer(asyncRingBuffer), m_asyncQueueSize(asyncQueueSize),
+    m_delegatee(delegatee)
 {
 }
 
@@ -218,6 +221,30 @@ ctkObjectClassDefinitionPtr ctkEAMetaTypeProvider::getObjectClassDefinition(cons
                                                    QVariant::String, m_ignoreTimeout, 0,
                                                    QStringList(QString::number(std::numeric_limits<int>::max())))));
 
+    adList.push_back(ctkAttributeDefinitionPtr(
+                       new AttributeDefinitionImpl(ctkEAConfiguration::PROP_TOPIC_INDEX, "Topic Index",
+                                                   "Are the event handlers of an event looked up in an index of their topics? "
+                                                   "This is enabled by default: the index is updated as event handlers come and "
+                                                   "go, and their event filters are parsed once. Disabling this setting queries "
+                                                   "the framework with an ldap-filter for each event.",
+                                                   QVariant::Bool, m_topicIndex ? QStringList("true") : QStringList("false"))));
+
+    adList.push_back(ctkAttributeDefinitionPtr(
+                       new AttributeDefinitionImpl(ctkEAConfiguration::PROP_ASYNC_RING_BUFFER, "Asynchronous Ring Buffer",
+                                                   "Are posted events queued per event handler? This is disabled by default: the "
+                                                   "events posted from a thread are delivered one after the other by a pooled thread. "
+                                                   "Enabling this setting queues the events in a lock-free ring buffer per event handler, "
+                                                   "drained in batches by worker threads, so that a slow handler does not delay the other ones.",
+                                                   QVariant::Bool, m_asyncRingBuffer ? QStringList("true") : QStringList("false"))));
+
+    adList.push_back(ctkAttributeDefinitionPtr(
+                       new AttributeDefinitionImpl(ctkEAConfiguration::PROP_ASYNC_QUEUE_SIZE, "Asynchronous Queue Size",
+                                                   "The capacity of the queue of each event handler if the asynchronous ring buffer is "
+                                                   "enabled. The default value is 1024, rounded up to a power of two. Events posted while "
+                                                   "the queue is full are kept in a slower overflow list. A value of less then 2 triggers "
+                                                   "the default value.",
+                                                   QVariant::Int, QStringList(QString::number(m_asyncQueueSize)))));
+
     ocd = ctkObjectClassDefinitionPtr(new ObjectClassDefinitionImpl(adList));
   }
 
@@ -42,6 +42,9 @@ private:
   const int m_timeout;
   const bool m_requireTopic;
   const QStringList m_ignoreTimeout;
+  const bool m_topicIndex;
+  const bool m_asyncRingBuffer;
+  const int m_asyncQueueSize;
 
   ctkManagedService* const m_delegatee;
 
@@ -54,7 +57,8 @@ public:
 
   ctkEAMetaTypeProvider(ctkManagedService* delegatee, int cacheSize,
                         int threadPoolSize, int timeout, bool requireTopic,
-                        const QStringList& ignoreTimeout);
+                        const QStringList& ignoreTimeout, bool topicIndex,
+                        bool asyncRingBuffer, int asyncQueueSize);
 
 
   /**
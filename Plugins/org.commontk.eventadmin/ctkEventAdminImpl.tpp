@@ -27,7 +27,8 @@ template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::ctkEventAdminImpl(
   HandlerTasksInterface* managers, ctkEADefaultThreadPool* syncPool,
   ctkEADefaultThreadPool* asyncPool, int timeout,
-  const QStringList& ignoreTimeout)
+  const QStringList& ignoreTimeout, bool asyncRingBuffer,
+  int asyncQueueSize)
   : managers(managers)
 {
   checkNull(managers, "Managers");
@@ -38,7 +39,8 @@ ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::ctkEventAdmi
                                      (timeout > 100 ? timeout : 0),
                                      ignoreTimeout);
 
-  postManager = new AsyncDeliverTasks(asyncPool, sendManager);
+  postManager = new AsyncDeliverTasks(asyncPool, sendManager,
+                                      asyncRingBuffer, asyncQueueSize);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
@@ -91,11 +93,19 @@ void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::stop()
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
 void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::update(HandlerTasksInterface* managers, int timeout,
-                               const QStringList& ignoreTimeout)
+                               const QStringList& ignoreTimeout,
+                               bool asyncRingBuffer, int asyncQueueSize)
 {
   HandlerTasksInterface* oldManagers = this->managers.fetchAndStoreOrdered(managers);
   delete oldManagers;
   this->sendManager->update(timeout, ignoreTimeout);
+  this->postManager->update(asyncRingBuffer, asyncQueueSize);
+}
+
+template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
+void ctkEventAdminImpl<HandlerTasks,SyncDeliverTasks,AsyncDeliverTasks>::handlerUnregistered(const ctkServiceReference& handlerRef)
+{
+  this->postManager->handlerUnregistered(handlerRef);
 }
 
 template<class HandlerTasks, class SyncDeliverTasks, class AsyncDeliverTasks>
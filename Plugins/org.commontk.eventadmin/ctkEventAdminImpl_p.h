@@ -58,7 +58,7 @@ private:
   QAtomicPointer<HandlerTasksInterface> managers;
 
   // The asynchronous event dispatcher
-  AsyncDeliverTaskInterface* postManager;
+  AsyncDeliverTasks* postManager;
 
   // The (interruptible) thread where sync events are handled
   ctkEASyncMasterThread syncMasterThread;
@@ -98,12 +98,16 @@ public:
    * @param managers The factory used to determine applicable <tt>ctkEventHandler</tt>
    * @param syncPool The synchronous thread pool
    * @param asyncPool The asynchronous thread pool
+   * @param asyncRingBuffer Whether posted events are queued per event handler
+   * @param asyncQueueSize The capacity of the queue of each event handler
    */
   ctkEventAdminImpl(HandlerTasksInterface* managers,
                     ctkEADefaultThreadPool* syncPool,
                     ctkEADefaultThreadPool* asyncPool,
                     int timeout,
-                    const QStringList& ignoreTimeout);
+                    const QStringList& ignoreTimeout,
+                    bool asyncRingBuffer,
+                    int asyncQueueSize);
 
   ~ctkEventAdminImpl();
 
@@ -144,7 +148,13 @@ public:
    * Update the event admin with new configuration.
    */
   void update(HandlerTasksInterface* managers, int timeout,
-              const QStringList& ignoreTimeout);
+              const QStringList& ignoreTimeout,
+              bool asyncRingBuffer, int asyncQueueSize);
+
+  /**
+   * Called when an event handler is unregistered.
+   */
+  void handlerUnregistered(const ctkServiceReference& handlerRef);
 
 private:
 
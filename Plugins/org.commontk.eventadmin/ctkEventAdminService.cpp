@@ -25,21 +25,36 @@
 #include "handler/ctkEASlotHandler_p.h"
 
 #include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkServiceEvent.h>
 
 ctkEventAdminService::ctkEventAdminService(ctkPluginContext* context,
                                            HandlerTasksInterface* managers,
                                            ctkEADefaultThreadPool* syncPool,
                                            ctkEADefaultThreadPool* asyncPool,
                                            int timeout,
-                                           const QStringList& ignoreTimeout)
-  : impl(managers, syncPool, asyncPool, timeout, ignoreTimeout),
+                                           const QStringList& ignoreTimeout,
+                                           bool asyncRingBuffer,
+                                           int asyncQueueSize)
+  : impl(managers, syncPool, asyncPool, timeout, ignoreTimeout,
+         asyncRingBuffer, asyncQueueSize),
     context(context)
 {
-
+  context->connectServiceListener(this, "serviceChanged",
+                                  QString("(") + ctkPluginConstants::OBJECTCLASS + "="
+                                  + qobject_interface_iid<ctkEventHandler*>() + ")");
 }
 
 ctkEventAdminService::~ctkEventAdminService()
 {
+  try
+  {
+    context->disconnectServiceListener(this, "serviceChanged");
+  }
+  catch (const ctkIllegalStateException&)
+  {
+    // the plugin context is no longer valid
+  }
   qDeleteAll(slotHandler);
   foreach(QList<ctkEASignalPublisher*> l, signalPublisher.values())
   {
@@ -197,8 +212,16 @@ void ctkEventAdminService::stop()
 }
 
 void ctkEventAdminService::update(HandlerTasksInterface* managers, int timeout,
-                                  const QStringList& ignoreTimeout)
+                                  const QStringList& ignoreTimeout,
+                                  bool asyncRingBuffer, int asyncQueueSize)
 {
-  impl.update(managers, timeout, ignoreTimeout);
+  impl.update(managers, timeout, ignoreTimeout, asyncRingBuffer, asyncQueueSize);
 }
 
+void ctkEventAdminService::serviceChanged(const ctkServiceEvent& event)
+{
+  if (event.getType() == ctkServiceEvent::UNREGISTERING)
+  {
+    impl.handlerUnregistered(event.getServiceReference());
+  }
+}
@@ -38,6 +38,7 @@
 #include "dispatch/ctkEASignalPublisher_p.h"
 
 class ctkEASlotHandler;
+class ctkServiceEvent;
 
 class ctkEventAdminService : public QObject, public ctkEventAdmin
 {
@@ -80,7 +81,9 @@ public:
                        ctkEADefaultThreadPool* syncPool,
                        ctkEADefaultThreadPool* asyncPool,
                        int timeout,
-                       const QStringList& ignoreTimeout);
+                       const QStringList& ignoreTimeout,
+                       bool asyncRingBuffer,
+                       int asyncQueueSize);
 
   ~ctkEventAdminService();
 
@@ -113,7 +116,15 @@ public:
    * Update the event admin with new configuration.
    */
   void update(HandlerTasksInterface* managers, int timeout,
-              const QStringList& ignoreTimeout);
+              const QStringList& ignoreTimeout,
+              bool asyncRingBuffer, int asyncQueueSize);
+
+private Q_SLOTS:
+
+  /**
+   * Releases the resources kept by the dispatch for unregistered event handlers.
+   */
+  void serviceChanged(const ctkServiceEvent& event);
 
 };
 
@@ -0,0 +1,162 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEARINGBUFFER_P_H
+#define CTKEARINGBUFFER_P_H
+
+#include <QAtomicInteger>
+
+#include <new>
+#include <type_traits>
+
+/**
+ * A bounded, lock-free queue for multiple producers and a single consumer.
+ * Each slot carries a sequence number telling whether it is free for the
+ * producer of a given position or filled for the consumer, so that producers
+ * only contend on the increment of the enqueue position.
+ *
+ * The capacity is rounded up to a power of two.
+ */
+template<class T>
+class ctkEARingBuffer
+{
+
+public:
+
+  ctkEARingBuffer(int capacity)
+  {
+    quint32 size = 2;
+    while (size < static_cast<quint32>(capacity))
+    {
+      size <<= 1;
+    }
+    mask = size - 1;
+    cells = new Cell[size];
+    for (quint32 i = 0; i < size; ++i)
+    {
+      cells[i].sequence.storeRelease(i);
+    }
+    enqueuePos.storeRelease(0);
+    dequeuePos = 0;
+  }
+
+  ~ctkEARingBuffer()
+  {
+    // destroy the values which were not taken
+    while (!isEmpty())
+    {
+      reinterpret_cast<T*>(&cells[dequeuePos & mask].storage)->~T();
+      ++dequeuePos;
+    }
+    delete[] cells;
+  }
+
+  int capacity() const
+  {
+    return static_cast<int>(mask + 1);
+  }
+
+  /**
+   * Add a value, from any thread.
+   *
+   * @return <code>false</code> if the buffer is full.
+   */
+  bool tryPush(const T& value)
+  {
+    quint32 pos = enqueuePos.loadAcquire();
+    for (;;)
+    {
+      Cell* cell = &cells[pos & mask];
+      const qint32 diff = static_cast<qint32>(cell->sequence.loadAcquire() - pos);
+      if (diff == 0)
+      {
+        if (enqueuePos.testAndSetRelaxed(pos, pos + 1, pos))
+        {
+          new (&cell->storage) T(value);
+          cell->sequence.storeRelease(pos + 1);
+          return true;
+        }
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = enqueuePos.loadAcquire();
+      }
+    }
+  }
+
+  /**
+   * Move the oldest value to the end of <code>values</code>, from the
+   * consumer thread only.
+   *
+   * @return <code>false</code> if the buffer is empty.
+   */
+  template<class Container>
+  bool tryPop(Container& values)
+  {
+    Cell* cell = &cells[dequeuePos & mask];
+    const qint32 diff = static_cast<qint32>(cell->sequence.loadAcquire() - (dequeuePos + 1));
+    if (diff < 0)
+    {
+      return false;
+    }
+    T* stored = reinterpret_cast<T*>(&cell->storage);
+    values.push_back(*stored);
+    stored->~T();
+    cell->sequence.storeRelease(dequeuePos + mask + 1);
+    ++dequeuePos;
+    return true;
+  }
+
+  /**
+   * Whether the buffer is empty, from the consumer thread only.
+   */
+  bool isEmpty() const
+  {
+    const Cell* cell = &cells[dequeuePos & mask];
+    return static_cast<qint32>(cell->sequence.loadAcquire() - (dequeuePos + 1)) < 0;
+  }
+
+private:
+
+  struct Cell
+  {
+    QAtomicInteger<quint32> sequence;
+    typename std::aligned_storage<sizeof(T), Q_ALIGNOF(T)>::type storage;
+  };
+
+  Cell* cells;
+  quint32 mask;
+
+  // Keep the producer and consumer positions on separate cache lines
+  char padding0[64];
+  QAtomicInteger<quint32> enqueuePos;
+  char padding1[64];
+  quint32 dequeuePos;
+
+  Q_DISABLE_COPY(ctkEARingBuffer)
+};
+
+#endif // CTKEARINGBUFFER_P_H
@@ -33,6 +33,7 @@
 #include "ctkEATopicHandlerFilters_p.h"
 #include "ctkEAFilters_p.h"
 #include "ctkEABlackList_p.h"
+#include "ctkEATopicHandlerIndex_p.h"
 
 /**
  * This class is an implementation of the ctkEAHandlerTasks interface that does provide
@@ -42,6 +43,10 @@
  * query for each sent event. In order to do this, an ldap-filter is created that
  * will match applicable <tt>ctkEventHandler</tt> references. In order to ease some of
  * the overhead pains of this approach some light caching is going on.
+ *
+ * Alternatively, if a <tt>ctkEATopicHandlerIndex</tt> is given, the handlers are
+ * looked up in the topic trie it maintains and their pre-parsed event filters are
+ * used instead.
  */
 template<class BlackList, class TopicHandlerFilters, class Filters>
 class ctkEABlacklistingHandlerTasks :
@@ -67,6 +72,10 @@ private:
   // event handler is interested in a particular event
   ctkEAFilters<Filters>* filters;
 
+  // Optional index of the event handlers by topic, replacing the query
+  // of the framework for each event
+  ctkEATopicHandlerIndex* topicHandlerIndex;
+
 public:
 
   /**
@@ -76,11 +85,14 @@ public:
    * @param blackList The set to use for keeping track of blacklisted references
    * @param topicHandlerFilters The factory for topic handler filters
    * @param filters The factory for <tt>ctkLDAPSearchFilter</tt> objects
+   * @param topicHandlerIndex The index of the event handlers by topic or 0
+   *        to query the framework for each event
    */
   ctkEABlacklistingHandlerTasks(ctkPluginContext* context,
                                 ctkEABlackList<BlackList>* blackList,
                                 ctkEATopicHandlerFilters<TopicHandlerFilters>* topicHandlerFilters,
-                                ctkEAFilters<Filters>* filters);
+                                ctkEAFilters<Filters>* filters,
+                                ctkEATopicHandlerIndex* topicHandlerIndex = 0);
 
   ~ctkEABlacklistingHandlerTasks();
 
@@ -158,6 +170,12 @@ private:
    * may not be null.
    */
   void checkNull(void* object, const QString& name);
+
+  /*
+   * Create the handler tasks for the event from the handlers found
+   * in the topic handler index.
+   */
+  QList<ctkEAHandlerTask<Self> > createIndexedHandlerTasks(const ctkEvent& event);
 };
 
 #include "ctkEABlacklistingHandlerTasks.tpp"
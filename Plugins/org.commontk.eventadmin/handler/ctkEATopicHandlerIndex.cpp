@@ -0,0 +1,263 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#include "ctkEATopicHandlerIndex_p.h"
+
+#include <ctkPluginConstants.h>
+#include <ctkPluginContext.h>
+#include <ctkServiceEvent.h>
+#include <service/event/ctkEventConstants.h>
+#include <service/event/ctkEventHandler.h>
+
+#include <QSet>
+
+namespace {
+
+// The segments of the node of a topic, "a/b/*" is indexed as a wildcard
+// of the node "a/b"
+QStringList topicSegments(const QString& topic, bool* isWildcard)
+{
+  *isWildcard = topic.endsWith("/*");
+  return (*isWildcard ? topic.left(topic.size() - 2) : topic).split('/');
+}
+
+}
+
+ctkEATopicHandlerIndex::ctkEATopicHandlerIndex(ctkPluginContext* context, bool requireTopic)
+  : context(context), requireTopic(requireTopic)
+{
+  // Connect first so that no registration is missed, handlers
+  // found twice are simply indexed again
+  context->connectServiceListener(this, "serviceChanged",
+                                  QString("(") + ctkPluginConstants::OBJECTCLASS + "="
+                                  + qobject_interface_iid<ctkEventHandler*>() + ")");
+
+  foreach (const ctkServiceReference& reference,
+           context->getServiceReferences<ctkEventHandler>())
+  {
+    addHandler(reference);
+  }
+}
+
+ctkEATopicHandlerIndex::~ctkEATopicHandlerIndex()
+{
+  try
+  {
+    context->disconnectServiceListener(this, "serviceChanged");
+  }
+  catch (const ctkIllegalStateException&)
+  {
+    // the plugin context is no longer valid
+  }
+}
+
+QList<ctkEATopicHandlerIndex::HandlerPtr> ctkEATopicHandlerIndex::getHandlers(const QString& topic) const
+{
+  QReadLocker l(&lock);
+
+  QList<HandlerPtr> result = root.wildcard;
+  if (!requireTopic)
+  {
+    result += noTopicHandlers;
+  }
+
+  const QStringList segments = topic.split('/');
+  const Node* node = &root;
+  for (int i = 0; i < segments.size(); ++i)
+  {
+    node = node->children.value(segments.at(i));
+    if (node == 0)
+    {
+      break;
+    }
+    result += (i == segments.size() - 1) ? node->exact : node->wildcard;
+  }
+
+  // A handler registered with several topics may match more than once
+  if (result.size() > 1)
+  {
+    QSet<const Handler*> seen;
+    QList<HandlerPtr>::iterator it = result.begin();
+    while (it != result.end())
+    {
+      if (seen.contains(it->data()))
+      {
+        it = result.erase(it);
+      }
+      else
+      {
+        seen.insert(it->data());
+        ++it;
+      }
+    }
+  }
+  return result;
+}
+
+void ctkEATopicHandlerIndex::serviceChanged(const ctkServiceEvent& event)
+{
+  const ctkServiceReference reference = event.getServiceReference();
+  const qlonglong serviceId = reference.getProperty(ctkPluginConstants::SERVICE_ID).toLongLong();
+
+  switch (event.getType())
+  {
+  case ctkServiceEvent::REGISTERED:
+  case ctkServiceEvent::MODIFIED:
+    addHandler(reference);
+    break;
+  case ctkServiceEvent::UNREGISTERING:
+  case ctkServiceEvent::MODIFIED_ENDMATCH:
+  {
+    QWriteLocker l(&lock);
+    removeHandler(serviceId);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void ctkEATopicHandlerIndex::addHandler(const ctkServiceReference& reference)
+{
+  Handler* handler = new Handler;
+  handler->reference = reference;
+
+  const QVariant topics = reference.getProperty(ctkEventConstants::EVENT_TOPIC);
+  if (topics.isValid())
+  {
+    handler->topics = topics.toStringList();
+  }
+
+  const QString filter = reference.getProperty(ctkEventConstants::EVENT_FILTER).toString();
+  if (!filter.isEmpty())
+  {
+    try
+    {
+      handler->filter = ctkLDAPSearchFilter(filter);
+    }
+    catch (const ctkInvalidArgumentException&)
+    {
+      // The handler is blacklisted when it is about to receive an event
+      handler->filterValid = false;
+    }
+  }
+
+  HandlerPtr handlerPtr(handler);
+  const qlonglong serviceId = reference.getProperty(ctkPluginConstants::SERVICE_ID).toLongLong();
+
+  QWriteLocker l(&lock);
+  removeHandler(serviceId);
+  handlers.insert(serviceId, handlerPtr);
+  if (handler->topics.isEmpty())
+  {
+    noTopicHandlers.push_back(handlerPtr);
+  }
+  foreach (const QString& topic, handler->topics)
+  {
+    handlerList(topic, true)->push_back(handlerPtr);
+  }
+}
+
+void ctkEATopicHandlerIndex::removeHandler(qlonglong serviceId)
+{
+  HandlerPtr handler = handlers.take(serviceId);
+  if (!handler)
+  {
+    return;
+  }
+  if (handler->topics.isEmpty())
+  {
+    noTopicHandlers.removeAll(handler);
+  }
+  foreach (const QString& topic, handler->topics)
+  {
+    if (QList<HandlerPtr>* list = handlerList(topic, false))
+    {
+      list->removeAll(handler);
+      pruneNodes(topic);
+    }
+  }
+}
+
+QList<ctkEATopicHandlerIndex::HandlerPtr>* ctkEATopicHandlerIndex::handlerList(const QString& topic,
+                                                                              bool create)
+{
+  if (topic == "*")
+  {
+    return &root.wildcard;
+  }
+
+  bool isWildcard = false;
+  const QStringList segments = topicSegments(topic, &isWildcard);
+
+  Node* node = &root;
+  foreach (const QString& segment, segments)
+  {
+    Node* child = node->children.value(segment);
+    if (child == 0)
+    {
+      if (!create)
+      {
+        return 0;
+      }
+      child = new Node;
+      node->children.insert(segment, child);
+    }
+    node = child;
+  }
+  return isWildcard ? &node->wildcard : &node->exact;
+}
+
+void ctkEATopicHandlerIndex::pruneNodes(const QString& topic)
+{
+  if (topic == "*")
+  {
+    return;
+  }
+
+  bool isWildcard = false;
+  const QStringList segments = topicSegments(topic, &isWildcard);
+
+  QList<Node*> path;
+  path.push_back(&root);
+  foreach (const QString& segment, segments)
+  {
+    Node* child = path.back()->children.value(segment);
+    if (child == 0)
+    {
+      return;
+    }
+    path.push_back(child);
+  }
+
+  // Walk back up the path, up to the first node still in use
+  for (int i = segments.size(); i > 0; --i)
+  {
+    Node* node = path.at(i);
+    if (!node->exact.isEmpty() || !node->wildcard.isEmpty() || !node->children.isEmpty())
+    {
+      break;
+    }
+    path.at(i - 1)->children.remove(segments.at(i - 1));
+    delete node;
+  }
+}
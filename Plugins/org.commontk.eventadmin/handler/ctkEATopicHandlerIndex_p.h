@@ -0,0 +1,135 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEATOPICHANDLERINDEX_P_H
+#define CTKEATOPICHANDLERINDEX_P_H
+
+#include <QHash>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <ctkLDAPSearchFilter.h>
+#include <ctkServiceReference.h>
+
+class ctkPluginContext;
+class ctkServiceEvent;
+
+/**
+ * This class keeps track of the registered <tt>ctkEventHandler</tt> services in a
+ * trie of their topics, so that the handlers of an event are found by walking the
+ * segments of the event topic instead of querying the service registry with an
+ * ldap-filter for each event. The <tt>EVENT_FILTER</tt> of each handler is parsed
+ * once when the handler is registered or modified.
+ *
+ * The index is kept up to date by a service listener, it is thread safe.
+ */
+class ctkEATopicHandlerIndex : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  /**
+   * An indexed event handler.
+   */
+  struct Handler
+  {
+    ctkServiceReference reference;
+
+    // The topics under which the handler is indexed
+    QStringList topics;
+
+    // The parsed EVENT_FILTER, null if the handler has no filter
+    ctkLDAPSearchFilter filter;
+
+    // false if the EVENT_FILTER could not be parsed
+    bool filterValid;
+
+    Handler() : filterValid(true) {}
+  };
+
+  typedef QSharedPointer<const Handler> HandlerPtr;
+
+  /**
+   * Creates the index and adds the currently registered event handlers.
+   *
+   * @param context The context of the plugin
+   * @param requireTopic Include handlers that do not provide a topic
+   */
+  ctkEATopicHandlerIndex(ctkPluginContext* context, bool requireTopic);
+
+  ~ctkEATopicHandlerIndex();
+
+  /**
+   * Get the handlers registered for a topic, i.e. the ones registered
+   * with the topic itself, with <tt>*</tt> or with a wildcard topic
+   * matching one of its parent topics.
+   *
+   * @param topic The topic of an event
+   * @return The matching handlers, each one once
+   */
+  QList<HandlerPtr> getHandlers(const QString& topic) const;
+
+private Q_SLOTS:
+
+  void serviceChanged(const ctkServiceEvent& event);
+
+private:
+
+  struct Node
+  {
+    QHash<QString, Node*> children;
+
+    // Handlers registered with the topic of this node
+    QList<HandlerPtr> exact;
+
+    // Handlers registered with the topic of this node followed by "/*"
+    QList<HandlerPtr> wildcard;
+
+    ~Node() { qDeleteAll(children); }
+  };
+
+  ctkPluginContext* const context;
+  const bool requireTopic;
+
+  mutable QReadWriteLock lock;
+
+  Node root;
+
+  // Handlers without topic, receiving all events if requireTopic is false
+  QList<HandlerPtr> noTopicHandlers;
+
+  // The indexed handlers by service id
+  QHash<qlonglong, HandlerPtr> handlers;
+
+  void addHandler(const ctkServiceReference& reference);
+  void removeHandler(qlonglong serviceId);
+
+  QList<HandlerPtr>* handlerList(const QString& topic, bool create);
+
+  // Delete the nodes of the topic path left without handlers and children
+  void pruneNodes(const QString& topic);
+};
+
+#endif // CTKEATOPICHANDLERINDEX_P_H
@@ -73,14 +73,23 @@ public:
 };
 
 template<class SyncDeliverTasks, class HandlerTask>
-ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask)
- : pool(pool), deliver_task(deliverTask)
+ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask,
+                                                                              bool ringBuffer, int queueSize)
+ : pool(pool), deliver_task(deliverTask),
+   ringBufferTasks(pool, static_cast<SyncDeliverTasks*>(deliverTask), queueSize, 64),
+   useRingBuffer(ringBuffer)
 {
 }
 
 template<class SyncDeliverTasks, class HandlerTask>
 void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::execute(const QList<HandlerTask>& tasks)
 {
+  if (useRingBuffer.loadAcquire())
+  {
+    ringBufferTasks.execute(tasks);
+    return;
+  }
+
   QThread* currentThread = QThread::currentThread();
   TaskExecuter* executer = 0;
   {
@@ -103,3 +112,16 @@ void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::execute(const QList<
   }
 }
 
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::update(bool ringBuffer, int queueSize)
+{
+  ringBufferTasks.setQueueSize(queueSize);
+  useRingBuffer.storeRelease(ringBuffer);
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEAAsyncDeliverTasks<SyncDeliverTasks, HandlerTask>::handlerUnregistered(const ctkServiceReference& handlerRef)
+{
+  ringBufferTasks.removeHandler(handlerRef);
+}
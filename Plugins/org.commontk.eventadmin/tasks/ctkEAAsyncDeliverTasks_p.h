@@ -24,12 +24,17 @@
 #define CTKEAASYNCDELIVERTASKS_P_H
 
 #include "ctkEADeliverTask_p.h"
+#include "ctkEARingBufferDeliverTasks_p.h"
 #include <dispatch/ctkEADefaultThreadPool_p.h>
 
 class ctkEARunnable;
 
 /**
  * This class does the actual work of the asynchronous event dispatch.
+ *
+ * By default, the events posted from a thread are delivered one after the
+ * other by a pooled thread. Alternatively, the events are queued per
+ * event handler in a ctkEARingBufferDeliverTasks.
  */
 template<class SyncDeliverTasks, class HandlerTask>
 class ctkEAAsyncDeliverTasks : public ctkEADeliverTask<ctkEAAsyncDeliverTasks<SyncDeliverTasks,HandlerTask>, HandlerTask>
@@ -52,6 +57,10 @@ private:
   QHash<QThread*, ctkEARunnable*> running_threads;
   QMutex running_threads_mutex;
 
+  /** The per handler queues, used if useRingBuffer is set. */
+  ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask> ringBufferTasks;
+  QAtomicInt useRingBuffer;
+
 public:
 
   /**
@@ -61,8 +70,11 @@ public:
    *        dispatching threads in case of timeout or that the asynchronous event
    *        dispatching thread is used to send a synchronous event
    * @param deliverTask The deliver tasks for dispatching the event.
+   * @param ringBuffer Whether the events are queued per event handler
+   * @param queueSize The capacity of the queue of each event handler
    */
-  ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask);
+  ctkEAAsyncDeliverTasks(ctkEADefaultThreadPool* pool, DeliverTask* deliverTask,
+                         bool ringBuffer, int queueSize);
 
   /**
    * This does not block an unrelated thread used to send a synchronous event.
@@ -73,6 +85,19 @@ public:
    */
   void execute(const QList<HandlerTask>& tasks);
 
+  /**
+   * Update the dispatch engine. The events already queued when
+   * switching engines are still delivered by the previous one.
+   */
+  void update(bool ringBuffer, int queueSize);
+
+  /**
+   * Release the resources kept for an unregistered event handler.
+   *
+   * @param handlerRef The reference of the unregistered handler
+   */
+  void handlerUnregistered(const ctkServiceReference& handlerRef);
+
 private:
 
   class TaskExecuter;
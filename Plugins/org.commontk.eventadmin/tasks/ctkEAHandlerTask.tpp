@@ -91,6 +91,12 @@ QString ctkEAHandlerTask<BlacklistingHandlerTasks>::getHandlerClassName() const
   return handler->metaObject()->className();
 }
 
+template<class BlacklistingHandlerTasks>
+ctkServiceReference ctkEAHandlerTask<BlacklistingHandlerTasks>::getHandlerReference() const
+{
+  return eventHandlerRef;
+}
+
 template<class BlacklistingHandlerTasks>
 void ctkEAHandlerTask<BlacklistingHandlerTasks>::execute()
 {
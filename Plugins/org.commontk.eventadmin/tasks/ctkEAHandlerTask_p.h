@@ -73,6 +73,11 @@ public:
    */
   QString getHandlerClassName() const;
 
+  /**
+   * Return the service reference of the handler
+   */
+  ctkServiceReference getHandlerReference() const;
+
   /**
    * Deliver the event to the handler.
    */
@@ -0,0 +1,270 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include <ctkException.h>
+
+/**
+ * The queue of an event handler. When the ring buffer is full, the tasks
+ * spill over into a locked list, which is not bounded, until the consumer
+ * caught up, so that posting never blocks and the order of the tasks is kept.
+ */
+template<class SyncDeliverTasks, class HandlerTask>
+class ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::HandlerQueue
+{
+
+public:
+
+  const ctkServiceReference handlerRef;
+
+  // 1 while a drainer is scheduled or running for this queue
+  QAtomicInt scheduled;
+
+  HandlerQueue(const ctkServiceReference& handlerRef, int queueSize)
+    : handlerRef(handlerRef), buffer(queueSize)
+  {
+  }
+
+  // From any thread
+  void push(const HandlerTask& task)
+  {
+    if (!overflowing.loadAcquire() && buffer.tryPush(task))
+    {
+      return;
+    }
+    QMutexLocker l(&overflowMutex);
+    overflow.push_back(task);
+    overflowing.storeRelease(1);
+  }
+
+  // From the drainer only: the spilled tasks are taken once the
+  // buffer is empty, and delivered before newer tasks of the buffer.
+  bool pop(QList<HandlerTask>& batch)
+  {
+    if (!spilled.isEmpty())
+    {
+      batch.push_back(spilled.takeFirst());
+      return true;
+    }
+    if (popBuffer(batch))
+    {
+      return true;
+    }
+    if (overflowing.loadAcquire())
+    {
+      {
+        QMutexLocker l(&overflowMutex);
+        spilled.swap(overflow);
+        overflowing.storeRelease(0);
+      }
+      if (!spilled.isEmpty())
+      {
+        batch.push_back(spilled.takeFirst());
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // From the drainer only
+  bool isEmpty() const
+  {
+    return spilled.isEmpty() && buffer.isEmpty() && !overflowing.loadAcquire();
+  }
+
+private:
+
+  ctkEARingBuffer<HandlerTask> buffer;
+
+  QAtomicInt overflowing;
+  QMutex overflowMutex;
+  QList<HandlerTask> overflow;
+
+  QList<HandlerTask> spilled;
+
+  bool popBuffer(QList<HandlerTask>& batch)
+  {
+    return buffer.tryPop(batch);
+  }
+};
+
+/**
+ * Delivers the tasks of a handler queue until it is empty.
+ */
+template<class SyncDeliverTasks, class HandlerTask>
+class ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::Drainer
+    : public QRunnable
+{
+
+public:
+
+  Drainer(ctkEARingBufferDeliverTasks* tc, const QSharedPointer<HandlerQueue>& queue)
+    : tc(tc), queue(queue)
+  {
+  }
+
+  void run()
+  {
+    for (;;)
+    {
+      QList<HandlerTask> batch;
+      while (batch.size() < tc->batchSize && queue->pop(batch)) {}
+
+      if (!batch.isEmpty())
+      {
+        tc->deliver(batch);
+        continue;
+      }
+
+      queue->scheduled.fetchAndStoreOrdered(0);
+      // a producer may have pushed after the queue was found empty
+      // but before the flag was cleared
+      if (queue->isEmpty() || !queue->scheduled.testAndSetOrdered(0, 1))
+      {
+        break;
+      }
+    }
+
+    if (!queue->handlerRef)
+    {
+      // the handler is unregistered
+      tc->removeHandlerQueue(queue);
+    }
+  }
+
+private:
+
+  ctkEARingBufferDeliverTasks* tc;
+  QSharedPointer<HandlerQueue> queue;
+};
+
+template<class SyncDeliverTasks, class HandlerTask>
+ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::ctkEARingBufferDeliverTasks(
+  ctkEADefaultThreadPool* pool, SyncDeliverTasks* deliverTask, int queueSize, int batchSize)
+  : pool(pool), deliver_task(deliverTask), batchSize(qMax(1, batchSize)), queueSize(queueSize)
+{
+  threadPool.setMaxThreadCount(qMax(1, pool->getMinimumPoolSize()));
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::~ctkEARingBufferDeliverTasks()
+{
+  waitForDone();
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::setQueueSize(int queueSize)
+{
+  this->queueSize.storeRelease(queueSize);
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::execute(const QList<HandlerTask>& tasks)
+{
+  foreach(const HandlerTask& task, tasks)
+  {
+    QSharedPointer<HandlerQueue> queue = handlerQueue(task.getHandlerReference());
+    queue->push(task);
+    if (queue->scheduled.testAndSetOrdered(0, 1))
+    {
+      // follow the reconfigurations of the thread pool size
+      int poolSize = qMax(1, pool->getMinimumPoolSize());
+      if (threadPool.maxThreadCount() != poolSize)
+      {
+        threadPool.setMaxThreadCount(poolSize);
+      }
+      threadPool.start(new Drainer(this, queue));
+    }
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::waitForDone()
+{
+  threadPool.waitForDone();
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::removeHandler(const ctkServiceReference& handlerRef)
+{
+  QWriteLocker l(&queuesLock);
+  QSharedPointer<HandlerQueue> queue = queues.value(handlerRef);
+  // a scheduled drainer removes the queue itself when it is done
+  if (queue && !queue->scheduled.loadAcquire())
+  {
+    queues.remove(handlerRef);
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+QSharedPointer<typename ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::HandlerQueue>
+ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::handlerQueue(const ctkServiceReference& handlerRef)
+{
+  {
+    QReadLocker l(&queuesLock);
+    QSharedPointer<HandlerQueue> queue = queues.value(handlerRef);
+    if (queue)
+    {
+      return queue;
+    }
+  }
+
+  QWriteLocker l(&queuesLock);
+  QSharedPointer<HandlerQueue>& queue = queues[handlerRef];
+  if (!queue)
+  {
+    queue = QSharedPointer<HandlerQueue>(new HandlerQueue(handlerRef, queueSize.loadAcquire()));
+  }
+  return queue;
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::removeHandlerQueue(
+  const QSharedPointer<HandlerQueue>& queue)
+{
+  QWriteLocker l(&queuesLock);
+  if (queues.value(queue->handlerRef) == queue)
+  {
+    queues.remove(queue->handlerRef);
+  }
+}
+
+template<class SyncDeliverTasks, class HandlerTask>
+void ctkEARingBufferDeliverTasks<SyncDeliverTasks, HandlerTask>::deliver(const QList<HandlerTask>& batch)
+{
+  // All the tasks of a batch are for the same handler
+  if (deliver_task->useTimeout(batch.front()))
+  {
+    deliver_task->execute(batch);
+    return;
+  }
+
+  foreach(HandlerTask task, batch)
+  {
+    try
+    {
+      task.execute();
+    }
+    catch (const ctkIllegalStateException& )
+    {
+      // this can happen on shutdown, so we ignore it
+    }
+  }
+}
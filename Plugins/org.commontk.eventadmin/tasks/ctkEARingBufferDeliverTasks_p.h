@@ -0,0 +1,127 @@
+/*=============================================================================
+
+  Library: CTK
+
+  Copyright (c) German Cancer Research Center,
+    Division of Medical and Biological Informatics
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+
+#ifndef CTKEARINGBUFFERDELIVERTASKS_P_H
+#define CTKEARINGBUFFERDELIVERTASKS_P_H
+
+#include "ctkEADeliverTask_p.h"
+#include <dispatch/ctkEADefaultThreadPool_p.h>
+#include <dispatch/ctkEARingBuffer_p.h>
+
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+/**
+ * This class is an alternative engine for the asynchronous event dispatch.
+ * Each event handler has its own queue, a bounded ring buffer filled without
+ * locking by the posting threads, which spills over into an unbounded locked
+ * list when it is full. A queue is drained in batches by a single worker thread
+ * at a time,
+ * so that the events are delivered to each handler in the order they were
+ * posted. A worker thread is only requested from the pool when the queue of a
+ * handler becomes non-empty.
+ *
+ * Handlers which are subject to the timeout handling are delivered through the
+ * synchronous deliver tasks, one batch at a time, the other ones are called
+ * directly from the worker thread.
+ *
+ * There are at most as many worker threads as the minimum size of the
+ * asynchronous thread pool of the event admin, which is derived from
+ * org.commontk.eventadmin.ThreadPoolSize.
+ */
+template<class SyncDeliverTasks, class HandlerTask>
+class ctkEARingBufferDeliverTasks : public ctkEADeliverTask<ctkEARingBufferDeliverTasks<SyncDeliverTasks,HandlerTask>, HandlerTask>
+{
+
+public:
+
+  /**
+   * @param pool The asynchronous thread pool of the event admin, giving the
+   *        maximum number of worker threads.
+   * @param deliverTask The deliver tasks used for handlers with a timeout.
+   * @param queueSize The capacity of the queue of each handler.
+   * @param batchSize The maximum number of events delivered at once.
+   */
+  ctkEARingBufferDeliverTasks(ctkEADefaultThreadPool* pool, SyncDeliverTasks* deliverTask,
+                              int queueSize, int batchSize);
+
+  /**
+   * Waits for the queued events to be delivered.
+   */
+  ~ctkEARingBufferDeliverTasks();
+
+  /**
+   * Set the capacity of the queues created from now on.
+   */
+  void setQueueSize(int queueSize);
+
+  /**
+   * Queue the tasks for their handlers. This never blocks: the tasks for a
+   * handler whose ring buffer is full are kept in its overflow list, so the
+   * memory used by the queue of a slow handler is not bounded (see HandlerQueue).
+   *
+   * @param tasks The event handler dispatch tasks to execute
+   *
+   * @see ctkEADeliverTask#execute(const QList<HandlerTask>&)
+   */
+  void execute(const QList<HandlerTask>& tasks);
+
+  /**
+   * Wait for the queued events to be delivered.
+   */
+  void waitForDone();
+
+  /**
+   * Free the queue of an unregistered handler. A queue still being drained
+   * is freed by its worker thread once it is empty.
+   *
+   * @param handlerRef The reference of the unregistered handler
+   */
+  void removeHandler(const ctkServiceReference& handlerRef);
+
+private:
+
+  class HandlerQueue;
+  class Drainer;
+
+  ctkEADefaultThreadPool* const pool;
+  SyncDeliverTasks* const deliver_task;
+  const int batchSize;
+  QAtomicInt queueSize;
+
+  QThreadPool threadPool;
+
+  QHash<ctkServiceReference, QSharedPointer<HandlerQueue> > queues;
+  QReadWriteLock queuesLock;
+
+  QSharedPointer<HandlerQueue> handlerQueue(const ctkServiceReference& handlerRef);
+  void removeHandlerQueue(const QSharedPointer<HandlerQueue>& queue);
+
+  void deliver(const QList<HandlerTask>& batch);
+};
+
+#include "ctkEARingBufferDeliverTasks.tpp"
+
+#endif // CTKEARINGBUFFERDELIVERTASKS_P_H
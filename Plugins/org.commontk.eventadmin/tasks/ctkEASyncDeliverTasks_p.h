@@ -129,6 +129,9 @@ public:
 
 private:
 
+  // Delivers the handlers subject to the timeout handling through execute()
+  template<class S, class H> friend class ctkEARingBufferDeliverTasks;
+
   /**
    * This method defines if a timeout handling should be used for the
    * task.